@@ -43,6 +43,8 @@ SOURCES += main.cpp\
     re/dbccomparatorwindow.cpp \
     mainwindow.cpp \
     canframemodel.cpp \
+    canframestore.cpp \
+    framebatch.cpp \
     simplecrypt.cpp \
     triggerdialog.cpp \
     utility.cpp \
@@ -51,6 +53,8 @@ SOURCES += main.cpp\
     candatagrid.cpp \
     framesenderwindow.cpp \
     framefileio.cpp \
+    continuouslogger.cpp \
+    decodedexport.cpp \
     mainsettingsdialog.cpp \
     firmwareuploaderwindow.cpp \
     scriptingwindow.cpp \
@@ -70,6 +74,10 @@ SOURCES += main.cpp\
     dbc/dbcmessageeditor.cpp \
     dbc/dbc_classes.cpp \
     dbc/dbchandler.cpp \
+    dbc/dbccache.cpp \
+    dbc/dbclineparser.cpp \
+    dbc/signalbulkdecoder.cpp \
+    dbc/signalstore.cpp \
     dbc/dbcloadsavewindow.cpp \
     dbc/dbcmaineditor.cpp \
     dbc/dbcnodeeditor.cpp \
@@ -97,6 +105,9 @@ SOURCES += main.cpp\
     frameplaybackobject.cpp \
     helpwindow.cpp \
     blfhandler.cpp \
+    capturefile.cpp \
+    textlogloader.cpp \
+    filesniffer.cpp \
     re/sniffer/SnifferDelegate.cpp \
     connections/newconnectiondialog.cpp \
     re/temporalgraphwindow.cpp \
@@ -107,6 +118,8 @@ HEADERS  += mainwindow.h \
     can_structs.h \
     canbridgewindow.h \
     canframemodel.h \
+    canframestore.h \
+    framebatch.h \
     connections/canlogserver.h \
     connections/canserver.h \
     connections/lawicel_serial.h \
@@ -145,6 +158,8 @@ HEADERS  += mainwindow.h \
     framesenderwindow.h \
     can_trigger_structs.h \
     framefileio.h \
+    continuouslogger.h \
+    decodedexport.h \
     config.h \
     mainsettingsdialog.h \
     firmwareuploaderwindow.h \
@@ -152,6 +167,7 @@ HEADERS  += mainwindow.h \
     scriptcontainer.h \
     canfilter.h \
     utils/lfqueue.h \
+    utils/signalextractor.h \
     motorcontrollerconfigwindow.h \
     connections/canconnection.h \
     connections/serialbusconnection.h \
@@ -164,6 +180,10 @@ HEADERS  += mainwindow.h \
     re/sniffer/snifferwindow.h \
     dbc/dbc_classes.h \
     dbc/dbchandler.h \
+    dbc/dbccache.h \
+    dbc/dbclineparser.h \
+    dbc/signalbulkdecoder.h \
+    dbc/signalstore.h \
     dbc/dbcloadsavewindow.h \
     dbc/dbcmaineditor.h \
     dbc/dbcsignaleditor.h \
@@ -192,6 +212,9 @@ HEADERS  += mainwindow.h \
     frameplaybackobject.h \
     helpwindow.h \
     blfhandler.h \
+    capturefile.h \
+    textlogloader.h \
+    filesniffer.h \
     re/sniffer/SnifferDelegate.h \
     connections/newconnectiondialog.h \
     re/temporalgraphwindow.h \
@@ -8,7 +8,7 @@
 #include <QDebug>
 #include <algorithm>
 
-BisectWindow::BisectWindow(const QVector<CANFrame> *frames, QWidget *parent) :
+BisectWindow::BisectWindow(const CANFrameStore *frames, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::BisectWindow)
 {
@@ -18,6 +18,7 @@ BisectWindow::BisectWindow(const QVector<CANFrame> *frames, QWidget *parent) :
     modelFrames = frames;
 
     connect(MainWindow::getReference(), SIGNAL(framesUpdated(int)), this, SLOT(updatedFrames(int)));
+    connect(MainWindow::getReference(), SIGNAL(framesEvicted(int)), this, SLOT(framesEvicted(int)));
     connect(ui->btnCalculate, &QAbstractButton::clicked, this, &BisectWindow::handleCalculateButton);
     connect(ui->btnReplaceFrames, &QAbstractButton::clicked, this, &BisectWindow::handleReplaceButton);
     connect(ui->btnSaveFrames, &QAbstractButton::clicked, this, &BisectWindow::handleSaveButton);
@@ -101,7 +102,7 @@ void BisectWindow::refreshIDList()
     ui->cbIDUpper->clear();
     for (int i = 0; i < modelFrames->count(); i++)
     {
-        id = modelFrames->at(i).frameId();
+        id = modelFrames->view(i).frameId();
         if (!foundID.contains(id))
         {
             foundID.append(id);
@@ -140,6 +141,14 @@ void BisectWindow::updatedFrames(int numFrames)
     }
 }
 
+//the frame number slider must not point past the end once the oldest frames are gone
+void BisectWindow::framesEvicted(int numFrames)
+{
+    Q_UNUSED(numFrames);
+    refreshFrameNumbers();
+    updateFrameNumText();
+}
+
 void BisectWindow::handleCalculateButton()
 {
     splitFrames.clear();
@@ -165,7 +174,7 @@ void BisectWindow::handleCalculateButton()
         uint32_t upperID = Utility::ParseStringToNum2(ui->cbIDUpper->currentText());
         for (int i = 0; i < modelFrames->count(); i++)
         {
-            if (modelFrames->at(i).frameId() >= lowerID && modelFrames->at(i).frameId() <= upperID)
+            if (modelFrames->view(i).frameId() >= lowerID && modelFrames->view(i).frameId() <= upperID)
             {
                 if (saveLower) splitFrames.append(modelFrames->at(i));
             }
@@ -180,7 +189,7 @@ void BisectWindow::handleCalculateButton()
         int targetBus = Utility::ParseStringToNum(ui->editBusNum->text());
         for (int i = 0; i < modelFrames->count(); i++)
         {
-            if (modelFrames->at(i).bus == targetBus)
+            if (modelFrames->view(i).bus() == targetBus)
             {
                 if (saveLower) splitFrames.append(modelFrames->at(i));
             }
@@ -3,6 +3,7 @@
 
 #include <QDialog>
 #include "can_structs.h"
+#include "canframestore.h"
 
 namespace Ui {
 class BisectWindow;
@@ -13,7 +14,7 @@ class BisectWindow : public QDialog
     Q_OBJECT
 
 public:
-    explicit BisectWindow(const QVector<CANFrame> *frames, QWidget *parent = 0);
+    explicit BisectWindow(const CANFrameStore *frames, QWidget *parent = 0);
     ~BisectWindow();
     void showEvent(QShowEvent*);
 
@@ -23,6 +24,7 @@ signals:
 
 private slots:
     void updatedFrames(int numFrames);
+    void framesEvicted(int numFrames);
     void handleSaveButton();
     void handleReplaceButton();
     void handleCalculateButton();
@@ -34,7 +36,7 @@ private slots:
 
 private:
     Ui::BisectWindow *ui;
-    const QVector<CANFrame> *modelFrames;
+    const CANFrameStore *modelFrames;
     QVector<CANFrame> splitFrames;
     QList<int> foundID;
 
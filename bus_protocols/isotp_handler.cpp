@@ -123,25 +123,25 @@ void ISOTP_HANDLER::updatedFrames(int numFrames)
     }
 }
 
-void ISOTP_HANDLER::rapidFrames(const CANConnection* conn, const QVector<CANFrame>& pFrames)
+void ISOTP_HANDLER::rapidFrames(const FrameBatchPtr &pBatch)
 {
-    Q_UNUSED(conn)
-    if (pFrames.length() <= 0) return;
+    if (pBatch->count() <= 0) return;
 
-    qDebug() << "received " << QString::number(pFrames.count()) << " messages in ISOTP handler";
+    qDebug() << "received " << QString::number(pBatch->count()) << " messages in ISOTP handler";
 
-    foreach(const CANFrame& thisFrame, pFrames)
+    for (int c = 0; c < pBatch->count(); c++)
     {
+        CANFrameView thisFrame = pBatch->view(c);
         //only process frames that we've marked are ISOTP frames
         //unless processAll is true
-        if (processAll) processFrame(thisFrame);
+        if (processAll) processFrame(thisFrame.toCANFrame());
         else
         {
             for (int i = 0; i < filters.count(); i++)
             {
-                if ((thisFrame.bus == filters[i].bus) && ((thisFrame.frameId() & filters[i].mask) == filters[i].ID))
+                if ((thisFrame.bus() == filters[i].bus) && ((thisFrame.frameId() & filters[i].mask) == filters[i].ID))
                 {
-                    processFrame(thisFrame);
+                    processFrame(thisFrame.toCANFrame());
                     break;
                 }
             }
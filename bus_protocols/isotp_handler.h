@@ -9,6 +9,7 @@
 #include "canframemodel.h"
 #include "isotp_message.h"
 #include "canfilter.h"
+#include "framebatch.h"
 
 class ISOTP_HANDLER : public QObject
 {
@@ -29,7 +30,7 @@ public:
 
 public slots:
     void updatedFrames(int);
-    void rapidFrames(const CANConnection* conn, const QVector<CANFrame>& pFrames);
+    void rapidFrames(const FrameBatchPtr &pBatch);
     void frameTimerTick();
 
 signals:
@@ -39,7 +40,7 @@ private:
     QHash<uint32_t, ISOTP_MESSAGE> messageBuffer;
     QList<CANFrame> sendingFrames;
     QList<CANFilter> filters;
-    const QVector<CANFrame> *modelFrames;
+    const CANFrameStore *modelFrames;
     bool useExtendedAddressing;
     bool isReceiving;
     bool waitingForFlow;
@@ -5,6 +5,7 @@
 #include <QObject>
 #include <QDebug>
 #include "can_structs.h"
+#include "canframestore.h"
 #include "isotp_message.h"
 
 class ISOTP_HANDLER;
@@ -114,7 +115,7 @@ signals:
 
 private:
     QList<ISOTP_MESSAGE> messageBuffer;
-    const QVector<CANFrame> *modelFrames;
+    const CANFrameStore *modelFrames;
     bool isReceiving;
     bool useExtendedAddressing;
 
@@ -4,6 +4,10 @@
 #include <QObject>
 #include <QVector>
 #include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
 #include <QCanBusFrame>
 
 //Now inherits from the built-in CAN frame class from Qt. This should be more future proof and easier to integrate with other code
@@ -16,11 +20,14 @@ public:
     uint64_t timedelta;
     uint32_t frameCount; //used in overwrite mode
 
+    int64_t timestampMicros() const
+    {
+        return timeStamp().seconds() * 1000000 + timeStamp().microSeconds();
+    }
+
     friend bool operator<(const CANFrame& l, const CANFrame& r)
     {
-        qint64 lStamp = l.timeStamp().seconds() * 1000000 + l.timeStamp().microSeconds();
-        qint64 rStamp = r.timeStamp().seconds() * 1000000 + r.timeStamp().microSeconds();
-        return lStamp < rStamp;
+        return l.timestampMicros() < r.timestampMicros();
     }
 
     CANFrame()
@@ -35,6 +42,109 @@ public:
     }
 };
 
+Q_DECLARE_METATYPE(CANFrame)
+
+/*
+ * Plain copy of a frame for code that churns through lots of them. No QByteArray, no refcount, no
+ * virtual anything so arrays of these can be sorted, filtered and memcpy'd freely. Convert from CANFrame
+ * (or a QCanBusFrame at the QtSerialBus boundary) once, work on these, convert back only where a
+ * CANFrame is really needed.
+ */
+struct CANFrameData
+{
+    enum Flags : uint8_t
+    {
+        Extended        = 0x01,
+        FlexibleData    = 0x02,
+        BitrateSwitch   = 0x04,
+        ErrorState      = 0x08,
+        Received        = 0x10
+    };
+
+    int64_t timestamp; //microseconds
+    uint32_t frameId;
+    uint8_t bus;
+    uint8_t length;
+    uint8_t flags;
+    uint8_t frameType; //QCanBusFrame::FrameType, covers remote and error frames
+    uint8_t data[64];
+
+    bool isExtended() const { return flags & Extended; }
+    bool isReceived() const { return flags & Received; }
+    bool isFD() const { return flags & FlexibleData; }
+
+    friend bool operator<(const CANFrameData& l, const CANFrameData& r)
+    {
+        return l.timestamp < r.timestamp;
+    }
+
+    static CANFrameData fromQCanBusFrame(const QCanBusFrame &frame, int bus, bool received)
+    {
+        CANFrameData out;
+        out.timestamp = frame.timeStamp().seconds() * 1000000 + frame.timeStamp().microSeconds();
+        //error frames keep their error flags in the ID field, same as the capture store does
+        if (frame.frameType() == QCanBusFrame::ErrorFrame) out.frameId = static_cast<uint32_t>(frame.error());
+        else out.frameId = frame.frameId();
+        out.bus = static_cast<uint8_t>(bus);
+        out.frameType = static_cast<uint8_t>(frame.frameType());
+        out.flags = 0;
+        if (frame.hasExtendedFrameFormat()) out.flags |= Extended;
+        if (frame.hasFlexibleDataRateFormat()) out.flags |= FlexibleData;
+        if (frame.hasBitrateSwitch()) out.flags |= BitrateSwitch;
+        if (frame.hasErrorStateIndicator()) out.flags |= ErrorState;
+        if (received) out.flags |= Received;
+        const QByteArray payload = frame.payload();
+        out.length = static_cast<uint8_t>(qMin(payload.length(), 64));
+        memcpy(out.data, payload.constData(), out.length);
+        memset(out.data + out.length, 0, sizeof(out.data) - out.length);
+        return out;
+    }
+
+    static CANFrameData fromCANFrame(const CANFrame &frame)
+    {
+        return fromQCanBusFrame(frame, frame.bus, frame.isReceived);
+    }
+
+    CANFrame toCANFrame() const
+    {
+        CANFrame frame;
+        QCanBusFrame::FrameType type = static_cast<QCanBusFrame::FrameType>(frameType);
+        frame.setFrameType(type);
+        if (type == QCanBusFrame::ErrorFrame) frame.setError(QCanBusFrame::FrameErrors(QFlag(static_cast<int>(frameId))));
+        else frame.setFrameId(frameId);
+        frame.setExtendedFrameFormat(flags & Extended);
+        frame.setPayload(QByteArray(reinterpret_cast<const char *>(data), length));
+        frame.setFlexibleDataRateFormat(flags & FlexibleData);
+        frame.setBitrateSwitch(flags & BitrateSwitch);
+        frame.setErrorStateIndicator(flags & ErrorState);
+        frame.setTimeStamp(QCanBusFrame::TimeStamp(0, timestamp));
+        frame.bus = bus;
+        frame.isReceived = flags & Received;
+        return frame;
+    }
+};
+
+static_assert(std::is_trivially_copyable<CANFrameData>::value, "CANFrameData has to stay a plain struct");
+
+//Sorts by timestamp without shuffling CANFrames (and their payload refcounts) around for every comparison.
+//Stable so frames with equal timestamps keep their order.
+inline void sortFramesByTime(QVector<CANFrame> &frames)
+{
+    std::vector<std::pair<int64_t, int>> keys;
+    keys.reserve(frames.count());
+    for (int i = 0; i < frames.count(); i++) keys.push_back(std::make_pair(frames[i].timestampMicros(), i));
+
+    std::stable_sort(keys.begin(), keys.end(), [](const std::pair<int64_t, int> &l, const std::pair<int64_t, int> &r)
+    {
+        return l.first < r.first;
+    });
+
+    QVector<CANFrame> sorted;
+    sorted.reserve(frames.count());
+    for (const std::pair<int64_t, int> &key : keys) sorted.append(frames[key.second]);
+    frames.swap(sorted);
+}
+
 class CANFltObserver
 {
 public:
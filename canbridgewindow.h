@@ -3,6 +3,7 @@
 
 #include <QDialog>
 #include "connections/canconmanager.h"
+#include "canframestore.h"
 
 namespace Ui {
 class CANBridgeWindow;
@@ -13,7 +14,7 @@ class CANBridgeWindow : public QDialog
     Q_OBJECT
 
 public:
-    explicit CANBridgeWindow(const QVector<CANFrame> *frames, QWidget *parent = nullptr);
+    explicit CANBridgeWindow(const CANFrameStore *frames, QWidget *parent = nullptr);
     ~CANBridgeWindow();
     void showEvent(QShowEvent*);
 
@@ -24,7 +25,7 @@ private slots:
 
 private:
     Ui::CANBridgeWindow *ui;
-    const QVector<CANFrame> *modelFrames;
+    const CANFrameStore *modelFrames;
     QMap<int, bool> foundIDSide1;
     QMap<int, bool> foundIDSide2;
     int side1BusNum;
@@ -5,12 +5,23 @@
 #include <QPalette>
 #include <QDateTime>
 #include <QSettings>
+#include <QElapsedTimer>
+#include <algorithm>
 #include "utility.h"
+#include "connections/canconmanager.h"
+
+//key used to find the overwrite mode row for a frame. ID in the lower 29 bits, bus number above that
+static inline uint64_t overwriteKey(uint32_t id, int bus)
+{
+    return static_cast<uint64_t>(id) + (static_cast<uint64_t>(bus) << 29ull);
+}
 
 CANFrameModel::~CANFrameModel()
 {
-    frames.clear();
+    CANConManager::getInstance()->setIngestStore(nullptr);
     filteredFrames.clear();
+    frames.clear();
+    idRows.clear();
     filters.clear();
     busFilters.clear();
 }
@@ -18,16 +29,7 @@ CANFrameModel::~CANFrameModel()
 int CANFrameModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    if (filteredFrames.data())
-    {
-        int rows = filteredFrames.count();
-        return rows;
-    }
-
-     //just in case somehow data is invalid which I have seen before.
-    //But, this should not happen so issue a debugging message too
-    qDebug() << "Invalid data for filteredFrames. Returning 0.";
-    return 0;
+    return shownFrames().count();
 }
 
 int CANFrameModel::totalFrameCount()
@@ -44,7 +46,7 @@ int CANFrameModel::columnCount(const QModelIndex &index) const
 }
 
 CANFrameModel::CANFrameModel(QObject *parent)
-    : QAbstractTableModel(parent)
+    : QAbstractTableModel(parent), filteredFrames(&frames), signalStore(&frames, &idRows)
 {
     int maxFramesDefault;
     if (QSysInfo::WordSize > 32)
@@ -61,14 +63,10 @@ CANFrameModel::CANFrameModel(QObject *parent)
     QSettings settings;
     preallocSize = settings.value("Main/MaximumFrames", maxFramesDefault).toInt();
 
-    //Each CANFrame object takes up 56 bytes and we're allocating two arrays here so take the
-    //# of pre-alloc frames and multiply by 112 to get the RAM usage. This is around 1GiB for the default.
-
-    //the goal is to prevent a reallocation from ever happening
+    //Frames are kept packed in CANFrameStore at 24 bytes each (plus the payload for CAN-FD frames) and the store
+    //only allocates as frames actually arrive. preallocSize is the retention limit when keeping a fixed number of frames.
     frames.reserve(preallocSize);
-    //this is pretty wasteful. We're storing all frames twice. It may be better for filteredFrames to be a list of pointers.
-    //Pointers take up 8 bytes instead of 56 so this is quite a savings for RAM usage. But, then filteredFrames would
-    //work differently from frames above so the two could not be used interchangeably. Still think about what can be done.
+    //filteredFrames only holds 4 byte row numbers into frames
     filteredFrames.reserve(preallocSize);
 
     dbcHandler = DBCHandler::getReference();
@@ -82,11 +80,29 @@ CANFrameModel::CANFrameModel(QObject *parent)
     lastUpdateNumFrames = 0;
     timeFormat =  "MMM-dd HH:mm:ss.zzz";
     sortDirAsc = false;
+    filteredInFrameOrder = true;
+    overwriteRowsAdded = false;
     bytesPerLine = 8;
+    ingestHold = false;
+    streaming = false;
+    textCache.setMaxCost(TEXT_CACHE_ROWS);
+    textCacheRevision = DBCMessageHandler::revision();
+    decodeAheadRow = 0;
+    decodeAheadDistance = 0;
+    decodeAheadTimer = new QTimer(this);
+    decodeAheadTimer->setSingleShot(true);
+    decodeAheadTimer->setInterval(0);
+    connect(decodeAheadTimer, &QTimer::timeout, this, &CANFrameModel::decodeAhead);
+
+    loadRetentionSettings();
+
+    //captured frames are packed straight into frames by the ingest thread, see acceptIngestedFrames
+    CANConManager::getInstance()->setIngestStore(&frames);
 }
 
 void CANFrameModel::setBytesPerLine(int bpl)
 {
+    if (bytesPerLine != bpl) textCache.clear();
     bytesPerLine = bpl;
 }
 
@@ -97,6 +113,7 @@ void CANFrameModel::setHexMode(bool mode)
         this->beginResetModel();
         useHexMode = mode;
         Utility::decimalMode = !useHexMode;
+        textCache.clear();
         this->endResetModel();
     }
 }
@@ -120,6 +137,7 @@ void CANFrameModel::setInterpretMode(bool mode)
     {
         this->beginResetModel();
         interpretFrames = mode;
+        textCache.clear();
         this->endResetModel();
     }
 }
@@ -153,35 +171,33 @@ void CANFrameModel::setIgnoreDBCColors(bool mode)
 void CANFrameModel::normalizeTiming()
 {
     mutex.lock();
-    if (frames.count() == 0) 
+    if (frames.count() == 0 || streaming)
     {
         mutex.unlock();
         return;
     }
-    timeOffset = frames[0].timeStamp().microSeconds();
+    timeOffset = frames.view(0).timestamp();
     qint64 prevStamp = 0;
 
     //find the absolute lowest timestamp in the whole time. Needed because maybe timestamp was reset in the middle.
     for (int j = 0; j < frames.count(); j++)
     {
-        if (frames[j].timeStamp().microSeconds() < timeOffset) timeOffset = frames[j].timeStamp().microSeconds();
+        if (frames.view(j).timestamp() < timeOffset) timeOffset = frames.view(j).timestamp();
     }
 
     for (int i = 0; i < frames.count(); i++)
     {
-        qint64 thisStamp = frames[i].timeStamp().microSeconds() - timeOffset;
+        qint64 thisStamp = frames.view(i).timestamp() - timeOffset;
         if (thisStamp <= prevStamp)
         {
             timeOffset -= prevStamp;
         }
-        frames[i].setTimeStamp(QCanBusFrame::TimeStamp(0, thisStamp));
+        frames.setTimestamp(i, thisStamp);
     }
+    signalStore.reset();
 
+    //filteredFrames reads its timestamps straight out of frames so there is nothing else to fix up
     this->beginResetModel();
-    for (int i = 0; i < filteredFrames.count(); i++)
-    {
-        filteredFrames[i].setTimeStamp(QCanBusFrame::TimeStamp(0, filteredFrames[i].timeStamp().microSeconds() - timeOffset));
-    }
     this->endResetModel();
 
     mutex.unlock();
@@ -189,10 +205,9 @@ void CANFrameModel::normalizeTiming()
 
 void CANFrameModel::setOverwriteMode(bool mode)
 {
-    beginResetModel();
     overwriteDups = mode;
-    recalcOverwrite();
-    endResetModel();
+    //rebuilds the filtered view for the new mode, either way the model gets reset
+    sendRefresh();
 }
 
 void CANFrameModel::setClearMode(bool mode)
@@ -200,11 +215,33 @@ void CANFrameModel::setClearMode(bool mode)
     filtersPersistDuringClear = mode;
 }
 
+/*
+ * Toggling a single ID only merges or removes the rows for that ID using its list in idRows.
+ * Overwrite mode and a column sorted grid still take the full refresh path.
+ */
 void CANFrameModel::setFilterState(unsigned int ID, bool state)
 {
     if (!filters.contains(ID)) return;
+    if (filters[ID] == state) return;
     filters[ID] = state;
-    sendRefresh();
+
+    if (overwriteDups || !filteredInFrameOrder)
+    {
+        sendRefresh();
+        return;
+    }
+
+    bool busTable[256];
+    fillBusFilterTable(busTable);
+    QVector<uint32_t> idList = filteredRowsForID(ID, busTable);
+
+    mutex.lock();
+    beginResetModel();
+    if (state) filteredFrames.mergeRows(idList);
+    else filteredFrames.removeRows(idList);
+    lastUpdateNumFrames = 0;
+    endResetModel();
+    mutex.unlock();
 }
 
 void CANFrameModel::setBusFilterState(unsigned int BusID, bool state)
@@ -225,11 +262,10 @@ void CANFrameModel::setAllFilters(bool state)
 }
 
 /*
- * There is probably a more correct way to have done this but below are several functions that collectively implement
- * quicksort on the columns and interpret the columns numerically. But, correct or not, this implementation is quite fast
- * and sorts the columns properly.
+ * Sorting works on a list of row numbers with the sort key pulled out once per row. Since the filtered
+ * list is a view into frames only its row numbers get shuffled, no frame data moves.
 */
-uint64_t CANFrameModel::getCANFrameVal(QVector<CANFrame> *frames, int row, Column col)
+uint64_t CANFrameModel::getCANFrameVal(const CANFrameStore *frames, int row, Column col)
 {
     uint64_t temp = 0;
     if (row >= frames->count()) return 0;
@@ -266,76 +302,31 @@ uint64_t CANFrameModel::getCANFrameVal(QVector<CANFrame> *frames, int row, Colum
     return 0;
 }
 
-void CANFrameModel::qSortCANFrameAsc(QVector<CANFrame> *frames, Column column, int lowerBound, int upperBound)
-{
-    int p, i, j;
-    qDebug() << "Lower " << lowerBound << " Upper" << upperBound;
-    if (lowerBound < upperBound)
-    {
-        uint64_t piv = getCANFrameVal(frames, lowerBound + (upperBound - lowerBound) / 2, column);
-        i = lowerBound - 1;
-        j = upperBound + 1;
-        for (;;){
-            do {
-                i++;
-            } while ((i < upperBound) && getCANFrameVal(frames, i, column) < piv);
-
-            do
-            {
-                j--;
-            } while ((j > lowerBound) && getCANFrameVal(frames, j, column) > piv);
-            if (i < j) {
-                CANFrame temp = frames->at(i);
-                frames->replace(i, frames->at(j));
-                frames->replace(j, temp);
-            }
-            else {p = j; break;}
-        }
-
-        qSortCANFrameAsc(frames, column, lowerBound, p);
-        qSortCANFrameAsc(frames, column, p+1, upperBound);
-    }
-}
-
-void CANFrameModel::qSortCANFrameDesc(QVector<CANFrame> *frames, Column column, int lowerBound, int upperBound)
+void CANFrameModel::sortCANFrames(CANFrameStore *frames, Column column, bool ascending)
 {
-    int p, i, j;
-    qDebug() << "Lower " << lowerBound << " Upper" << upperBound;
-    if (lowerBound < upperBound)
-    {
-        uint64_t piv = getCANFrameVal(frames, lowerBound + (upperBound - lowerBound) / 2, column);
-        i = lowerBound - 1;
-        j = upperBound + 1;
-        for (;;){
-            do {
-                i++;
-            } while ((i < upperBound) && getCANFrameVal(frames, i, column) > piv);
+    QVector<QPair<uint64_t, int>> keys;
+    keys.reserve(frames->count());
+    for (int i = 0; i < frames->count(); i++) keys.append(qMakePair(getCANFrameVal(frames, i, column), i));
 
-            do
-            {
-                j--;
-            } while ((j > lowerBound) && getCANFrameVal(frames, j, column) < piv);
-            if (i < j) {
-                CANFrame temp = frames->at(i);
-                frames->replace(i, frames->at(j));
-                frames->replace(j, temp);
-            }
-            else {p = j; break;}
-        }
+    if (ascending) std::stable_sort(keys.begin(), keys.end(), [](const QPair<uint64_t, int> &a, const QPair<uint64_t, int> &b) { return a.first < b.first; });
+    else std::stable_sort(keys.begin(), keys.end(), [](const QPair<uint64_t, int> &a, const QPair<uint64_t, int> &b) { return a.first > b.first; });
 
-        qSortCANFrameDesc(frames, column, lowerBound, p);
-        qSortCANFrameDesc(frames, column, p+1, upperBound);
-    }
+    QVector<int> order;
+    order.reserve(keys.count());
+    for (int i = 0; i < keys.count(); i++) order.append(keys[i].second);
+    frames->permute(order);
 }
 
 void CANFrameModel::sortByColumn(int column)
 {
+    if (streaming) return;
     sortDirAsc = !sortDirAsc;
-    if (sortDirAsc) qSortCANFrameAsc(&filteredFrames, Column(column), 0, filteredFrames.count()-1);
-    else qSortCANFrameDesc(&filteredFrames, Column(column), 0, filteredFrames.count()-1);
 
     mutex.lock();
     beginResetModel();
+    sortCANFrames(&filteredFrames, Column(column), sortDirAsc);
+    filteredInFrameOrder = false;
+    rebuildOverwriteIndex();
     endResetModel();
     mutex.unlock();
 }
@@ -344,7 +335,7 @@ void CANFrameModel::sortByColumn(int column)
 
 void CANFrameModel::recalcOverwrite()
 {
-    if (!overwriteDups) return; //no need to do a thing if mode is disabled
+    if (!overwriteDups || streaming) return; //no need to do a thing if mode is disabled
 
     qDebug() << "recalcOverwrite called in model";
 
@@ -352,46 +343,58 @@ void CANFrameModel::recalcOverwrite()
     beginResetModel();
 
     //Look at the current list of frames and turn it into just a list of unique IDs
-    QHash<uint64_t, CANFrame> overWriteFrames;
-    uint64_t idAugmented; //id in lower 29 bits, bus number shifted up 29 bits
-    foreach(CANFrame frame, frames)
+    struct OverwriteEntry
     {
-        if (frame.frameType() != frame.DataFrame) continue;
+        int row;
+        uint64_t timedelta;
+        uint32_t frameCount;
+    };
+    QHash<uint64_t, OverwriteEntry> overWriteFrames;
+    uint64_t idAugmented; //id in lower 29 bits, bus number shifted up 29 bits
+    bool busTable[256];
+    fillBusFilterTable(busTable);
 
-        idAugmented = frame.frameId();
-        idAugmented = idAugmented + (frame.bus << 29ull);
-        if (filters[frame.frameId()] && busFilters[frame.bus])
+    QHash<uint32_t, QVector<uint32_t>>::const_iterator idIter;
+    for (idIter = idRows.constBegin(); idIter != idRows.constEnd(); ++idIter)
+    {
+        if (!filters.value(static_cast<int>(idIter.key()))) continue;
+        const QVector<uint32_t> &rowList = idIter.value();
+        for (int i = 0; i < rowList.count(); i++)
         {
+            int row = static_cast<int>(rowList[i]);
+            CANFrameView view = frames.view(row);
+            if (view.frameType() != QCanBusFrame::DataFrame) continue;
+            if (!busTable[view.bus()]) continue;
+
+            idAugmented = overwriteKey(view.frameId(), view.bus());
             if (!overWriteFrames.contains(idAugmented))
             {
-                frame.timedelta = 0;
-                frame.frameCount = 1;
-                overWriteFrames.insert(idAugmented, frame);
+                OverwriteEntry entry;
+                entry.row = row;
+                entry.timedelta = 0;
+                entry.frameCount = 1;
+                overWriteFrames.insert(idAugmented, entry);
             }
             else
             {
-                frame.timedelta = frame.timeStamp().microSeconds() - overWriteFrames[idAugmented].timeStamp().microSeconds();
-                frame.frameCount = overWriteFrames[idAugmented].frameCount + 1;
-                overWriteFrames[idAugmented] = frame;
+                OverwriteEntry &entry = overWriteFrames[idAugmented];
+                entry.timedelta = view.timestamp() - frames.view(entry.row).timestamp();
+                entry.frameCount++;
+                entry.row = row;
             }
         }
     }
-    //Then replace the old list of frames with just the unique list
-    //frames.clear();
-    //frames.append(overWriteFrames.values().toVector());
-    //frames.reserve(preallocSize);
 
+    //Then the filtered view becomes just the newest row of each unique ID
     filteredFrames.clear();
-    filteredFrames.append(overWriteFrames.values().toVector());
     filteredFrames.reserve(preallocSize);
-
-    /*for (int i = 0; i < frames.count(); i++)
+    QHash<uint64_t, OverwriteEntry>::const_iterator it;
+    for (it = overWriteFrames.constBegin(); it != overWriteFrames.constEnd(); ++it)
     {
-        if (filters[frames[i].frameId()] && busFilters[frames[i].bus])
-        {
-            filteredFrames.append(frames[i]);
-        }
-    }*/
+        filteredFrames.appendRow(it.value().row);
+        filteredFrames.setOverwriteStats(filteredFrames.count() - 1, it.value().timedelta, it.value().frameCount);
+    }
+    rebuildOverwriteIndex();
 
     endResetModel();
     mutex.unlock();
@@ -407,12 +410,27 @@ QVariant CANFrameModel::data(const QModelIndex &index, int role) const
     if (!index.isValid())
         return QVariant();
 
-    if (index.row() >= (filteredFrames.count()))
+    if (index.row() >= (shownFrames().count()))
         return QVariant();
 
-    thisFrame = filteredFrames.at(index.row());
+    //the view asks for plenty of roles nothing here answers, don't unpack the frame for those
+    if (role != Qt::DisplayRole && role != Qt::BackgroundRole && role != Qt::ForegroundRole && role != Qt::TextAlignmentRole)
+        return QVariant();
+
+    //overwrite mode rows get new text in place as frames come in so only the full list is cached
+    if (role == Qt::DisplayRole && Column(index.column()) == Column::Data && !overwriteDups)
+    {
+        validateTextCache();
+        QString *cached = textCache.object(shownFrames().sequenceAt(index.row()));
+        if (cached)
+        {
+            scheduleDecodeAhead(index.row());
+            return *cached;
+        }
+    }
+
+    thisFrame = shownFrames().at(index.row());
 
-    const unsigned char *data = reinterpret_cast<const unsigned char *>(thisFrame.payload().constData());
     int dataLen = thisFrame.payload().count();
 
     if (role == Qt::BackgroundRole)
@@ -516,73 +534,144 @@ QVariant CANFrameModel::data(const QModelIndex &index, int role) const
             }
             return tempString;
         case Column::Data:
-            if (dataLen < 0) dataLen = 0;
-            //if (useHexMode) tempString.append("0x ");
-            if (thisFrame.frameType() == QCanBusFrame::RemoteRequestFrame) {
-                return tempString;
-            }
-            for (int i = 0; i < dataLen; i++)
-            {
-                if (useHexMode) tempString.append( QString::number(data[i], 16).toUpper().rightJustified(2, '0'));
-                else tempString.append(QString::number(data[i], 10));
-                if (!((i+1) % bytesPerLine) && (i != (dataLen - 1))) tempString.append("\n");
-                else tempString.append(" ");
-            }
-            if (thisFrame.frameType() == thisFrame.ErrorFrame)
+            tempString = formatDataText(thisFrame);
+            if (!overwriteDups)
             {
-                if (thisFrame.error() & thisFrame.TransmissionTimeoutError) tempString.append("\nTX Timeout");
-                if (thisFrame.error() & thisFrame.LostArbitrationError) tempString.append("\nLost Arbitration");
-                if (thisFrame.error() & thisFrame.ControllerError) tempString.append("\nController Error");
-                if (thisFrame.error() & thisFrame.ProtocolViolationError) tempString.append("\nProtocol Violation");
-                if (thisFrame.error() & thisFrame.TransceiverError) tempString.append("\nTransceiver Error");
-                if (thisFrame.error() & thisFrame.MissingAcknowledgmentError) tempString.append("\nMissing ACK");
-                if (thisFrame.error() & thisFrame.BusOffError) tempString.append("\nBus OFF");
-                if (thisFrame.error() & thisFrame.BusError) tempString.append("\nBus ERR");
-                if (thisFrame.error() & thisFrame.ControllerRestartError) tempString.append("\nController restart err");
-                if (thisFrame.error() & thisFrame.UnknownError) tempString.append("\nUnknown error type");
+                textCache.insert(shownFrames().sequenceAt(index.row()), new QString(tempString));
+                scheduleDecodeAhead(index.row());
             }
-            //TODO: technically the actual returned bytes for an error frame encode some more info. Not interpreting it yet.
+            return tempString;
+        default:
+            return tempString;
+        }
+    }
 
-            //now, if we're supposed to interpret the data and the DBC handler is loaded then use it
-            if ( (dbcHandler != nullptr) && interpretFrames && (thisFrame.frameType() == thisFrame.DataFrame) )
-            {
-                DBC_MESSAGE *msg = dbcHandler->findMessage(thisFrame);
-                if (msg != nullptr)
+    return QVariant();
+}
+
+//the Data column text for a frame. This is the expensive cell, decoding every signal when interpreting,
+//so data() keeps the result in textCache
+QString CANFrameModel::formatDataText(const CANFrame &thisFrame) const
+{
+    QString tempString;
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(thisFrame.payload().constData());
+    int dataLen = thisFrame.payload().count();
+
+    if (dataLen < 0) dataLen = 0;
+    //if (useHexMode) tempString.append("0x ");
+    if (thisFrame.frameType() == QCanBusFrame::RemoteRequestFrame) {
+        return tempString;
+    }
+    for (int i = 0; i < dataLen; i++)
+    {
+        if (useHexMode) tempString.append( QString::number(data[i], 16).toUpper().rightJustified(2, '0'));
+        else tempString.append(QString::number(data[i], 10));
+        if (!((i+1) % bytesPerLine) && (i != (dataLen - 1))) tempString.append("\n");
+        else tempString.append(" ");
+    }
+    if (thisFrame.frameType() == thisFrame.ErrorFrame)
+    {
+        if (thisFrame.error() & thisFrame.TransmissionTimeoutError) tempString.append("\nTX Timeout");
+        if (thisFrame.error() & thisFrame.LostArbitrationError) tempString.append("\nLost Arbitration");
+        if (thisFrame.error() & thisFrame.ControllerError) tempString.append("\nController Error");
+        if (thisFrame.error() & thisFrame.ProtocolViolationError) tempString.append("\nProtocol Violation");
+        if (thisFrame.error() & thisFrame.TransceiverError) tempString.append("\nTransceiver Error");
+        if (thisFrame.error() & thisFrame.MissingAcknowledgmentError) tempString.append("\nMissing ACK");
+        if (thisFrame.error() & thisFrame.BusOffError) tempString.append("\nBus OFF");
+        if (thisFrame.error() & thisFrame.BusError) tempString.append("\nBus ERR");
+        if (thisFrame.error() & thisFrame.ControllerRestartError) tempString.append("\nController restart err");
+        if (thisFrame.error() & thisFrame.UnknownError) tempString.append("\nUnknown error type");
+    }
+    //TODO: technically the actual returned bytes for an error frame encode some more info. Not interpreting it yet.
+
+    //now, if we're supposed to interpret the data and the DBC handler is loaded then use it
+    if ( (dbcHandler != nullptr) && interpretFrames && (thisFrame.frameType() == thisFrame.DataFrame) )
+    {
+        DBC_MESSAGE *msg = dbcHandler->findMessage(thisFrame);
+        if (msg != nullptr)
+        {
+            tempString.append("   <" + msg->name + ">\n");
+            if (msg->comment.length() > 1) tempString.append(msg->comment + "\n");
+            for (int j = 0; j < msg->sigHandler->getCount(); j++)
+            {                        
+                DBC_SIGNAL_VALUE sigValue;
+                DBC_SIGNAL* sig = msg->sigHandler->findSignalByIdx(j);
+
+                if ( (sig->multiplexParent == nullptr) && sig->decode(thisFrame, sigValue))
                 {
-                    tempString.append("   <" + msg->name + ">\n");
-                    if (msg->comment.length() > 1) tempString.append(msg->comment + "\n");
-                    for (int j = 0; j < msg->sigHandler->getCount(); j++)
-                    {                        
-                        QString sigString;
-                        DBC_SIGNAL* sig = msg->sigHandler->findSignalByIdx(j);
-
-                        if ( (sig->multiplexParent == nullptr) && sig->processAsText(thisFrame, sigString))
-                        {
-                            tempString.append(sigString);
-                            tempString.append("\n");
-                            if (sig->isMultiplexor)
-                            {
-                                qDebug() << "Multiplexor. Diving into the tree";
-                                tempString.append(sig->processSignalTree(thisFrame));
-                            }
-                        }
-                        else if (sig->isMultiplexed && overwriteDups) //wasn't in this exact frame but is in the message. Use cached value
-                        {
-                            bool isInteger = false;
-                            if (sig->valType == UNSIGNED_INT || sig->valType == SIGNED_INT) isInteger = true;
-                            tempString.append(sig->makePrettyOutput(sig->cachedValue.toDouble(), sig->cachedValue.toLongLong(), true, isInteger));
-                            tempString.append("\n");
-                        }
+                    signalStates.update(sig, sigValue);
+                    tempString.append(sig->formatValue(sigValue));
+                    tempString.append("\n");
+                    if (sig->isMultiplexor)
+                    {
+                        tempString.append(sig->processSignalTree(thisFrame, &signalStates));
                     }
                 }
+                else if (sig->isMultiplexed && overwriteDups && signalStates.lastValue(sig, sigValue)) //wasn't in this exact frame but is in the message. Use cached value
+                {
+                    bool isInteger = false;
+                    if (sig->valType == UNSIGNED_INT || sig->valType == SIGNED_INT) isInteger = true;
+                    tempString.append(sig->makePrettyOutput(sigValue.value, sigValue.intValue, true, isInteger));
+                    tempString.append("\n");
+                }
             }
-            return tempString;
-        default:
-            return tempString;
         }
     }
+    return tempString;
+}
 
-    return QVariant();
+//the Data text only depends on the frame and the display settings. The setters clear the cache when the
+//settings change, editing or loading DBC files is picked up here
+void CANFrameModel::validateTextCache() const
+{
+    int rev = DBCMessageHandler::revision();
+    if (rev != textCacheRevision)
+    {
+        textCache.clear();
+        textCacheRevision = rev;
+    }
+}
+
+void CANFrameModel::scheduleDecodeAhead(int row) const
+{
+    if (row != decodeAheadRow)
+    {
+        decodeAheadRow = row;
+        decodeAheadDistance = 0;
+    }
+    if (!decodeAheadTimer->isActive()) decodeAheadTimer->start();
+}
+
+/*
+ * Runs when the event loop is idle after rows were painted and formats the rows around the last one
+ * painted, nearest first, so scrolling mostly finds its text already in textCache. Each pass stops
+ * after a few milliseconds and queues itself again so input and painting are never held up.
+ * This stays on the GUI thread since frames, filteredFrames and the DBC definitions all belong to it.
+ */
+void CANFrameModel::decodeAhead()
+{
+    if (overwriteDups || shownFrames().count() == 0) return;
+    validateTextCache();
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    int numRows = shownFrames().count();
+    while (decodeAheadDistance <= DECODE_AHEAD_ROWS)
+    {
+        int rows[2] = {decodeAheadRow + decodeAheadDistance, decodeAheadRow - decodeAheadDistance};
+        for (int i = 0; i < 2; i++)
+        {
+            if (rows[i] < 0 || rows[i] >= numRows) continue;
+            uint64_t seq = shownFrames().sequenceAt(rows[i]);
+            if (!textCache.contains(seq)) textCache.insert(seq, new QString(formatDataText(shownFrames().at(rows[i]))));
+        }
+        decodeAheadDistance++;
+        if (elapsed.elapsed() >= DECODE_AHEAD_SLICE_MS)
+        {
+            decodeAheadTimer->start();
+            return;
+        }
+    }
 }
 
 QVariant CANFrameModel::headerData(int section, Qt::Orientation orientation,
@@ -651,148 +740,259 @@ bool CANFrameModel::any_busfilters_are_configured(void)
 }
 
 
+void CANFrameModel::fillBusFilterTable(bool *table)
+{
+    for (int i = 0; i < 256; i++) table[i] = false;
+    QMap<int, bool>::const_iterator it;
+    for (it = busFilters.constBegin(); it != busFilters.constEnd(); ++it)
+    {
+        if (it.key() >= 0 && it.key() < 256) table[it.key()] = it.value();
+    }
+}
+
+//rows in frames with this ID that also pass the bus filter, in ascending order
+QVector<uint32_t> CANFrameModel::filteredRowsForID(uint32_t ID, const bool *busTable)
+{
+    QVector<uint32_t> out;
+    const QVector<uint32_t> rowList = idRows.value(ID);
+    out.reserve(rowList.count());
+    for (int i = 0; i < rowList.count(); i++)
+    {
+        if (busTable[frames.view(static_cast<int>(rowList[i])).bus()]) out.append(rowList[i]);
+    }
+    return out;
+}
+
+void CANFrameModel::dropOldestFrames(int num)
+{
+    frames.removeFirst(num);
+    filteredFrames.sourceRowsRemoved(num);
+    if (overwriteDups)
+    {
+        rebuildOverwriteIndex();
+        overwriteRowsAdded = true; //rows may have shifted so the next tick has to reset the view
+    }
+
+    QHash<uint32_t, QVector<uint32_t>>::iterator it;
+    for (it = idRows.begin(); it != idRows.end(); ++it)
+    {
+        QVector<uint32_t> &rowList = it.value();
+        int drop = static_cast<int>(std::lower_bound(rowList.begin(), rowList.end(), static_cast<uint32_t>(num)) - rowList.begin());
+        rowList.remove(0, drop);
+        for (int i = 0; i < rowList.count(); i++) rowList[i] -= static_cast<uint32_t>(num);
+    }
+}
+
+void CANFrameModel::rebuildOverwriteIndex()
+{
+    overwriteIndex.clear();
+    overwriteChangedRows.clear();
+    if (!overwriteDups) return;
+    for (int i = 0; i < filteredFrames.count(); i++)
+    {
+        CANFrameView view = filteredFrames.view(i);
+        overwriteIndex.insert(overwriteKey(view.frameId(), view.bus()), i);
+    }
+}
+
+/*
+ * Overwrite mode collects which rows changed as frames come in and tells the views once per GUI tick.
+ * Only a brand new ID needs a reset, otherwise it's a dataChanged for each run of changed rows.
+ */
+void CANFrameModel::flushOverwriteUpdates()
+{
+    if (overwriteRowsAdded)
+    {
+        beginResetModel();
+        endResetModel();
+    }
+    else if (!overwriteChangedRows.isEmpty())
+    {
+        QList<int> changed = overwriteChangedRows.values();
+        std::sort(changed.begin(), changed.end());
+        int runStart = changed[0];
+        for (int i = 1; i <= changed.count(); i++)
+        {
+            if (i < changed.count() && changed[i] == changed[i - 1] + 1) continue;
+            emit dataChanged(index(runStart, 0), index(changed[i - 1], (int)Column::NUM_COLUMN - 1));
+            if (i < changed.count()) runStart = changed[i];
+        }
+    }
+    overwriteRowsAdded = false;
+    overwriteChangedRows.clear();
+}
+
 void CANFrameModel::addFrame(const CANFrame& frame, bool autoRefresh = false)
 {
-    /*TODO: remove mutex */
-    mutex.lock();
+    if (streaming) return; //a streamed file is read only
+    if (ingestHold)
+    {
+        heldFrames.append(frame);
+        return;
+    }
+
     CANFrame tempFrame;
     tempFrame = frame;
 
     tempFrame.setTimeStamp(QCanBusFrame::TimeStamp(0, tempFrame.timeStamp().microSeconds() - timeOffset));
 
+    //rows the ingest thread already wrote come first, append takes them in under the same lock
+    int firstRow = frames.count();
+    int ingested = 0;
+    try
+    {
+        ingested = frames.append(tempFrame);
+    }
+    catch (const std::exception& ex)
+    {
+        qDebug() << "addFrame failed to append. App is probably going to crash. frames.length(): " << frames.length() << " Exception: " << ex.what();
+        return;
+    }
+    indexIngestedRows(firstRow, ingested);
+    indexNewFrame(frames.count() - 1, autoRefresh);
+}
+
+//does the filter, ID list and overwrite mode bookkeeping for a row that was just added to frames
+void CANFrameModel::indexNewFrame(int row, bool autoRefresh)
+{
+    CANFrameView frame = frames.view(row);
+    uint32_t id = frame.frameId();
+    int bus = frame.bus();
+
     lastUpdateNumFrames++;
+    idRows[id].append(static_cast<uint32_t>(row));
 
     //if this ID isn't found in the filters list then add it and show it by default
-    if (!filters.contains(tempFrame.frameId()))
+    if (!filters.contains(id))
     {
         // if there are any filters already configured, leave the new filter disabled
         if (any_filters_are_configured())
-            filters.insert(tempFrame.frameId(), false);
+            filters.insert(id, false);
         else
-            filters.insert(tempFrame.frameId(), true);
+            filters.insert(id, true);
         needFilterRefresh = true;
     }
 
     //if this BusID isn't found in the busFilters list then add it and show it by default
-    if (!busFilters.contains(tempFrame.bus))
+    if (!busFilters.contains(bus))
     {
         // if there are any busFilters already configured, leave the new filter disabled
         if (any_busfilters_are_configured())
-            busFilters.insert(tempFrame.bus, false);
+            busFilters.insert(bus, false);
         else
-            busFilters.insert(tempFrame.bus, true);
+            busFilters.insert(bus, true);
         needFilterRefresh = true;
     }
 
     if (!overwriteDups)
     {
-        try
-        {
-            frames.append(tempFrame);
-
-            if (filters[tempFrame.frameId()] && busFilters[tempFrame.bus])
-            {
-                if (autoRefresh) beginInsertRows(QModelIndex(), filteredFrames.count(), filteredFrames.count());
-                tempFrame.frameCount = 1;
-                filteredFrames.append(tempFrame);
-                if (autoRefresh) endInsertRows();
-            }
-        }
-        catch (const std::exception& ex)
+        if (filters[id] && busFilters[bus])
         {
-            qDebug() << "addFrame failed to append. App is probably going to crash. frames.length(): " << frames.length() << " Exception: " << ex.what();
+            if (autoRefresh) beginInsertRows(QModelIndex(), filteredFrames.count(), filteredFrames.count());
+            filteredFrames.appendRow(row);
+            if (autoRefresh) endInsertRows();
         }
     }
     else //yes, overwrite dups
     {
-        bool found = false;
-//        for (int i = 0; i < frames.count(); i++)
-//        {
-//            if ( (frames[i].frameId() == tempFrame.frameId()) && (frames[i].bus == tempFrame.bus) )
-//            {
-//                tempFrame.frameCount = frames[i].frameCount + 1;
-//                tempFrame.timedelta = tempFrame.timeStamp().microSeconds() - frames[i].timeStamp().microSeconds();
-//                frames.replace(i, tempFrame);
-//                found = true;
-//                break;
-//            }
-//        }
-        for (int i = 0; i < filteredFrames.count(); i++)
+        uint64_t key = overwriteKey(id, bus);
+
+        QHash<uint64_t, int>::const_iterator it = overwriteIndex.constFind(key);
+        if (it != overwriteIndex.constEnd())
         {
-            if ( (filteredFrames[i].frameId() == tempFrame.frameId()) && (filteredFrames[i].bus == tempFrame.bus) )
-            {
-                tempFrame.frameCount = filteredFrames[i].frameCount + 1;
-                tempFrame.timedelta = tempFrame.timeStamp().microSeconds() - filteredFrames[i].timeStamp().microSeconds();
-                filteredFrames.replace(i, tempFrame);
-                found = true;
-                break;
-            }
+            int i = it.value();
+            uint32_t frameCount = filteredFrames.frameCountAt(i) + 1;
+            uint64_t timedelta = frame.timestamp() - filteredFrames.view(i).timestamp();
+            filteredFrames.replaceRow(i, row);
+            filteredFrames.setOverwriteStats(i, timedelta, frameCount);
+            if (autoRefresh) emit dataChanged(index(i, 0), index(i, (int)Column::NUM_COLUMN - 1));
+            else overwriteChangedRows.insert(i);
         }
-        frames.append(tempFrame);
-        if (!found)
+        else
         {
-            //frames.append(tempFrame);
-            if (filters[tempFrame.frameId()] && busFilters[tempFrame.bus])
+            if (filters[id] && busFilters[bus])
             {
                 if (autoRefresh) beginInsertRows(QModelIndex(), filteredFrames.count(), filteredFrames.count());
-                tempFrame.frameCount = 1;
-                tempFrame.timedelta = 0;
-                filteredFrames.append(tempFrame);
+                filteredFrames.appendRow(row);
+                filteredFrames.setOverwriteStats(filteredFrames.count() - 1, 0, 1);
+                overwriteIndex.insert(key, filteredFrames.count() - 1);
                 if (autoRefresh) endInsertRows();
-            }
-        }
-        else
-        {
-            for (int j = 0; j < filteredFrames.count(); j++)
-            {
-                if ( (filteredFrames[j].frameId() == tempFrame.frameId()) && (filteredFrames[j].bus == tempFrame.bus) )
-                {
-                    if (autoRefresh) beginResetModel();
-                    filteredFrames.replace(j, tempFrame);
-                    if (autoRefresh) endResetModel();
-                }
+                else overwriteRowsAdded = true;
             }
         }
     }
-
-    mutex.unlock();
 }
 
+/*
+ * The ingest thread in CANConManager packs received frames into frames but they stay pending until
+ * picked up here on the GUI thread. Only reading the published count is lock free, accepting takes
+ * the store lock once. After that the new rows get the same treatment addFrame gives a single frame.
+ */
+int CANFrameModel::acceptIngestedFrames()
+{
+    if (frames.pendingCount() == 0) return 0;
+
+    int firstRow = frames.count();
+    int added = frames.acceptPending();
+    indexIngestedRows(firstRow, added);
+    return added;
+}
 
-void CANFrameModel::addFrames(const CANConnection*, const QVector<CANFrame>& pFrames)
+//rows from the ingest thread, either accepted above or taken in by frames.append
+void CANFrameModel::indexIngestedRows(int firstRow, int added)
 {
-    if(frames.length() > frames.capacity() * 0.99)
+    for (int row = firstRow; row < firstRow + added; row++)
     {
-        mutex.lock();
-        qDebug() << "Frames count: " << frames.length() << " of " << frames.capacity() << " capacity, removing first " << (int)(frames.capacity() * 0.05) << " frames";
-        frames.remove(0, (int)(frames.capacity() * 0.05));
-        qDebug() << "Frames removed, new count: " << frames.length();
-        mutex.unlock();
+        if (timeOffset != 0) frames.setTimestamp(row, frames.view(row).timestamp() - timeOffset);
+        indexNewFrame(row, false);
     }
+    //in overwrite mode the changed rows get announced on the next GUI tick by sendBulkRefresh
+}
 
-    if(filteredFrames.length() > filteredFrames.capacity() * 0.99)
-    {
-        mutex.lock();
-        qDebug() << "filteredFrames count: " << filteredFrames.length() << " of " << filteredFrames.capacity() << " capacity, removing first " << (int)(filteredFrames.capacity() * 0.05) << " frames";
-        filteredFrames.remove(0, (int)(filteredFrames.capacity() * 0.05));
-        qDebug() << "filteredFrames removed, new count: " << filteredFrames.length();
-        mutex.unlock();
-    }
+/*
+ * Ring buffer capture. Whenever live frames came in, throw away whole chunks of the oldest ones that
+ * fall outside the retention limit and let the other windows know. Loaded files are never trimmed.
+ */
+void CANFrameModel::evictOldFrames()
+{
+    int evict = frames.evictionCount(retention);
+    if (evict <= 0) return;
 
-    foreach(const CANFrame& frame, pFrames)
-    {
-        addFrame(frame);
-    }
-    if (overwriteDups) //if in overwrite mode we'll update every time frames come in
+    dropOldestFrames(evict);
+    emit framesEvicted(evict);
+}
+
+void CANFrameModel::setRetention(const FrameRetention &newRetention)
+{
+    retention = newRetention;
+}
+
+void CANFrameModel::loadRetentionSettings()
+{
+    QSettings settings;
+    FrameRetention newRetention;
+    preallocSize = settings.value("Main/MaximumFrames", preallocSize).toInt();
+    newRetention.mode = static_cast<FrameRetention::Mode>(settings.value("Main/RetentionMode", FrameRetention::ByCount).toInt());
+    switch (newRetention.mode)
     {
-        beginResetModel();
-        endResetModel();
+    case FrameRetention::ByMemory:
+        newRetention.limit = settings.value("Main/RetentionMemory", 1024).toLongLong() * 1024 * 1024; //setting is in MB
+        break;
+    case FrameRetention::ByTime:
+        newRetention.limit = settings.value("Main/RetentionTime", 600).toLongLong() * 1000000; //setting is in seconds
+        break;
+    default:
+        newRetention.mode = FrameRetention::ByCount;
+        newRetention.limit = preallocSize;
+        break;
     }
+    setRetention(newRetention);
 }
 
 void CANFrameModel::sendRefresh()
 {
     qDebug() << "Sending mass refresh";    
+    if (streaming) return;
 
     if(overwriteDups)
     {
@@ -800,21 +1000,24 @@ void CANFrameModel::sendRefresh()
     }
     else
     {
-        QVector<CANFrame> tempContainer;
-        int count = frames.count();
-        for (int i = 0; i < count; i++)
+        //build the new row list from the per ID lists of every enabled ID. No frames get copied.
+        bool busTable[256];
+        fillBusFilterTable(busTable);
+        QVector<uint32_t> rows;
+        rows.reserve(frames.count());
+        QHash<uint32_t, QVector<uint32_t>>::const_iterator it;
+        for (it = idRows.constBegin(); it != idRows.constEnd(); ++it)
         {
-            if (filters[frames[i].frameId()] && busFilters[frames[i].bus])
-            {
-                tempContainer.append(frames[i]);
-            }
+            if (!filters.value(static_cast<int>(it.key()))) continue;
+            rows.append(filteredRowsForID(it.key(), busTable));
         }
+        std::sort(rows.begin(), rows.end());
 
         mutex.lock();
         beginResetModel();
-        filteredFrames.clear();
-        filteredFrames.append(tempContainer);
-        filteredFrames.reserve(preallocSize);
+        filteredFrames.setRows(rows);
+        filteredInFrameOrder = true;
+        rebuildOverwriteIndex();
         lastUpdateNumFrames = 0;
         endResetModel();
         mutex.unlock();
@@ -832,6 +1035,11 @@ void CANFrameModel::sendRefresh(int pos)
 //have to send thousands of messages per second
 int CANFrameModel::sendBulkRefresh()
 {
+    //captured frames stay pending in the store until the hold is released
+    if (ingestHold) return 0;
+
+    if (acceptIngestedFrames() > 0) evictOldFrames();
+
     //int num = filteredFrames.count() - lastUpdateNumFrames;
     if (lastUpdateNumFrames <= 0) return 0;
 
@@ -840,8 +1048,12 @@ int CANFrameModel::sendBulkRefresh()
 
     //qDebug() << "Bulk refresh of " << lastUpdateNumFrames;
 
-    beginResetModel();
-    endResetModel();
+    if (overwriteDups) flushOverwriteUpdates();
+    else
+    {
+        beginResetModel();
+        endResetModel();
+    }
 
     int num = lastUpdateNumFrames;
     lastUpdateNumFrames = 0;
@@ -853,8 +1065,21 @@ void CANFrameModel::clearFrames()
 {
     mutex.lock();
     this->beginResetModel();
-    frames.clear();
     filteredFrames.clear();
+    frames.clear();
+    if (streaming)
+    {
+        streaming = false;
+        CANConManager::getInstance()->setIngestStore(&frames);
+    }
+    idRows.clear();
+    overwriteIndex.clear();
+    overwriteChangedRows.clear();
+    overwriteRowsAdded = false;
+    filteredInFrameOrder = true;
+    signalStates.clear();
+    textCache.clear();
+    signalStore.reset();
     if(filtersPersistDuringClear == false)
     {
         filters.clear();
@@ -880,11 +1105,16 @@ void CANFrameModel::insertFrames(const QVector<CANFrame> &newFrames)
     //and that refresh will cause the view to update. If you do both it usually ends up thinking you have
     //double the number of frames.
     //beginResetModel();
+    Q_ASSERT(!streaming); //clearFrames first
     mutex.lock();
     int insertedFiltered = 0;
+    int firstRow = frames.count();
+    int ingested = frames.append(newFrames);
+    indexIngestedRows(firstRow, ingested);
+    firstRow += ingested;
     for (int i = 0; i < newFrames.count(); i++)
     {
-        frames.append(newFrames[i]);
+        idRows[newFrames[i].frameId()].append(static_cast<uint32_t>(firstRow + i));
         if (!filters.contains(newFrames[i].frameId()))
         {
             filters.insert(newFrames[i].frameId(), true);
@@ -898,7 +1128,7 @@ void CANFrameModel::insertFrames(const QVector<CANFrame> &newFrames)
         if (filters[newFrames[i].frameId()] && busFilters[newFrames[i].bus])
         {
             insertedFiltered++;
-            filteredFrames.append(newFrames[i]);
+            filteredFrames.appendRow(firstRow + i);
         }
     }
     lastUpdateNumFrames = newFrames.count();
@@ -913,13 +1143,12 @@ int CANFrameModel::getIndexFromTimeID(unsigned int ID, double timestamp)
 {
     int bestIndex = -1;
     int64_t intTimeStamp = static_cast<int64_t> (timestamp * 1000000l);
-    for (int i = 0; i < frames.count(); i++)
+    CANFrameScanner scan(frames);
+    scan.setIdFilter(ID);
+    while (scan.next())
     {
-        if ((frames[i].frameId() == ID))
-        {
-            if (frames[i].timeStamp().microSeconds() <= intTimeStamp) bestIndex = i;
-            else break; //drop out of loop as soon as we pass the proper timestamp
-        }
+        if (scan.frame().timestamp() <= intTimeStamp) bestIndex = scan.row();
+        else break; //drop out of loop as soon as we pass the proper timestamp
     }
     return bestIndex;
 }
@@ -986,14 +1215,15 @@ bool CANFrameModel::needsFilterRefresh()
  * external code that needs to access frames directly and doesn't care about
  * this model's normal output mechanism.
  */
-const QVector<CANFrame>* CANFrameModel::getListReference() const
+const CANFrameStore* CANFrameModel::getListReference() const
 {
     return &frames;
 }
 
-const QVector<CANFrame>* CANFrameModel::getFilteredListReference() const
+//nothing is filtered out of a streamed file so it's the whole list then
+const CANFrameStore* CANFrameModel::getFilteredListReference() const
 {
-    return &filteredFrames;
+    return &shownFrames();
 }
 
 const QMap<int, bool>* CANFrameModel::getFiltersReference() const
@@ -1005,3 +1235,57 @@ const QMap<int, bool>* CANFrameModel::getBusFiltersReference() const
 {
     return &busFilters;
 }
+
+SignalStore *CANFrameModel::getSignalStore()
+{
+    return &signalStore;
+}
+
+/*
+ * For work that reads the frame lists from other threads while the GUI keeps running, like
+ * DecodedExport. Captured frames pile up as pending in the store and frames handed to addFrame
+ * are kept aside, both get added as usual once the hold is released.
+ */
+void CANFrameModel::setIngestHold(bool hold)
+{
+    ingestHold = hold;
+    if (hold) return;
+
+    QVector<CANFrame> waiting;
+    waiting.swap(heldFrames);
+    for (int i = 0; i < waiting.count(); i++) addFrame(waiting[i], false);
+}
+
+/*
+ * Everything that indexes frames one by one (the per ID row lists, the filtered view, overwrite mode)
+ * would grow with the file, so none of it is built for a streamed file. The grid reads frames straight
+ * out of the paged store and the analysis windows scan it with CANFrameScanner.
+ */
+bool CANFrameModel::openStream(const QString &captureFile)
+{
+    mutex.lock();
+    beginResetModel();
+    //live frames still go to the other windows, they just can't be added to a file that's open read only
+    CANConManager::getInstance()->setIngestStore(nullptr);
+    filteredFrames.clear();
+    idRows.clear();
+    overwriteIndex.clear();
+    overwriteChangedRows.clear();
+    overwriteRowsAdded = false;
+    filteredInFrameOrder = true;
+    signalStates.clear();
+    textCache.clear();
+    signalStore.reset();
+    filters.clear();
+    busFilters.clear();
+    heldFrames.clear();
+    timeOffset = 0;
+    streaming = frames.openPaged(captureFile);
+    if (!streaming) CANConManager::getInstance()->setIngestStore(&frames);
+    lastUpdateNumFrames = 0;
+    endResetModel();
+    mutex.unlock();
+
+    emit updatedFiltersList();
+    return streaming;
+}
@@ -6,8 +6,14 @@
 #include <QVector>
 #include <QDebug>
 #include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <QCache>
+#include <QTimer>
 #include "can_structs.h"
+#include "canframestore.h"
 #include "dbc/dbchandler.h"
+#include "dbc/signalstore.h"
 #include "connections/canconnection.h"
 #include "utility.h"
 
@@ -48,6 +54,8 @@ public:
     void setOverwriteMode(bool);
     void setHexMode(bool);
     void setClearMode(bool mode);
+    void setRetention(const FrameRetention &newRetention);
+    void loadRetentionSettings();
     void setTimeStyle(TimeStyle newStyle);
     void setIgnoreDBCColors(bool mode);
     void setFilterState(unsigned int ID, bool state);
@@ -63,30 +71,58 @@ public:
     void insertFrames(const QVector<CANFrame> &newFrames);
     void sortByColumn(int column);
     int getIndexFromTimeID(unsigned int ID, double timestamp);
-    const QVector<CANFrame> *getListReference() const; //thou shalt not modify these frames externally!
-    const QVector<CANFrame> *getFilteredListReference() const; //Thus saith the Lord, NO.
+    const CANFrameStore *getListReference() const; //thou shalt not modify these frames externally!
+    const CANFrameStore *getFilteredListReference() const; //Thus saith the Lord, NO.
     const QMap<int, bool> *getFiltersReference() const; //this neither
     const QMap<int, bool> *getBusFiltersReference() const; //this neither
+    SignalStore *getSignalStore(); //decoded signals over the whole capture, shared by the analysis windows
+    void setIngestHold(bool hold); //while held the frame lists don't change at all, new frames wait for the release
+    //Shows a capture file without loading it, frames get paged in from the file as the grid needs them.
+    //Filters, overwrite mode and sorting don't apply to a streamed file and captured frames aren't added
+    //to it. clearFrames() goes back to the normal in memory list.
+    bool openStream(const QString &captureFile);
+    bool isStreaming() const { return streaming; }
 
 public slots:
     void addFrame(const CANFrame&, bool);
-    void addFrames(const CANConnection*, const QVector<CANFrame>&);
 
 signals:
     void updatedFiltersList();
+    void framesEvicted(int numFrames); //the oldest numFrames frames were dropped, row numbers moved down by that much
+
+private slots:
+    void decodeAhead();
 
 private:
-    void qSortCANFrameAsc(QVector<CANFrame>* frames, Column column, int lowerBound, int upperBound);
-    void qSortCANFrameDesc(QVector<CANFrame>* frames, Column column, int lowerBound, int upperBound);
-    uint64_t getCANFrameVal(QVector<CANFrame> *frames, int row, Column col);
+    QString formatDataText(const CANFrame &frame) const;
+    void validateTextCache() const;
+    void scheduleDecodeAhead(int row) const;
+    void sortCANFrames(CANFrameStore *frames, Column column, bool ascending);
+    uint64_t getCANFrameVal(const CANFrameStore *frames, int row, Column col);
     bool any_filters_are_configured(void);
     bool any_busfilters_are_configured(void);
+    void fillBusFilterTable(bool *table);
+    QVector<uint32_t> filteredRowsForID(uint32_t ID, const bool *busTable);
+    void indexNewFrame(int row, bool autoRefresh);
+    int acceptIngestedFrames();
+    void indexIngestedRows(int firstRow, int added);
+    void evictOldFrames();
+    void dropOldestFrames(int num);
+    void rebuildOverwriteIndex();
+    void flushOverwriteUpdates();
+    const CANFrameStore &shownFrames() const { return streaming ? frames : filteredFrames; }
 
-    QVector<CANFrame> frames;
-    QVector<CANFrame> filteredFrames;
+    CANFrameStore frames;
+    CANFrameStore filteredFrames; //view of rows in frames, no frame data of its own
+    QHash<uint32_t, QVector<uint32_t>> idRows; //every row in frames for each frame ID, in ascending order
+    SignalStore signalStore;
+    QHash<uint64_t, int> overwriteIndex; //overwrite mode: (id | bus << 29) -> row in filteredFrames
+    QSet<int> overwriteChangedRows; //rows updated since the last GUI tick
+    bool overwriteRowsAdded;
     QMap<int, bool> filters;
     QMap<int, bool> busFilters;
     DBCHandler *dbcHandler;
+    mutable SignalStateCache signalStates; //last value of each signal this model decoded, for overwrite mode
     QMutex mutex;
     bool interpretFrames; //should we use the dbcHandler?
     bool overwriteDups; //should we display all frames or only the newest for each ID?
@@ -99,8 +135,22 @@ private:
     int64_t timeOffset;
     int lastUpdateNumFrames;
     uint32_t preallocSize;
+    FrameRetention retention;
     bool sortDirAsc;
+    bool filteredInFrameOrder; //false once the grid is sorted by a column, incremental filtering needs capture order
     int bytesPerLine;
+    bool ingestHold;
+    bool streaming; //frames is paged in from a capture file, filteredFrames isn't used
+    QVector<CANFrame> heldFrames; //passed to addFrame while the ingest was held
+
+    static const int TEXT_CACHE_ROWS = 20000; //formatted Data cells kept, least recently used go first
+    static const int DECODE_AHEAD_ROWS = 200; //rows formatted ahead on each side of the last painted row
+    static const int DECODE_AHEAD_SLICE_MS = 4;
+    mutable QCache<uint64_t, QString> textCache; //Data column text keyed by frame sequence number
+    mutable int textCacheRevision; //DBCMessageHandler::revision() the cached text was decoded with
+    mutable int decodeAheadRow;
+    mutable int decodeAheadDistance;
+    QTimer *decodeAheadTimer;
 };
 
 
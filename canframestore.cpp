@@ -0,0 +1,775 @@
+#include "canframestore.h"
+#include "framebatch.h"
+#include "capturefile.h"
+
+#include <QCache>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+CANFrame CANFrameView::toCANFrame() const
+{
+    CANFrame frame;
+    QCanBusFrame::FrameType type = frameType();
+
+    frame.setFrameType(type);
+    //QCanBusFrame keeps the error flags where the ID would normally go so it's stored that way here too
+    if (type == QCanBusFrame::ErrorFrame) frame.setError(QCanBusFrame::FrameErrors(QFlag(static_cast<int>(record->frameId))));
+    else frame.setFrameId(record->frameId);
+    frame.setExtendedFrameFormat(record->flags & PackedFrameFlags::Extended);
+    frame.setPayload(QByteArray(reinterpret_cast<const char *>(payloadPtr), record->length));
+    frame.setFlexibleDataRateFormat(record->flags & PackedFrameFlags::FlexibleData);
+    frame.setBitrateSwitch(record->flags & PackedFrameFlags::BitrateSwitch);
+    frame.setErrorStateIndicator(record->flags & PackedFrameFlags::ErrorState);
+    frame.setTimeStamp(QCanBusFrame::TimeStamp(0, record->timestamp));
+    frame.bus = record->bus;
+    frame.isReceived = record->flags & PackedFrameFlags::Received;
+    return frame;
+}
+
+CANFrameData CANFrameView::toFrameData() const
+{
+    CANFrameData out;
+    out.timestamp = record->timestamp;
+    out.frameId = record->frameId;
+    out.bus = record->bus;
+    out.frameType = record->flags & PackedFrameFlags::TypeMask;
+    out.flags = 0;
+    if (record->flags & PackedFrameFlags::Extended) out.flags |= CANFrameData::Extended;
+    if (record->flags & PackedFrameFlags::FlexibleData) out.flags |= CANFrameData::FlexibleData;
+    if (record->flags & PackedFrameFlags::BitrateSwitch) out.flags |= CANFrameData::BitrateSwitch;
+    if (record->flags & PackedFrameFlags::ErrorState) out.flags |= CANFrameData::ErrorState;
+    if (record->flags & PackedFrameFlags::Received) out.flags |= CANFrameData::Received;
+    out.length = static_cast<uint8_t>(qMin<int>(record->length, 64));
+    memcpy(out.data, payloadPtr, out.length);
+    memset(out.data + out.length, 0, sizeof(out.data) - out.length);
+    return out;
+}
+
+//one decoded block of a capture file, records in the same packed form the in memory chunks use
+struct PagedBlock
+{
+    std::unique_ptr<PackedCANFrame[]> records;
+    int count = 0;
+    PayloadArena arena;
+};
+
+class PagedCapture
+{
+public:
+    CaptureFileReader reader;
+    mutable QCache<int, PagedBlock> resident; //least recently used blocks go first
+    mutable QVector<CANFrameData> decoded; //readBlock's output, kept to save reallocating it each time
+    mutable int lastBlock = 0;
+
+    //block the row is in, starting the search at hint since rows mostly get asked for in order
+    int blockOf(int row, int hint) const
+    {
+        int numBlocks = reader.blockCount();
+        if (hint >= 0 && hint < numBlocks)
+        {
+            const CaptureBlockInfo &info = reader.block(hint);
+            if (row >= info.firstFrame && row < info.firstFrame + info.frameCount) return hint;
+            if (hint + 1 < numBlocks && row >= reader.block(hint + 1).firstFrame
+                && row < reader.block(hint + 1).firstFrame + reader.block(hint + 1).frameCount) return hint + 1;
+        }
+        int lo = 0, hi = numBlocks - 1;
+        while (lo < hi)
+        {
+            int mid = (lo + hi + 1) / 2;
+            if (reader.block(mid).firstFrame <= row) lo = mid;
+            else hi = mid - 1;
+        }
+        return lo;
+    }
+
+    bool decode(int blockIdx, PagedBlock &block, QVector<CANFrameData> &scratch) const
+    {
+        if (!reader.readBlock(blockIdx, scratch)) return false;
+        block.count = scratch.count();
+        block.records.reset(new PackedCANFrame[qMax(1, block.count)]);
+        for (int i = 0; i < block.count; i++) CANFrameStore::pack(block.records[i], block.arena, scratch[i]);
+        return true;
+    }
+
+    //a block that can't be read (damaged file) comes back as frames that are all zero
+    const PackedCANFrame &record(int row) const
+    {
+        int idx = blockOf(row, lastBlock);
+        lastBlock = idx;
+        PagedBlock *block = resident.object(idx);
+        int local = static_cast<int>(row - reader.block(idx).firstFrame);
+        if (!block || local >= block->count)
+        {
+            block = new PagedBlock;
+            if (!decode(idx, *block, decoded) || local >= block->count)
+            {
+                block->count = reader.block(idx).frameCount;
+                block->records.reset(new PackedCANFrame[qMax(1, block->count)]());
+            }
+            resident.insert(idx, block);
+        }
+        return block->records[local];
+    }
+};
+
+CANFrameStore::CANFrameStore()
+{
+    headOffset = 0;
+    numFrames = 0;
+    pendingFrames = 0;
+    baseSequence = 0;
+    source = nullptr;
+}
+
+CANFrameStore::CANFrameStore(const CANFrameStore *source)
+{
+    headOffset = 0;
+    numFrames = 0;
+    pendingFrames = 0;
+    baseSequence = 0;
+    this->source = source;
+}
+
+CANFrameStore::~CANFrameStore()
+{
+    clear();
+}
+
+const uint8_t *PayloadArena::store(const uint8_t *data, int len)
+{
+    if (blocks.empty() || used + len > blockSize)
+    {
+        int size = std::max(blockSize, len);
+        blocks.emplace_back(new uint8_t[size]);
+        allocated += size;
+        used = 0;
+    }
+    uint8_t *dest = blocks.back().get() + used;
+    memcpy(dest, data, len);
+    used += len;
+    return dest;
+}
+
+void CANFrameStore::pack(PackedCANFrame &rec, PayloadArena &arena, const CANFrame &frame)
+{
+    const QByteArray &payload = frame.payload();
+    QCanBusFrame::FrameType type = frame.frameType();
+
+    rec.timestamp = frame.timeStamp().seconds() * 1000000 + frame.timeStamp().microSeconds();
+    if (type == QCanBusFrame::ErrorFrame) rec.frameId = static_cast<uint32_t>(frame.error());
+    else rec.frameId = frame.frameId();
+    rec.length = static_cast<uint16_t>(payload.length());
+    rec.bus = static_cast<uint8_t>(frame.bus); //nobody has more than 256 buses hooked up
+
+    rec.flags = static_cast<uint8_t>(type) & PackedFrameFlags::TypeMask;
+    if (frame.hasExtendedFrameFormat()) rec.flags |= PackedFrameFlags::Extended;
+    if (frame.hasFlexibleDataRateFormat()) rec.flags |= PackedFrameFlags::FlexibleData;
+    if (frame.hasBitrateSwitch()) rec.flags |= PackedFrameFlags::BitrateSwitch;
+    if (frame.hasErrorStateIndicator()) rec.flags |= PackedFrameFlags::ErrorState;
+    if (frame.isReceived) rec.flags |= PackedFrameFlags::Received;
+
+    if (rec.length <= 8)
+    {
+        memset(rec.payload.inlineData, 0, 8);
+        memcpy(rec.payload.inlineData, payload.constData(), rec.length);
+    }
+    else
+    {
+        rec.payload.arenaData = arena.store(reinterpret_cast<const uint8_t *>(payload.constData()), rec.length);
+    }
+}
+
+void CANFrameStore::pack(PackedCANFrame &rec, PayloadArena &arena, const CANFrameData &frame)
+{
+    rec.timestamp = frame.timestamp;
+    rec.frameId = frame.frameId;
+    rec.length = frame.length;
+    rec.bus = frame.bus;
+
+    rec.flags = frame.frameType & PackedFrameFlags::TypeMask;
+    if (frame.flags & CANFrameData::Extended) rec.flags |= PackedFrameFlags::Extended;
+    if (frame.flags & CANFrameData::FlexibleData) rec.flags |= PackedFrameFlags::FlexibleData;
+    if (frame.flags & CANFrameData::BitrateSwitch) rec.flags |= PackedFrameFlags::BitrateSwitch;
+    if (frame.flags & CANFrameData::ErrorState) rec.flags |= PackedFrameFlags::ErrorState;
+    if (frame.flags & CANFrameData::Received) rec.flags |= PackedFrameFlags::Received;
+
+    if (rec.length <= 8)
+    {
+        memset(rec.payload.inlineData, 0, 8);
+        memcpy(rec.payload.inlineData, frame.data, rec.length);
+    }
+    else rec.payload.arenaData = arena.store(frame.data, rec.length);
+}
+
+bool CANFrameStore::openPaged(const QString &captureFile)
+{
+    clear();
+    std::unique_ptr<PagedCapture> capture(new PagedCapture);
+    if (!capture->reader.open(captureFile)) return false;
+    //rows are ints everywhere, a file with more frames than that can't be shown
+    if (capture->reader.frameCount() > std::numeric_limits<int>::max()) return false;
+    capture->resident.setMaxCost(PAGED_BLOCKS);
+
+    QMutexLocker locker(&pendingLock);
+    paged = std::move(capture);
+    numFrames = static_cast<int>(paged->reader.frameCount());
+    return true;
+}
+
+const PackedCANFrame &CANFrameStore::record(int idx, const Chunk **chunk) const
+{
+    int global = idx + headOffset;
+    *chunk = chunks[global >> CHUNK_SHIFT];
+    return (*chunk)->records[global & CHUNK_MASK];
+}
+
+CANFrameView CANFrameStore::view(int idx) const
+{
+    if (source) return source->view(static_cast<int>(rows[idx]));
+    if (paged)
+    {
+        const PackedCANFrame &rec = paged->record(idx);
+        return CANFrameView(&rec, rec.length <= 8 ? rec.payload.inlineData : rec.payload.arenaData);
+    }
+
+    const Chunk *chunk;
+    const PackedCANFrame &rec = record(idx, &chunk);
+    if (rec.length <= 8) return CANFrameView(&rec, rec.payload.inlineData);
+    return CANFrameView(&rec, rec.payload.arenaData);
+}
+
+CANFrame CANFrameStore::at(int idx) const
+{
+    if (source)
+    {
+        CANFrame frame = source->at(static_cast<int>(rows[idx]));
+        if (!rowTimedeltas.isEmpty())
+        {
+            frame.timedelta = rowTimedeltas[idx];
+            frame.frameCount = rowFrameCounts[idx];
+        }
+        return frame;
+    }
+    if (paged) return view(idx).toCANFrame();
+
+    const Chunk *chunk;
+    record(idx, &chunk);
+    CANFrame frame = view(idx).toCANFrame();
+
+    //overwrite mode stats aren't part of the frame record, they only exist where something stored them
+    int local = (idx + headOffset) & CHUNK_MASK;
+    if (chunk->timedeltas) frame.timedelta = chunk->timedeltas[local];
+    if (chunk->frameCounts) frame.frameCount = chunk->frameCounts[local];
+    return frame;
+}
+
+QVector<CANFrame> CANFrameStore::toVector() const
+{
+    return mid(0);
+}
+
+QVector<CANFrame> CANFrameStore::mid(int pos, int len) const
+{
+    QVector<CANFrame> out;
+    if (pos < 0) pos = 0;
+    if (len < 0 || pos + len > numFrames) len = numFrames - pos;
+    if (len <= 0) return out;
+
+    out.reserve(len);
+    for (int i = pos; i < pos + len; i++) out.append(at(i));
+    return out;
+}
+
+/*
+ * Anything the ingest thread wrote since the last acceptPending sits right where this frame would go,
+ * so it's taken into the store first under the same lock and the frame lands after it. Returns how many
+ * of those ingested rows came in that way, they're the ones just in front of the appended frame(s).
+ */
+int CANFrameStore::append(const CANFrame &frame)
+{
+    QMutexLocker locker(&pendingLock);
+    int ingested = acceptPendingLocked();
+    appendLocked(frame);
+    return ingested;
+}
+
+void CANFrameStore::appendLocked(const CANFrame &frame)
+{
+    Q_ASSERT(!source && !paged);
+    //callers absorb the pending rows first, otherwise this would land on top of them
+    Q_ASSERT(pendingFrames == 0);
+    int global = numFrames + headOffset;
+    int chunkIdx = global >> CHUNK_SHIFT;
+    if (chunkIdx >= chunks.count())
+    {
+        Chunk *chunk = new Chunk;
+        chunk->records.reset(new PackedCANFrame[CHUNK_SIZE]);
+        chunks.append(chunk);
+    }
+
+    Chunk *chunk = chunks[chunkIdx];
+    pack(chunk->records[global & CHUNK_MASK], chunk->arena, frame);
+    numFrames++;
+    if (chunk->timedeltas || frame.timedelta != 0 || frame.frameCount != 1)
+        setOverwriteStats(numFrames - 1, frame.timedelta, frame.frameCount);
+}
+
+int CANFrameStore::append(const QVector<CANFrame> &newFrames)
+{
+    QMutexLocker locker(&pendingLock);
+    int ingested = acceptPendingLocked();
+    for (int i = 0; i < newFrames.count(); i++) appendLocked(newFrames[i]);
+    return ingested;
+}
+
+/*
+ * Called from the ingest thread. The records go in right after the last visible one (or into chunks
+ * only the writer knows about yet) so the owner can go on reading rows below numFrames while this
+ * runs. The lock is taken once per batch, not per frame.
+ */
+uint64_t CANFrameStore::appendPending(const FrameBatch &batch)
+{
+    Q_ASSERT(!source && !paged);
+    QMutexLocker locker(&pendingLock);
+    uint64_t firstSeq = baseSequence + static_cast<uint64_t>(numFrames + pendingFrames);
+    for (int i = 0; i < batch.count(); i++)
+    {
+        int chunkIdx = (headOffset + numFrames + pendingFrames) >> CHUNK_SHIFT;
+        int local = (headOffset + numFrames + pendingFrames) & CHUNK_MASK;
+        Chunk *chunk;
+        if (chunkIdx < chunks.count()) chunk = chunks[chunkIdx];
+        else
+        {
+            int pendingIdx = chunkIdx - chunks.count();
+            if (pendingIdx >= pendingChunks.count())
+            {
+                chunk = new Chunk;
+                chunk->records.reset(new PackedCANFrame[CHUNK_SIZE]);
+                pendingChunks.append(chunk);
+            }
+            else chunk = pendingChunks[pendingIdx];
+        }
+        //the batch is already packed, only payloads that live outside the record need copying over.
+        //Live frames never carry overwrite mode stats so the record is all there is.
+        PackedCANFrame &rec = chunk->records[local];
+        rec = batch.record(i);
+        if (rec.length > 8) rec.payload.arenaData = chunk->arena.store(rec.payload.arenaData, rec.length);
+        pendingFrames++;
+    }
+    published.storeRelease(pendingFrames);
+    return firstSeq;
+}
+
+//Owner side. Makes everything the writer has published so far part of the store.
+int CANFrameStore::acceptPending()
+{
+    QMutexLocker locker(&pendingLock);
+    return acceptPendingLocked();
+}
+
+int CANFrameStore::acceptPendingLocked()
+{
+    int added = pendingFrames;
+    chunks.append(pendingChunks);
+    pendingChunks.clear();
+    numFrames += pendingFrames;
+    pendingFrames = 0;
+    published.storeRelease(0);
+    return added;
+}
+
+int CANFrameStore::appendFrom(const CANFrameStore &other, int idx)
+{
+    return append(other.at(idx));
+}
+
+void CANFrameStore::replace(int idx, const CANFrame &frame)
+{
+    Q_ASSERT(!source && !paged);
+    //a replaced FD payload leaves its old bytes in the arena until the chunk is dropped. Replacing only
+    //happens in overwrite mode where the store holds one frame per ID so that is not worth reclaiming.
+    QMutexLocker locker(&pendingLock);
+    int global = idx + headOffset;
+    Chunk *chunk = chunks[global >> CHUNK_SHIFT];
+    pack(chunk->records[global & CHUNK_MASK], chunk->arena, frame);
+    if (chunk->timedeltas || frame.timedelta != 0 || frame.frameCount != 1)
+        setOverwriteStats(idx, frame.timedelta, frame.frameCount);
+}
+
+void CANFrameStore::setTimestamp(int idx, int64_t micros)
+{
+    Q_ASSERT(!source && !paged);
+    int global = idx + headOffset;
+    chunks[global >> CHUNK_SHIFT]->records[global & CHUNK_MASK].timestamp = micros;
+}
+
+void CANFrameStore::setOverwriteStats(int idx, uint64_t timedelta, uint32_t frameCount)
+{
+    if (source)
+    {
+        if (rowTimedeltas.isEmpty())
+        {
+            rowTimedeltas.fill(0, rows.count());
+            rowFrameCounts.fill(1, rows.count());
+        }
+        rowTimedeltas[idx] = timedelta;
+        rowFrameCounts[idx] = frameCount;
+        return;
+    }
+
+    int global = idx + headOffset;
+    Chunk *chunk = chunks[global >> CHUNK_SHIFT];
+    if (!chunk->timedeltas)
+    {
+        chunk->timedeltas.reset(new uint64_t[CHUNK_SIZE]());
+        chunk->frameCounts.reset(new uint32_t[CHUNK_SIZE]);
+        std::fill(chunk->frameCounts.get(), chunk->frameCounts.get() + CHUNK_SIZE, 1u);
+    }
+    chunk->timedeltas[global & CHUNK_MASK] = timedelta;
+    chunk->frameCounts[global & CHUNK_MASK] = frameCount;
+}
+
+/*
+ * Throwing away the oldest frames only moves the start offset. Whole chunks that are no longer
+ * referenced get freed so this costs nothing like the memmove QVector::remove(0, x) used to do.
+ */
+void CANFrameStore::removeFirst(int num)
+{
+    if (num <= 0) return;
+
+    if (source)
+    {
+        if (num >= numFrames)
+        {
+            clear();
+            return;
+        }
+        rows.remove(0, num);
+        if (!rowTimedeltas.isEmpty())
+        {
+            rowTimedeltas.remove(0, num);
+            rowFrameCounts.remove(0, num);
+        }
+        numFrames = rows.count();
+        return;
+    }
+
+    QMutexLocker locker(&pendingLock);
+    if (num >= numFrames && pendingFrames == 0)
+    {
+        locker.unlock();
+        clear();
+        return;
+    }
+    if (num > numFrames) num = numFrames;
+
+    headOffset += num;
+    numFrames -= num;
+    baseSequence += static_cast<uint64_t>(num);
+    while (headOffset >= CHUNK_SIZE && !chunks.isEmpty())
+    {
+        delete chunks.takeFirst();
+        headOffset -= CHUNK_SIZE;
+    }
+}
+
+void CANFrameStore::reserve(int num)
+{
+    //only the chunk table is reserved. Chunks themselves get allocated as they fill so reserving a
+    //large number of frames up front doesn't cost RAM until the frames actually show up.
+    if (source) rows.reserve(num);
+    else
+    {
+        QMutexLocker locker(&pendingLock);
+        chunks.reserve((num >> CHUNK_SHIFT) + 2);
+    }
+}
+
+//also throws away anything the ingest thread had pending
+void CANFrameStore::clear()
+{
+    QMutexLocker locker(&pendingLock);
+    baseSequence += static_cast<uint64_t>(source ? 0 : numFrames);
+    qDeleteAll(chunks);
+    chunks.clear();
+    qDeleteAll(pendingChunks);
+    pendingChunks.clear();
+    pendingFrames = 0;
+    published.storeRelease(0);
+    rows.clear();
+    rowTimedeltas.clear();
+    rowFrameCounts.clear();
+    paged.reset();
+    headOffset = 0;
+    numFrames = 0;
+}
+
+uint64_t CANFrameStore::firstSequence() const
+{
+    if (source) return source->firstSequence();
+    return baseSequence;
+}
+
+uint64_t CANFrameStore::sequenceAt(int idx) const
+{
+    if (source) return source->sequenceAt(static_cast<int>(rows[idx]));
+    return baseSequence + static_cast<uint64_t>(idx);
+}
+
+int CANFrameStore::indexOfSequence(uint64_t seq) const
+{
+    if (source)
+    {
+        //views are nearly always in capture order so try a binary search first
+        int srcIdx = source->indexOfSequence(seq);
+        if (srcIdx < 0) return -1;
+        QVector<uint32_t>::const_iterator it = std::lower_bound(rows.constBegin(), rows.constEnd(), static_cast<uint32_t>(srcIdx));
+        if (it != rows.constEnd() && *it == static_cast<uint32_t>(srcIdx)) return static_cast<int>(it - rows.constBegin());
+        return rows.indexOf(static_cast<uint32_t>(srcIdx));
+    }
+    if (seq < baseSequence || seq >= baseSequence + static_cast<uint64_t>(numFrames)) return -1;
+    return static_cast<int>(seq - baseSequence);
+}
+
+qint64 CANFrameStore::chunkBytes(const Chunk *chunk)
+{
+    qint64 bytes = static_cast<qint64>(CHUNK_SIZE) * sizeof(PackedCANFrame);
+    bytes += chunk->arena.bytesAllocated();
+    if (chunk->timedeltas) bytes += static_cast<qint64>(CHUNK_SIZE) * (sizeof(uint64_t) + sizeof(uint32_t));
+    return bytes;
+}
+
+qint64 CANFrameStore::bytesUsed() const
+{
+    Q_ASSERT(!source);
+    QMutexLocker locker(&pendingLock);
+    qint64 bytes = 0;
+    foreach (const Chunk *chunk, chunks) bytes += chunkBytes(chunk);
+    foreach (const Chunk *chunk, pendingChunks) bytes += chunkBytes(chunk);
+    return bytes;
+}
+
+/*
+ * How many frames to pass to removeFirst so the store fits the retention limit. Always a whole number
+ * of chunks counted from the front. The last chunk is the one being filled so it is never evicted.
+ */
+int CANFrameStore::evictionCount(const FrameRetention &retention) const
+{
+    Q_ASSERT(!source);
+    QMutexLocker locker(&pendingLock);
+    if (numFrames == 0 || retention.limit <= 0 || paged) return 0;
+
+    qint64 bytes = 0;
+    if (retention.mode == FrameRetention::ByMemory)
+    {
+        foreach (const Chunk *chunk, chunks) bytes += chunkBytes(chunk);
+        foreach (const Chunk *chunk, pendingChunks) bytes += chunkBytes(chunk);
+    }
+    const Chunk *lastChunk;
+    int64_t newest = record(numFrames - 1, &lastChunk).timestamp;
+
+    int evict = 0;
+    for (int c = 0; c < chunks.count() - 1; c++)
+    {
+        const Chunk *chunk = chunks[c];
+        int inChunk = (c == 0) ? CHUNK_SIZE - headOffset : CHUNK_SIZE;
+        if (retention.mode == FrameRetention::ByCount && numFrames - evict - inChunk < retention.limit) break;
+        if (retention.mode == FrameRetention::ByMemory && bytes <= retention.limit) break;
+        //timestamps can jump around between buses a bit, going by the last frame in the chunk is close enough
+        if (retention.mode == FrameRetention::ByTime && chunk->records[CHUNK_MASK].timestamp >= newest - retention.limit) break;
+
+        evict += inChunk;
+        bytes -= chunkBytes(chunk);
+    }
+    return evict;
+}
+
+void CANFrameStore::appendRow(int sourceRow)
+{
+    Q_ASSERT(source);
+    rows.append(static_cast<uint32_t>(sourceRow));
+    if (!rowTimedeltas.isEmpty())
+    {
+        rowTimedeltas.append(0);
+        rowFrameCounts.append(1);
+    }
+    numFrames++;
+}
+
+void CANFrameStore::replaceRow(int idx, int sourceRow)
+{
+    Q_ASSERT(source);
+    rows[idx] = static_cast<uint32_t>(sourceRow);
+}
+
+void CANFrameStore::setRows(const QVector<uint32_t> &newRows)
+{
+    Q_ASSERT(source);
+    rows = newRows;
+    rowTimedeltas.clear();
+    rowFrameCounts.clear();
+    numFrames = rows.count();
+}
+
+//Both lists have to be in ascending order. Used when a filter gets turned on so only the rows for
+//that ID get touched instead of rebuilding the whole list.
+void CANFrameStore::mergeRows(const QVector<uint32_t> &sortedRows)
+{
+    Q_ASSERT(source);
+    QVector<uint32_t> merged(rows.count() + sortedRows.count());
+    std::merge(rows.constBegin(), rows.constEnd(), sortedRows.constBegin(), sortedRows.constEnd(), merged.begin());
+    setRows(merged);
+}
+
+void CANFrameStore::removeRows(const QVector<uint32_t> &sortedRows)
+{
+    Q_ASSERT(source);
+    QVector<uint32_t> remaining(rows.count());
+    QVector<uint32_t>::iterator end = std::set_difference(rows.constBegin(), rows.constEnd(), sortedRows.constBegin(), sortedRows.constEnd(), remaining.begin());
+    remaining.resize(static_cast<int>(end - remaining.begin()));
+    setRows(remaining);
+}
+
+//reorders the view so that new row i is old row order[i]. Sorting the grid only shuffles row numbers now.
+void CANFrameStore::permute(const QVector<int> &order)
+{
+    Q_ASSERT(source);
+    QVector<uint32_t> newRows(order.count());
+    for (int i = 0; i < order.count(); i++) newRows[i] = rows[order[i]];
+    rows = newRows;
+
+    if (!rowTimedeltas.isEmpty())
+    {
+        QVector<uint64_t> newDeltas(order.count());
+        QVector<uint32_t> newCounts(order.count());
+        for (int i = 0; i < order.count(); i++)
+        {
+            newDeltas[i] = rowTimedeltas[order[i]];
+            newCounts[i] = rowFrameCounts[order[i]];
+        }
+        rowTimedeltas = newDeltas;
+        rowFrameCounts = newCounts;
+    }
+    numFrames = rows.count();
+}
+
+//The source dropped its oldest num frames. Forget rows that pointed at them and renumber the rest.
+void CANFrameStore::sourceRowsRemoved(int num)
+{
+    Q_ASSERT(source);
+    int out = 0;
+    bool hasStats = !rowTimedeltas.isEmpty();
+    for (int i = 0; i < rows.count(); i++)
+    {
+        if (rows[i] < static_cast<uint32_t>(num)) continue;
+        rows[out] = rows[i] - static_cast<uint32_t>(num);
+        if (hasStats)
+        {
+            rowTimedeltas[out] = rowTimedeltas[i];
+            rowFrameCounts[out] = rowFrameCounts[i];
+        }
+        out++;
+    }
+    rows.resize(out);
+    if (hasStats)
+    {
+        rowTimedeltas.resize(out);
+        rowFrameCounts.resize(out);
+    }
+    numFrames = out;
+}
+
+CANFrameScanner::CANFrameScanner(const CANFrameStore &store, int first, int last) : store(store)
+{
+    if (first < 0) first = 0;
+    if (last < 0 || last >= store.count()) last = store.count() - 1;
+    current = first - 1;
+    this->last = last;
+    useFilter = false;
+    filterId = 0;
+    blockIdx = -1;
+    blockFirst = 0;
+}
+
+CANFrameScanner::~CANFrameScanner()
+{
+}
+
+void CANFrameScanner::setIdFilter(uint32_t id)
+{
+    useFilter = true;
+    filterId = id;
+}
+
+//what the packed record holds in frameId, the error flags for error frames
+static inline uint32_t rawFrameId(const CANFrameView &view)
+{
+    if (view.frameType() == QCanBusFrame::ErrorFrame) return static_cast<uint32_t>(view.errorFlags());
+    return view.frameId();
+}
+
+bool CANFrameScanner::next()
+{
+    const PagedCapture *paged = store.paged.get();
+    while (++current <= last)
+    {
+        if (!paged)
+        {
+            if (useFilter && rawFrameId(store.view(current)) != filterId) continue;
+            return true;
+        }
+
+        if (!block || current >= blockFirst + block->count)
+        {
+            if (!loadBlock(true)) return false;
+            if (current > last) return false;
+        }
+        if (useFilter && block->records[current - blockFirst].frameId != filterId) continue;
+        return true;
+    }
+    return false;
+}
+
+bool CANFrameScanner::seek(int row)
+{
+    if (row < current || row > last) return false;
+    current = row;
+    if (!store.paged) return true;
+    if (!block || current >= blockFirst + block->count) return loadBlock(false);
+    return true;
+}
+
+//Decodes the block current is in. With skipFiltered, blocks the filter ID can't be in are stepped
+//over and current moves to the first row of the block that got decoded.
+bool CANFrameScanner::loadBlock(bool skipFiltered)
+{
+    const PagedCapture *paged = store.paged.get();
+    const CaptureFileReader &reader = paged->reader;
+    int idx = paged->blockOf(current, blockIdx + 1);
+    while (skipFiltered && useFilter && idx < reader.blockCount() && !reader.block(idx).mayContain(filterId)) idx++;
+    if (idx >= reader.blockCount()) return false;
+
+    const CaptureBlockInfo &info = reader.block(idx);
+    if (info.firstFrame > current) current = static_cast<int>(info.firstFrame);
+    if (current > last) return false;
+
+    block.reset(new PagedBlock);
+    blockIdx = idx;
+    blockFirst = static_cast<int>(info.firstFrame);
+    if (!paged->decode(idx, *block, decoded) || block->count != static_cast<int>(info.frameCount))
+    {
+        //same as paging it in, an unreadable block shows up as zeroed frames
+        block->count = static_cast<int>(info.frameCount);
+        block->records.reset(new PackedCANFrame[qMax(1, block->count)]());
+    }
+    return true;
+}
+
+CANFrameView CANFrameScanner::frame() const
+{
+    if (!store.paged) return store.view(current);
+    const PackedCANFrame &rec = block->records[current - blockFirst];
+    return CANFrameView(&rec, rec.length <= 8 ? rec.payload.inlineData : rec.payload.arenaData);
+}
@@ -0,0 +1,285 @@
+#ifndef CANFRAMESTORE_H
+#define CANFRAMESTORE_H
+
+#include <QVector>
+#include <QMutex>
+#include <QAtomicInt>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+#include "can_structs.h"
+
+class FrameBatch;
+class PagedCapture;
+struct PagedBlock;
+
+/*
+ * Packed storage for captured frames. A CANFrame is a QCanBusFrame plus our own fields which works
+ * out to 56 bytes of object plus a separately heap allocated QByteArray for the payload. With millions
+ * of frames that was gigabytes of RAM. Here every frame is a 24 byte record. Payloads of 8 bytes or
+ * less (all classic CAN) live right inside the record, longer CAN-FD payloads go into a byte arena
+ * owned by the chunk the record lives in. Records are allocated a whole chunk at a time so appending
+ * a frame never does a heap allocation of its own. Neither records nor arena bytes ever move once
+ * written which is what lets the capture ingest thread append while the GUI reads (see appendPending).
+ */
+
+namespace PackedFrameFlags
+{
+    enum : uint8_t
+    {
+        TypeMask        = 0x07, //holds QCanBusFrame::FrameType
+        Extended        = 0x08,
+        FlexibleData    = 0x10,
+        BitrateSwitch   = 0x20,
+        ErrorState      = 0x40,
+        Received        = 0x80
+    };
+}
+
+struct PackedCANFrame
+{
+    int64_t timestamp; //microseconds
+    union
+    {
+        uint8_t inlineData[8];
+        const uint8_t *arenaData; //used if length > 8
+    } payload;
+    uint32_t frameId;
+    uint16_t length;
+    uint8_t bus;
+    uint8_t flags;
+};
+
+//Append only storage for payloads that don't fit inline. Blocks are never reallocated so records can
+//point straight at their bytes and stay valid while more gets added.
+class PayloadArena
+{
+public:
+    explicit PayloadArena(int blockSize = 64 * 1024) : blockSize(blockSize), used(0) {}
+
+    const uint8_t *store(const uint8_t *data, int len);
+    qint64 bytesAllocated() const { return allocated; }
+
+private:
+    std::vector<std::unique_ptr<uint8_t[]>> blocks;
+    int blockSize;
+    int used; //bytes used in the last block
+    qint64 allocated = 0;
+};
+
+//Lightweight read only view of one stored frame. It is only valid until the store is next modified.
+//Use this instead of CANFrameStore::at() in loops that only need to look at a couple of fields
+class CANFrameView
+{
+public:
+    CANFrameView(const PackedCANFrame *rec, const uint8_t *data) : record(rec), payloadPtr(data) {}
+
+    //0 for error frames like QCanBusFrame::frameId(), their flags are in errorFlags()
+    uint32_t frameId() const { return isError() ? 0 : record->frameId; }
+    QCanBusFrame::FrameErrors errorFlags() const { return isError() ? QCanBusFrame::FrameErrors(QFlag(static_cast<int>(record->frameId))) : QCanBusFrame::FrameErrors(); }
+    int bus() const { return record->bus; }
+    int64_t timestamp() const { return record->timestamp; }
+    int length() const { return record->length; }
+    const uint8_t *data() const { return payloadPtr; }
+    uint8_t byteAt(int idx) const { return payloadPtr[idx]; }
+    bool hasExtendedFrameFormat() const { return record->flags & PackedFrameFlags::Extended; }
+    bool isReceived() const { return record->flags & PackedFrameFlags::Received; }
+    QCanBusFrame::FrameType frameType() const { return static_cast<QCanBusFrame::FrameType>(record->flags & PackedFrameFlags::TypeMask); }
+    CANFrame toCANFrame() const;
+    CANFrameData toFrameData() const;
+
+private:
+    bool isError() const { return (record->flags & PackedFrameFlags::TypeMask) == QCanBusFrame::ErrorFrame; }
+
+    const PackedCANFrame *record;
+    const uint8_t *payloadPtr;
+};
+
+/*
+ * How much capture history to keep. Old frames are evicted a whole chunk at a time which frees them
+ * in O(1) but means the limit is only honored to within one chunk (65536 frames). At least limit
+ * frames or the last limit microseconds are kept, a memory budget is never exceeded by more than the
+ * chunk currently being filled.
+ */
+struct FrameRetention
+{
+    enum Mode
+    {
+        ByCount = 0,
+        ByMemory = 1,
+        ByTime = 2
+    };
+
+    Mode mode;
+    qint64 limit; //frames, bytes or microseconds depending on mode
+};
+
+/*
+ * A store either owns packed frame records or is a view of another store. A view only keeps a list of
+ * 32 bit row numbers into its source (plus the overwrite mode stats if something sets them) so the
+ * filtered list in the main window no longer needs a second copy of every frame it shows.
+ */
+class CANFrameStore
+{
+public:
+    CANFrameStore();
+    explicit CANFrameStore(const CANFrameStore *source);
+    ~CANFrameStore();
+
+    int count() const { return numFrames; }
+    int size() const { return numFrames; }
+    int length() const { return numFrames; }
+    bool isEmpty() const { return numFrames == 0; }
+
+    CANFrame at(int idx) const;
+    CANFrame operator[](int idx) const { return at(idx); }
+    CANFrame first() const { return at(0); }
+    CANFrame last() const { return at(numFrames - 1); }
+    CANFrameView view(int idx) const;
+    QVector<CANFrame> toVector() const;
+    QVector<CANFrame> mid(int pos, int len = -1) const;
+
+    //These first take in whatever the ingest thread has pending (see below) and return how many rows
+    //that was. Those rows end up in front of the appended ones.
+    int append(const CANFrame &frame);
+    int append(const QVector<CANFrame> &newFrames);
+    int appendFrom(const CANFrameStore &other, int idx);
+    void replace(int idx, const CANFrame &frame);
+    void setTimestamp(int idx, int64_t micros);
+    void setOverwriteStats(int idx, uint64_t timedelta, uint32_t frameCount);
+    void removeFirst(int num);
+    void reserve(int num);
+    void clear();
+
+    //Capture ingest. One writer thread may add frames with appendPending() while the thread that owns
+    //the store keeps reading it without locking. Pending frames stay invisible until the owner calls
+    //acceptPending() which returns how many rows that added to the end of the store. appendPending
+    //returns the sequence number the first frame of the batch got.
+    uint64_t appendPending(const FrameBatch &batch);
+    int pendingCount() const { return published.loadAcquire(); }
+    int acceptPending();
+
+    //only valid for views
+    bool isView() const { return source != nullptr; }
+    int sourceRow(int idx) const { return static_cast<int>(rows[idx]); }
+    uint32_t frameCountAt(int idx) const { return rowFrameCounts.isEmpty() ? 1 : rowFrameCounts[idx]; }
+    const QVector<uint32_t> &sourceRows() const { return rows; }
+    void appendRow(int sourceRow);
+    void replaceRow(int idx, int sourceRow);
+    void setRows(const QVector<uint32_t> &newRows);
+    void mergeRows(const QVector<uint32_t> &sortedRows);
+    void removeRows(const QVector<uint32_t> &sortedRows);
+    void permute(const QVector<int> &order);
+    void sourceRowsRemoved(int num);
+
+    //Every frame appended to a store gets the next sequence number and keeps it while it's in the
+    //store, unlike its row which shifts whenever older frames are evicted. Views report the numbers
+    //of their source. indexOfSequence is -1 for frames that were evicted or haven't arrived.
+    uint64_t firstSequence() const;
+    uint64_t sequenceAt(int idx) const;
+    int indexOfSequence(uint64_t seq) const;
+
+    //ring buffer support, neither is valid for views
+    qint64 bytesUsed() const;
+    int evictionCount(const FrameRetention &retention) const;
+
+    //Read only store over a SavvyCAN capture file (.sccap) that can be far bigger than RAM. A block of
+    //frames is decoded when a row in it is asked for and only the PAGED_BLOCKS most recently used
+    //blocks stay in memory, so a view() of a paged store is only good until a few other blocks have
+    //been touched. Paging happens on the calling thread and isn't locked, so outside the GUI thread
+    //and for long runs of rows go through a CANFrameScanner instead.
+    bool openPaged(const QString &captureFile);
+    bool isPaged() const { return paged != nullptr; }
+
+    static int bytesPerFrame() { return sizeof(PackedCANFrame); }
+    static void pack(PackedCANFrame &rec, PayloadArena &arena, const CANFrame &frame);
+    static void pack(PackedCANFrame &rec, PayloadArena &arena, const CANFrameData &frame);
+
+    static const int PAGED_BLOCKS = 32;
+
+private:
+    friend class CANFrameScanner;
+
+    static constexpr int CHUNK_SHIFT = 16;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+    static constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+
+    struct Chunk
+    {
+        std::unique_ptr<PackedCANFrame[]> records;
+        PayloadArena arena; //payloads longer than 8 bytes
+        std::unique_ptr<uint64_t[]> timedeltas; //only allocated when overwrite mode stats are stored
+        std::unique_ptr<uint32_t[]> frameCounts;
+    };
+
+    void appendLocked(const CANFrame &frame);
+    int acceptPendingLocked();
+    const PackedCANFrame &record(int idx, const Chunk **chunk) const;
+    static qint64 chunkBytes(const Chunk *chunk);
+
+    QVector<Chunk*> chunks;
+    int headOffset; //number of already discarded records at the start of chunks[0]
+    int numFrames;
+    uint64_t baseSequence; //sequence number of row 0
+
+    //Everything that changes where the next record goes is guarded by pendingLock. The owner's plain
+    //reads never take it since the writer only touches records past numFrames and chunks it hasn't
+    //handed over yet.
+    mutable QMutex pendingLock;
+    QVector<Chunk*> pendingChunks; //filled by the writer past the end of chunks
+    int pendingFrames;
+    QAtomicInt published;
+
+    std::unique_ptr<PagedCapture> paged;
+
+    const CANFrameStore *source;
+    QVector<uint32_t> rows;
+    QVector<uint64_t> rowTimedeltas; //empty unless overwrite mode stats were set on the view
+    QVector<uint32_t> rowFrameCounts;
+
+    Q_DISABLE_COPY(CANFrameStore)
+};
+
+/*
+ * Walks the rows first to last of a store in order. Use it for loops over a large part of the capture
+ * instead of calling view() row by row. On a paged store each block gets decoded once into a buffer
+ * the scanner owns, so a long scan doesn't push the rows the main grid is showing out of the page
+ * cache and several scanners can run on worker threads at the same time. With an ID filter the blocks
+ * of a paged store that can't have that ID aren't read at all. On other stores it is just the loop.
+ */
+class CANFrameScanner
+{
+public:
+    CANFrameScanner(const CANFrameStore &store, int first = 0, int last = -1);
+    ~CANFrameScanner();
+
+    //only stop at frames with this ID (error flags for error frames)
+    void setIdFilter(uint32_t id);
+    //moves to the next row in range, false once there are none left
+    bool next();
+    //Moves straight to row, which can't be before the current one, without looking at the filter.
+    //On a paged store only the block row is in gets decoded, the ones in between are stepped over.
+    bool seek(int row);
+    int row() const { return current; }
+    //valid until next() is called again
+    CANFrameView frame() const;
+
+private:
+    bool loadBlock(bool skipFiltered);
+
+    const CANFrameStore &store;
+    int current;
+    int last;
+    bool useFilter;
+    uint32_t filterId;
+
+    //only used on paged stores
+    std::unique_ptr<PagedBlock> block;
+    QVector<CANFrameData> decoded;
+    int blockIdx;
+    int blockFirst; //row of the first frame in block
+
+    Q_DISABLE_COPY(CANFrameScanner)
+};
+
+#endif // CANFRAMESTORE_H
@@ -0,0 +1,349 @@
+#include "capturefile.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QtEndian>
+#include <string.h>
+
+static const char HEADER_MAGIC[8] = {'S', 'C', 'C', 'A', 'P', 'T', 0, 0};
+static const char FOOTER_MAGIC[8] = {'S', 'C', 'C', 'A', 'P', 'E', 'N', 'D'};
+static const uint32_t FORMAT_VERSION = 1;
+static const int HEADER_SIZE = 16;
+static const int BLOCK_HEADER_SIZE = 8;
+static const int RECORD_SIZE = 16;
+static const int INDEX_ENTRY_SIZE = 64;
+static const int FOOTER_SIZE = 24;
+
+template <typename T> static void putLE(QByteArray &out, T value)
+{
+    uchar buf[sizeof(T)];
+    qToLittleEndian<T>(value, buf);
+    out.append(reinterpret_cast<const char *>(buf), sizeof(T));
+}
+
+template <typename T> static T getLE(const uchar *src)
+{
+    return qFromLittleEndian<T>(src);
+}
+
+//block contents without the block header, frames is replaced
+static bool decodeBlock(const QByteArray &compressed, uint32_t frameCount, QVector<CANFrameData> &frames)
+{
+    QByteArray raw = qUncompress(compressed);
+    qint64 recordBytes = static_cast<qint64>(frameCount) * RECORD_SIZE;
+    if (raw.size() < recordBytes) return false;
+
+    const uchar *rec = reinterpret_cast<const uchar *>(raw.constData());
+    const uchar *payload = rec + recordBytes;
+    const uchar *end = rec + raw.size();
+
+    frames.resize(static_cast<int>(frameCount));
+    CANFrameData *out = frames.data();
+    int64_t timestamp = 0;
+    for (uint32_t i = 0; i < frameCount; i++, rec += RECORD_SIZE)
+    {
+        CANFrameData &frame = out[i];
+        timestamp += getLE<qint64>(rec);
+        frame.timestamp = timestamp;
+        frame.frameId = getLE<quint32>(rec + 8);
+        frame.bus = rec[12];
+        frame.length = rec[13];
+        frame.flags = rec[14];
+        frame.frameType = rec[15];
+        if (frame.length > sizeof(frame.data) || payload + frame.length > end) return false;
+        memcpy(frame.data, payload, frame.length);
+        memset(frame.data + frame.length, 0, sizeof(frame.data) - frame.length);
+        payload += frame.length;
+    }
+    return true;
+}
+
+CaptureFileWriter::CaptureFileWriter()
+{
+    totalFrames = 0;
+    compressionLevel = 1;
+}
+
+CaptureFileWriter::~CaptureFileWriter()
+{
+    if (file.isOpen()) close();
+}
+
+bool CaptureFileWriter::open(const QString &filename)
+{
+    if (file.isOpen()) close();
+
+    pending.clear();
+    pending.reserve(FRAMES_PER_BLOCK);
+    index.clear();
+    totalFrames = 0;
+
+    file.setFileName(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    QByteArray header(HEADER_MAGIC, sizeof(HEADER_MAGIC));
+    putLE<quint32>(header, FORMAT_VERSION);
+    putLE<quint32>(header, 0);
+    if (file.write(header) != header.size())
+    {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool CaptureFileWriter::append(const CANFrameData &frame)
+{
+    if (!file.isOpen()) return false;
+    pending.append(frame);
+    if (pending.count() >= FRAMES_PER_BLOCK) return writeBlock();
+    return true;
+}
+
+bool CaptureFileWriter::flush()
+{
+    if (!file.isOpen()) return false;
+    if (!pending.isEmpty() && !writeBlock()) return false;
+    return file.flush();
+}
+
+bool CaptureFileWriter::close()
+{
+    if (!file.isOpen()) return false;
+
+    bool ok = pending.isEmpty() || writeBlock();
+
+    QByteArray tail;
+    tail.reserve(index.count() * INDEX_ENTRY_SIZE + FOOTER_SIZE);
+    qint64 indexOffset = file.pos();
+    foreach (const CaptureBlockInfo &info, index)
+    {
+        putLE<quint64>(tail, static_cast<quint64>(info.offset));
+        putLE<quint32>(tail, info.compressedSize);
+        putLE<quint32>(tail, info.frameCount);
+        putLE<qint64>(tail, info.firstTimestamp);
+        putLE<qint64>(tail, info.lastTimestamp);
+        tail.append(reinterpret_cast<const char *>(info.idBits), sizeof(info.idBits));
+    }
+    putLE<quint64>(tail, static_cast<quint64>(indexOffset));
+    putLE<quint64>(tail, static_cast<quint64>(totalFrames));
+    tail.append(FOOTER_MAGIC, sizeof(FOOTER_MAGIC));
+
+    ok = ok && (file.write(tail) == tail.size());
+    file.close();
+    return ok;
+}
+
+bool CaptureFileWriter::writeBlock()
+{
+    int count = pending.count();
+    int payloadBytes = 0;
+    for (int i = 0; i < count; i++) payloadBytes += pending[i].length;
+
+    CaptureBlockInfo info;
+    memset(info.idBits, 0, sizeof(info.idBits));
+    info.frameCount = static_cast<uint32_t>(count);
+    info.firstTimestamp = pending.first().timestamp;
+    info.lastTimestamp = pending.last().timestamp;
+    info.firstFrame = totalFrames;
+
+    QByteArray raw(count * RECORD_SIZE + payloadBytes, Qt::Uninitialized);
+    uchar *rec = reinterpret_cast<uchar *>(raw.data());
+    uchar *payload = rec + count * RECORD_SIZE;
+    int64_t lastTimestamp = 0;
+    for (int i = 0; i < count; i++, rec += RECORD_SIZE)
+    {
+        const CANFrameData &frame = pending[i];
+        qToLittleEndian<qint64>(frame.timestamp - lastTimestamp, rec);
+        lastTimestamp = frame.timestamp;
+        qToLittleEndian<quint32>(frame.frameId, rec + 8);
+        rec[12] = frame.bus;
+        rec[13] = frame.length;
+        rec[14] = frame.flags;
+        rec[15] = frame.frameType;
+        memcpy(payload, frame.data, frame.length);
+        payload += frame.length;
+
+        int bit = CaptureBlockInfo::idBit(frame.frameId);
+        info.idBits[bit >> 3] |= static_cast<uint8_t>(1 << (bit & 7));
+    }
+
+    QByteArray compressed = qCompress(raw, compressionLevel);
+    info.offset = file.pos();
+    info.compressedSize = static_cast<uint32_t>(compressed.size());
+
+    QByteArray header;
+    putLE<quint32>(header, info.compressedSize);
+    putLE<quint32>(header, info.frameCount);
+    pending.clear();
+    if (file.write(header) != header.size() || file.write(compressed) != compressed.size()) return false;
+
+    index.append(info);
+    totalFrames += count;
+    return true;
+}
+
+CaptureFileReader::CaptureFileReader()
+{
+    mem = nullptr;
+    fileSize = 0;
+    totalFrames = 0;
+}
+
+CaptureFileReader::~CaptureFileReader()
+{
+    close();
+}
+
+bool CaptureFileReader::open(const QString &filename)
+{
+    close();
+
+    file.setFileName(filename);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    fileSize = file.size();
+    if (fileSize < HEADER_SIZE)
+    {
+        close();
+        return false;
+    }
+
+    //mapping fails for files bigger than the address space on 32 bit builds, blocks get read instead then
+    mem = file.map(0, fileSize);
+
+    QByteArray header = blockBytes(0, HEADER_SIZE);
+    if (header.size() != HEADER_SIZE || memcmp(header.constData(), HEADER_MAGIC, sizeof(HEADER_MAGIC))
+        || getLE<quint32>(reinterpret_cast<const uchar *>(header.constData()) + 8) != FORMAT_VERSION)
+    {
+        close();
+        return false;
+    }
+
+    if (!readIndex() && !rebuildIndex())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CaptureFileReader::close()
+{
+    if (mem) file.unmap(const_cast<uchar *>(mem));
+    mem = nullptr;
+    if (file.isOpen()) file.close();
+    fileSize = 0;
+    blocks.clear();
+    totalFrames = 0;
+}
+
+bool CaptureFileReader::readBlock(int idx, QVector<CANFrameData> &frames) const
+{
+    if (idx < 0 || idx >= blocks.count()) return false;
+    const CaptureBlockInfo &info = blocks[idx];
+    QByteArray compressed = blockBytes(info.offset + BLOCK_HEADER_SIZE, static_cast<int>(info.compressedSize));
+    if (compressed.size() != static_cast<int>(info.compressedSize)) return false;
+    return decodeBlock(compressed, info.frameCount, frames);
+}
+
+bool CaptureFileReader::isCaptureFile(const QString &filename)
+{
+    QFile inFile(filename);
+    if (!inFile.open(QIODevice::ReadOnly)) return false;
+    return isCaptureHeader(inFile.read(HEADER_SIZE));
+}
+
+bool CaptureFileReader::isCaptureHeader(const QByteArray &head)
+{
+    return head.size() >= HEADER_SIZE && !memcmp(head.constData(), HEADER_MAGIC, sizeof(HEADER_MAGIC));
+}
+
+//With the file mapped this doesn't copy anything, the bytes stay valid until close()
+QByteArray CaptureFileReader::blockBytes(qint64 offset, int len) const
+{
+    if (offset < 0 || len < 0 || offset + len > fileSize) return QByteArray();
+    if (mem) return QByteArray::fromRawData(reinterpret_cast<const char *>(mem + offset), len);
+
+    QMutexLocker locker(&fileLock);
+    if (!file.seek(offset)) return QByteArray();
+    return file.read(len);
+}
+
+bool CaptureFileReader::readIndex()
+{
+    if (fileSize < HEADER_SIZE + FOOTER_SIZE) return false;
+    QByteArray footer = blockBytes(fileSize - FOOTER_SIZE, FOOTER_SIZE);
+    const uchar *foot = reinterpret_cast<const uchar *>(footer.constData());
+    if (footer.size() != FOOTER_SIZE || memcmp(foot + 16, FOOTER_MAGIC, sizeof(FOOTER_MAGIC))) return false;
+
+    qint64 indexOffset = static_cast<qint64>(getLE<quint64>(foot));
+    qint64 indexBytes = fileSize - FOOTER_SIZE - indexOffset;
+    if (indexOffset < HEADER_SIZE || indexBytes < 0 || indexBytes % INDEX_ENTRY_SIZE) return false;
+
+    QByteArray entries = blockBytes(indexOffset, static_cast<int>(indexBytes));
+    const uchar *entry = reinterpret_cast<const uchar *>(entries.constData());
+    int numBlocks = static_cast<int>(indexBytes / INDEX_ENTRY_SIZE);
+    QVector<CaptureBlockInfo> index;
+    index.reserve(numBlocks);
+    qint64 frames = 0;
+    for (int i = 0; i < numBlocks; i++, entry += INDEX_ENTRY_SIZE)
+    {
+        CaptureBlockInfo info;
+        info.offset = static_cast<qint64>(getLE<quint64>(entry));
+        info.compressedSize = getLE<quint32>(entry + 8);
+        info.frameCount = getLE<quint32>(entry + 12);
+        info.firstTimestamp = getLE<qint64>(entry + 16);
+        info.lastTimestamp = getLE<qint64>(entry + 24);
+        memcpy(info.idBits, entry + 32, sizeof(info.idBits));
+        info.firstFrame = frames;
+        if (info.offset < HEADER_SIZE || info.offset + BLOCK_HEADER_SIZE + info.compressedSize > indexOffset) return false;
+        frames += info.frameCount;
+        index.append(info);
+    }
+    if (frames != static_cast<qint64>(getLE<quint64>(foot + 8))) return false;
+
+    blocks = index;
+    totalFrames = frames;
+    return true;
+}
+
+//No usable index, walk the blocks from the start. Each block has to be decoded to get its timestamps and
+//IDs so this costs about as much as loading the file once.
+bool CaptureFileReader::rebuildIndex()
+{
+    qDebug() << "Capture file has no index, rebuilding it from the blocks";
+
+    QVector<CaptureBlockInfo> index;
+    QVector<CANFrameData> frames;
+    qint64 offset = HEADER_SIZE;
+    qint64 numFrames = 0;
+    while (offset + BLOCK_HEADER_SIZE <= fileSize)
+    {
+        QByteArray header = blockBytes(offset, BLOCK_HEADER_SIZE);
+        CaptureBlockInfo info;
+        info.offset = offset;
+        info.compressedSize = getLE<quint32>(reinterpret_cast<const uchar *>(header.constData()));
+        info.frameCount = getLE<quint32>(reinterpret_cast<const uchar *>(header.constData()) + 4);
+        info.firstFrame = numFrames;
+        if (info.frameCount == 0 || offset + BLOCK_HEADER_SIZE + info.compressedSize > fileSize) break;
+
+        QByteArray compressed = blockBytes(offset + BLOCK_HEADER_SIZE, static_cast<int>(info.compressedSize));
+        if (!decodeBlock(compressed, info.frameCount, frames)) break; //torn write at the end
+
+        info.firstTimestamp = frames.first().timestamp;
+        info.lastTimestamp = frames.last().timestamp;
+        memset(info.idBits, 0, sizeof(info.idBits));
+        foreach (const CANFrameData &frame, frames)
+        {
+            int bit = CaptureBlockInfo::idBit(frame.frameId);
+            info.idBits[bit >> 3] |= static_cast<uint8_t>(1 << (bit & 7));
+        }
+        index.append(info);
+        numFrames += info.frameCount;
+        offset += BLOCK_HEADER_SIZE + info.compressedSize;
+    }
+
+    blocks = index;
+    totalFrames = numFrames;
+    return true;
+}
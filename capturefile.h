@@ -0,0 +1,114 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <stdint.h>
+#include "can_structs.h"
+
+/*
+ * SavvyCAN's own binary capture format (.sccap). Unlike GVRET CSV it keeps every field of a frame:
+ * the full 64 byte CAN-FD payload, FD/BRS/ESI flags, remote and error frames, bus and direction.
+ * Overwrite mode counters are derived from the frames and aren't stored.
+ *
+ * Frames are written in blocks of up to FRAMES_PER_BLOCK. Each block is compressed on its own (zlib at
+ * a fast level through qCompress) so blocks can be decompressed in parallel or one at a time without
+ * touching the rest of the file. An index at the end of the file says where each block is, its first
+ * and last timestamp, how many frames it has and which IDs might be in it.
+ *
+ * Everything is little endian:
+ *   header  char[8] "SCCAPT\0\0", uint32 version (1), uint32 reserved
+ *   block   uint32 compressed size, uint32 frame count, compressed bytes (qCompress output)
+ *           uncompressed it is frame count records of 16 bytes followed by all payloads back to back:
+ *             int64 timestamp in microseconds, the first one absolute and the rest relative to the one before
+ *             uint32 frame ID (error flags for error frames)
+ *             uint8 bus, uint8 payload length, uint8 CANFrameData::Flags, uint8 QCanBusFrame::FrameType
+ *   index   one entry per block: uint64 file offset, uint32 compressed size, uint32 frame count,
+ *           int64 first timestamp, int64 last timestamp, uint8[32] ID bitset (see idBit)
+ *   footer  uint64 index offset, uint64 total frames, char[8] "SCCAPEND"
+ *
+ * A file whose writer never got to close it (crash, power loss) has no index. The reader rebuilds it by
+ * walking the blocks and drops a partially written last block.
+ */
+
+struct CaptureBlockInfo
+{
+    qint64 offset; //of the block header
+    uint32_t compressedSize;
+    uint32_t frameCount;
+    int64_t firstTimestamp;
+    int64_t lastTimestamp;
+    uint8_t idBits[32];
+    qint64 firstFrame; //number of frames in all the blocks before this one, not stored
+
+    //false means no frame in the block has this ID, true only means it might
+    bool mayContain(uint32_t id) const { int bit = idBit(id); return idBits[bit >> 3] & (1 << (bit & 7)); }
+    static int idBit(uint32_t id) { return static_cast<int>((id * 2654435761u) >> 24); }
+};
+
+class CaptureFileWriter
+{
+public:
+    static const int FRAMES_PER_BLOCK = 65536;
+
+    CaptureFileWriter();
+    ~CaptureFileWriter();
+
+    bool open(const QString &filename);
+    bool append(const CANFrameData &frame);
+    bool append(const CANFrame &frame) { return append(CANFrameData::fromCANFrame(frame)); }
+    //writes out the frames collected so far as a short block, so they survive a crash
+    bool flush();
+    //writes the last block, the index and the footer
+    bool close();
+    bool isOpen() const { return file.isOpen(); }
+    qint64 bytesWritten() const { return file.isOpen() ? file.pos() : 0; }
+    qint64 framesWritten() const { return totalFrames + pending.count(); }
+    //qCompress level, -1 to 9. The default of 1 is several times faster than 6 and not much bigger
+    void setCompressionLevel(int level) { compressionLevel = level; }
+
+private:
+    bool writeBlock();
+
+    QFile file;
+    QVector<CANFrameData> pending;
+    QVector<CaptureBlockInfo> index;
+    qint64 totalFrames;
+    int compressionLevel;
+};
+
+class CaptureFileReader
+{
+public:
+    CaptureFileReader();
+    ~CaptureFileReader();
+
+    //maps the file and reads (or rebuilds) the block index
+    bool open(const QString &filename);
+    void close();
+    int blockCount() const { return blocks.count(); }
+    const CaptureBlockInfo &block(int idx) const { return blocks[idx]; }
+    qint64 frameCount() const { return totalFrames; }
+    //decodes one block, replacing the contents of frames. Safe to call from several threads at once.
+    bool readBlock(int idx, QVector<CANFrameData> &frames) const;
+
+    static bool isCaptureFile(const QString &filename);
+    //true if head (the start of a file) begins with a capture file header
+    static bool isCaptureHeader(const QByteArray &head);
+
+private:
+    QByteArray blockBytes(qint64 offset, int len) const;
+    bool readIndex();
+    bool rebuildIndex();
+
+    mutable QFile file;
+    mutable QMutex fileLock; //only used if the file couldn't be mapped
+    const uchar *mem;
+    qint64 fileSize;
+    QVector<CaptureBlockInfo> blocks;
+    qint64 totalFrames;
+};
+
+#endif // CAPTUREFILE_H
@@ -10,7 +10,14 @@
 
 using namespace CANCon;
 
-CANConnection* CanConFactory::create(type pType, QString pPortName, QString pDriverName, int pSerialSpeed, int pBusSpeed, bool pCanFd, int pDataRate)
+CANConnection* CanConFactory::create(type pType, QString pPortName, QString pDriverName, int pSerialSpeed, int pBusSpeed, bool pCanFd, int pDataRate, int pQueueLen)
+{
+    CANConnection *conn_p = createDriver(pType, pPortName, pDriverName, pSerialSpeed, pBusSpeed, pCanFd, pDataRate);
+    if (conn_p) conn_p->setQueueLength(pQueueLen);
+    return conn_p;
+}
+
+CANConnection* CanConFactory::createDriver(type pType, QString pPortName, QString pDriverName, int pSerialSpeed, int pBusSpeed, bool pCanFd, int pDataRate)
 {
     switch(pType) {
     case SERIALBUS:
@@ -1,9 +1,12 @@
 #include <QDateTime>
 #include <QSettings>
 #include <QCoreApplication>
+#include <climits>
 
 #include "canconmanager.h"
 #include "canconfactory.h"
+#include "canframestore.h"
+#include "framebatch.h"
 
 CANConManager* CANConManager::mInstance = nullptr;
 
@@ -17,10 +20,30 @@ CANConManager* CANConManager::getInstance()
 
 CANConManager::CANConManager(QObject *parent): QObject(parent)
 {
-    connect(&mTimer, SIGNAL(timeout()), this, SLOT(refreshCanList()));
-    mTimer.setInterval(20); /*Tick 50 times per second to allow for good resolution in reception where needed. GUI updates *MUCH* more slowly*/
+    qRegisterMetaType<CANFrame>("CANFrame");
+    qRegisterMetaType<FrameBatchPtr>("FrameBatchPtr");
+
+    mIngestStore = nullptr;
+    mInFlightWarning = IN_FLIGHT_WARNING;
+
+    /* Connection queues are drained in a thread of our own so a slow repaint in the GUI can't back them
+     * up. Draining is driven by the connections' framesQueued signal which is delivered to the timers
+     * living in that thread. The repeating timer is only a slow fallback. */
+    connect(&mTimer, &QTimer::timeout, this, &CANConManager::refreshCanList, Qt::DirectConnection);
+    mTimer.setInterval(FALLBACK_POLL_INTERVAL);
     mTimer.setSingleShot(false);
-    mTimer.start();
+    mTimer.moveToThread(&mIngestThread);
+    connect(&mDrainTimer, &QTimer::timeout, this, &CANConManager::refreshCanList, Qt::DirectConnection);
+    mDrainTimer.setInterval(COALESCE_INTERVAL);
+    mDrainTimer.setSingleShot(true);
+    mDrainTimer.setTimerType(Qt::PreciseTimer);
+    mDrainTimer.moveToThread(&mIngestThread);
+    connect(&mIngestThread, SIGNAL(started()), &mTimer, SLOT(start()));
+    connect(&mIngestThread, &QThread::finished, &mTimer, &QTimer::stop, Qt::DirectConnection);
+    connect(&mIngestThread, &QThread::finished, &mDrainTimer, &QTimer::stop, Qt::DirectConnection);
+    mIngestThread.start(QThread::HighPriority);
+
+    connect(&mStatsTimer, &QTimer::timeout, this, &CANConManager::writeStatsLog);
 
     mNumActiveBuses = 0;
 
@@ -33,6 +56,8 @@ CANConManager::CANConManager(QObject *parent): QObject(parent)
         useSystemTime = true;
     }
     else useSystemTime = false;
+
+    setLowLatency(settings.value("Main/LowLatencyCapture", false).toBool());
 }
 
 void CANConManager::resetTimeBasis()
@@ -43,7 +68,9 @@ void CANConManager::resetTimeBasis()
 
 CANConManager::~CANConManager()
 {
-    mTimer.stop();
+    stopStatsLog();
+    mIngestThread.quit();
+    mIngestThread.wait();
     mInstance = nullptr;
 }
 
@@ -55,22 +82,48 @@ void CANConManager::stopAllConnections()
     }
 }
 
+//Suspending flushes the connection queues so the ingest thread must not be in the middle of draining them
+void CANConManager::suspendAll(bool pSuspend)
+{
+    QMutexLocker locker(&mIngestMutex);
+    foreach (CANConnection *conn, mConns)
+    {
+        conn->suspend(pSuspend);
+    }
+}
+
+void CANConManager::setIngestStore(CANFrameStore *pStore)
+{
+    QMutexLocker locker(&mIngestMutex);
+    mIngestStore = pStore;
+}
+
 void CANConManager::add(CANConnection* pConn_p)
 {
+    QMutexLocker locker(&mIngestMutex);
     mConns.append(pConn_p);
+    connect(pConn_p, &CANConnection::framesQueued, &mDrainTimer, [this]() { drainRequested(); }, Qt::QueuedConnection);
+    //the connection may have queued frames (and used up its notification) before it was added
+    QMetaObject::invokeMethod(&mDrainTimer, [this]() { drainRequested(); }, Qt::QueuedConnection);
 }
 
 
+//once this returns the ingest thread is done with the connection so it can be deleted
 void CANConManager::remove(CANConnection* pConn_p)
 {
     //disconnect(pConn_p, 0, this, 0);
+    QMutexLocker locker(&mIngestMutex);
+    disconnect(pConn_p, &CANConnection::framesQueued, &mDrainTimer, nullptr);
     mConns.removeOne(pConn_p);
 }
 
 void CANConManager::replace(int idx, CANConnection* pConn_p)
 {
+    QMutexLocker locker(&mIngestMutex);
     CANConnection *original = mConns[idx];
+    disconnect(original, &CANConnection::framesQueued, &mDrainTimer, nullptr);
     mConns.replace(idx, pConn_p);
+    connect(pConn_p, &CANConnection::framesQueued, &mDrainTimer, [this]() { drainRequested(); }, Qt::QueuedConnection);
     delete original; original = NULL;
 }
 
@@ -96,34 +149,142 @@ int CANConManager::getBusBase(CANConnection *which)
     return -1;
 }
 
+//Runs in the ingest thread
 void CANConManager::refreshCanList()
 {
-    QObject* sender_p = QObject::sender();
+    QMutexLocker locker(&mIngestMutex);
 
     if (mConns.count() == 0)
     {
-        tempFrames.clear();
-        //TODO: Seems to crash under heavy load. Find out why.
-        if(buslessFrames.size()) {            
-            tempFrames = buslessFrames; //make a copy and pass that copy
-            buslessFrames.clear(); //delete all frames from the original
-            emit framesReceived(nullptr, tempFrames);
+        if(buslessFrames.size()) {
+            FrameBatch *batch = new FrameBatch(nullptr, 0);
+            batch->reserve(buslessFrames.count());
+            foreach (const CANFrame &frame, buslessFrames) batch->append(frame);
+            buslessFrames.clear();
+            publishBatch(batch);
         }
         return;
     }
 
-    if( sender_p != &mTimer)
+    foreach (CANConnection* conn_p, mConns)
+        refreshConnection(conn_p);
+}
+
+//Runs in the ingest thread whenever a connection queued frames after its last drain. In low latency mode
+//the queue is emptied right away, otherwise the coalescing timer gives other frames a moment to pile up.
+void CANConManager::drainRequested()
+{
+    if (mLowLatency.loadRelaxed())
+    {
+        mDrainTimer.stop();
+        refreshCanList();
+    }
+    else if (!mDrainTimer.isActive()) mDrainTimer.start();
+}
+
+void CANConManager::setLowLatency(bool pLowLatency)
+{
+    mLowLatency.storeRelaxed(pLowLatency ? 1 : 0);
+}
+
+//Hands a finished batch to the capture store and then to everyone listening. Runs in the ingest thread.
+void CANConManager::publishBatch(FrameBatch *pBatch)
+{
+    if (mIngestStore) pBatch->setFirstSequence(mIngestStore->appendPending(*pBatch));
+    emit framesReceived(FrameBatchPtr(pBatch));
+
+    //batches stay alive until the slowest consumer is done with them, complain if they pile up
+    int inFlight = FrameBatch::inFlight();
+    if (inFlight >= mInFlightWarning)
     {
-        /* if we are not the sender, the signal is coming from a connection */
-        /* refresh only the given connection */
-        if(mConns.contains((CANConnection*) sender_p))
-            refreshConnection((CANConnection*)sender_p);
+        qWarning() << inFlight << "frame batches in flight, a framesReceived consumer is falling behind";
+        mInFlightWarning *= 2;
     }
-    else
+    else if (inFlight < IN_FLIGHT_WARNING / 2) mInFlightWarning = IN_FLIGHT_WARNING;
+}
+
+int CANConManager::getBatchesInFlight()
+{
+    return FrameBatch::inFlight();
+}
+
+CANConStats CANConManager::getStats()
+{
+    CANConStats total;
+    foreach (CANConnection *conn_p, mConns)
     {
-        foreach (CANConnection* conn_p, mConns)
-            refreshConnection((CANConnection*)conn_p);
+        CANConStats stats = conn_p->getStats();
+        total.received += stats.received;
+        total.enqueued += stats.enqueued;
+        total.dropped += stats.dropped;
+        total.parseErrors += stats.parseErrors;
+        total.maxQueueDepth = qMax(total.maxQueueDepth, stats.maxQueueDepth);
+        total.queueCapacity = qMax(total.queueCapacity, stats.queueCapacity);
+        total.lastDrainLatency = qMax(total.lastDrainLatency, stats.lastDrainLatency);
+        total.maxDrainLatency = qMax(total.maxDrainLatency, stats.maxDrainLatency);
     }
+    return total;
+}
+
+bool CANConManager::startStatsLog(const QString &pFilename, int pIntervalMs)
+{
+    stopStatsLog();
+
+    mStatsFile.setFileName(pFilename);
+    if (!mStatsFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+    {
+        qDebug() << "Could not open stats log" << pFilename;
+        return false;
+    }
+    mStatsStream.setDevice(&mStatsFile);
+    if (mStatsFile.size() == 0)
+    {
+        mStatsStream << "Time,Connection,Port,Bus,Received,Enqueued,Dropped,ParseErrors,MaxQueueDepth,QueueCapacity,LastLatencyUs,MaxLatencyUs,BatchesInFlight\n";
+    }
+
+    writeStatsLog();
+    mStatsTimer.start(pIntervalMs);
+    return true;
+}
+
+void CANConManager::stopStatsLog()
+{
+    mStatsTimer.stop();
+    if (mStatsFile.isOpen())
+    {
+        mStatsStream.flush();
+        mStatsStream.setDevice(nullptr);
+        mStatsFile.close();
+    }
+}
+
+bool CANConManager::isStatsLogging()
+{
+    return mStatsFile.isOpen();
+}
+
+//One line per bus, bus numbers are the global ones shown everywhere else
+void CANConManager::writeStatsLog()
+{
+    if (!mStatsFile.isOpen()) return;
+
+    QString now = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    int inFlight = FrameBatch::inFlight();
+    int busBase = 0;
+    for (int c = 0; c < mConns.count(); c++)
+    {
+        CANConnection *conn_p = mConns[c];
+        for (int b = 0; b < conn_p->getNumBuses(); b++)
+        {
+            CANConStats stats = conn_p->getStats(b);
+            mStatsStream << now << "," << c << "," << conn_p->getPort() << "," << (busBase + b) << ","
+                         << stats.received << "," << stats.enqueued << "," << stats.dropped << ","
+                         << stats.parseErrors << "," << stats.maxQueueDepth << "," << stats.queueCapacity << ","
+                         << stats.lastDrainLatency << "," << stats.maxDrainLatency << "," << inFlight << "\n";
+        }
+        busBase += conn_p->getNumBuses();
+    }
+    mStatsStream.flush();
 }
 
 uint64_t CANConManager::getTimeBasis()
@@ -165,7 +326,6 @@ void CANConManager::refreshConnection(CANConnection* pConn_p)
     if (pConn_p->getQueue().peek() == nullptr) return;
 
     CANFrame* frame_p = nullptr;
-    QVector<CANFrame> frames;
 
     //Each connection only knows about its own bus numbers
     //so this variable is used to fix that up to turn local bus numbers
@@ -180,15 +340,22 @@ void CANConManager::refreshConnection(CANConnection* pConn_p)
 
     //qDebug() << "Bus fixup number: " << busBase;
 
-    while( (frame_p = pConn_p->getQueue().peek() ) ) {
-        frame_p->bus += busBase;
-        //qDebug() << "Rx of frame from bus: " << frame_p->bus;
-        frames.append(*frame_p);
-        pConn_p->getQueue().dequeue();
+    pConn_p->queueDrained();
+    FrameBatch *batch = new FrameBatch(pConn_p, busBase);
+    batch->reserve(pConn_p->getQueue().count());
+    int num = INT_MAX;
+    while( (frame_p = pConn_p->getQueue().peekBulk(num) ) ) {
+        for (int i = 0; i < num; i++)
+        {
+            frame_p[i].bus += busBase;
+            //qDebug() << "Rx of frame from bus: " << frame_p[i].bus;
+            batch->append(frame_p[i]);
+        }
+        pConn_p->getQueue().release(num);
+        num = INT_MAX;
     }
 
-    if(frames.size())
-        emit framesReceived(pConn_p, frames);
+    publishBatch(batch);
 }
 
 /*
@@ -209,7 +376,9 @@ bool CANConManager::sendFrame(const CANFrame& pFrame)
 
     if (mConns.count() == 0)
     {
+        QMutexLocker locker(&mIngestMutex);
         buslessFrames.append(pFrame);
+        QMetaObject::invokeMethod(&mDrainTimer, [this]() { drainRequested(); }, Qt::QueuedConnection);
         return true;
     }
 
@@ -4,9 +4,15 @@
 #include <QObject>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <QThread>
+#include <QMutex>
+#include <QFile>
+#include <QTextStream>
 
 #include "canconnection.h"
 
+#include "framebatch.h"
+
 class CANConManager : public QObject
 {
     Q_OBJECT
@@ -20,6 +26,43 @@ public:
     void replace(int idx, CANConnection* pConn_p);
     QList<CANConnection*>& getConnections();
     void stopAllConnections();
+    void suspendAll(bool pSuspend);
+
+    /**
+     * @brief setIngestStore sets the store that received frames get appended to
+     * @param pStore - store to fill from the ingest thread, nullptr to stop appending
+     * @note frames are added with CANFrameStore::appendPending, the owner picks them up with acceptPending
+     */
+    void setIngestStore(CANFrameStore *pStore);
+
+    /**
+     * @brief getBatchesInFlight
+     * @return number of frame batches emitted by framesReceived that some consumer still holds on to
+     */
+    int getBatchesInFlight();
+
+    /**
+     * @brief setLowLatency picks how quickly frames are passed on once a connection has queued them
+     * @param pLowLatency - true to drain right away, false to gather frames for a few milliseconds first
+     * @note low latency means smaller batches and so more work per frame for every framesReceived consumer
+     */
+    void setLowLatency(bool pLowLatency);
+
+    /**
+     * @brief getStats
+     * @return the ingest counters of all connections added up. Queue depth and latencies are the worst of any connection.
+     */
+    CANConStats getStats();
+
+    /**
+     * @brief startStatsLog periodically appends the ingest counters of every bus to a CSV file
+     * @param pFilename - file to append to
+     * @param pIntervalMs - time between two snapshots
+     * @return false if the file could not be opened
+     */
+    bool startStatsLog(const QString &pFilename, int pIntervalMs = 1000);
+    void stopStatsLog();
+    bool isStatsLogging();
 
     CANConnection* getByName(const QString& pName) const;
 
@@ -63,25 +106,41 @@ public:
     bool removeAllTargettedFrames(QObject *receiver);
 
 signals:
-    void framesReceived(CANConnection* pConn_p, QVector<CANFrame>& pFrames);
+    //emitted from the ingest thread. Every receiver gets the same read only batch.
+    void framesReceived(const FrameBatchPtr &pBatch);
     void connectionStatusUpdated(int conns);
 
 private slots:
     void refreshCanList();
+    void drainRequested();
+    void writeStatsLog();
 
 private:
     explicit CANConManager(QObject *parent = 0);
     void refreshConnection(CANConnection* pConn_p);
+    void publishBatch(FrameBatch *pBatch);
+
+    static const int IN_FLIGHT_WARNING = 64;
+    static const int COALESCE_INTERVAL = 5; //ms to gather frames for in normal mode
+    static const int FALLBACK_POLL_INTERVAL = 100; //ms, catches status changes and notifications that raced a drain
 
     static CANConManager*  mInstance;
     QList<CANConnection*>  mConns;
-    QTimer                 mTimer;
+    QThread                mIngestThread;
+    QTimer                 mTimer; //lives in mIngestThread, fallback poll
+    QTimer                 mDrainTimer; //lives in mIngestThread, single shot coalescing timer
+    QAtomicInt             mLowLatency;
+    QMutex                 mIngestMutex; //held while draining, guards mConns changes, buslessFrames and mIngestStore
+    CANFrameStore*         mIngestStore;
+    int                    mInFlightWarning; //warn when this many batches are alive
+    QTimer                 mStatsTimer; //GUI thread, drives the stats log
+    QFile                  mStatsFile;
+    QTextStream            mStatsStream;
     QElapsedTimer          mElapsedTimer;
     uint64_t               mTimestampBasis;
     uint32_t               mNumActiveBuses;
     bool                   useSystemTime;
     QVector<CANFrame>      buslessFrames;
-    QVector<CANFrame>      tempFrames;
 };
 
 #endif // CANCONNECTIONMODEL_H
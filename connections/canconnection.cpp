@@ -1,5 +1,6 @@
 #include <QSettings>
 #include <QThread>
+#include <atomic>
 #include "canconnection.h"
 
 CANConnection::CANConnection(QString pPort,
@@ -14,7 +15,13 @@ CANConnection::CANConnection(QString pPort,
                              bool pUseThread) :
     mNumBuses(pNumBuses),
     mSerialSpeed(pSerialSpeed),
+    mRxBus(0),
+    mRxBatching(false),
+    mRxRun(nullptr),
+    mRxRunLength(0),
+    mRxRunUsed(0),
     mQueue(),
+    mQueueLenOverride(0),
     mPort(pPort),
     mDriver(pDriver),
     mType(pType),
@@ -31,6 +38,7 @@ CANConnection::CANConnection(QString pPort,
 
     /* set queue size */
     mQueue.setSize(pQueueLen); /*TODO add check on returned value */
+    mStatsClock.start();
 
     /* allocate buses */
     /* TODO: change those tables for a vector */
@@ -178,12 +186,12 @@ bool CANConnection::sendFrame(const CANFrame& pFrame)
     }
 
     CANFrame *txFrame;
-    txFrame = getQueue().get();
+    txFrame = getRxSlot(pFrame.bus);
     if (txFrame)
     {
-        *txFrame = pFrame;        
-    }    
-    getQueue().queue();
+        *txFrame = pFrame;
+        queueRxFrame();
+    }
 
     return piSendFrame(pFrame);
 }
@@ -269,6 +277,139 @@ void CANConnection::setStatus(CANCon::status pStatus) {
     mStatus.storeRelaxed(pStatus);
 }
 
+CANFrame* CANConnection::getRxSlot(int pBusId)
+{
+    if (pBusId < 0) pBusId = 0;
+    if (pBusId >= MAX_STATS_BUSES) pBusId = MAX_STATS_BUSES - 1;
+    mRxBus = pBusId;
+
+    bump(mBusCounters[pBusId].received);
+
+    CANFrame *frame_p;
+    if (mRxBatching)
+    {
+        if (mRxRunUsed == mRxRunLength)
+        {
+            //run is used up, publish it and grab the next one
+            commitRxRun();
+            mRxRunLength = RX_RUN_LENGTH;
+            mRxRun = mQueue.reserve(mRxRunLength);
+        }
+        frame_p = mRxRun ? &mRxRun[mRxRunUsed] : nullptr;
+    }
+    else frame_p = mQueue.get();
+
+    if (!frame_p) bump(mBusCounters[pBusId].dropped);
+    return frame_p;
+}
+
+void CANConnection::queueRxFrame()
+{
+    if (mFirstQueuedAt.loadRelaxed() == 0) mFirstQueuedAt.testAndSetRelaxed(0, mStatsClock.nsecsElapsed() | 1);
+    bump(mBusCounters[mRxBus].enqueued);
+
+    if (mRxBatching)
+    {
+        mRxRunUsed++;
+        return;
+    }
+
+    mQueue.queue();
+    int depth = mQueue.count();
+    if (depth > mMaxQueueDepth.loadRelaxed()) mMaxQueueDepth.storeRelaxed(depth);
+    notifyQueued();
+}
+
+void CANConnection::beginRxBatch()
+{
+    mRxBatching = true;
+    mRxRun = nullptr;
+    mRxRunLength = mRxRunUsed = 0;
+}
+
+void CANConnection::endRxBatch()
+{
+    commitRxRun();
+    mRxBatching = false;
+}
+
+void CANConnection::commitRxRun()
+{
+    if (mRxRunUsed > 0)
+    {
+        mQueue.commit(mRxRunUsed);
+        int depth = mQueue.count();
+        if (depth > mMaxQueueDepth.loadRelaxed()) mMaxQueueDepth.storeRelaxed(depth);
+        notifyQueued();
+    }
+    mRxRun = nullptr;
+    mRxRunLength = mRxRunUsed = 0;
+}
+
+//The plain load keeps the common case (a drain is already on its way) free of atomic writes. The fence
+//keeps that load from being done before the frames just committed are visible, paired with the one in
+//queueDrained either this sees the flag cleared or the drain that cleared it sees the frames.
+void CANConnection::notifyQueued()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mDrainPending.loadAcquire() != 0) return;
+    if (mDrainPending.fetchAndStoreOrdered(1) == 0) emit framesQueued();
+}
+
+void CANConnection::setQueueLength(int pQueueLen)
+{
+    if (pQueueLen <= 0) return;
+    mQueue.setSize(pQueueLen);
+    mQueueLenOverride = pQueueLen;
+}
+
+void CANConnection::countParseError()
+{
+    bump(mParseErrors);
+}
+
+//The stamp of the oldest frame is taken when it gets queued and cleared here. A frame queued while this
+//runs can leave a stamp behind for a frame that gets drained right now, so the next value may be a
+//little high. Good enough to tell whether the queues are drained fast enough.
+void CANConnection::queueDrained()
+{
+    mDrainPending.fetchAndStoreOrdered(0);
+    std::atomic_thread_fence(std::memory_order_seq_cst); //before the caller reads the queue, see notifyQueued
+
+    qint64 queuedAt = mFirstQueuedAt.fetchAndStoreRelaxed(0);
+    if (queuedAt == 0) return;
+
+    qint64 latency = (mStatsClock.nsecsElapsed() - queuedAt) / 1000;
+    mLastDrainLatency.storeRelaxed(latency);
+    if (latency > mMaxDrainLatency.loadRelaxed()) mMaxDrainLatency.storeRelaxed(latency);
+}
+
+CANConStats CANConnection::getStats(int pBusIdx) const
+{
+    CANConStats stats;
+
+    //the device may have reported frames on buses it no longer claims so totals include every counter
+    int first = 0;
+    int last = MAX_STATS_BUSES - 1;
+    if (pBusIdx >= 0)
+    {
+        first = last = qMin(pBusIdx, (int)MAX_STATS_BUSES - 1);
+    }
+    for (int i = first; i <= last; i++)
+    {
+        stats.received += mBusCounters[i].received.loadRelaxed();
+        stats.enqueued += mBusCounters[i].enqueued.loadRelaxed();
+        stats.dropped += mBusCounters[i].dropped.loadRelaxed();
+    }
+
+    stats.parseErrors = mParseErrors.loadRelaxed();
+    stats.maxQueueDepth = mMaxQueueDepth.loadRelaxed();
+    stats.queueCapacity = mQueue.capacity();
+    stats.lastDrainLatency = mLastDrainLatency.loadRelaxed();
+    stats.maxDrainLatency = mMaxDrainLatency.loadRelaxed();
+    return stats;
+}
+
 bool CANConnection::isCapSuspended() {
     return mIsCapSuspended;
 }
@@ -3,6 +3,7 @@
 
 #include <Qt>
 #include <QObject>
+#include <QElapsedTimer>
 #include "utils/lfqueue.h"
 #include "can_structs.h"
 #include "canbus.h"
@@ -10,6 +11,23 @@
 
 struct BusData;
 
+/**
+ * @brief Snapshot of the ingest counters of one bus or of a whole connection
+ * @note queue depth, drain latency and parse errors are only tracked per connection. Per bus snapshots
+ * carry the values of the connection they belong to.
+ */
+struct CANConStats
+{
+    quint64 received = 0;       /*!< frames the device handed us while capture was running */
+    quint64 enqueued = 0;       /*!< frames that made it into the queue */
+    quint64 dropped = 0;        /*!< frames lost because the queue was full */
+    quint64 parseErrors = 0;    /*!< device traffic that could not be turned into a frame */
+    int maxQueueDepth = 0;      /*!< high water mark of the queue */
+    int queueCapacity = 0;
+    qint64 lastDrainLatency = 0; /*!< microseconds the oldest frame waited in the queue on the last drain */
+    qint64 maxDrainLatency = 0;
+};
+
 class CANConnection : public QObject
 {
     Q_OBJECT
@@ -89,6 +107,33 @@ public:
      */
     void setConsoleOutput(bool state);
 
+    /**
+     * @brief setQueueLength changes how many received frames can be buffered for the manager
+     * @param pQueueLen: new length, rounded up to a power of two
+     * @note must be called before start() and before the connection is handed to CANConManager
+     */
+    void setQueueLength(int pQueueLen);
+
+    /**
+     * @brief getQueueLengthOverride
+     * @return the length passed to setQueueLength, 0 if the driver's default is still used
+     */
+    int getQueueLengthOverride() const { return mQueueLenOverride; }
+
+    /**
+     * @brief getStats
+     * @param pBusIdx: local bus to get the counters of, -1 for the totals of the whole connection
+     * @return a snapshot of the ingest counters
+     * @note can be called from any thread
+     */
+    CANConStats getStats(int pBusIdx = -1) const;
+
+    /**
+     * @brief queueDrained records how long the oldest queued frame waited and rearms framesQueued
+     * @note called by the thread draining the queue right before it empties it
+     */
+    void queueDrained();
+
 
 signals:
     /*not implemented yet */
@@ -112,6 +157,12 @@ signals:
      */
     void status(CANConStatus pStatus);
 
+    /**
+     * @brief emitted from the connection's thread when frames got queued after the last queueDrained()
+     * @note emitted at most once per drain no matter how many frames arrive in between
+     */
+    void framesQueued();
+
     /**
       * @brief Event sent when device has done something worthy of debugging output.
       * @param debugString: String based output to show for debugging purposes
@@ -248,6 +299,32 @@ protected:
      */
     void setBusConfig(int pBusId, CANBus& pBus);
 
+    /**
+     * @brief getRxSlot gets the queue slot a received frame should be written to
+     * @param pBusId: local bus the frame came from
+     * @return the slot, or nullptr if the queue is full in which case the frame is counted as dropped
+     * @note only call this while capture isn't suspended and follow it up with queueRxFrame()
+     */
+    CANFrame* getRxSlot(int pBusId);
+
+    /**
+     * @brief queueRxFrame enqueues the slot returned by the last getRxSlot call
+     */
+    void queueRxFrame();
+
+    /**
+     * @brief beginRxBatch / endRxBatch bracket the parsing of one chunk of device data
+     * @note frames queued in between are handed to the manager all at once by endRxBatch instead of
+     * one release store per frame. Drivers should call these around each read of their device.
+     */
+    void beginRxBatch();
+    void endRxBatch();
+
+    /**
+     * @brief countParseError should be called whenever traffic from the device had to be thrown away
+     */
+    void countParseError();
+
     /**
      * @brief isCapSuspended
      * @return true if the capture is suspended
@@ -315,7 +392,38 @@ protected:
     virtual bool piSendFrames(const QList<CANFrame>&);
 
 private:
+    static const int MAX_STATS_BUSES = 16; //higher bus numbers are counted with the last one
+    static const int RX_RUN_LENGTH = 256; //slots reserved at a time while batching
+
+    /* All counters are only ever written by the thread filling the queue (plus queueDrained for the
+     * latencies) so they're bumped with plain relaxed load/store pairs and can be read from anywhere. */
+    struct BusCounters
+    {
+        QAtomicInteger<quint64> received;
+        QAtomicInteger<quint64> enqueued;
+        QAtomicInteger<quint64> dropped;
+    };
+
+    static void bump(QAtomicInteger<quint64> &counter) { counter.storeRelaxed(counter.loadRelaxed() + 1); }
+    void commitRxRun();
+    void notifyQueued();
+
+    BusCounters         mBusCounters[MAX_STATS_BUSES];
+    int                 mRxBus; //bus of the slot handed out by getRxSlot
+    bool                mRxBatching;
+    CANFrame*           mRxRun; //slots reserved from the queue while batching
+    int                 mRxRunLength;
+    int                 mRxRunUsed;
+    QAtomicInteger<quint64> mParseErrors;
+    QAtomicInt          mMaxQueueDepth;
+    QElapsedTimer       mStatsClock;
+    QAtomicInteger<qint64> mFirstQueuedAt; //mStatsClock ns when the oldest undrained frame was queued, 0 if none
+    QAtomicInteger<qint64> mLastDrainLatency;
+    QAtomicInteger<qint64> mMaxDrainLatency;
+    QAtomicInt          mDrainPending; //set once framesQueued was emitted, cleared by queueDrained
+
     LFQueue<CANFrame>   mQueue;
+    int                 mQueueLenOverride;
     const QString       mPort;
     const QString       mDriver;
     const CANCon::type  mType;
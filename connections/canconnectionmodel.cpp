@@ -16,7 +16,11 @@ enum class Column {
     Subtype    = 1, ///< Mostly used by SerialBus devices to pick the sub type
     Port       = 2, ///< The CAN hardware port, e.g. can0 for socketcan
     NumBuses   = 3, ///< Number of buses exposed by this device. Usually non-GVRET devices will just have one
-    Status     = 4  ///< The bus status as text message
+    Status     = 4, ///< The bus status as text message
+    Received   = 5, ///< Frames received from the device
+    Dropped    = 6, ///< Frames lost to a full queue plus traffic that couldn't be parsed
+    Queue      = 7, ///< Highest queue fill level seen versus queue capacity
+    Latency    = 8  ///< How long frames waited in the queue on the last drain
 };
 
 QVariant CANConnectionModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -38,6 +42,14 @@ QVariant CANConnectionModel::headerData(int section, Qt::Orientation orientation
             return QString(tr("Buses"));
         case Column::Status:
             return QString(tr("Status"));
+        case Column::Received:
+            return QString(tr("Received"));
+        case Column::Dropped:
+            return QString(tr("Dropped"));
+        case Column::Queue:
+            return QString(tr("Max Queue"));
+        case Column::Latency:
+            return QString(tr("Latency"));
         }
     }
 
@@ -50,7 +62,7 @@ QVariant CANConnectionModel::headerData(int section, Qt::Orientation orientation
 int CANConnectionModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    return 5;
+    return 9;
 }
 
 
@@ -105,8 +117,27 @@ QVariant CANConnectionModel::data(const QModelIndex &index, int role) const
                 break;
             case Column::Status:
                  return (conn_p->getStatus()==CANCon::CONNECTED) ? "Connected" : "Not Connected";
+            case Column::Received:
+                return conn_p->getStats().received;
+            case Column::Dropped:
+            {
+                CANConStats stats = conn_p->getStats();
+                if (stats.parseErrors == 0) return stats.dropped;
+                return QString::number(stats.dropped) + " + " + QString::number(stats.parseErrors);
+            }
+            case Column::Queue:
+            {
+                CANConStats stats = conn_p->getStats();
+                return QString::number(stats.maxQueueDepth) + " / " + QString::number(stats.queueCapacity);
+            }
+            case Column::Latency:
+                return QString::number(conn_p->getStats().lastDrainLatency / 1000.0, 'f', 1) + " ms";
         }
     }
+    else if (role == Qt::ToolTipRole && Column(index.column()) == Column::Dropped)
+    {
+        return tr("Frames dropped because the queue was full + device traffic that could not be parsed");
+    }
     return QVariant();
 }
 
@@ -149,6 +180,13 @@ CANConnection* CANConnectionModel::getAtIdx(int pIdx) const
     return conns.at(pIdx);
 }
 
+//Only the counter columns change while running. Resetting the model would lose the selection.
+void CANConnectionModel::refreshStats()
+{
+    if (rowCount() == 0) return;
+    emit dataChanged(createIndex(0, int(Column::Received)), createIndex(rowCount() - 1, int(Column::Latency)), QVector<int>() << Qt::DisplayRole);
+}
+
 void CANConnectionModel::refresh(int pIndex)
 {
     Q_UNUSED(pIndex)
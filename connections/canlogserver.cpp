@@ -72,7 +72,7 @@ void CanLogServer::readNetworkData()
                 // Support only normal can message. Extended CAN not supported.
                 if(qstrId.size() <= 4){
                     // Prepare the frame
-                    CANFrame* frame_p = getQueue().get();
+                    CANFrame* frame_p = getRxSlot(qstrCanId.toInt());
                     // Check for frame existence
                     if(frame_p){
                         // Set frame ID
@@ -92,11 +92,12 @@ void CanLogServer::readNetworkData()
                         // Elaborate frame
                         checkTargettedFrame(*frame_p);
                         /* enqueue frame */
-                        getQueue().queue();
+                        queueRxFrame();
                     }
                     qDebug() << data << "---" << qstrTs << " - " << qstrId << " + " << qstrPayload;
                 }
             }
+            else countParseError();
         }
     }
 }
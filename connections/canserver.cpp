@@ -161,6 +161,7 @@ void CANserver::readNetworkData()
     //qDebug() << "Processing " << packetCount << " packets";
 
     //Process this chunk of data
+    beginRxBatch();
     for (int i = 0 ; i < packetCount; i++)
     {
         uint16_t headerByteLocation = (i*16);
@@ -197,18 +198,18 @@ void CANserver::readNetworkData()
 
         //printf("frameId: %02X, busId: %d, length: %d\n", frameId, busId, length);
         
-        CANFrame* frame_p = getQueue().get();
+        // We need to change the bus id if it is the special CANserver bus id.
+        // This keeps us from needing to define 15 busses just to get access to our special one
+        if (busId == 15)
+        {
+            busId = 2;
+        }
+
+        CANFrame* frame_p = getRxSlot(busId);
         if(frame_p)
         {
             frame_p->setFrameId(frameId);
             frame_p->setExtendedFrameFormat(0);
-
-            // We need to change the bus id if it is the special CANserver bus id.
-            // This keeps us from needing to define 15 busses just to get access to our special one
-            if (busId == 15)
-            {
-                busId = 2;
-            }
             frame_p->bus = busId;
             
             frame_p->setFrameType(QCanBusFrame::DataFrame);
@@ -221,10 +222,10 @@ void CANserver::readNetworkData()
             checkTargettedFrame(*frame_p);
 
             /* enqueue frame */
-            getQueue().queue();
+            queueRxFrame();
         }
     }
-
+    endRxBatch();
 }
 
 void CANserver::heartbeatTimerSlot()
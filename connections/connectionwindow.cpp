@@ -1,6 +1,8 @@
 #include <QCanBus>
 #include <QNetworkDatagram>
 #include <QThread>
+#include <QFileDialog>
+#include <QMessageBox>
 
 #include "connectionwindow.h"
 #include "mainwindow.h"
@@ -33,7 +35,10 @@ ConnectionWindow::ConnectionWindow(QWidget *parent) :
     ui->tableConnections->setColumnWidth(1, 100);
     ui->tableConnections->setColumnWidth(2, 130);
     ui->tableConnections->setColumnWidth(3, 70);
-    ui->tableConnections->setColumnWidth(4, 200);
+    ui->tableConnections->setColumnWidth(4, 110);
+    ui->tableConnections->setColumnWidth(5, 90);
+    ui->tableConnections->setColumnWidth(6, 70);
+    ui->tableConnections->setColumnWidth(7, 90);
     QHeaderView *HorzHdr = ui->tableConnections->horizontalHeader();
     HorzHdr->setStretchLastSection(true); //causes the data column to automatically fill the tableview
 
@@ -61,6 +66,8 @@ ConnectionWindow::ConnectionWindow(QWidget *parent) :
     connect(ui->btnSaveBus, &QPushButton::clicked, this, &ConnectionWindow::saveBusSettings);
     connect(ui->btnMoveUp, &QPushButton::clicked, this, &ConnectionWindow::moveConnUp);
     connect(ui->btnMoveDown, &QPushButton::clicked, this, &ConnectionWindow::moveConnDown);
+    connect(ui->btnStatsLog, &QPushButton::clicked, this, &ConnectionWindow::handleStatsLog);
+    connect(&statsTimer, &QTimer::timeout, this, &ConnectionWindow::updateStats);
 
     ui->cbBusSpeed->addItem("33333");
     ui->cbBusSpeed->addItem("50000");
@@ -156,7 +163,8 @@ ConnectionWindow::~ConnectionWindow()
     /* delete connections */
     while(!conns.isEmpty())
     {
-        conn_p = conns.takeFirst();
+        conn_p = conns.first();
+        CANConManager::getInstance()->remove(conn_p);
         conn_p->stop();
         delete conn_p;
     }
@@ -173,12 +181,14 @@ void ConnectionWindow::showEvent(QShowEvent* event)
     readSettings();
     ui->tableConnections->selectRow(0);
     currentRowChanged(ui->tableConnections->currentIndex(), ui->tableConnections->currentIndex());
+    statsTimer.start(1000);
 }
 
 void ConnectionWindow::closeEvent(QCloseEvent *event)
 {
     Q_UNUSED(event);
     removeEventFilter(this);
+    statsTimer.stop();
     writeSettings();
 }
 
@@ -255,6 +265,7 @@ void ConnectionWindow::handleNewConn()
     int newBusSpeed;
     bool newCanFd;
     int newDataRate;
+    int newQueueLen;
     CANConnection *conn;
 
     if (thisDialog->exec() == QDialog::Accepted)
@@ -266,7 +277,8 @@ void ConnectionWindow::handleNewConn()
         newBusSpeed = thisDialog->getBusSpeed();
         newCanFd=thisDialog->isCanFd();
         newDataRate = thisDialog->getDataRate();
-        conn = create(newType, newPort, newDriver, newSerialSpeed, newBusSpeed, newCanFd, newDataRate);
+        newQueueLen = thisDialog->getQueueLength();
+        conn = create(newType, newPort, newDriver, newSerialSpeed, newBusSpeed, newCanFd, newDataRate, newQueueLen);
         if (conn)
         {
             connModel->add(conn);
@@ -341,10 +353,7 @@ void ConnectionWindow::connectionStatus(CANConStatus pStatus)
 
 void ConnectionWindow::setSuspendAll(bool pSuspend)
 {
-    QList<CANConnection*>& conns = CANConManager::getInstance()->getConnections();
-
-    foreach(CANConnection* conn_p, conns)
-        conn_p->suspend(pSuspend);
+    CANConManager::getInstance()->suspendAll(pSuspend);
 
     connModel->refresh();
 }
@@ -447,6 +456,51 @@ void ConnectionWindow::populateBusDetails(int offset)
 void ConnectionWindow::currentTabChanged(int newIdx)
 {
     populateBusDetails(newIdx);
+    updateStats();
+}
+
+void ConnectionWindow::updateStats()
+{
+    connModel->refreshStats();
+
+    CANConnection* conn_p = connModel->getAtIdx(ui->tableConnections->currentIndex().row());
+    if (!conn_p)
+    {
+        ui->lblBusStats->clear();
+        return;
+    }
+
+    CANConStats stats = conn_p->getStats(ui->tabBuses->currentIndex());
+    ui->lblBusStats->setText(tr("Received: %1   Queued: %2   Dropped (queue full): %3   Parse errors: %4\n"
+                                "Max queue depth: %5 of %6   Drain latency: %7 ms (max %8 ms)")
+                             .arg(stats.received).arg(stats.enqueued).arg(stats.dropped).arg(stats.parseErrors)
+                             .arg(stats.maxQueueDepth).arg(stats.queueCapacity)
+                             .arg(stats.lastDrainLatency / 1000.0, 0, 'f', 1).arg(stats.maxDrainLatency / 1000.0, 0, 'f', 1));
+}
+
+void ConnectionWindow::handleStatsLog()
+{
+    CANConManager *manager = CANConManager::getInstance();
+
+    if (manager->isStatsLogging())
+    {
+        manager->stopStatsLog();
+        ui->btnStatsLog->setText(tr("Start Statistics Log..."));
+        return;
+    }
+
+    QSettings settings;
+    QString filename = QFileDialog::getSaveFileName(this, tr("Save Statistics Log"), settings.value("ConnWindow/StatsLogPath", QDir::homePath()).toString(),
+                                                    tr("CSV Files (*.csv)"));
+    if (filename.isEmpty()) return;
+    if (!filename.endsWith(".csv", Qt::CaseInsensitive)) filename += ".csv";
+
+    if (manager->startStatsLog(filename, 1000))
+    {
+        settings.setValue("ConnWindow/StatsLogPath", QFileInfo(filename).absolutePath());
+        ui->btnStatsLog->setText(tr("Stop Statistics Log"));
+    }
+    else QMessageBox::warning(this, tr("Statistics Log"), tr("Could not open %1 for writing").arg(filename));
 }
 
 void ConnectionWindow::currentRowChanged(const QModelIndex &current, const QModelIndex &previous)
@@ -515,12 +569,12 @@ void ConnectionWindow::handleSendText() {
     emit sendDebugData(bytes);
 }
 
-CANConnection* ConnectionWindow::create(CANCon::type pTye, QString pPortName, QString pDriver, int pSerialSpeed, int pBusSpeed, bool pCanFd, int pDataRate)
+CANConnection* ConnectionWindow::create(CANCon::type pTye, QString pPortName, QString pDriver, int pSerialSpeed, int pBusSpeed, bool pCanFd, int pDataRate, int pQueueLen)
 {
     CANConnection* conn_p;
 
     /* create connection */
-    conn_p = CanConFactory::create(pTye, pPortName, pDriver, pSerialSpeed, pBusSpeed, pCanFd, pDataRate);
+    conn_p = CanConFactory::create(pTye, pPortName, pDriver, pSerialSpeed, pBusSpeed, pCanFd, pDataRate, pQueueLen);
     if(conn_p)
     {
         /* connect signal */
@@ -550,6 +604,7 @@ void ConnectionWindow::loadConnections()
     QVector<QString> portNames = settings.value("connections/portNames").value<QVector<QString>>();
     QVector<QString> driverNames = settings.value("connections/driverNames").value<QVector<QString>>();
     QVector<int>    devTypes = settings.value("connections/types").value<QVector<int>>();
+    QVector<int>    queueLengths = settings.value("connections/queueLengths").value<QVector<int>>();
 
     //don't load the connections if the three setting arrays above aren't all the same size.
     if (portNames.count() != driverNames.count() || devTypes.count() != driverNames.count()) return;
@@ -557,7 +612,8 @@ void ConnectionWindow::loadConnections()
     for(int i = 0 ; i < portNames.count() ; i++)
     {
         //TODO: add serial speed and bus speed to this properly.
-        CANConnection* conn_p = create((CANCon::type)devTypes[i], portNames[i], driverNames[i], 0, 0, false, 0);
+        int queueLen = (i < queueLengths.count()) ? queueLengths[i] : 0;
+        CANConnection* conn_p = create((CANCon::type)devTypes[i], portNames[i], driverNames[i], 0, 0, false, 0, queueLen);
         /* add connection to model */
         connModel->add(conn_p);
     }
@@ -577,6 +633,7 @@ void ConnectionWindow::saveConnections()
     QVector<QString> driverNames;
     QVector<int> serialSpeeds;
     QVector<int> busSpeeds;
+    QVector<int> queueLengths;
 
     /* save connections */
     foreach(CANConnection* conn_p, conns)
@@ -584,11 +641,13 @@ void ConnectionWindow::saveConnections()
         portNames.append(conn_p->getPort());
         devTypes.append(conn_p->getType());
         driverNames.append(conn_p->getDriver());
+        queueLengths.append(conn_p->getQueueLengthOverride()); //0 keeps following the driver default
     }
 
     settings.setValue("connections/portNames", QVariant::fromValue(portNames));
     settings.setValue("connections/types", QVariant::fromValue(devTypes));
     settings.setValue("connections/driverNames", QVariant::fromValue(driverNames));
+    settings.setValue("connections/queueLengths", QVariant::fromValue(queueLengths));
 }
 
 void ConnectionWindow::moveConnUp()
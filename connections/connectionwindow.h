@@ -55,6 +55,8 @@ private slots:
     void moveConnDown();
     void connectionStatus(CANConStatus);
     void readPendingDatagrams();
+    void updateStats();
+    void handleStatsLog();
 
 private:
     Ui::ConnectionWindow *ui;    
@@ -64,8 +66,9 @@ private:
     QUdpSocket *rxBroadcastKayak;
     QVector<QString> remoteDeviceIPGVRET;
     QVector<QString> remoteDeviceKayak;
+    QTimer statsTimer;
 
-    CANConnection* create(CANCon::type pTye, QString pPortName, QString pDriver, int pSerialSpeed, int pBusSpeed, bool pCanFd, int pDataRate);
+    CANConnection* create(CANCon::type pTye, QString pPortName, QString pDriver, int pSerialSpeed, int pBusSpeed, bool pCanFd, int pDataRate, int pQueueLen);
     void populateBusDetails(int offset);
     void loadConnections();
     void saveConnections();
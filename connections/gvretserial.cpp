@@ -488,9 +488,11 @@ void GVRetSerial::serialError(QSerialPort::SerialPortError err)
 #if QT_VERSION <= QT_VERSION_CHECK( 6, 0, 0 )
     case QSerialPort::ParityError:
         errMessage = "Parity error on serial port";
+        countParseError();
         break;
     case QSerialPort::FramingError:
         errMessage = "Framing error on serial port";
+        countParseError();
         break;
     case QSerialPort::BreakConditionError:
         errMessage = "Break error on serial port";
@@ -582,6 +584,7 @@ void GVRetSerial::readSerialData()
     if (udpClient) data = udpClient->readAll();
 
     sendDebug("Got data from serial. Len = " % QString::number(data.length()));
+    beginRxBatch();
     for (int i = 0; i < data.length(); i++)
     {
         c = data.at(i);
@@ -589,6 +592,7 @@ void GVRetSerial::readSerialData()
         debugBuild = debugBuild % QString::number(c, 16).rightJustified(2,'0') % " ";
         procRXChar(c);
     }
+    endRxBatch();
     debugOutput(debugBuild);
     //qDebug() << debugBuild;
 }
@@ -665,6 +669,9 @@ void GVRetSerial::procRXChar(unsigned char c)
             rx_step = 0;
             qDebug() << "Got FD settings reply";
             break;
+        default: //not a reply we know, the stream is out of sync
+            countParseError();
+            break;
         }
         break;
     case BUILD_CAN_FRAME:
@@ -726,17 +733,15 @@ void GVRetSerial::procRXChar(unsigned char c)
                     if (!isCapSuspended())
                     {
                         /* get frame from queue */
-                        CANFrame* frame_p = getQueue().get();
+                        CANFrame* frame_p = getRxSlot(buildFrame.bus);
                         if(frame_p) {
                             //qDebug() << "GVRET got frame on bus " << frame_p->bus;
                             /* copy frame */
                             *frame_p = buildFrame;
                             checkTargettedFrame(buildFrame);
                             /* enqueue frame */
-                            getQueue().queue();
+                            queueRxFrame();
                         }
-                        else
-                            qDebug() << "can't get a frame, ERROR";
 
                         //take the time the frame came in and try to resync the time base.
                         //if (continuousTimeSync) txTimestampBasis = QDateTime::currentMSecsSinceEpoch() - (buildFrame.timestamp / 1000);
@@ -814,17 +819,15 @@ void GVRetSerial::procRXChar(unsigned char c)
                 if (!isCapSuspended())
                 {
                     /* get frame from queue */
-                    CANFrame* frame_p = getQueue().get();
+                    CANFrame* frame_p = getRxSlot(buildFrame.bus);
                     if(frame_p) {
                         //qDebug() << "GVRET got frame on bus " << frame_p->bus;
                         /* copy frame */
                         *frame_p = buildFrame;
                         checkTargettedFrame(buildFrame);
                         /* enqueue frame */
-                        getQueue().queue();
+                        queueRxFrame();
                     }
-                    else
-                        qDebug() << "can't get a frame, ERROR";
 
                     //take the time the frame came in and try to resync the time base.
                     //if (continuousTimeSync) txTimestampBasis = QDateTime::currentMSecsSinceEpoch() - (buildFrame.timestamp / 1000);
@@ -390,9 +390,11 @@ void LAWICELSerial::serialError(QSerialPort::SerialPortError err)
         break;
     case QSerialPort::ParityError:
         errMessage = "Parity error on serial port";
+        countParseError();
         break;
     case QSerialPort::FramingError:
         errMessage = "Framing error on serial port";
+        countParseError();
         break;
     case QSerialPort::BreakConditionError:
         errMessage = "Break error on serial port";
@@ -480,6 +482,7 @@ void LAWICELSerial::readSerialData()
     if (serial) data = serial->readAll();
 
     sendDebug("Got data from serial. Len = " % QString::number(data.length()));
+    beginRxBatch();
     for (int i = 0; i < data.length(); i++)
     {
         c = data.at(i);
@@ -508,17 +511,15 @@ void LAWICELSerial::readSerialData()
                 if (!isCapSuspended())
                 {
                     /* get frame from queue */
-                    CANFrame* frame_p = getQueue().get();
+                    CANFrame* frame_p = getRxSlot(buildFrame.bus);
                     if(frame_p) {
                         //qDebug() << "Lawicel got frame on bus " << frame_p->bus;
                         /* copy frame */
                         *frame_p = buildFrame;
                         checkTargettedFrame(buildFrame);
                         /* enqueue frame */
-                        getQueue().queue();
+                        queueRxFrame();
                     }
-                    else
-                        qDebug() << "can't get a frame, ERROR";
                 }
                 break;
             case 'T': //extended frame
@@ -536,17 +537,15 @@ void LAWICELSerial::readSerialData()
                 if (!isCapSuspended())
                 {
                     /* get frame from queue */
-                    CANFrame* frame_p = getQueue().get();
+                    CANFrame* frame_p = getRxSlot(buildFrame.bus);
                     if(frame_p) {
                         //qDebug() << "Lawicel got frame on bus " << frame_p->bus;
                         /* copy frame */
                         *frame_p = buildFrame;
                         checkTargettedFrame(buildFrame);
                         /* enqueue frame */
-                        getQueue().queue();
+                        queueRxFrame();
                     }
-                    else
-                        qDebug() << "can't get a frame, ERROR";
                 }
                 break;
             case 'b':
@@ -567,17 +566,15 @@ void LAWICELSerial::readSerialData()
                 if (!isCapSuspended())
                 {
                     /* get frame from queue */
-                    CANFrame* frame_p = getQueue().get();
+                    CANFrame* frame_p = getRxSlot(buildFrame.bus);
                     if(frame_p) {
                         //qDebug() << "Lawicel got frame on bus " << frame_p->bus;
                         /* copy frame */
                         *frame_p = buildFrame;
                         checkTargettedFrame(buildFrame);
                         /* enqueue frame */
-                        getQueue().queue();
+                        queueRxFrame();
                     }
-                    else
-                        qDebug() << "can't get a frame, ERROR";
                 }
                 break;
             case 'B':
@@ -600,23 +597,22 @@ void LAWICELSerial::readSerialData()
                 if (!isCapSuspended())
                 {
                     /* get frame from queue */
-                    CANFrame* frame_p = getQueue().get();
+                    CANFrame* frame_p = getRxSlot(buildFrame.bus);
                     if(frame_p) {
                         //qDebug() << "Lawicel got frame on bus " << frame_p->bus;
                         /* copy frame */
                         *frame_p = buildFrame;
                         checkTargettedFrame(buildFrame);
                         /* enqueue frame */
-                        getQueue().queue();
+                        queueRxFrame();
                     }
-                    else
-                        qDebug() << "can't get a frame, ERROR";
                 }
                 break;
             }
             mBuildLine.clear();
         }
     }
+    endRxBatch();
     debugOutput(debugBuild);
     //qDebug() << debugBuild;
 }
@@ -285,7 +285,14 @@ void MQTT_BUS::clientMessageReceived(const QMQTT::Message& message)
     if(isCapSuspended())
         return;
 
-    CANFrame* frame_p = getQueue().get();
+    //8 bytes of timestamp and a flags byte come before the payload
+    if (message.payload().count() < 9)
+    {
+        countParseError();
+        return;
+    }
+
+    CANFrame* frame_p = getRxSlot(0);
     if(frame_p)
     {
         uint32_t frameID = message.topic().split("/")[1].toInt();
@@ -309,7 +316,7 @@ void MQTT_BUS::clientMessageReceived(const QMQTT::Message& message)
         checkTargettedFrame(*frame_p);
 
         /* enqueue frame */
-        getQueue().queue();
+        queueRxFrame();
     }
 }
 
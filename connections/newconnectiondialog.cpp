@@ -439,3 +439,8 @@ bool NewConnectionDialog::isCanFd()
      }
      else return 0;
  }
+
+int NewConnectionDialog::getQueueLength()
+{
+    return ui->spinQueueLen->value();
+}
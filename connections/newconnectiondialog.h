@@ -28,6 +28,7 @@ public:
     int getBusSpeed();
     bool isCanFd();
     int getDataRate();
+    int getQueueLength();
 
 public slots:
     void handleConnTypeChanged();
@@ -174,6 +174,7 @@ void SerialBusConnection::framesReceived()
         return;
 
     /* read frame */
+    beginRxBatch();
     while(true)
     {
         const QCanBusFrame recFrame = mDev_p->readFrame();
@@ -189,7 +190,7 @@ void SerialBusConnection::framesReceived()
         /* check frame */
         //if (recFrame.payload().length() <= 8) {
         if (true) {
-            CANFrame* frame_p = getQueue().get();
+            CANFrame* frame_p = getRxSlot(0);
             if(frame_p) {
                 frame_p->setPayload(recFrame.payload());
                 frame_p->bus = 0;
@@ -218,12 +219,11 @@ void SerialBusConnection::framesReceived()
                 checkTargettedFrame(*frame_p);
 
                 /* enqueue frame */
-                getQueue().queue();
+                queueRxFrame();
             }
-            else
-                qDebug() << "can't get a frame, ERROR";
         }
     }
+    endRxBatch();
 }
 
 
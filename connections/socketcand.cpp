@@ -311,7 +311,7 @@ QString SocketCANd::decodeFrames(QString data, int busNum)
     if (!isCapSuspended())
     {
         /* get frame from queue */
-        CANFrame* frame_p = getQueue().get();
+        CANFrame* frame_p = getRxSlot(buildFrame.bus);
         if(frame_p) {
             /* copy frame */
             *frame_p = buildFrame;
@@ -319,7 +319,7 @@ QString SocketCANd::decodeFrames(QString data, int busNum)
             frame_p->setFrameType(QCanBusFrame::DataFrame);
             checkTargettedFrame(buildFrame);
             /* enqueue frame */
-            getQueue().queue();
+            queueRxFrame();
         }
     }
     //else
@@ -373,7 +373,9 @@ void SocketCANd::readTCPData(int busNum)
         data = QString(socket->readAll());
     //sendDebug("Got data from TCP. Len = " % QString::number(data.length()));
     //qDebug() << "Received datagramm: " << data;
+    beginRxBatch();
     procRXData(data, busNum);
+    endRxBatch();
 }
 
 void SocketCANd::procRXData(QString data, int busNum)
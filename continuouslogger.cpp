@@ -0,0 +1,272 @@
+#include "continuouslogger.h"
+
+#include <QFileInfo>
+#include <QThread>
+#include <string.h>
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+static const char NATIVE_HEADER[] = "Time Stamp,ID,Extended,Dir,Bus,LEN,D1,D2,D3,D4,D5,D6,D7,D8\n";
+static const int OUT_BUFFER_RESERVE = 4 * 1024 * 1024;
+
+static inline char *putDecimal(char *p, uint64_t value)
+{
+    char digits[20];
+    int n = 0;
+    do
+    {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n) *p++ = digits[--n];
+    return p;
+}
+
+static inline char *putText(char *p, const char *str, int len)
+{
+    memcpy(p, str, len);
+    return p + len;
+}
+
+ContinuousLogger::ContinuousLogger()
+{
+    format = NativeCSV;
+    rotateBytes = 0;
+    rotateSeconds = 0;
+    fileBytes = 0;
+    stopping = true;
+    thread = nullptr;
+}
+
+ContinuousLogger::~ContinuousLogger()
+{
+    stop();
+}
+
+bool ContinuousLogger::start(const QString &filename, Format format, qint64 rotateBytes, int rotateSeconds)
+{
+    if (thread) return false;
+
+    baseName = filename;
+    this->format = format;
+    this->rotateBytes = rotateBytes;
+    this->rotateSeconds = rotateSeconds;
+    bytesTotal.storeRelease(0);
+    framesTotal.storeRelease(0);
+    droppedTotal.storeRelease(0);
+    backlogFrames.storeRelease(0);
+    fileCount.storeRelease(0);
+    failed.storeRelease(0);
+    outBuffer.reserve(OUT_BUFFER_RESERVE);
+
+    //the first file is opened here so a bad name is reported right away
+    if (!openFile()) return false;
+
+    //enqueue may already be getting batches on the ingest thread
+    queueLock.lock();
+    stopping = false;
+    queueLock.unlock();
+    thread = QThread::create([this]() { run(); });
+    thread->start();
+    return true;
+}
+
+void ContinuousLogger::stop()
+{
+    if (!thread) return;
+    queueLock.lock();
+    stopping = true;
+    queueReady.wakeOne();
+    queueLock.unlock();
+
+    thread->wait();
+    delete thread;
+    thread = nullptr;
+    outBuffer = QByteArray();
+}
+
+void ContinuousLogger::enqueue(const FrameBatchPtr &batch)
+{
+    if (batch->isEmpty()) return;
+
+    QMutexLocker locker(&queueLock);
+    if (stopping) return;
+    if (backlogFrames.loadAcquire() + batch->count() > MAX_BACKLOG_FRAMES)
+    {
+        droppedTotal.fetchAndAddRelaxed(batch->count());
+        return;
+    }
+    backlogFrames.fetchAndAddRelaxed(batch->count());
+    incoming.append(batch);
+    if (incoming.count() == 1) queueReady.wakeOne();
+}
+
+void ContinuousLogger::run()
+{
+    QVector<FrameBatchPtr> working;
+    QElapsedTimer sinceFlush;
+    sinceFlush.start();
+
+    bool done = false;
+    while (!done)
+    {
+        queueLock.lock();
+        if (incoming.isEmpty() && !stopping) queueReady.wait(&queueLock, FLUSH_INTERVAL_MS);
+        working.swap(incoming);
+        done = stopping;
+        queueLock.unlock();
+
+        int numFrames = 0;
+        for (const FrameBatchPtr &batch : working) numFrames += batch->count();
+        if (!working.isEmpty() && !failed.loadAcquire() && !writeBatches(working)) failed.storeRelease(1);
+        if (failed.loadAcquire()) droppedTotal.fetchAndAddRelaxed(numFrames);
+        backlogFrames.fetchAndAddRelaxed(-numFrames);
+        working.clear(); //FrameBatch::inFlight() counts them until every consumer lets go
+
+        if (sinceFlush.elapsed() >= FLUSH_INTERVAL_MS && !failed.loadAcquire())
+        {
+            if (format == Capture)
+            {
+                qint64 before = captureFile.bytesWritten();
+                if (!captureFile.flush()) failed.storeRelease(1);
+                bytesTotal.fetchAndAddRelaxed(captureFile.bytesWritten() - before);
+                fileBytes = captureFile.bytesWritten();
+            }
+            else if (!textFile.flush()) failed.storeRelease(1);
+            sinceFlush.restart();
+        }
+    }
+    closeFile();
+}
+
+bool ContinuousLogger::writeBatches(const QVector<FrameBatchPtr> &batches)
+{
+    auto writeOut = [this]()
+    {
+        if (outBuffer.isEmpty()) return true;
+        bool ok = textFile.write(outBuffer) == outBuffer.size();
+        outBuffer.resize(0);
+        return ok;
+    };
+
+    for (const FrameBatchPtr &batch : batches)
+    {
+        bool rotate = (rotateBytes > 0 && fileBytes >= rotateBytes)
+                || (rotateSeconds > 0 && fileAge.elapsed() >= rotateSeconds * 1000LL);
+        if (rotate)
+        {
+            if (format == NativeCSV && !writeOut()) return false;
+            closeFile();
+            if (!openFile()) return false;
+        }
+
+        int count = batch->count();
+        if (format == Capture)
+        {
+            qint64 before = captureFile.bytesWritten();
+            for (int i = 0; i < count; i++)
+            {
+                if (!captureFile.append(batch->view(i).toFrameData())) return false;
+            }
+            fileBytes = captureFile.bytesWritten();
+            bytesTotal.fetchAndAddRelaxed(fileBytes - before);
+        }
+        else
+        {
+            int base = outBuffer.size();
+            outBuffer.resize(base + count * MAX_LINE_BYTES);
+            char *start = outBuffer.data() + base;
+            char *p = start;
+            for (int i = 0; i < count; i++) p += formatNative(batch->view(i), p);
+            outBuffer.resize(base + static_cast<int>(p - start));
+            fileBytes += p - start;
+            bytesTotal.fetchAndAddRelaxed(p - start);
+        }
+        framesTotal.fetchAndAddRelaxed(count);
+    }
+    return format == Capture || writeOut();
+}
+
+bool ContinuousLogger::openFile()
+{
+    currentName = rotatedName(baseName, fileCount.loadAcquire());
+    fileBytes = 0;
+    fileAge.start();
+
+    if (format == Capture)
+    {
+        if (!captureFile.open(currentName)) return false;
+        fileBytes = captureFile.bytesWritten();
+    }
+    else
+    {
+        textFile.setFileName(currentName);
+        if (!textFile.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+        fileBytes = sizeof(NATIVE_HEADER) - 1;
+        if (textFile.write(NATIVE_HEADER, fileBytes) != fileBytes) return false;
+    }
+    bytesTotal.fetchAndAddRelaxed(fileBytes);
+    fileCount.fetchAndAddRelaxed(1);
+    return true;
+}
+
+void ContinuousLogger::closeFile()
+{
+    if (captureFile.isOpen())
+    {
+        //the block still being filled and the index go out on close
+        qint64 before = captureFile.bytesWritten();
+        if (!captureFile.close()) failed.storeRelease(1);
+        bytesTotal.fetchAndAddRelaxed(qMax<qint64>(0, QFileInfo(currentName).size() - before));
+    }
+    if (textFile.isOpen()) textFile.close();
+}
+
+//Same line as the old QString based writer down to the padding: the first 8 data bytes only, missing
+//ones as 00, and 0 for the ID of error frames like QCanBusFrame::frameId() returns
+int ContinuousLogger::formatNative(const CANFrameView &frame, char *out)
+{
+    char *p = out;
+    int64_t stamp = frame.timestamp();
+    if (stamp < 0)
+    {
+        *p++ = '-';
+        p = putDecimal(p, static_cast<uint64_t>(-(stamp + 1)) + 1);
+    }
+    else p = putDecimal(p, static_cast<uint64_t>(stamp));
+    *p++ = ',';
+
+    uint32_t id = frame.frameId();
+    for (int shift = 28; shift >= 0; shift -= 4) *p++ = HEX_DIGITS[(id >> shift) & 0xF];
+    *p++ = ',';
+
+    if (frame.hasExtendedFrameFormat()) p = putText(p, "true,", 5);
+    else p = putText(p, "false,", 6);
+    if (frame.isReceived()) p = putText(p, "Rx,", 3);
+    else p = putText(p, "Tx,", 3);
+
+    p = putDecimal(p, static_cast<uint64_t>(frame.bus()));
+    *p++ = ',';
+    int dataLen = frame.length();
+    p = putDecimal(p, static_cast<uint64_t>(dataLen));
+    *p++ = ',';
+
+    const uint8_t *data = frame.data();
+    for (int i = 0; i < 8; i++)
+    {
+        uint8_t byte = (i < dataLen) ? data[i] : 0;
+        *p++ = HEX_DIGITS[byte >> 4];
+        *p++ = HEX_DIGITS[byte & 0xF];
+        *p++ = ',';
+    }
+    *p++ = '\n';
+    return static_cast<int>(p - out);
+}
+
+QString ContinuousLogger::rotatedName(const QString &filename, int fileNumber)
+{
+    if (fileNumber == 0) return filename;
+    QFileInfo info(filename);
+    QString name = info.path() + "/" + info.completeBaseName() + QString("_%1").arg(fileNumber, 3, 10, QChar('0'));
+    if (!info.suffix().isEmpty()) name += "." + info.suffix();
+    return name;
+}
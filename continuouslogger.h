@@ -0,0 +1,101 @@
+#ifndef CONTINUOUSLOGGER_H
+#define CONTINUOUSLOGGER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include <memory>
+#include "framebatch.h"
+#include "capturefile.h"
+
+class QThread;
+
+/*
+ * Writes every frame that comes in to disk for as long as it runs (File > Start Continuous Logging).
+ * enqueue is connected straight to CANConManager::framesReceived so it runs on the ingest thread. All it
+ * does is keep a reference to the shared batch in the incoming list, it never formats, writes or waits on
+ * the logger. The logger thread swaps the incoming list for its own empty one (so the two sides never
+ * work on the same list) and turns the batches into file contents in one buffer that's written in a
+ * single call. GVRET CSV lines are put together by hand straight into that buffer.
+ *
+ * If the disk can't keep up the batches pile up in the incoming list. Past MAX_BACKLOG_FRAMES new ones
+ * are dropped and counted instead, which is the only way logging ever gives way to capturing.
+ */
+class ContinuousLogger
+{
+public:
+    enum Format
+    {
+        NativeCSV, //GVRET CSV, the classic continuous log
+        Capture    //SavvyCAN capture (.sccap), binary and compressed
+    };
+
+    static const int MAX_BACKLOG_FRAMES = 4 * 1024 * 1024;
+    static const int FLUSH_INTERVAL_MS = 2000; //what's lost at most if SavvyCAN or the computer dies
+    static const int MAX_LINE_BYTES = 96; //longest GVRET CSV line formatNative can produce
+
+    ContinuousLogger();
+    ~ContinuousLogger();
+
+    //Opens filename and starts the logger thread. A new file is started once the current one has
+    //rotateBytes in it or was opened rotateSeconds ago, 0 turns either off. Rotated files get _001,
+    //_002 and so on in front of the extension.
+    bool start(const QString &filename, Format format, qint64 rotateBytes = 0, int rotateSeconds = 0);
+    //writes out what's still queued, closes the file and waits for the thread
+    void stop();
+    bool isRunning() const { return thread != nullptr; }
+
+    //any thread, doesn't block on the logger
+    void enqueue(const FrameBatchPtr &batch);
+
+    qint64 bytesWritten() const { return bytesTotal.loadAcquire(); } //over all the files
+    qint64 framesWritten() const { return framesTotal.loadAcquire(); }
+    qint64 framesDropped() const { return droppedTotal.loadAcquire(); }
+    int backlog() const { return backlogFrames.loadAcquire(); } //frames queued but not written yet
+    int filesStarted() const { return fileCount.loadAcquire(); }
+    bool hasFailed() const { return failed.loadAcquire(); } //couldn't write, the thread stopped logging
+
+    //One GVRET CSV line, the same the "native" save writes. out needs MAX_LINE_BYTES, returns the length.
+    static int formatNative(const CANFrameView &frame, char *out);
+    static QString rotatedName(const QString &filename, int fileNumber);
+
+private:
+    void run();
+    bool openFile();
+    void closeFile();
+    bool writeBatches(const QVector<FrameBatchPtr> &batches);
+
+    QString baseName;
+    QString currentName;
+    Format format;
+    qint64 rotateBytes;
+    int rotateSeconds;
+
+    //touched only by the logger thread once it runs
+    QFile textFile;
+    CaptureFileWriter captureFile;
+    QByteArray outBuffer;
+    qint64 fileBytes; //in the current file
+    QElapsedTimer fileAge;
+
+    QMutex queueLock;
+    QWaitCondition queueReady;
+    QVector<FrameBatchPtr> incoming;
+    bool stopping;
+
+    QThread *thread;
+    QAtomicInteger<qint64> bytesTotal;
+    QAtomicInteger<qint64> framesTotal;
+    QAtomicInteger<qint64> droppedTotal;
+    QAtomicInt backlogFrames;
+    QAtomicInt fileCount;
+    QAtomicInt failed;
+
+    Q_DISABLE_COPY(ContinuousLogger)
+};
+
+#endif // CONTINUOUSLOGGER_H
@@ -2,6 +2,10 @@
 #include "dbchandler.h"
 #include "utility.h"
 #include <QtMath>
+#include <QMutex>
+
+//children with more values than this between low and high aren't expanded into the multiplex table
+static const int MAX_EXPANDED_MUX_VALUES = 256;
 
 DBC_MESSAGE::DBC_MESSAGE()
 {
@@ -10,6 +14,100 @@ DBC_MESSAGE::DBC_MESSAGE()
     len = 0;
     multiplexorSignal = nullptr;
     sender = nullptr;
+    muxTableLock = std::make_shared<QMutex>();
+}
+
+std::shared_ptr<const DBC_MULTIPLEX_TABLE> DBC_MESSAGE::multiplexTable() const
+{
+    int revision = DBCMessageHandler::revision();
+    std::shared_ptr<const DBC_MULTIPLEX_TABLE> table = std::atomic_load_explicit(&muxTable, std::memory_order_acquire);
+    if (table && table->revision() == revision) return table;
+
+    QMutexLocker lock(muxTableLock.get());
+    //another thread may have rebuilt it while this one waited
+    table = std::atomic_load_explicit(&muxTable, std::memory_order_acquire);
+    if (table && table->revision() == revision) return table;
+
+    std::shared_ptr<DBC_MULTIPLEX_TABLE> rebuilt = std::make_shared<DBC_MULTIPLEX_TABLE>();
+    rebuilt->build(sigHandler, revision);
+    table = rebuilt;
+    std::atomic_store_explicit(&muxTable, table, std::memory_order_release);
+    return table;
+}
+
+QVector<const DBC_SIGNAL *> DBC_MESSAGE::activeSignals(const CANFrame &frame) const
+{
+    const QByteArray payload = frame.payload();
+    return activeSignals(reinterpret_cast<const uint8_t *>(payload.constData()), payload.length());
+}
+
+QVector<const DBC_SIGNAL *> DBC_MESSAGE::activeSignals(const uint8_t *data, int len) const
+{
+    QVector<const DBC_SIGNAL *> out;
+    std::shared_ptr<const DBC_MULTIPLEX_TABLE> table = multiplexTable();
+    for (int i = 0; i < sigHandler->getCount(); i++)
+    {
+        const DBC_SIGNAL *sig = sigHandler->findSignalByIdx(i);
+        if (sig->multiplexParent != nullptr) continue; //comes in below its multiplexor if it's in the frame at all
+        out.append(sig);
+        if (sig->isMultiplexor) appendActiveChildren(*table, sig, data, len, out);
+    }
+    return out;
+}
+
+void DBC_MESSAGE::appendActiveChildren(const DBC_MULTIPLEX_TABLE &table, const DBC_SIGNAL *multiplexor, const uint8_t *data,
+                                       int len, QVector<const DBC_SIGNAL *> &out) const
+{
+    int val;
+    if (!multiplexor->processAsInt(data, len, val)) return;
+    foreach (const DBC_SIGNAL *sig, table.activeChildren(multiplexor, val))
+    {
+        out.append(sig);
+        if (sig->isMultiplexor) appendActiveChildren(table, sig, data, len, out);
+    }
+}
+
+void DBC_MULTIPLEX_TABLE::build(DBCSignalHandler *sigHandler, int revision)
+{
+    levels.clear();
+    builtRevision = revision;
+    for (int i = 0; i < sigHandler->getCount(); i++)
+    {
+        const DBC_SIGNAL *mux = sigHandler->findSignalByIdx(i);
+        if (mux->multiplexedChildren.isEmpty()) continue;
+
+        Level level;
+        level.hasWideRanges = false;
+        foreach (const DBC_SIGNAL *child, mux->multiplexedChildren)
+        {
+            level.children.append(child);
+            qint64 span = static_cast<qint64>(child->multiplexHighValue) - child->multiplexLowValue;
+            if (span >= MAX_EXPANDED_MUX_VALUES)
+            {
+                level.hasWideRanges = true;
+                continue;
+            }
+            for (qint64 val = child->multiplexLowValue; val <= child->multiplexHighValue; val++)
+            {
+                level.byValue[static_cast<int>(val)].append(child);
+            }
+        }
+        levels.insert(mux, level);
+    }
+}
+
+QVector<const DBC_SIGNAL *> DBC_MULTIPLEX_TABLE::activeChildren(const DBC_SIGNAL *multiplexor, int value) const
+{
+    QHash<const DBC_SIGNAL *, Level>::const_iterator it = levels.constFind(multiplexor);
+    if (it == levels.constEnd()) return QVector<const DBC_SIGNAL *>();
+    if (!it->hasWideRanges) return it->byValue.value(value);
+
+    QVector<const DBC_SIGNAL *> active;
+    foreach (const DBC_SIGNAL *sig, it->children)
+    {
+        if ( (value >= sig->multiplexLowValue) && (value <= sig->multiplexHighValue) ) active.append(sig);
+    }
+    return active;
 }
 
 DBC_SIGNAL::DBC_SIGNAL()
@@ -31,17 +129,53 @@ DBC_SIGNAL::DBC_SIGNAL()
     valType = DBC_SIG_VAL_TYPE::UNSIGNED_INT;
 }
 
-bool DBC_SIGNAL::isSignalInMessage(const CANFrame &frame)
+//Builds the extractor for the signal's current layout. The DBC loader does this for every signal and
+//the signal editor whenever it changes one.
+void DBC_SIGNAL::compile()
+{
+    extractor.compile(startBit, rawSize(), intelByteOrder, valType == SIGNED_INT);
+}
+
+int DBC_SIGNAL::rawSize() const
+{
+    if (valType == SP_FLOAT) return 32;
+    if (valType == DP_FLOAT) return 64;
+    return signalSize;
+}
+
+//The raw integer bits of the signal. Floating point signals come back as their 32 or 64 bit pattern.
+//If the signal was changed since it was last compiled a throwaway extractor is used, the shared one is
+//never modified from here so any number of threads can decode at once.
+int64_t DBC_SIGNAL::extractRaw(const uint8_t *data, int len) const
+{
+    int size = rawSize();
+    if (extractor.matches(startBit, size, intelByteOrder, valType == SIGNED_INT)) return extractor.extract(data, len);
+    return SignalExtractor(startBit, size, intelByteOrder, valType == SIGNED_INT).extract(data, len);
+}
+
+int64_t DBC_SIGNAL::extractRaw(const QByteArray &payload) const
+{
+    return extractRaw(reinterpret_cast<const uint8_t *>(payload.constData()), payload.length());
+}
+
+bool DBC_SIGNAL::isSignalInMessage(const CANFrame &frame) const
+{
+    const QByteArray payload = frame.payload();
+    return isSignalInPayload(reinterpret_cast<const uint8_t *>(payload.constData()), payload.length());
+}
+
+//Same thing for raw payload bytes, lets bulk decoding check multiplexing without building CANFrames
+bool DBC_SIGNAL::isSignalInPayload(const uint8_t *data, int len) const
 {
     if (isMultiplexor && !isMultiplexed) return true; //the root multiplexor is always in the message.
     if (isMultiplexed)
     {
         if (parentMessage->multiplexorSignal != nullptr)
         {
-            if (multiplexParent->isSignalInMessage(frame)) //parent is in message so check if value is correct
+            if (multiplexParent->isSignalInPayload(data, len)) //parent is in message so check if value is correct
             {
                 int val;
-                if (!multiplexParent->processAsInt(frame, val)) return false;
+                if (!multiplexParent->processAsInt(data, len, val)) return false;
                 if ((val >= multiplexLowValue) && (val <= multiplexHighValue))
                 {
                     return true;
@@ -56,37 +190,40 @@ bool DBC_SIGNAL::isSignalInMessage(const CANFrame &frame)
 }
 
 //Take all the children of this signal and see if they exist in the message. Can be called recursively to descend the dependency tree
-QString DBC_SIGNAL::processSignalTree(const CANFrame &frame)
+//If a state cache is passed every signal that gets decoded along the way is recorded in it.
+QString DBC_SIGNAL::processSignalTree(const CANFrame &frame, SignalStateCache *cache) const
 {
     QString build;
     int val;
-    if (!this->processAsInt(frame, val))
+    if (!this->processAsInt(frame, val)) return build;
+
+    //the message's multiplex table says straight away which children this value selects
+    QVector<const DBC_SIGNAL *> active;
+    if (parentMessage) active = parentMessage->multiplexTable()->activeChildren(this, val);
+    else
     {
-        qDebug() << "Could not process multiplexor as an integer.";
-        return build;
+        foreach (const DBC_SIGNAL *sig, multiplexedChildren)
+        {
+            if ( (val >= sig->multiplexLowValue) && (val <= sig->multiplexHighValue) ) active.append(sig);
+        }
     }
-    qDebug() << val;
 
-    foreach (DBC_SIGNAL *sig, multiplexedChildren)
+    foreach (const DBC_SIGNAL *sig, active)
     {
-        if ( (val >= sig->multiplexLowValue) && (val <= sig->multiplexHighValue) )
+        DBC_SIGNAL_VALUE sigValue;
+        if (sig->decode(frame, sigValue))
         {
-            qDebug() << "Found match for multiplex value range - " << sig->name;
-            QString sigString;
-            if (sig->processAsText(frame, sigString))
+            QString sigString = sig->formatValue(sigValue);
+            if (cache) cache->update(sig, sigValue);
+            if (!build.isEmpty() && !sigString.isEmpty())
+                build.append("\n");
+            build.append(sigString);
+            if (sig->isMultiplexor)
             {
-                qDebug() << "Returned value: " << sigString;
-                if (!build.isEmpty() && !sigString.isEmpty())
+                auto subTreeString = sig->processSignalTree(frame, cache);
+                if (!build.isEmpty() && !subTreeString.isEmpty())
                     build.append("\n");
-                build.append(sigString);
-                if (sig->isMultiplexor)
-                {
-                    qDebug() << "Spelunkin!";
-                    auto subTreeString = sig->processSignalTree(frame);
-                    if (!build.isEmpty() && !subTreeString.isEmpty())
-                        build.append("\n");
-                    build.append(subTreeString);
-                }
+                build.append(subTreeString);
             }
         }
     }
@@ -122,34 +259,31 @@ s 5   47 46 45 44 43 42 41 40
   So, the bits are 12, 11, 10, 9, 8, 23, 22, 21. Yes, that's confusing. They now go in reverse value order too.
   Bit 12 is worth 128, 11 is worth 64, etc until bit 21 is worth 1.
 */
-bool DBC_SIGNAL::processAsText(const CANFrame &frame, QString &outString, bool outputName, bool outputUnit)
+bool DBC_SIGNAL::decode(const CANFrame &frame, DBC_SIGNAL_VALUE &out) const
 {
-    int64_t result = 0;
-    bool isSigned = false;
-    bool isInteger = false;
-    double endResult;
+    out.isInteger = false;
+    out.intValue = 0;
+    out.value = 0.0;
+    out.text.clear();
 
     //if (!isSignalInMessage(frame)) return false;
 
+    const QByteArray payload = frame.payload();
+
     if (valType == STRING)
     {
-        QString buildString;
         int startByte = startBit / 8;
         int bytes = signalSize / 8;
-        for (int x = 0; x < bytes; x++) buildString.append(frame.payload().data()[startByte + x]);
-        outString = buildString;
-        cachedValue = outString;
+        for (int x = 0; x < bytes && (startByte + x) < payload.length(); x++) out.text.append(payload.at(startByte + x));
         return true;
     }
 
-    if (valType == SIGNED_INT) isSigned = true;
     if (valType == SIGNED_INT || valType == UNSIGNED_INT)
     {
-        result = Utility::processIntegerSignal(frame.payload(), startBit, signalSize, intelByteOrder, isSigned);
-        endResult = ((double)result * factor) + bias;
-        result = (int64_t)endResult;
+        out.value = ((double)extractRaw(payload) * factor) + bias;
+        out.intValue = (int64_t)out.value;
         // if factor is an integer, we don't need the possibly human-unreadable float representation
-        isInteger = (factor == qFloor(factor));
+        out.isInteger = (factor == qFloor(factor));
     }
     else if (valType == SP_FLOAT)
     {
@@ -158,28 +292,35 @@ bool DBC_SIGNAL::processAsText(const CANFrame &frame, QString &outString, bool o
         //that the bytes that make up the integer are instead treated as having made up
         //a 32 bit single precision float. That's evil incarnate but it is very fast and small
         //in terms of new code.
-        result = Utility::processIntegerSignal(frame.payload(), startBit, 32, intelByteOrder, false);
-        endResult = (*((float *)(&result)) * factor) + bias; //look away! This is awful. I don't even know for sure if it works. Should test that.
+        out.intValue = extractRaw(payload);
+        out.value = (*((float *)(&out.intValue)) * factor) + bias; //look away! This is awful. I don't even know for sure if it works. Should test that.
     }
     else //double precision float
     {
-        if ( frame.payload().length() < 8 )
-        {
-            result = 0;
-            return false;
-        }
+        if ( payload.length() < 8 ) return false;
         //like the above, this is rotten and evil and wrong in so many ways. Force
         //calculation of a 64 bit integer and then cast it into a double.
-        result = Utility::processIntegerSignal(frame.payload(), startBit, 64, intelByteOrder, false);
-        endResult = (*((double *)(&result)) * factor) + bias;
+        out.intValue = extractRaw(payload);
+        out.value = (*((double *)(&out.intValue)) * factor) + bias;
     }
+    return true;
+}
+
+QString DBC_SIGNAL::formatValue(const DBC_SIGNAL_VALUE &val, bool outputName, bool outputUnit) const
+{
+    if (valType == STRING) return val.text;
+    return makePrettyOutput(val.value, val.intValue, outputName, val.isInteger, outputUnit);
+}
 
-    outString = makePrettyOutput(endResult, result, outputName, isInteger, outputUnit);
-    cachedValue = endResult;
+bool DBC_SIGNAL::processAsText(const CANFrame &frame, QString &outString, bool outputName, bool outputUnit) const
+{
+    DBC_SIGNAL_VALUE val;
+    if (!decode(frame, val)) return false;
+    outString = formatValue(val, outputName, outputUnit);
     return true;
 }
 
-bool DBC_SIGNAL::getValueString(int64_t intVal, QString &outString)
+bool DBC_SIGNAL::getValueString(int64_t intVal, QString &outString) const
 {
     if (valList.count() > 0) //if this is a value list type then look it up and display the proper string
     {
@@ -195,7 +336,7 @@ bool DBC_SIGNAL::getValueString(int64_t intVal, QString &outString)
     return false;
 }
 
-QString DBC_SIGNAL::makePrettyOutput(double floatVal, int64_t intVal, bool outputName, bool isInteger, bool outputUnit)
+QString DBC_SIGNAL::makePrettyOutput(double floatVal, int64_t intVal, bool outputName, bool isInteger, bool outputUnit) const
 {
     QString outputString;
 
@@ -230,10 +371,15 @@ QString DBC_SIGNAL::makePrettyOutput(double floatVal, int64_t intVal, bool outpu
 //as this basically assumes the signal is an integer.
 //The call syntax is different from the more generic processSignal. Instead of returning the value we return
 //true or false to show whether the function succeeded. The variable to fill out is passed by reference.
-bool DBC_SIGNAL::processAsInt(const CANFrame &frame, int32_t &outValue)
+bool DBC_SIGNAL::processAsInt(const CANFrame &frame, int32_t &outValue) const
+{
+    const QByteArray payload = frame.payload();
+    return processAsInt(reinterpret_cast<const uint8_t *>(payload.constData()), payload.length(), outValue);
+}
+
+bool DBC_SIGNAL::processAsInt(const uint8_t *data, int len, int32_t &outValue) const
 {
     int32_t result = 0;
-    bool isSigned = false;
 
     if (valType == STRING || valType == SP_FLOAT  || valType == DP_FLOAT)
     {
@@ -242,18 +388,16 @@ bool DBC_SIGNAL::processAsInt(const CANFrame &frame, int32_t &outValue)
 
     //if (!isSignalInMessage(frame)) return false;
 
-    if (valType == SIGNED_INT) isSigned = true;
     /*if ( static_cast<int>(frame.payload().length() * 8) <= (startBit + signalSize) )
     {
         result = 0;
         return false;
     }*/
 
-    result = static_cast<int32_t>(Utility::processIntegerSignal(frame.payload(), startBit, signalSize, intelByteOrder, isSigned));
+    result = static_cast<int32_t>(extractRaw(data, len));
 
     double endResult = (result * factor) + bias;
     result = static_cast<int32_t>(endResult);
-    cachedValue = result;
     outValue = result;
     return true;
 }
@@ -262,10 +406,9 @@ bool DBC_SIGNAL::processAsInt(const CANFrame &frame, int32_t &outValue)
 //except STRING. Useful for when you know you'll need floating point data and don't want to incur a conversion
 //back and forth to double or float. Such a use is the graphing window.
 //Similar syntax to processSignalInt but with double instead.
-bool DBC_SIGNAL::processAsDouble(const CANFrame &frame, double &outValue)
+bool DBC_SIGNAL::processAsDouble(const CANFrame &frame, double &outValue) const
 {
     int64_t result = 0;
-    bool isSigned = false;
     double endResult;
 
     if (valType == STRING)
@@ -275,7 +418,6 @@ bool DBC_SIGNAL::processAsDouble(const CANFrame &frame, double &outValue)
 
     //if (!isSignalInMessage(frame)) return false;
 
-    if (valType == SIGNED_INT) isSigned = true;
     if (valType == SIGNED_INT || valType == UNSIGNED_INT)
     {
         if ( frame.payload().length() * 8 < (startBit+signalSize) )
@@ -283,7 +425,7 @@ bool DBC_SIGNAL::processAsDouble(const CANFrame &frame, double &outValue)
             result = 0;
             return false;
         }
-        result = Utility::processIntegerSignal(frame.payload(), startBit, signalSize, intelByteOrder, isSigned);
+        result = extractRaw(frame.payload());
         endResult = ((double)result * factor) + bias;
         result = (int64_t)endResult;
     }
@@ -300,7 +442,7 @@ bool DBC_SIGNAL::processAsDouble(const CANFrame &frame, double &outValue)
         //that the bytes that make up the integer are instead treated as having made up
         //a 32 bit single precision float. That's evil incarnate but it is very fast and small
         //in terms of new code.
-        result = Utility::processIntegerSignal(frame.payload(), startBit, 32, false, false);
+        result = extractRaw(frame.payload());
         endResult = (*((float *)(&result)) * factor) + bias;
     }
     else //double precision float
@@ -312,10 +454,9 @@ bool DBC_SIGNAL::processAsDouble(const CANFrame &frame, double &outValue)
         }
         //like the above, this is rotten and evil and wrong in so many ways. Force
         //calculation of a 64 bit integer and then cast it into a double.
-        result = Utility::processIntegerSignal(frame.payload(), startBit, 64, false, false);
+        result = extractRaw(frame.payload());
         endResult = (*((double *)(&result)) * factor) + bias;
     }
-    cachedValue = endResult;
     outValue = endResult;
     return true;
 }
@@ -5,7 +5,11 @@
 #include <QString>
 #include <QStringList>
 #include <QVariant>
+#include <QHash>
+#include <QVector>
+#include <memory>
 #include "can_structs.h"
+#include "utils/signalextractor.h"
 
 /*classes to encapsulate data from a DBC file. Really, the stuff of interest
   are the nodes, messages, signals, attributes, and comments.
@@ -85,6 +89,19 @@ public:
 
 class DBC_MESSAGE; //forward reference so that DBC_SIGNAL can compile before we get to real definition of DBC_MESSAGE
 class DBC_SIGNAL;
+class SignalStateCache;
+
+//One decoded signal value. value is the scaled result, intValue is that truncated to an integer except
+//for float signals where it holds the raw bit pattern (that's what value tables get looked up with).
+//STRING signals only fill in text.
+class DBC_SIGNAL_VALUE
+{
+public:
+    double value;
+    int64_t intValue;
+    bool isInteger; //factor is a whole number so intValue is the nicer thing to show
+    QString text;
+};
 
 class DBC_SIGNAL
 {
@@ -106,32 +123,88 @@ public: //TODO: this is sloppy. It shouldn't all be public!
     DBC_MESSAGE *parentMessage;
     QString unitName;
     QString comment;
-    QVariant cachedValue;
     QList<DBC_ATTRIBUTE_VALUE> attributes;
     QList<DBC_VAL_ENUM_ENTRY> valList;
     QList<DBC_SIGNAL *> multiplexedChildren;
     DBC_SIGNAL *multiplexParent;
     DBC_SIGNAL *self;
+    SignalExtractor extractor;
 
     DBC_SIGNAL();
-    bool processAsText(const CANFrame &frame, QString &outString, bool outputName = true, bool outputUnit = true);
-    bool processAsInt(const CANFrame &frame, int32_t &outValue);
-    bool processAsDouble(const CANFrame &frame, double &outValue);
-    bool getValueString(int64_t intVal, QString &outString);
-    QString makePrettyOutput(double floatVal, int64_t intVal, bool outputName = true, bool isInteger = false, bool outputUnit = true);
-    QString processSignalTree(const CANFrame &frame);
+    void compile();
+
+    //Decoding only ever reads the signal definition. Nothing is remembered between calls so several
+    //threads can decode with the same signal. Use a SignalStateCache to keep last values around.
+    int64_t extractRaw(const QByteArray &payload) const;
+    int64_t extractRaw(const uint8_t *data, int len) const;
+    bool decode(const CANFrame &frame, DBC_SIGNAL_VALUE &out) const;
+    QString formatValue(const DBC_SIGNAL_VALUE &val, bool outputName = true, bool outputUnit = true) const;
+    bool processAsText(const CANFrame &frame, QString &outString, bool outputName = true, bool outputUnit = true) const;
+    bool processAsInt(const CANFrame &frame, int32_t &outValue) const;
+    bool processAsInt(const uint8_t *data, int len, int32_t &outValue) const;
+    bool processAsDouble(const CANFrame &frame, double &outValue) const;
+    bool getValueString(int64_t intVal, QString &outString) const;
+    QString makePrettyOutput(double floatVal, int64_t intVal, bool outputName = true, bool isInteger = false, bool outputUnit = true) const;
+    QString processSignalTree(const CANFrame &frame, SignalStateCache *cache = nullptr) const;
     DBC_ATTRIBUTE_VALUE *findAttrValByName(QString name);
     DBC_ATTRIBUTE_VALUE *findAttrValByIdx(int idx);
-    bool isSignalInMessage(const CANFrame &frame);
+    bool isSignalInMessage(const CANFrame &frame) const;
+    bool isSignalInPayload(const uint8_t *data, int len) const;
 
     friend bool operator<(const DBC_SIGNAL& l, const DBC_SIGNAL& r)
     {
         return (l.name.toLower() < r.name.toLower());
     }
+
+private:
+    int rawSize() const;
 };
 
+//Last value each signal decoded to, as far as one consumer is concerned. Every window (or thread) that
+//wants to show something like "the last value this multiplexed signal had" keeps its own.
+class SignalStateCache
+{
+public:
+    void update(const DBC_SIGNAL *sig, const DBC_SIGNAL_VALUE &val) { values.insert(sig, val); }
+    bool lastValue(const DBC_SIGNAL *sig, DBC_SIGNAL_VALUE &val) const
+    {
+        QHash<const DBC_SIGNAL *, DBC_SIGNAL_VALUE>::const_iterator it = values.constFind(sig);
+        if (it == values.constEnd()) return false;
+        val = it.value();
+        return true;
+    }
+    void clear() { values.clear(); }
+
+private:
+    QHash<const DBC_SIGNAL *, DBC_SIGNAL_VALUE> values;
+};
+
+class QMutex;
 class DBCSignalHandler; //forward declaration to keep from having to include dbchandler.h in this file and thus create a loop
 
+//Compiled form of a message's multiplexing. For every signal with multiplexed children it maps each
+//multiplexor value to the children that are in the frame at that value, in multiplexedChildren order,
+//so finding them is one hash lookup instead of testing every child's range. Children with huge value
+//ranges aren't expanded, a multiplexor that has any of those falls back to checking its children in turn.
+class DBC_MULTIPLEX_TABLE
+{
+public:
+    void build(DBCSignalHandler *sigHandler, int revision);
+    QVector<const DBC_SIGNAL *> activeChildren(const DBC_SIGNAL *multiplexor, int value) const;
+    int revision() const { return builtRevision; } //DBCMessageHandler::revision() it was built at
+
+private:
+    class Level
+    {
+    public:
+        QHash<int, QVector<const DBC_SIGNAL *>> byValue;
+        QVector<const DBC_SIGNAL *> children;
+        bool hasWideRanges;
+    };
+    QHash<const DBC_SIGNAL *, Level> levels;
+    int builtRevision = -1;
+};
+
 class DBC_MESSAGE
 {
 public:
@@ -152,10 +225,27 @@ public:
     DBC_ATTRIBUTE_VALUE *findAttrValByName(QString name);
     DBC_ATTRIBUTE_VALUE *findAttrValByIdx(int idx);
 
+    //Signals that are really in this frame: everything that isn't multiplexed and, level by level, the
+    //children the multiplexor values in the frame select. Same order processSignalTree shows them in.
+    QVector<const DBC_SIGNAL *> activeSignals(const CANFrame &frame) const;
+    QVector<const DBC_SIGNAL *> activeSignals(const uint8_t *data, int len) const;
+    //Rebuilt on first use after any DBC changed (see DBCMessageHandler::revision). Never changes once
+    //handed out, a rebuild publishes a new table so hold on to the pointer while using it.
+    std::shared_ptr<const DBC_MULTIPLEX_TABLE> multiplexTable() const;
+
     friend bool operator<(const DBC_MESSAGE& l, const DBC_MESSAGE& r)
     {
         return (l.name.toLower() < r.name.toLower());
     }
+
+private:
+    void appendActiveChildren(const DBC_MULTIPLEX_TABLE &table, const DBC_SIGNAL *multiplexor, const uint8_t *data,
+                              int len, QVector<const DBC_SIGNAL *> &out) const;
+
+    //read with std::atomic_load so decoding threads never wait. Copies of a message share the signal
+    //handler so they share the table and the lock only a rebuild takes too.
+    mutable std::shared_ptr<const DBC_MULTIPLEX_TABLE> muxTable;
+    std::shared_ptr<QMutex> muxTableLock;
 };
 
 
@@ -0,0 +1,276 @@
+#include "dbccache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include "dbchandler.h"
+
+static const quint32 CACHE_MAGIC = 0x53434442; //"SCDB"
+static const quint32 CACHE_VERSION = 1; //bump whenever the layout below or what loadFile produces changes
+
+static void writeAttrVals(QDataStream &out, const QList<DBC_ATTRIBUTE_VALUE> &vals)
+{
+    out << vals.count();
+    foreach (const DBC_ATTRIBUTE_VALUE &val, vals) out << val.attrName << val.value;
+}
+
+//counts can't be more than the bytes that are left, anything else means the snapshot is damaged
+static bool readCount(QDataStream &in, int &count)
+{
+    in >> count;
+    return in.status() == QDataStream::Ok && count >= 0 && count <= in.device()->bytesAvailable();
+}
+
+static bool readAttrVals(QDataStream &in, QList<DBC_ATTRIBUTE_VALUE> &vals)
+{
+    int count;
+    if (!readCount(in, count)) return false;
+    for (int i = 0; i < count; i++)
+    {
+        DBC_ATTRIBUTE_VALUE val;
+        in >> val.attrName >> val.value;
+        vals.append(val);
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+QString DBCCache::cachePath(const QString &dbcFileName)
+{
+    QByteArray pathHash = QCryptographicHash::hash(QFileInfo(dbcFileName).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/dbc/" + pathHash.toHex() + ".bin";
+}
+
+QByteArray DBCCache::makeKey(const QString &dbcFileName, const DBCDefaultColors &colors)
+{
+    QFileInfo info(dbcFileName);
+    QFile inFile(dbcFileName);
+    if (!info.exists() || !inFile.open(QIODevice::ReadOnly)) return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    qint64 size = inFile.size();
+    uchar *mem = (size > 0) ? inFile.map(0, size) : nullptr;
+    if (mem)
+    {
+        hash.addData(reinterpret_cast<const char *>(mem), static_cast<int>(size));
+        inFile.unmap(mem);
+    }
+    else hash.addData(&inFile);
+
+    //the default message colors end up in the attributes so a different theme needs a new parse
+    QByteArray key;
+    QDataStream out(&key, QIODevice::WriteOnly);
+    out << info.absoluteFilePath() << info.lastModified().toMSecsSinceEpoch() << size << hash.result();
+    out << colors.background.name() << colors.foreground.name();
+    return key;
+}
+
+bool DBCCache::save(const QString &dbcFileName, const DBCDefaultColors &colors, const DBCFile &file, int numMsgFaults,
+                    int numSigFaults)
+{
+    QByteArray key = makeKey(dbcFileName, colors);
+    if (key.isEmpty()) return false;
+
+    QString path = cachePath(dbcFileName);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile outFile(path);
+    if (!outFile.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&outFile);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << CACHE_MAGIC << CACHE_VERSION << key;
+    out << numMsgFaults << numSigFaults;
+    out << static_cast<int>(file.messageHandler->getMatchingCriteria()) << file.messageHandler->filterLabeling();
+
+    //pointers are written as indexes into the list they point into, -1 for none
+    QHash<const DBC_NODE *, int> nodeIdx;
+    out << file.dbc_nodes.count();
+    for (int i = 0; i < file.dbc_nodes.count(); i++)
+    {
+        const DBC_NODE &node = file.dbc_nodes.at(i);
+        nodeIdx.insert(&node, i);
+        out << node.name << node.comment << node.sourceFileName;
+        writeAttrVals(out, node.attributes);
+    }
+
+    out << file.dbc_attributes.count();
+    foreach (const DBC_ATTRIBUTE &attr, file.dbc_attributes)
+    {
+        out << attr.name << static_cast<int>(attr.valType) << static_cast<int>(attr.attrType);
+        out << attr.upper << attr.lower << attr.enumVals << attr.defaultValue;
+    }
+
+    out << file.messageHandler->getCount();
+    for (int m = 0; m < file.messageHandler->getCount(); m++)
+    {
+        DBC_MESSAGE *msg = file.messageHandler->findMsgByIdx(m);
+        QHash<const DBC_SIGNAL *, int> sigIdx;
+        for (int s = 0; s < msg->sigHandler->getCount(); s++) sigIdx.insert(msg->sigHandler->findSignalByIdx(s), s);
+
+        out << msg->ID << msg->extendedID << msg->name << msg->comment << msg->len;
+        out << nodeIdx.value(msg->sender, -1) << msg->bgColor << msg->fgColor;
+        writeAttrVals(out, msg->attributes);
+        out << sigIdx.value(msg->multiplexorSignal, -1);
+
+        out << msg->sigHandler->getCount();
+        for (int s = 0; s < msg->sigHandler->getCount(); s++)
+        {
+            DBC_SIGNAL *sig = msg->sigHandler->findSignalByIdx(s);
+            out << sig->name << sig->startBit << sig->signalSize << sig->intelByteOrder;
+            out << sig->isMultiplexor << sig->isMultiplexed << sig->multiplexHighValue << sig->multiplexLowValue;
+            out << static_cast<int>(sig->valType) << sig->factor << sig->bias << sig->min << sig->max;
+            out << nodeIdx.value(sig->receiver, -1) << sig->unitName << sig->comment;
+            writeAttrVals(out, sig->attributes);
+            out << sig->valList.count();
+            foreach (const DBC_VAL_ENUM_ENTRY &val, sig->valList) out << val.value << val.descript;
+            out << sigIdx.value(sig->multiplexParent, -1);
+            QList<int> children;
+            foreach (DBC_SIGNAL *child, sig->multiplexedChildren) children.append(sigIdx.value(child, -1));
+            out << children;
+        }
+    }
+
+    if (out.status() != QDataStream::Ok) return false;
+    return outFile.commit();
+}
+
+bool DBCCache::load(const QString &dbcFileName, const DBCDefaultColors &colors, DBCFile &file, int &numMsgFaults,
+                    int &numSigFaults)
+{
+    QFile inFile(cachePath(dbcFileName));
+    if (!inFile.open(QIODevice::ReadOnly) || inFile.size() == 0) return false;
+    uchar *mem = inFile.map(0, inFile.size());
+    if (!mem) return false;
+
+    QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char *>(mem), static_cast<int>(inFile.size()));
+    QDataStream in(raw);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic, version;
+    QByteArray storedKey;
+    in >> magic >> version;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+    {
+        inFile.unmap(mem);
+        return false;
+    }
+    in >> storedKey;
+    if (in.status() != QDataStream::Ok || storedKey != makeKey(dbcFileName, colors))
+    {
+        inFile.unmap(mem);
+        return false;
+    }
+
+    file.dbc_nodes.clear();
+    file.dbc_attributes.clear();
+    file.messageHandler->removeAllMessages();
+
+    bool ok = true;
+    int count, criteria;
+    bool labeling;
+    in >> numMsgFaults >> numSigFaults >> criteria >> labeling;
+    file.messageHandler->setMatchingCriteria(static_cast<MatchingCriteria_t>(criteria));
+    file.messageHandler->setFilterLabeling(labeling);
+
+    ok = readCount(in, count);
+    for (int i = 0; ok && i < count; i++)
+    {
+        DBC_NODE node;
+        in >> node.name >> node.comment >> node.sourceFileName;
+        ok = readAttrVals(in, node.attributes);
+        file.dbc_nodes.append(node);
+    }
+    int numNodes = file.dbc_nodes.count();
+
+    ok = ok && readCount(in, count);
+    for (int i = 0; ok && i < count; i++)
+    {
+        DBC_ATTRIBUTE attr;
+        int valType, attrType;
+        in >> attr.name >> valType >> attrType >> attr.upper >> attr.lower >> attr.enumVals >> attr.defaultValue;
+        attr.valType = static_cast<DBC_ATTRIBUTE_VAL_TYPE>(valType);
+        attr.attrType = static_cast<DBC_ATTRIBUTE_TYPE>(attrType);
+        file.dbc_attributes.append(attr);
+    }
+
+    ok = ok && readCount(in, count);
+    for (int m = 0; ok && m < count; m++)
+    {
+        DBC_MESSAGE newMsg;
+        int senderIdx, multiplexorIdx, numSigs;
+        in >> newMsg.ID >> newMsg.extendedID >> newMsg.name >> newMsg.comment >> newMsg.len;
+        in >> senderIdx >> newMsg.bgColor >> newMsg.fgColor;
+        ok = readAttrVals(in, newMsg.attributes);
+        in >> multiplexorIdx;
+        newMsg.sender = (senderIdx >= 0 && senderIdx < numNodes) ? &file.dbc_nodes[senderIdx] : nullptr;
+        file.messageHandler->addMessage(newMsg);
+        DBC_MESSAGE *msg = file.messageHandler->findMsgByIdx(file.messageHandler->getCount() - 1);
+
+        //the multiplex pointers can point either way so they're filled in once all signals exist
+        QVector<int> parentIdx;
+        QVector<QList<int>> childIdx;
+        ok = ok && readCount(in, numSigs);
+        for (int s = 0; ok && s < numSigs; s++)
+        {
+            DBC_SIGNAL sig;
+            int valType, receiverIdx, numVals, parent;
+            QList<int> children;
+            in >> sig.name >> sig.startBit >> sig.signalSize >> sig.intelByteOrder;
+            in >> sig.isMultiplexor >> sig.isMultiplexed >> sig.multiplexHighValue >> sig.multiplexLowValue;
+            in >> valType >> sig.factor >> sig.bias >> sig.min >> sig.max;
+            in >> receiverIdx >> sig.unitName >> sig.comment;
+            ok = readAttrVals(in, sig.attributes) && readCount(in, numVals);
+            for (int v = 0; ok && v < numVals; v++)
+            {
+                DBC_VAL_ENUM_ENTRY val;
+                in >> val.value >> val.descript;
+                sig.valList.append(val);
+            }
+            in >> parent >> children;
+            sig.valType = static_cast<DBC_SIG_VAL_TYPE>(valType);
+            sig.receiver = (receiverIdx >= 0 && receiverIdx < numNodes) ? &file.dbc_nodes[receiverIdx] : nullptr;
+            sig.parentMessage = msg;
+            msg->sigHandler->addSignal(sig);
+            parentIdx.append(parent);
+            childIdx.append(children);
+        }
+
+        msg->multiplexorSignal = msg->sigHandler->findSignalByIdx(multiplexorIdx);
+        for (int s = 0; ok && s < msg->sigHandler->getCount(); s++)
+        {
+            DBC_SIGNAL *sig = msg->sigHandler->findSignalByIdx(s);
+            sig->multiplexParent = msg->sigHandler->findSignalByIdx(parentIdx[s]);
+            foreach (int child, childIdx[s])
+            {
+                DBC_SIGNAL *childSig = msg->sigHandler->findSignalByIdx(child);
+                if (childSig) sig->multiplexedChildren.append(childSig);
+            }
+            sig->compile();
+        }
+        ok = ok && (in.status() == QDataStream::Ok);
+    }
+
+    inFile.unmap(mem);
+
+    if (!ok || in.status() != QDataStream::Ok)
+    {
+        qDebug() << "Damaged DBC cache for" << dbcFileName;
+        file.dbc_nodes.clear();
+        file.dbc_attributes.clear();
+        file.messageHandler->removeAllMessages();
+        return false;
+    }
+
+    QStringList fileList = dbcFileName.split('/');
+    file.fileName = fileList[fileList.length() - 1];
+    file.filePath = dbcFileName.left(dbcFileName.length() - file.fileName.length());
+    file.assocBuses = -1;
+    file.isDirty = false;
+    return true;
+}
@@ -0,0 +1,36 @@
+#ifndef DBCCACHE_H
+#define DBCCACHE_H
+
+#include <QString>
+#include <QByteArray>
+
+class DBCFile;
+class DBCDefaultColors;
+
+/*
+ * Binary snapshots of loaded DBC files so they don't have to be parsed again on every start.
+ * A snapshot lives in the application cache directory under a name made from the DBC's path and
+ * holds everything loadFile would have built: nodes, attributes, messages, signals, value tables,
+ * multiplex relations and the fault counts to report. It is only used while the DBC's path,
+ * modification time, size and SHA-1 all still match (and the default message colors it was
+ * loaded with), otherwise the DBC is parsed normally and the snapshot rewritten.
+ *
+ * Snapshots are read straight out of a memory mapped file. Everything here is safe to call from
+ * the worker threads DBCHandler::loadDBCFiles uses.
+ */
+class DBCCache
+{
+public:
+    //fills file from a current snapshot of dbcFileName, false if there isn't one (file is left empty then)
+    static bool load(const QString &dbcFileName, const DBCDefaultColors &colors, DBCFile &file, int &numMsgFaults,
+                     int &numSigFaults);
+    //writes a snapshot of a file just loaded from dbcFileName
+    static bool save(const QString &dbcFileName, const DBCDefaultColors &colors, const DBCFile &file, int numMsgFaults,
+                     int numSigFaults);
+    static QString cachePath(const QString &dbcFileName);
+
+private:
+    static QByteArray makeKey(const QString &dbcFileName, const DBCDefaultColors &colors);
+};
+
+#endif // DBCCACHE_H
@@ -8,13 +8,17 @@
 #include <QApplication>
 #include <QPalette>
 #include <QSettings>
+#include <QThread>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
+#include "dbccache.h"
+#include "dbclineparser.h"
 #include "utility.h"
 #include "connections/canconmanager.h"
 
 DBCHandler* DBCHandler::instance = nullptr;
+QAtomicInt DBCMessageHandler::revisionCounter;
 
 DBC_SIGNAL* DBCSignalHandler::findSignalByIdx(int idx)
 {
@@ -100,46 +104,59 @@ void DBCSignalHandler::sort()
 DBC_MESSAGE* DBCMessageHandler::findMsgByID(uint32_t id)
 {
     if (messages.count() == 0) return nullptr;
-    DBC_MESSAGE *bestMatch = nullptr;
 
-    for (int i = 0; i < messages.count(); i++)
+    //an exact match always wins no matter which matching criteria is set
+    QHash<uint32_t, int>::const_iterator it = idIndex.constFind(id);
+    if (it != idIndex.constEnd()) return &messages[it.value()];
+
+    if (matchingCriteria == J1939)
     {
-        if ( messages[i].ID == id )
+        // include data page and extended data page in the pgn
+        uint32_t pgn = (id & 0x3FFFF00) >> 8;
+        if ( (pgn & 0xFF00) <= 0xEF00 )
         {
-            return &messages[i];
+            // PDU1 format, destination address isn't part of the pgn
+            it = pdu1Index.constFind(id & 0x3FF0000);
+            if (it != pdu1Index.constEnd()) return &messages[it.value()];
         }
-
-        if (matchingCriteria == J1939)
+        else
         {
-            // include data page and extended data page in the pgn
-            uint32_t pgn = (id & 0x3FFFF00) >> 8;
-            if ( (pgn & 0xFF00) <= 0xEF00 )
-            {
-                // PDU1 format
-                pgn &= 0x3FF00;
-                if ((messages[i].ID & 0x3FF0000) == (pgn << 8))
-                {
-                    bestMatch = &messages[i];
-                }
-            }
-            else
-            {
-                // PDU2 format
-                if ((messages[i].ID & 0x3FFFF00) == (pgn << 8))
-                {
-                    bestMatch = &messages[i];
-                }
-            }
+            // PDU2 format
+            it = pdu2Index.constFind(id & 0x3FFFF00);
+            if (it != pdu2Index.constEnd()) return &messages[it.value()];
         }
-        else if (matchingCriteria == GMLAN)
+    }
+    else if (matchingCriteria == GMLAN)
+    {
+        // Match the bits 14-26 (Arbitration Id) of GMLAN 29bit header
+        uint32_t arbId = id & 0x3FFE000;
+        if (arbId != 0)
         {
-            // Match the bits 14-26 (Arbitration Id) of GMLAN 29bit header
-            uint32_t arbId = id &0x3FFE000;
-            if ( (arbId != 0) && (messages[i].ID & 0x3FFE000) == arbId )
-                bestMatch = &messages[i];
+            it = arbIdIndex.constFind(arbId);
+            if (it != arbIdIndex.constEnd()) return &messages[it.value()];
         }
     }
-    return bestMatch;
+    return nullptr;
+}
+
+void DBCMessageHandler::indexMessage(int idx)
+{
+    uint32_t id = messages[idx].ID;
+    if (!idIndex.contains(id)) idIndex.insert(id, idx);
+    pdu1Index.insert(id & 0x3FF0000, idx);
+    pdu2Index.insert(id & 0x3FFFF00, idx);
+    arbIdIndex.insert(id & 0x3FFE000, idx);
+}
+
+void DBCMessageHandler::rebuildIndex()
+{
+    idIndex.clear();
+    pdu1Index.clear();
+    pdu2Index.clear();
+    arbIdIndex.clear();
+    idIndex.reserve(messages.count());
+    for (int i = 0; i < messages.count(); i++) indexMessage(i);
+    touch();
 }
 
 DBC_MESSAGE* DBCMessageHandler::findMsgByIdx(int idx)
@@ -198,6 +215,8 @@ QList<DBC_MESSAGE*> DBCMessageHandler::findMsgsByNode(DBC_NODE* node)
 bool DBCMessageHandler::addMessage(DBC_MESSAGE &msg)
 {
     messages.append(msg);
+    indexMessage(messages.count() - 1);
+    touch();
     return true;
 }
 
@@ -213,6 +232,7 @@ bool DBCMessageHandler::removeMessage(DBC_MESSAGE *msg)
             break;
         }
     }
+    rebuildIndex();
     return true;
 }
 
@@ -222,6 +242,7 @@ bool DBCMessageHandler::removeMessageByIndex(int idx)
     if (idx < 0) return false;
     if (idx >= messages.count()) return false;
     messages.removeAt(idx);
+    rebuildIndex();
     return true;
 }
 
@@ -237,6 +258,7 @@ bool DBCMessageHandler::removeMessage(uint32_t ID)
             foundSome = true;
         }
     }
+    if (foundSome) rebuildIndex();
     return foundSome;
 }
 
@@ -252,12 +274,14 @@ bool DBCMessageHandler::removeMessage(QString name)
             foundSome = true;
         }
     }
+    if (foundSome) rebuildIndex();
     return foundSome;
 }
 
 void DBCMessageHandler::removeAllMessages()
 {
     messages.clear();
+    rebuildIndex();
 }
 
 int DBCMessageHandler::getCount()
@@ -272,6 +296,7 @@ void DBCMessageHandler::sort()
     {
         messages[i].sigHandler->sort();
     }
+    rebuildIndex();
 }
 
 bool DBCMessageHandler::filterLabeling()
@@ -292,6 +317,7 @@ MatchingCriteria_t DBCMessageHandler::getMatchingCriteria()
 void DBCMessageHandler::setMatchingCriteria(MatchingCriteria_t _matchingCriteria)
 {
     matchingCriteria = _matchingCriteria;
+    touch();
 }
 
 DBCFile::DBCFile()
@@ -414,6 +440,7 @@ void DBCFile::setAssocBus(int bus)
     //int numBuses = CANConManager::getInstance()->getNumBuses();
     //if (bus >= numBuses) return;
     assocBuses = bus;
+    DBCMessageHandler::touch();
 }
 
 DBC_ATTRIBUTE *DBCFile::findAttributeByName(QString name, DBC_ATTRIBUTE_TYPE type)
@@ -449,6 +476,7 @@ void DBCFile::findAttributesByType(DBC_ATTRIBUTE_TYPE typ, QList<DBC_ATTRIBUTE>
 void DBCFile::setDirtyFlag()
 {
     isDirty = true;
+    DBCMessageHandler::touch(); //something is being edited, anything compiled from the definitions is stale
 }
 
 //BE CAREFUL HERE. Do not clear the dirty flag unless you're absolutely sure nothing has changed.
@@ -468,27 +496,18 @@ bool DBCFile::getDirtyFlag()
 
 DBC_MESSAGE* DBCFile::parseMessageLine(QString line)
 {
-    QRegularExpression regex;
-    QRegularExpressionMatch match;
-
+    DBCMessageLine parsed;
     DBC_MESSAGE *msgPtr;
 
-    qDebug() << "Found a BO line";
-    regex.setPattern("^BO\\_ (\\w+) ([-\\w]+) *: (\\w+) ([-\\w]+)");
-    match = regex.match(line);
-    //captured 1 = the ID in decimal
-    //captured 2 = The message name
-    //captured 3 = the message length
-    //captured 4 = the NODE responsible for this message
-    if (match.hasMatch())
+    if (DBCLineParser::parseMessage(line, parsed))
     {
         DBC_MESSAGE msg;
-        uint32_t ID = match.captured(1).toULong(); //the ID is always stored in decimal format
+        uint32_t ID = parsed.rawID; //the ID is always stored in decimal format
         msg.ID = ID & 0x1FFFFFFFul;
         msg.extendedID = (ID & 0x80000000ul) ? true : false;
-        msg.name = match.captured(2);
-        msg.len = match.captured(3).toUInt();
-        msg.sender = findNodeByName(match.captured(4));
+        msg.name = parsed.name;
+        msg.len = parsed.len;
+        msg.sender = findNodeByName(parsed.sender);
         if (!msg.sender) msg.sender = findNodeByIdx(0);
         messageHandler->addMessage(msg);
         msgPtr = messageHandler->findMsgByID(msg.ID);
@@ -499,152 +518,86 @@ DBC_MESSAGE* DBCFile::parseMessageLine(QString line)
 
 DBC_SIGNAL* DBCFile::parseSignalLine(QString line, DBC_MESSAGE *msg)
 {
-    QRegularExpression regex;
-    QRegularExpressionMatch match;
-
-    int offset = 0;
-    bool isMessageMultiplexor = false;
-    //bool isMultiplexed = false;
+    DBCSignalLine parsed;
     DBC_SIGNAL sig;
 
-    sig.multiplexLowValue = 0;
-    sig.multiplexHighValue = 0;
-    sig.isMultiplexed = false;
-    sig.isMultiplexor = false;
-
-    qDebug() << "Found a SG line";
-    regex.setPattern("^SG\\_ *([-\\w]+) +M *: *(\\d+)\\|(\\d+)@(\\d+)([\\+|\\-]) \\(([0-9.+\\-eE]+),([0-9.+\\-eE]+)\\) \\[([0-9.+\\-eE]+)\\|([0-9.+\\-eE]+)\\] \\\"(.*)\\\" (.*)");
-
-    match = regex.match(line);
-    if (match.hasMatch())
+    if (!DBCLineParser::parseSignal(line, parsed)) return nullptr;
+
+    //a plain M is the multiplexor of the whole message. m<n>M is both multiplexed and a multiplexor
+    //(extended multiplexing) so it isn't the top level one
+    bool isMessageMultiplexor = parsed.isMultiplexor && !parsed.isMultiplexed;
+    sig.isMultiplexor = parsed.isMultiplexor;
+    sig.isMultiplexed = parsed.isMultiplexed;
+    sig.multiplexLowValue = parsed.multiplexValue;
+    sig.multiplexHighValue = parsed.multiplexValue;
+
+    sig.name = parsed.name;
+    sig.startBit = parsed.startBit;
+    sig.signalSize = parsed.signalSize;
+    int val = parsed.valueType;
+    if (val < 2)
     {
-        qDebug() << "Multiplexor signal";
-        isMessageMultiplexor = true;
-        sig.isMultiplexor = true;
+        if (parsed.isSigned) sig.valType = SIGNED_INT;
+        else sig.valType = UNSIGNED_INT;
     }
-    else
+    switch (val)
     {
-        regex.setPattern("^SG\\_ *([-\\w]+) +m(\\d+) *: *(\\d+)\\|(\\d+)@(\\d+)([\\+|\\-]) \\(([0-9.+\\-eE]+),([0-9.+\\-eE]+)\\) \\[([0-9.+\\-eE]+)\\|([0-9.+\\-eE]+)\\] \\\"(.*)\\\" (.*)");
-        match = regex.match(line);
-        if (match.hasMatch())
-        {
-            qDebug() << "Multiplexed signal";
-            //isMultiplexed = true;
-            sig.isMultiplexed = true;
-            sig.multiplexLowValue = match.captured(2).toInt();
-            sig.multiplexHighValue = sig.multiplexLowValue;
-            offset = 1;
-        }
-        else
-        {
-            regex.setPattern("^SG\\_ *([-\\w]+) +m(\\d+)M *: *(\\d+)\\|(\\d+)@(\\d+)([\\+|\\-]) \\(([0-9.+\\-eE]+),([0-9.+\\-eE]+)\\) \\[([0-9.+\\-eE]+)\\|([0-9.+\\-eE]+)\\] \\\"(.*)\\\" (.*)");
-            match = regex.match(line);
-            if (match.hasMatch())
-            {
-                qDebug() << "Extended Multiplexor Signal";
-                sig.isMultiplexor = true; //we don't set the local isMessageMultiplexor variable because this isn't the top level multiplexor
-                sig.isMultiplexed = true; //but, it is both a multiplexor and multiplexed
-                sig.multiplexLowValue = match.captured(2).toInt();
-                sig.multiplexHighValue = sig.multiplexLowValue;
-                offset = 1;
-            }
-            else
-            {
-                qDebug() << "standard signal";
-                regex.setPattern("^SG\\_ *([-\\w]+) *: *(\\d+)\\|(\\d+)@(\\d+)([\\+|\\-]) \\(([0-9.+\\-eE]+),([0-9.+\\-eE]+)\\) \\[([0-9.+\\-eE]+)\\|([0-9.+\\-eE]+)\\] \\\"(.*)\\\" (.*)");
-                match = regex.match(line);
-                sig.isMultiplexed = false;
-                sig.isMultiplexor = false;
-            }
-        }
+    case 0: //big endian mode
+        sig.intelByteOrder = false;
+        break;
+    case 1: //little endian mode
+        sig.intelByteOrder = true;
+        break;
+    case 2:
+        sig.valType = SP_FLOAT;
+        break;
+    case 3:
+        sig.valType = DP_FLOAT;
+        break;
+    case 4:
+        sig.valType = STRING;
+        break;
+    case 5: //single point float in little endian
+        sig.valType = SP_FLOAT;
+        sig.intelByteOrder = true;
+        break;
+    case 6: //double point float in little endian
+        sig.valType = DP_FLOAT;
+        sig.intelByteOrder = true;
+        break;
     }
-
-    //captured 1 is the signal name
-    //captured 2 would be multiplex value if this is a multiplex signal. Then offset the rest of these by 1
-    //captured 2 is the starting bit
-    //captured 3 is the length in bits
-    //captured 4 is the byte order / value type
-    //captured 5 specifies signed/unsigned for ints
-    //captured 6 is the scaling factor
-    //captured 7 is the offset
-    //captured 8 is the minimum value
-    //captured 9 is the maximum value
-    //captured 10 is the unit
-    //captured 11 is the receiving node
-
-    if (match.hasMatch())
+    sig.factor = parsed.factor;
+    sig.bias = parsed.bias;
+    sig.min = parsed.min;
+    sig.max = parsed.max;
+    sig.unitName = parsed.unitName;
+    if (parsed.receivers.contains(','))
     {
-        sig.name = match.captured(1);
-        sig.startBit = match.captured(2 + offset).toInt();
-        sig.signalSize = match.captured(3 + offset).toInt();
-        int val = match.captured(4 + offset).toInt();
-        if (val < 2)
-        {
-            if (match.captured(5 + offset) == "+") sig.valType = UNSIGNED_INT;
-            else sig.valType = SIGNED_INT;
-        }
-        switch (val)
-        {
-        case 0: //big endian mode
-            sig.intelByteOrder = false;
-            break;
-        case 1: //little endian mode
-            sig.intelByteOrder = true;
-            break;
-        case 2:
-            sig.valType = SP_FLOAT;
-            break;
-        case 3:
-            sig.valType = DP_FLOAT;
-            break;
-        case 4:
-            sig.valType = STRING;
-            break;
-        case 5: //single point float in little endian
-            sig.valType = SP_FLOAT;
-            sig.intelByteOrder = true;
-            break;
-        case 6: //double point float in little endian
-            sig.valType = DP_FLOAT;
-            sig.intelByteOrder = true;
-            break;
-        }
-        sig.factor = match.captured(6 + offset).toDouble();
-        sig.bias = match.captured(7 + offset).toDouble();
-        sig.min = match.captured(8 + offset).toDouble();
-        sig.max = match.captured(9 + offset).toDouble();
-        sig.unitName = match.captured(10 + offset);
-        if (match.captured(11 + offset).contains(','))
-        {
-            QString tmp = match.captured(11 + offset).split(',')[0];
-            sig.receiver = findNodeByName(tmp);            
-        }
-        else sig.receiver = findNodeByName(match.captured(11 + offset));
+        QString tmp = parsed.receivers.split(',')[0];
+        sig.receiver = findNodeByName(tmp);
+    }
+    else sig.receiver = findNodeByName(parsed.receivers);
 
-        if (!sig.receiver) sig.receiver = findNodeByIdx(0); //apply default if there was no match
+    if (!sig.receiver) sig.receiver = findNodeByIdx(0); //apply default if there was no match
 
-        sig.parentMessage = msg;
-        if (msg)
-        {
-            msg->sigHandler->addSignal(sig);
-            if (isMessageMultiplexor) msg->multiplexorSignal = msg->sigHandler->findSignalByName(sig.name);
-            return msg->sigHandler->findSignalByName(sig.name);
-        }
-        else return nullptr;
+    sig.parentMessage = msg;
+    if (msg)
+    {
+        msg->sigHandler->addSignal(sig);
+        if (isMessageMultiplexor) msg->multiplexorSignal = msg->sigHandler->findSignalByName(sig.name);
+        return msg->sigHandler->findSignalByName(sig.name);
     }
-
     return nullptr;
 }
 
 //SG_MUL_VAL_ 2024 S1_PID_0D_VehicleSpeed S1 13-13;
 bool DBCFile::parseSignalMultiplexValueLine(QString line)
 {
-    QRegularExpression regex;
     QRegularExpressionMatch match;
 
     qDebug() << "Found a multiplex definition line";
-    regex.setPattern("^SG\\_MUL\\_VAL\\_ (\\d+) ([-\\w]+) ([-\\w]+) (\\d+)\\-(\\d+);");
-    match = regex.match(line);
+    static const QRegularExpression muxValueRegex("^SG\\_MUL\\_VAL\\_ (\\d+) ([-\\w]+) ([-\\w]+) (\\d+)\\-(\\d+);");
+    match = muxValueRegex.match(line);
     //captured 1 is message ID
     //Captured 2 is signal name
     //Captured 3 is parent multiplexor
@@ -676,11 +629,10 @@ bool DBCFile::parseSignalMultiplexValueLine(QString line)
 
 bool DBCFile::parseSignalValueTypeLine(QString line)
 {
-    QRegularExpression regex;
     QRegularExpressionMatch match;
     qDebug() << "Found a signal valtype line";
-    regex.setPattern("^SIG\\_VALTYPE\\_ *(\\d+) *([-\\w]+) *: *(\\d+);");
-    match = regex.match(line);
+    static const QRegularExpression valTypeRegex("^SIG\\_VALTYPE\\_ *(\\d+) *([-\\w]+) *: *(\\d+);");
+    match = valTypeRegex.match(line);
 
     // captured 1 is the message id
     // captured 2 is the signal name
@@ -714,12 +666,11 @@ bool DBCFile::parseSignalValueTypeLine(QString line)
 
 bool DBCFile::parseValueLine(QString line)
 {
-    QRegularExpression regex;
     QRegularExpressionMatch match;
 
     qDebug() << "Found a value definition line";
-    regex.setPattern("^VAL\\_ (\\w+) ([-\\w]+) (.*);");
-    match = regex.match(line);
+    static const QRegularExpression valueRegex("^VAL\\_ (\\w+) ([-\\w]+) (.*);");
+    match = valueRegex.match(line);
     //captured 1 is the ID to match against
     //captured 2 is the signal name to match against
     //captured 3 is a series of values in the form (number "text") that is, all sep'd by spaces
@@ -736,8 +687,8 @@ bool DBCFile::parseValueLine(QString line)
                 DBC_VAL_ENUM_ENTRY val;
                 while (tokenString.length() > 2)
                 {
-                    regex.setPattern("(\\d+) \\\"(.*?)\\\"(.*)");
-                    match = regex.match(tokenString);
+                    static const QRegularExpression valueEntryRegex("(\\d+) \\\"(.*?)\\\"(.*)");
+                    match = valueEntryRegex.match(tokenString);
                     if (match.hasMatch())
                     {
                         val.value = match.captured(1).toULong() & 0x1FFFFFFFul;
@@ -760,11 +711,10 @@ bool DBCFile::parseValueLine(QString line)
 
 bool DBCFile::parseAttributeLine(QString line)
 {
-    QRegularExpression regex;
     QRegularExpressionMatch match;
 
-    regex.setPattern("^BA\\_ \\\"*([-\\w]+)\\\"* BO\\_ (\\d+) \\\"*([#\\w]+)\\\"*");
-    match = regex.match(line);
+    static const QRegularExpression msgAttrRegex("^BA\\_ \\\"*([-\\w]+)\\\"* BO\\_ (\\d+) \\\"*([#\\w]+)\\\"*");
+    match = msgAttrRegex.match(line);
     //captured 1 is the attribute name
     //captured 2 is the message ID number (frame ID)
     //captured 3 is the attribute value
@@ -794,8 +744,8 @@ bool DBCFile::parseAttributeLine(QString line)
         }
     }
 
-    regex.setPattern("^BA\\_ \\\"*([-\\w]+)\\\"* SG\\_ (\\d+) \\\"*([-\\w]+)\\\"* \\\"*([#\\w]+)\\\"*");
-    match = regex.match(line);
+    static const QRegularExpression sigAttrRegex("^BA\\_ \\\"*([-\\w]+)\\\"* SG\\_ (\\d+) \\\"*([-\\w]+)\\\"* \\\"*([#\\w]+)\\\"*");
+    match = sigAttrRegex.match(line);
     //captured 1 is the attribute name
     //captured 2 is the message ID number (frame ID)
     //captured 3 is the signal name to bind to
@@ -828,8 +778,8 @@ bool DBCFile::parseAttributeLine(QString line)
         }
     }
 
-    regex.setPattern("^BA\\_ \\\"*([-\\w]+)\\\"* BU\\_ \\\"*([-\\w]+)\\\"* \\\"*([#\\w]+)\\\"*");
-    match = regex.match(line);
+    static const QRegularExpression nodeAttrRegex("^BA\\_ \\\"*([-\\w]+)\\\"* BU\\_ \\\"*([-\\w]+)\\\"* \\\"*([#\\w]+)\\\"*");
+    match = nodeAttrRegex.match(line);
     //captured 1 is the attribute name
     //captured 2 is the name of the node
     //captured 3 is the attribute value
@@ -863,11 +813,10 @@ bool DBCFile::parseAttributeLine(QString line)
 
 bool DBCFile::parseDefaultAttrLine(QString line)
 {
-    QRegularExpression regex;
     QRegularExpressionMatch match;
 
-    regex.setPattern("^BA\\_DEF\\_DEF\\_ \\\"*([-\\w]+)\\\"* \\\"*([#\\w]*)\\\"*");
-    match = regex.match(line);
+    static const QRegularExpression defaultAttrRegex("^BA\\_DEF\\_DEF\\_ \\\"*([-\\w]+)\\\"* \\\"*([#\\w]*)\\\"*");
+    match = defaultAttrRegex.match(line);
     //captured 1 is the name of the attribute
     //captured 2 is the default value for that attribute
     if (match.hasMatch())
@@ -906,21 +855,60 @@ bool DBCFile::parseDefaultAttrLine(QString line)
     return false;
 }
 
+DBCDefaultColors DBCDefaultColors::fromPalette()
+{
+    DBCDefaultColors colors;
+    colors.background = QApplication::palette().color(QPalette::Base);
+    colors.foreground = QApplication::palette().color(QPalette::WindowText);
+    return colors;
+}
+
 bool DBCFile::loadFile(QString fileName)
+{
+    int numMsgFaults, numSigFaults;
+    if (!loadFile(fileName, DBCDefaultColors::fromPalette(), numMsgFaults, numSigFaults)) return false;
+    reportLoadFaults(numMsgFaults, numSigFaults);
+    return true;
+}
+
+void DBCFile::reportLoadFaults(int numMsgFaults, int numSigFaults)
+{
+    if (numSigFaults > 0 || numMsgFaults > 0)
+    {
+        QMessageBox msgBox;
+        QString msg = "DBC file loaded with errors!\n";
+        msg += "Number of faulty message entries: " + QString::number(numMsgFaults) + "\n";
+        msg += "Number of faulty signal entries: " + QString::number(numSigFaults) + "\n\n";
+        msg += "Faulty entries have not been loaded.\n\n";
+        msg += "All other entries are, however, loaded.";
+        msgBox.setWindowTitle(fileName);
+        msgBox.setText(msg);
+        msgBox.exec();
+    }
+}
+
+/*
+ * Does the actual loading and never touches the GUI so DBCHandler::loadDBCFiles can run it on several
+ * files in parallel. Faulty lines are only counted here, loadFile(QString) is what reports them.
+ * All the regular expressions in the parse functions are static so each is compiled once, not for
+ * every line, and matching a const QRegularExpression from several threads at once is fine.
+ */
+bool DBCFile::loadFile(QString fileName, const DBCDefaultColors &colors, int &numMsgFaults, int &numSigFaults)
 {
     QFile *inFile = new QFile(fileName);
     QString line, rawLine;
-    QRegularExpression regex;
     QRegularExpressionMatch match;
     DBC_MESSAGE *currentMessage = nullptr;
     DBC_ATTRIBUTE attr;
-    int numSigFaults = 0, numMsgFaults = 0;
     int linesSinceYield = 0;
+    bool canYield = (QThread::currentThread() == qApp->thread());
     QString fileBaseName = QFileInfo(fileName).baseName();
 
     bool inMultilineBU = false;
 
     qDebug() << "DBC File: " << fileName;
+    numMsgFaults = 0;
+    numSigFaults = 0;
 
     if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
     {
@@ -945,9 +933,10 @@ bool DBCFile::loadFile(QString fileName)
         line = rawLine.simplified();
 
         linesSinceYield++;
-        if (linesSinceYield > 100)
+        if (linesSinceYield > 100 && canYield)
         {
             qApp->processEvents();
+            linesSinceYield = 0;
         }
 
         if (inMultilineBU)
@@ -987,8 +976,8 @@ bool DBCFile::loadFile(QString fileName)
             if (line.startsWith("BU_:")) //line specifies the nodes on this canbus
             {
                 qDebug() << "Found a BU line";
-                regex.setPattern("^BU\\_\\:(.*)");
-                match = regex.match(line);
+                static const QRegularExpression nodeListRegex("^BU\\_\\:(.*)");
+                match = nodeListRegex.match(line);
                 //captured 1 = a list of node names separated by spaces. No idea how many yet
                 if (match.hasMatch())
                 {
@@ -1011,8 +1000,8 @@ bool DBCFile::loadFile(QString fileName)
             if (line.startsWith("CM_ SG_ "))
             {
                 qDebug() << "Found an SG comment line";
-                regex.setPattern("^CM\\_ SG\\_ *(\\w+) *([-\\w]+) *\\\"(.*)\\\";");
-                match = regex.match(line);
+                static const QRegularExpression sigCommentRegex("^CM\\_ SG\\_ *(\\w+) *([-\\w]+) *\\\"(.*)\\\";");
+                match = sigCommentRegex.match(line);
                 //captured 1 is the ID to match against to get to the message
                 //captured 2 is the signal name from that message
                 //captured 3 is the comment itself
@@ -1033,8 +1022,8 @@ bool DBCFile::loadFile(QString fileName)
             if (line.startsWith("CM_ BO_ "))
             {
                 qDebug() << "Found a BO comment line";
-                regex.setPattern("^CM\\_ BO\\_ *(\\w+) *\\\"(.*)\\\";");
-                match = regex.match(line);
+                static const QRegularExpression msgCommentRegex("^CM\\_ BO\\_ *(\\w+) *\\\"(.*)\\\";");
+                match = msgCommentRegex.match(line);
                 //captured 1 is the ID to match against to get to the message
                 //captured 2 is the comment itself
                 if (match.hasMatch())
@@ -1050,8 +1039,8 @@ bool DBCFile::loadFile(QString fileName)
             if (line.startsWith("CM_ BU_ "))
             {
                 qDebug() << "Found a BU comment line";
-                regex.setPattern("^CM\\_ BU\\_ *([-\\w]+) *\\\"(.*)\\\";");
-                match = regex.match(line);
+                static const QRegularExpression nodeCommentRegex("^CM\\_ BU\\_ *([-\\w]+) *\\\"(.*)\\\";");
+                match = nodeCommentRegex.match(line);
                 //captured 1 is the Node name
                 //captured 2 is the comment itself
                 if (match.hasMatch())
@@ -1094,8 +1083,6 @@ bool DBCFile::loadFile(QString fileName)
             }
             else if (line.startsWith("BA_DEF_ BU_ ")) //definition of a node attribute
             {
-                qDebug() << "Found a BU attribute line";
-
                 if (parseAttribute(line.right(line.length() - 12), attr))
                 {
                     //qDebug() << "Success";
@@ -1106,8 +1093,6 @@ bool DBCFile::loadFile(QString fileName)
 
             else if (line.startsWith("BA_DEF_ ")) //definition of a root attribute
             {
-                qDebug() << "Found a BU attribute line";
-
                 if (parseAttribute(line.right(line.length() - 9), attr))
                 {
                     //qDebug() << "Success";
@@ -1135,7 +1120,7 @@ bool DBCFile::loadFile(QString fileName)
     if (!bgAttr)
     {
         attr.attrType = ATTR_TYPE_MESSAGE;
-        attr.defaultValue = QApplication::palette().color(QPalette::Base).name();
+        attr.defaultValue = colors.background.name();
         attr.enumVals.clear();
         attr.lower = 0;
         attr.upper = 0;
@@ -1149,7 +1134,7 @@ bool DBCFile::loadFile(QString fileName)
     if (!fgAttr)
     {
         attr.attrType = ATTR_TYPE_MESSAGE;
-        attr.defaultValue = QApplication::palette().color(QPalette::WindowText).name();
+        attr.defaultValue = colors.foreground.name();
         attr.enumVals.clear();
         attr.lower = 0;
         attr.upper = 0;
@@ -1209,20 +1194,10 @@ bool DBCFile::loadFile(QString fileName)
             {
                 sig->isMultiplexed = false; //can't multiplex if there is no multiplexor!
             }
+            sig->compile(); //value types can come from SIG_VALTYPE_ lines anywhere in the file so not until now
         }
     }
 
-    if (numSigFaults > 0 || numMsgFaults > 0)
-    {
-        QMessageBox msgBox;
-        QString msg = "DBC file loaded with errors!\n";
-        msg += "Number of faulty message entries: " + QString::number(numMsgFaults) + "\n";
-        msg += "Number of faulty signal entries: " + QString::number(numSigFaults) + "\n\n";
-        msg += "Faulty entries have not been loaded.\n\n";
-        msg += "All other entries are, however, loaded.";
-        msgBox.setText(msg);
-        msgBox.exec();
-    }
     inFile->close();
     delete inFile;
     QStringList fileList = fileName.split('/');
@@ -1255,11 +1230,10 @@ QVariant DBCFile::processAttributeVal(QString input, DBC_ATTRIBUTE_VAL_TYPE typ)
 bool DBCFile::parseAttribute(QString inpString, DBC_ATTRIBUTE &attr)
 {
     bool goodAttr = false;
-    QRegularExpression regex;
     QRegularExpressionMatch match;
 
-    regex.setPattern("\\\"*(\\w+)\\\"* \\\"*(\\w+)\\\"* (\\d+) (\\d+)");
-    match = regex.match(inpString);
+    static const QRegularExpression boundedAttrRegex("\\\"*(\\w+)\\\"* \\\"*(\\w+)\\\"* (\\d+) (\\d+)");
+    match = boundedAttrRegex.match(inpString);
     //captured 1 is the name of the attribute to set up
     //captured 2 is the type of signal attribute to create.
     //captured 3 is the lower bound value for this attribute
@@ -1298,8 +1272,8 @@ bool DBCFile::parseAttribute(QString inpString, DBC_ATTRIBUTE &attr)
     }
     else
     {
-        regex.setPattern("\\\"*(\\w+)\\\"* \\\"*(\\w+)\\\"* (.*)");
-        match = regex.match(inpString);
+        static const QRegularExpression attrRegex("\\\"*(\\w+)\\\"* \\\"*(\\w+)\\\"* (.*)");
+        match = attrRegex.match(inpString);
         //Same as above but no upper/lower bound values.
         if (match.hasMatch())
         {
@@ -1785,17 +1759,91 @@ int DBCHandler::createBlankFile()
 
 DBCFile* DBCHandler::loadDBCFile(QString filename)
 {
-    DBCFile newFile;
-    if (newFile.loadFile(filename))
+    loadDBCFiles(QStringList(filename));
+    if (loadedFiles.count()> 0) return &loadedFiles.last();
+    else return nullptr;
+}
+
+//A current binary snapshot if there is one, otherwise a full parse which then refreshes the snapshot
+static bool loadWithCache(DBCFile *file, const QString &filename, const DBCDefaultColors &colors, int &numMsgFaults, int &numSigFaults)
+{
+    if (DBCCache::load(filename, colors, *file, numMsgFaults, numSigFaults)) return true;
+    if (!file->loadFile(filename, colors, numMsgFaults, numSigFaults)) return false;
+    if (!DBCCache::save(filename, colors, *file, numMsgFaults, numSigFaults)) qDebug() << "Could not write DBC cache for" << filename;
+    return true;
+}
+
+//Loads a batch of files, one worker thread per core each loading whole files (from a snapshot when there
+//is a current one). They're added in the order given once all are done and the returned list matches
+//filenames, nullptr where a file couldn't be loaded.
+QList<DBCFile*> DBCHandler::loadDBCFiles(const QStringList &filenames)
+{
+    QList<DBCFile*> result;
+    int count = filenames.count();
+    if (count == 0) return result;
+
+    //created here so they belong to this thread, the workers only fill them in
+    QVector<DBCFile*> parsed(count);
+    QVector<bool> loaded(count, false);
+    QVector<int> msgFaults(count, 0);
+    QVector<int> sigFaults(count, 0);
+    for (int i = 0; i < count; i++) parsed[i] = new DBCFile;
+    const DBCDefaultColors colors = DBCDefaultColors::fromPalette();
+
+    if (count == 1)
     {
-        loadedFiles.append(newFile);
+        loaded[0] = loadWithCache(parsed[0], filenames[0], colors, msgFaults[0], sigFaults[0]);
     }
     else
     {
-        //createBlankFile();
+        QAtomicInt nextFile(0);
+        auto worker = [&]()
+        {
+            int i;
+            while ((i = nextFile.fetchAndAddRelaxed(1)) < count)
+            {
+                loaded[i] = loadWithCache(parsed[i], filenames[i], colors, msgFaults[i], sigFaults[i]);
+            }
+        };
+
+        QList<QThread *> threads;
+        int numThreads = qBound(1, QThread::idealThreadCount(), count);
+        for (int t = 0; t < numThreads; t++)
+        {
+            QThread *thread = QThread::create(worker);
+            threads.append(thread);
+            thread->start();
+        }
+        for (QThread *thread : threads)
+        {
+            while (!thread->wait(50)) qApp->processEvents();
+            delete thread;
+        }
     }
-    if (loadedFiles.count()> 0) return &loadedFiles.last();
-    else return nullptr;
+
+    //every file goes into loadedFiles before any pointer into it is taken, appending may move them all
+    QVector<int> index(count, -1);
+    for (int i = 0; i < count; i++)
+    {
+        if (loaded[i])
+        {
+            index[i] = loadedFiles.count();
+            loadedFiles.append(*parsed[i]);
+        }
+        delete parsed[i];
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (index[i] < 0)
+        {
+            result.append(nullptr);
+            continue;
+        }
+        DBCFile *file = &loadedFiles[index[i]];
+        result.append(file);
+        file->reportLoadFaults(msgFaults[i], sigFaults[i]);
+    }
+    return result;
 }
 
 //the only reason to even bother sending the index is to see if
@@ -2179,11 +2227,13 @@ void DBCHandler::removeDBCFile(int idx)
     if (idx < 0) return;
     if (idx >= loadedFiles.count()) return;
     loadedFiles.removeAt(idx);
+    DBCMessageHandler::touch();
 }
 
 void DBCHandler::removeAllFiles()
 {
     loadedFiles.clear();
+    DBCMessageHandler::touch();
 }
 
 void DBCHandler::swapFiles(int pos1, int pos2)
@@ -2195,6 +2245,7 @@ void DBCHandler::swapFiles(int pos1, int pos2)
     if (pos2 >= loadedFiles.count()) return;
 
     loadedFiles.swapItemsAt(pos1, pos2);
+    DBCMessageHandler::touch();
 }
 
 /*
@@ -2205,28 +2256,42 @@ void DBCHandler::swapFiles(int pos1, int pos2)
 */
 DBC_MESSAGE* DBCHandler::findMessage(const CANFrame &frame)
 {
-    for(int i = 0; i < loadedFiles.count(); i++)
-    {
-        if (loadedFiles[i].getAssocBus() == -1 || frame.bus == loadedFiles[i].getAssocBus())
-        {
-            DBC_MESSAGE* msg = loadedFiles[i].messageHandler->findMsgByID(frame.frameId());
-            if (msg != nullptr) return msg;
-        }
-    }
-    return nullptr;
+    return resolveMessage(frame.frameId(), frame.bus);
 }
 
 DBC_MESSAGE* DBCHandler::findMessage(uint32_t id)
 {
+    return resolveMessage(id, -1);
+}
+
+//Bus -1 means any file matches no matter what bus it is associated with. The result of going through
+//all the files is remembered until something about the loaded DBC files changes.
+DBC_MESSAGE* DBCHandler::resolveMessage(uint32_t id, int bus)
+{
+    QMutexLocker locker(&resolveLock);
+
+    int revision = DBCMessageHandler::revision();
+    if (revision != resolveRevision)
+    {
+        resolveCache.clear();
+        resolveRevision = revision;
+    }
+
+    quint64 key = (static_cast<quint64>(static_cast<uint32_t>(bus)) << 32) | id;
+    QHash<quint64, DBC_MESSAGE*>::const_iterator it = resolveCache.constFind(key);
+    if (it != resolveCache.constEnd()) return it.value();
+
+    DBC_MESSAGE *found = nullptr;
     for(int i = 0; i < loadedFiles.count(); i++)
     {
-        DBC_MESSAGE* msg = loadedFiles[i].messageHandler->findMsgByID(id);
-        if (msg != nullptr)
+        if (bus == -1 || loadedFiles[i].getAssocBus() == -1 || bus == loadedFiles[i].getAssocBus())
         {
-            return msg;
+            found = loadedFiles[i].messageHandler->findMsgByID(id);
+            if (found != nullptr) break;
         }
     }
-    return nullptr;
+    resolveCache.insert(key, found);
+    return found;
 }
 
 // This function won't care which bus the DBC file is associated, but will return any message as long as ID matches and the file
@@ -2333,15 +2398,23 @@ DBCFile* DBCHandler::getFileByName(QString name)
 
 DBCHandler::DBCHandler()
 {
+    resolveRevision = -1;
+
     // Load previously saved DBC file settings
     QSettings settings;
     qDebug() <<"Settings file: " << settings.fileName();
     int filecount = settings.value("DBC/FileCount", 0).toInt();
     qDebug() << "Previously loaded DBC file count: " << filecount;
+    QStringList filenames;
+    for (int i=0; i<filecount; i++)
+    {
+        filenames.append(settings.value("DBC/Filename_" + QString::number(i),"").toString());
+    }
+    QList<DBCFile*> files = loadDBCFiles(filenames);
     for (int i=0; i<filecount; i++)
     {
-        QString filename = settings.value("DBC/Filename_" + QString::number(i),"").toString();
-        DBCFile * file = loadDBCFile(filename);
+        QString filename = filenames[i];
+        DBCFile * file = files[i];
         if (file)
         {
             int bus = settings.value("DBC/AssocBus_" + QString::number(i),0).toInt();
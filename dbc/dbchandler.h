@@ -2,6 +2,9 @@
 #define DBCHANDLER_H
 
 #include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QAtomicInt>
 #include "dbc_classes.h"
 #include "can_structs.h"
 
@@ -56,11 +59,40 @@ public:
     void setFilterLabeling( bool labelFiltering );
     bool filterLabeling();
     void sort();
+    void rebuildIndex();
+
+    //Goes up whenever any message handler changes in a way that could change what an ID resolves to,
+    //and whenever a DBC file gets edited. DBCHandler's lookup cache and the multiplex tables of the
+    //messages compare it to know when they're stale.
+    static int revision() { return revisionCounter.loadAcquire(); }
+    static void touch() { revisionCounter.ref(); }
 
 private:
+    void indexMessage(int idx);
+
     QList<DBC_MESSAGE> messages;
     MatchingCriteria_t matchingCriteria;
     bool filterLabelingEnabled;
+
+    //Row of the message for each way findMsgByID can match. Rebuilt whenever messages are added, removed,
+    //reordered or change their ID (editors call rebuildIndex for that last one).
+    QHash<uint32_t, int> idIndex; //exact ID, first message wins like it always did
+    QHash<uint32_t, int> pdu1Index; //J1939 PDU1, ID & 0x3FF0000, last message wins
+    QHash<uint32_t, int> pdu2Index; //J1939 PDU2, ID & 0x3FFFF00, last message wins
+    QHash<uint32_t, int> arbIdIndex; //GMLAN arbitration ID, ID & 0x3FFE000, last message wins
+
+    static QAtomicInt revisionCounter;
+};
+
+//Message colors for files that don't set their own. They come from the palette which only the GUI
+//thread may read, so loading on other threads gets them handed in.
+class DBCDefaultColors
+{
+public:
+    QColor background;
+    QColor foreground;
+
+    static DBCDefaultColors fromPalette(); //GUI thread only
 };
 
 //technically there should be a node handler too but I'm sort of treating nodes as second class
@@ -80,6 +112,8 @@ public:
     void findAttributesByType(DBC_ATTRIBUTE_TYPE typ, QList<DBC_ATTRIBUTE> *list);
     bool saveFile(QString);
     bool loadFile(QString);
+    bool loadFile(QString fileName, const DBCDefaultColors &colors, int &numMsgFaults, int &numSigFaults); //no GUI, can run in any thread
+    void reportLoadFaults(int numMsgFaults, int numSigFaults);
     QString getFullFilename();
     QString getFilename();
     QString getFilenameNoExt();
@@ -95,6 +129,8 @@ public:
     QList<DBC_NODE> dbc_nodes;
     QList<DBC_ATTRIBUTE> dbc_attributes;
 private:
+    friend class DBCCache; //restores everything loadFile would have set
+
     QString fileName;
     QString filePath;
     int assocBuses; //-1 = all buses, 0 = first bus, 1 = second bus, etc.
@@ -116,6 +152,7 @@ class DBCHandler: public QObject
     Q_OBJECT
 public:
     DBCFile* loadDBCFile(QString filename);
+    QList<DBCFile*> loadDBCFiles(const QStringList &filenames);
     DBCFile* loadDBCFile(int);
     void saveDBCFile(int);
     void removeDBCFile(int);
@@ -138,6 +175,13 @@ public:
 private:
     QList<DBCFile> loadedFiles;
 
+    //(bus, id) -> message as findMessage last resolved it, misses included. Thrown away as soon as
+    //DBCMessageHandler::revision() moves. Bus -1 holds the bus agnostic lookups.
+    QHash<quint64, DBC_MESSAGE*> resolveCache;
+    int resolveRevision;
+    QMutex resolveLock;
+
+    DBC_MESSAGE* resolveMessage(uint32_t id, int bus);
     DBCHandler();
     static DBCHandler *instance;
 };
@@ -0,0 +1,153 @@
+#include "dbclineparser.h"
+
+#include <QLocale>
+#include <QStringView>
+
+namespace
+{
+
+//walks a line one token at a time. Every token function either consumes what it was asked for and
+//returns true or returns false with nothing consumed
+class LineScanner
+{
+public:
+    explicit LineScanner(const QString &line) : str(line), pos(0) {}
+
+    QChar peek() const { return (pos < str.length()) ? str.at(pos) : QChar(); }
+
+    bool character(char c)
+    {
+        if (peek() != QLatin1Char(c)) return false;
+        pos++;
+        return true;
+    }
+
+    bool literal(const char *text)
+    {
+        int len = static_cast<int>(qstrlen(text));
+        //Qt 5's QStringView::mid doesn't clamp like QString::mid does
+        if (str.length() - pos < len || QStringView(str).mid(pos, len) != QLatin1String(text, len)) return false;
+        pos += len;
+        return true;
+    }
+
+    void skipSpaces()
+    {
+        while (peek() == QLatin1Char(' ')) pos++;
+    }
+
+    bool word(QStringView &out) { return run(out, isWordChar); }                  // \w+
+    bool name(QStringView &out) { return run(out, isNameChar); }                  // [-\w]+
+    bool digits(QStringView &out) { return run(out, isDigitChar); }              // \d+
+    bool number(QStringView &out) { return run(out, isNumberChar); }             // [0-9.+\-eE]+
+
+    const QString &str;
+    int pos;
+
+private:
+    template <typename Pred> bool run(QStringView &out, Pred pred)
+    {
+        int start = pos;
+        while (pos < str.length() && pred(str.at(pos))) pos++;
+        if (pos == start) return false;
+        out = QStringView(str).mid(start, pos - start);
+        return true;
+    }
+
+    //the same classes the regular expressions used. \w and \d are Unicode aware there too
+    static bool isWordChar(QChar c) { return c.isLetterOrNumber() || c == QLatin1Char('_'); }
+    static bool isNameChar(QChar c) { return isWordChar(c) || c == QLatin1Char('-'); }
+    static bool isDigitChar(QChar c) { return c.isDigit(); }
+    static bool isNumberChar(QChar c)
+    {
+        ushort u = c.unicode();
+        return (u >= '0' && u <= '9') || u == '.' || u == '+' || u == '-' || u == 'e' || u == 'E';
+    }
+};
+
+}
+
+//^BO\_ (\w+) ([-\w]+) *: (\w+) ([-\w]+)
+bool DBCLineParser::parseMessage(const QString &line, DBCMessageLine &out)
+{
+    LineScanner s(line);
+    QStringView id, name, len, sender;
+
+    if (!s.literal("BO_ ") || !s.word(id) || !s.character(' ') || !s.name(name)) return false;
+    s.skipSpaces();
+    if (!s.character(':') || !s.character(' ') || !s.word(len) || !s.character(' ') || !s.name(sender)) return false;
+
+    //QStringView only got its own number conversions in Qt 6, the C locale ones work on both
+    const QLocale c = QLocale::c();
+    out.rawID = static_cast<uint32_t>(c.toULongLong(id));
+    out.name = name.toString();
+    out.len = c.toUInt(len);
+    out.sender = sender.toString();
+    return true;
+}
+
+//One pass covers all four forms the loader used to try one after another:
+//^SG\_ *([-\w]+) +M *: ...         multiplexor
+//^SG\_ *([-\w]+) +m(\d+) *: ...    multiplexed
+//^SG\_ *([-\w]+) +m(\d+)M *: ...   extended multiplexing, multiplexed and multiplexor at once
+//^SG\_ *([-\w]+) *: ...            plain signal
+//followed by (\d+)\|(\d+)@(\d+)([\+|\-]) \((num),(num)\) \[(num)\|(num)\] \"(.*)\" (.*)
+bool DBCLineParser::parseSignal(const QString &line, DBCSignalLine &out)
+{
+    LineScanner s(line);
+    QStringView name, mux, start, size, order, factor, bias, min, max;
+
+    if (!s.literal("SG_")) return false;
+    s.skipSpaces();
+    if (!s.name(name)) return false;
+
+    out.isMultiplexor = false;
+    out.isMultiplexed = false;
+    out.multiplexValue = 0;
+
+    //the multiplex markers need at least one space between them and the name
+    int nameEnd = s.pos;
+    s.skipSpaces();
+    if (s.pos > nameEnd && s.character('M'))
+    {
+        out.isMultiplexor = true;
+        s.skipSpaces();
+    }
+    else if (s.pos > nameEnd && s.character('m'))
+    {
+        if (!s.digits(mux)) return false;
+        out.isMultiplexed = true;
+        out.multiplexValue = QLocale::c().toInt(mux);
+        if (s.character('M')) out.isMultiplexor = true;
+        s.skipSpaces();
+    }
+    if (!s.character(':')) return false;
+    s.skipSpaces();
+
+    if (!s.digits(start) || !s.character('|') || !s.digits(size) || !s.character('@') || !s.digits(order)) return false;
+    QChar sign = s.peek();
+    if (sign != QLatin1Char('+') && sign != QLatin1Char('-') && sign != QLatin1Char('|')) return false;
+    s.pos++;
+
+    if (!s.literal(" (") || !s.number(factor) || !s.character(',') || !s.number(bias) || !s.literal(") [")) return false;
+    if (!s.number(min) || !s.character('|') || !s.number(max) || !s.literal("] \"")) return false;
+
+    //the unit runs to the last quote that is followed by a space, whatever is after that are the receivers
+    int unitStart = s.pos;
+    int unitEnd = line.lastIndexOf(QLatin1String("\" "));
+    if (unitEnd < unitStart) return false;
+
+    const QLocale c = QLocale::c();
+    out.name = name.toString();
+    out.startBit = c.toInt(start);
+    out.signalSize = c.toInt(size);
+    out.valueType = c.toInt(order);
+    out.isSigned = (sign != QLatin1Char('+'));
+    out.factor = c.toDouble(factor);
+    out.bias = c.toDouble(bias);
+    out.min = c.toDouble(min);
+    out.max = c.toDouble(max);
+    out.unitName = line.mid(unitStart, unitEnd - unitStart);
+    out.receivers = line.mid(unitEnd + 2);
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef DBCLINEPARSER_H
+#define DBCLINEPARSER_H
+
+#include <QString>
+#include <stdint.h>
+
+/*
+ * Hand written parsers for the two line types that make up nearly all of a DBC file, BO_ and SG_.
+ * They take the line after QString::simplified() just like the rest of DBCFile::loadFile and accept
+ * exactly what the regular expressions they replaced accepted, with the same text coming out of each
+ * field (test/tst_dbcparser checks this against the old expressions for every line in examples/).
+ * Nothing is allocated apart from the strings that are returned.
+ */
+
+//BO_ <id> <name>: <length> <sender>
+class DBCMessageLine
+{
+public:
+    uint32_t rawID; //as written, so the extended flag is still in bit 31
+    QString name;
+    uint32_t len;
+    QString sender;
+};
+
+//SG_ <name> [M|m<n>|m<n>M] : <start>|<size>@<order><sign> (<factor>,<offset>) [<min>|<max>] "<unit>" <receivers>
+class DBCSignalLine
+{
+public:
+    QString name;
+    bool isMultiplexor;  //M or m<n>M
+    bool isMultiplexed;  //m<n> or m<n>M
+    int multiplexValue;
+    int startBit;
+    int signalSize;
+    int valueType;       //the digit after the @. 0/1 are big/little endian ints, 2 and up are the SavvyCAN float/string extensions
+    bool isSigned;       //anything but a +
+    double factor;
+    double bias;
+    double min;
+    double max;
+    QString unitName;
+    QString receivers;   //everything after the unit, possibly a comma separated list
+};
+
+class DBCLineParser
+{
+public:
+    static bool parseMessage(const QString &line, DBCMessageLine &out);
+    static bool parseSignal(const QString &line, DBCSignalLine &out);
+};
+
+#endif // DBCLINEPARSER_H
@@ -7,7 +7,7 @@
 #include "helpwindow.h"
 #include "connections/canconmanager.h"
 
-DBCLoadSaveWindow::DBCLoadSaveWindow(const QVector<CANFrame> *frames, QWidget *parent) :
+DBCLoadSaveWindow::DBCLoadSaveWindow(const CANFrameStore *frames, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::DBCLoadSaveWindow)
 {
@@ -153,7 +153,7 @@ void DBCLoadSaveWindow::newFile()
 
 void DBCLoadSaveWindow::loadFile()
 {
-    DBCFile *file = nullptr;
+    QList<DBCFile*> files;
     QString filename;
     QFileDialog dialog;
     QSettings settings;
@@ -164,7 +164,7 @@ void DBCLoadSaveWindow::loadFile()
     filters.append(QString(tr("Secret CSV Signal Defs (*.csv)")));
 
     dialog.setDirectory(settings.value("DBC/LoadSaveDirectory", dialog.directory().path()).toString());
-    dialog.setFileMode(QFileDialog::ExistingFile);
+    dialog.setFileMode(QFileDialog::ExistingFiles);
     dialog.setNameFilters(filters);
     dialog.setViewMode(QFileDialog::Detail);
 
@@ -176,22 +176,30 @@ void DBCLoadSaveWindow::loadFile()
 
         if (dialog.selectedNameFilter() == filters[0])
         {
-            if (!filename.contains('.')) filename += ".dbc";
-            file = dbcHandler->loadDBCFile(filename);
+            //several DBC files can be picked at once, they get parsed in parallel
+            QStringList filenames = dialog.selectedFiles();
+            for (int i = 0; i < filenames.count(); i++)
+            {
+                if (!filenames[i].contains('.')) filenames[i] += ".dbc";
+            }
+            files = dbcHandler->loadDBCFiles(filenames);
         }
         if (dialog.selectedNameFilter() == filters[1])
         {
             if (!filename.contains('.')) filename += ".json";
-            file = dbcHandler->loadJSONFile(filename);
+            files.append(dbcHandler->loadJSONFile(filename));
         }
         if (dialog.selectedNameFilter() == filters[2])
         {
             if (!filename.contains('.')) filename += ".csv";
-            file = dbcHandler->loadSecretCSVFile(filename);
+            files.append(dbcHandler->loadSecretCSVFile(filename));
         }
     }
 
-    if(file) {
+    bool addedAny = false;
+    foreach (DBCFile *file, files)
+    {
+        if (!file) continue;
         inhibitCellProcessing=true;
         int idx = ui->tableFiles->rowCount();
         ui->tableFiles->insertRow(ui->tableFiles->rowCount());
@@ -217,9 +225,10 @@ void DBCLoadSaveWindow::loadFile()
             item->setCheckState(Qt::Unchecked);
         }
         inhibitCellProcessing=false;
-
-        updateSettings();
+        addedAny = true;
     }
+
+    if (addedAny) updateSettings();
 }
 
 void DBCLoadSaveWindow::loadJSON()
@@ -36,6 +36,7 @@ DBCMessageEditor::DBCMessageEditor(QWidget *parent) :
             if (suppressEditCallbacks) return;
             if ((dbcMessage->ID & 0x1FFFFFFFul) != Utility::ParseStringToNum(ui->lineFrameID->text())) dbcFile->setDirtyFlag();
             dbcMessage->ID = Utility::ParseStringToNum(ui->lineFrameID->text());
+            dbcFile->messageHandler->rebuildIndex(); //lookups by ID have to find it under the new one
             emit updatedTreeInfo(dbcMessage);
         });
 
@@ -684,6 +684,9 @@ void DBCSignalEditor::refreshBitGrid()
 {
     unsigned char bitpattern[64];
 
+    //every edit to where the signal sits or what type it is ends up redrawing the grid
+    if (currentSignal) currentSignal->compile();
+
     memset(bitpattern, 0, 64); //clear it out
     ui->bitfield->setReference(bitpattern, false);
     ui->bitfield->updateData(bitpattern, true);
@@ -909,6 +912,7 @@ void DBCSignalEditor::popFromUndoBuffer()
     undoBuffer.pop_back();
     currentSignal = sig.self; //restore the pointer
     *currentSignal = sig; //write the contents into the memory pointed to
+    DBCMessageHandler::touch(); //multiplexing might have changed back
 
     fillSignalForm(currentSignal);
     fillValueTable(currentSignal);
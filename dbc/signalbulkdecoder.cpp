@@ -0,0 +1,147 @@
+#include "signalbulkdecoder.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BULKDECODE_SSE2
+#endif
+
+SignalBulkDecoder::SignalBulkDecoder(const DBC_SIGNAL *sig)
+{
+    valType = sig->valType;
+    factor = sig->factor;
+    offset = sig->bias;
+
+    int size = sig->signalSize;
+    if (valType == SP_FLOAT) size = 32;
+    else if (valType == DP_FLOAT) size = 64;
+    extractor.compile(sig->startBit, size, sig->intelByteOrder, valType == SIGNED_INT);
+    fitsInt32 = (valType == UNSIGNED_INT && size < 32) || (valType == SIGNED_INT && size <= 32);
+
+    setMultiplexFilter(sig);
+}
+
+SignalBulkDecoder::SignalBulkDecoder(int startBit, int numBits, bool intelFormat, bool isSigned, double scale, double bias)
+{
+    valType = isSigned ? SIGNED_INT : UNSIGNED_INT;
+    factor = scale;
+    offset = bias;
+    extractor.compile(startBit, numBits, intelFormat, isSigned);
+    fitsInt32 = (numBits < 32) || (isSigned && numBits == 32);
+    muxSignal = nullptr;
+}
+
+QVector<uint32_t> SignalBulkDecoder::collectRows(const CANFrameStore &frames, uint32_t id, int bus, int stride, int first, int last)
+{
+    QVector<uint32_t> rows;
+    if (last < 0 || last >= frames.count()) last = frames.count() - 1;
+    if (first < 0) first = 0;
+    if (stride < 1) stride = 1;
+
+    int matched = 0;
+    CANFrameScanner scan(frames, first, last);
+    scan.setIdFilter(id);
+    while (scan.next())
+    {
+        CANFrameView view = scan.frame();
+        if (view.frameType() != QCanBusFrame::DataFrame) continue;
+        if (bus != -1 && view.bus() != bus) continue;
+        if ((matched++ % stride) == 0) rows.append(static_cast<uint32_t>(scan.row()));
+    }
+    return rows;
+}
+
+int SignalBulkDecoder::decode(const CANFrameStore &frames, const QVector<uint32_t> &rows, QVector<double> &times,
+                              QVector<double> &values, QVector<int64_t> *raw) const
+{
+    int numRows = rows.count();
+    times.resize(numRows);
+    values.resize(numRows);
+
+    if (valType == STRING)
+    {
+        times.clear();
+        values.clear();
+        if (raw) raw->clear();
+        return 0;
+    }
+
+    //integers that fit 32 bits are gathered narrow so the scaling pass can convert four at a time
+    bool narrow = fitsInt32 && !raw && (valType == SIGNED_INT || valType == UNSIGNED_INT);
+    QVector<int32_t> raw32;
+    QVector<int64_t> raw64;
+    QVector<int64_t> &wide = raw ? *raw : raw64;
+    if (narrow) raw32.resize(numRows);
+    else wide.resize(numRows);
+
+    //a paged store is read a block at a time by the scanner, never through view() and the page cache
+    //the grid shares. Blocks none of the rows are in don't get decoded at all.
+    double *timeOut = times.data();
+    int numOut = 0;
+    CANFrameScanner scan(frames, numRows ? static_cast<int>(rows[0]) : 0);
+    for (int i = 0; i < numRows; i++)
+    {
+        if (!scan.seek(static_cast<int>(rows[i]))) break;
+        CANFrameView view = scan.frame();
+        if (!acceptsLength(view.length())) continue;
+        if (muxSignal && !muxSignal->isSignalInPayload(view.data(), view.length())) continue;
+        timeOut[numOut] = static_cast<double>(view.timestamp());
+        int64_t bits = extractor.extract(view.data(), view.length());
+        if (narrow) raw32[numOut] = static_cast<int32_t>(bits);
+        else wide[numOut] = bits;
+        numOut++;
+    }
+
+    times.resize(numOut);
+    values.resize(numOut);
+    if (!narrow) wide.resize(numOut);
+
+    if (narrow) scale(raw32.constData(), values.data(), numOut, factor, offset);
+    else if (valType == SP_FLOAT)
+    {
+        for (int i = 0; i < numOut; i++)
+        {
+            uint32_t bits = static_cast<uint32_t>(wide[i]);
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            values[i] = (f * factor) + offset;
+        }
+    }
+    else if (valType == DP_FLOAT)
+    {
+        for (int i = 0; i < numOut; i++)
+        {
+            double d;
+            memcpy(&d, &wide[i], sizeof(d));
+            values[i] = (d * factor) + offset;
+        }
+    }
+    else scale(wide.constData(), values.data(), numOut, factor, offset);
+
+    return numOut;
+}
+
+void SignalBulkDecoder::scale(const int32_t *in, double *out, int count, double scale, double bias)
+{
+    int i = 0;
+#ifdef BULKDECODE_SSE2
+    const __m128d mul = _mm_set1_pd(scale);
+    const __m128d add = _mm_set1_pd(bias);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i ints = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        __m128d lo = _mm_cvtepi32_pd(ints);
+        __m128d hi = _mm_cvtepi32_pd(_mm_shuffle_epi32(ints, _MM_SHUFFLE(1, 0, 3, 2)));
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(lo, mul), add));
+        _mm_storeu_pd(out + i + 2, _mm_add_pd(_mm_mul_pd(hi, mul), add));
+    }
+#endif
+    for (; i < count; i++) out[i] = (in[i] * scale) + bias;
+}
+
+void SignalBulkDecoder::scale(const int64_t *in, double *out, int count, double scale, double bias)
+{
+    //no SSE2 instruction converts 64 bit integers, the compiler does as well as anything here
+    for (int i = 0; i < count; i++) out[i] = (in[i] * scale) + bias;
+}
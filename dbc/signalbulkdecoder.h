@@ -0,0 +1,54 @@
+#ifndef SIGNALBULKDECODER_H
+#define SIGNALBULKDECODER_H
+
+#include <QVector>
+#include <stdint.h>
+#include "dbc_classes.h"
+#include "canframestore.h"
+#include "utils/signalextractor.h"
+
+/*
+ * Decodes one signal out of a whole run of captured frames at once, straight from the packed records
+ * of a CANFrameStore so no CANFrame ever gets built. The raw bits of every frame are gathered into one
+ * contiguous array first and then scaled in a separate tight loop (SSE2 on x86, plain C++ anywhere
+ * else). The time and value arrays that come out can go to QCPGraph::setData as they are.
+ */
+class SignalBulkDecoder
+{
+public:
+    //decode a DBC signal, multiplexed signals skip the frames they aren't in
+    explicit SignalBulkDecoder(const DBC_SIGNAL *sig);
+    //decode a plain bit range as an integer, value = raw * scale + bias
+    SignalBulkDecoder(int startBit, int numBits, bool intelFormat, bool isSigned, double scale, double bias);
+
+    //only keep frames that carry this (multiplexed) signal. nullptr keeps every frame
+    void setMultiplexFilter(const DBC_SIGNAL *sig) { muxSignal = (sig && sig->isMultiplexed) ? sig : nullptr; }
+    //whether a payload of len bytes gets decoded at all, DBC_SIGNAL::decode turns down doubles in short frames too
+    bool acceptsLength(int len) const { return valType != DP_FLOAT || len >= 8; }
+
+    //Rows of data frames with the given ID on the given bus (-1 for any) from first to last inclusive.
+    //Every stride'th match is kept, handy for thinning out huge captures.
+    static QVector<uint32_t> collectRows(const CANFrameStore &frames, uint32_t id, int bus = -1,
+                                         int stride = 1, int first = 0, int last = -1);
+
+    //Fills times (microseconds) and values for the frames at the given rows, which have to be in
+    //ascending order like collectRows returns them. If raw is given it gets the unscaled integers too
+    //(what value tables are looked up with). Everything is resized to the number of points decoded
+    //which is also returned.
+    int decode(const CANFrameStore &frames, const QVector<uint32_t> &rows, QVector<double> &times,
+               QVector<double> &values, QVector<int64_t> *raw = nullptr) const;
+
+    //the scaling step on its own, out[i] = in[i] * scale + bias
+    static void scale(const int32_t *in, double *out, int count, double scale, double bias);
+    static void scale(const int64_t *in, double *out, int count, double scale, double bias);
+
+private:
+    SignalExtractor extractor;
+    DBC_SIG_VAL_TYPE valType;
+    double factor;
+    double offset;
+    bool fitsInt32; //every raw value fits an int32 which is what the SIMD conversion handles
+    const DBC_SIGNAL *muxSignal;
+};
+
+#endif // SIGNALBULKDECODER_H
@@ -0,0 +1,146 @@
+#include "signalstore.h"
+
+#include <algorithm>
+#include <QtMath>
+#include "dbchandler.h"
+#include "signalbulkdecoder.h"
+
+static const int DEFAULT_MAX_POINTS = 20000000; //about 480MB of decoded points across all series
+
+DBC_SIGNAL_VALUE SignalSeries::signalValue(const DBC_SIGNAL *sig, double value)
+{
+    DBC_SIGNAL_VALUE val;
+    val.value = value;
+    val.intValue = static_cast<int64_t>(val.value);
+    val.isInteger = (sig->valType == SIGNED_INT || sig->valType == UNSIGNED_INT) && (sig->factor == qFloor(sig->factor));
+    return val;
+}
+
+SignalStore::SignalStore(const CANFrameStore *frames, const QHash<uint32_t, QVector<uint32_t>> *idRows)
+{
+    this->frames = frames;
+    this->idRows = idRows;
+    cache.setMaxCost(DEFAULT_MAX_POINTS);
+    dbcRevision = DBCMessageHandler::revision();
+}
+
+SignalSeries SignalStore::series(const DBC_SIGNAL *sig, int bus)
+{
+    if (!sig || !sig->parentMessage || sig->valType == STRING) return SignalSeries();
+
+    int rev = DBCMessageHandler::revision();
+    if (rev != dbcRevision)
+    {
+        cache.clear();
+        dbcRevision = rev;
+    }
+
+    //taken out and put back so the cost follows the number of points and it counts as recently used
+    SeriesKey key(sig, bus);
+    SignalSeries *stored = cache.take(key);
+    if (!stored) stored = new SignalSeries;
+    catchUp(*stored, sig, bus);
+
+    SignalSeries result = *stored;
+    cache.insert(key, stored, qMax(1, stored->count()));
+    return result;
+}
+
+void SignalStore::reset()
+{
+    cache.clear();
+}
+
+void SignalStore::catchUp(SignalSeries &series, const DBC_SIGNAL *sig, int bus)
+{
+    uint64_t firstSeq = frames->firstSequence();
+    int stale = static_cast<int>(std::lower_bound(series.sequences.constBegin(), series.sequences.constEnd(), firstSeq)
+                                 - series.sequences.constBegin());
+    if (stale > 0) dropFirst(series, stale);
+    if (series.nextSequence < firstSeq) series.nextSequence = firstSeq;
+
+    uint64_t endSeq = firstSeq + static_cast<uint64_t>(frames->count());
+    if (series.nextSequence >= endSeq) return;
+
+    //only the rows of this ID past the last one already looked at
+    uint32_t startRow = static_cast<uint32_t>(series.nextSequence - firstSeq);
+    //the multiplex and length checks all happen here so every row kept turns into exactly one point
+    SignalBulkDecoder decoder(sig);
+    decoder.setMultiplexFilter(nullptr);
+    QVector<uint32_t> rows;
+    auto wanted = [sig, bus, &decoder](const CANFrameView &view)
+    {
+        if (view.frameType() != QCanBusFrame::DataFrame) return false;
+        if (bus != -1 && view.bus() != bus) return false;
+        if (!decoder.acceptsLength(view.length())) return false;
+        return !sig->isMultiplexed || sig->isSignalInPayload(view.data(), view.length());
+    };
+    if (frames->isPaged())
+    {
+        //no per ID row lists for a streamed file, the scanner skips the blocks the ID isn't in instead
+        CANFrameScanner scan(*frames, static_cast<int>(startRow));
+        scan.setIdFilter(sig->parentMessage->ID);
+        while (scan.next())
+        {
+            if (wanted(scan.frame())) rows.append(static_cast<uint32_t>(scan.row()));
+        }
+    }
+    else
+    {
+        const QVector<uint32_t> idList = idRows->value(sig->parentMessage->ID);
+        QVector<uint32_t>::const_iterator it = std::lower_bound(idList.constBegin(), idList.constEnd(), startRow);
+        rows.reserve(static_cast<int>(idList.constEnd() - it));
+        for (; it != idList.constEnd(); ++it)
+        {
+            if (wanted(frames->view(static_cast<int>(*it)))) rows.append(*it);
+        }
+    }
+    series.nextSequence = endSeq;
+    if (rows.isEmpty()) return;
+
+    bool wantRuns = !sig->valList.isEmpty();
+    QVector<double> times, values;
+    QVector<int64_t> raw;
+    int numPoints = decoder.decode(*frames, rows, times, values, wantRuns ? &raw : nullptr);
+
+    int base = series.count();
+    series.times += times;
+    series.values += values;
+    series.sequences.reserve(base + numPoints);
+    for (int i = 0; i < numPoints; i++) series.sequences.append(firstSeq + rows[i]);
+
+    if (wantRuns)
+    {
+        for (int i = 0; i < numPoints; i++)
+        {
+            if (!series.runs.isEmpty() && series.runs.last().rawValue == raw[i]) series.runs.last().numPoints++;
+            else
+            {
+                SignalStateRun run;
+                run.rawValue = raw[i];
+                run.firstPoint = base + i;
+                run.numPoints = 1;
+                series.runs.append(run);
+            }
+        }
+    }
+}
+
+void SignalStore::dropFirst(SignalSeries &series, int num)
+{
+    series.times.remove(0, num);
+    series.values.remove(0, num);
+    series.sequences.remove(0, num);
+
+    QVector<SignalStateRun> runs;
+    foreach (SignalStateRun run, series.runs)
+    {
+        int end = run.firstPoint + run.numPoints;
+        if (end <= num) continue;
+        int start = qMax(run.firstPoint, num);
+        run.firstPoint = start - num;
+        run.numPoints = end - start;
+        runs.append(run);
+    }
+    series.runs = runs;
+}
@@ -0,0 +1,73 @@
+#ifndef SIGNALSTORE_H
+#define SIGNALSTORE_H
+
+#include <QCache>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+#include <stdint.h>
+#include "dbc_classes.h"
+#include "canframestore.h"
+
+//consecutive points of a value table signal that all have the same raw value
+class SignalStateRun
+{
+public:
+    int64_t rawValue;
+    int firstPoint;
+    int numPoints;
+};
+
+class SignalSeries
+{
+public:
+    SignalSeries() : nextSequence(0) {}
+    int count() const { return times.count(); }
+    //a decoded value in the form formatValue takes, the way decode would have produced it
+    static DBC_SIGNAL_VALUE signalValue(const DBC_SIGNAL *sig, double value);
+
+    QVector<double> times;        //microseconds, as the frames have them
+    QVector<double> values;       //scaled
+    QVector<uint64_t> sequences;  //CANFrameStore sequence number of the frame each point came from
+    QVector<SignalStateRun> runs; //only filled for signals with a value table
+    uint64_t nextSequence;        //first frame that hasn't been looked at yet
+};
+
+/*
+ * Decoded values of DBC signals over the whole capture, kept per (signal, bus) so every window that
+ * wants a signal shares one decode of it. A series is built the first time anyone asks for it and
+ * after that only the frames that arrived since the last request get decoded. Frames evicted from
+ * the front of the capture take their points with them. Editing or loading DBC files throws every
+ * series away since the signals they were decoded with might not exist any more.
+ *
+ * The store belongs to CANFrameModel and decodes straight out of its frames using its per ID row
+ * index, so it must only be used from the GUI thread. Series nobody has asked for in a while are
+ * dropped first once the total number of points goes over the limit.
+ * String signals have no numeric values and always come back empty.
+ */
+class SignalStore
+{
+public:
+    SignalStore(const CANFrameStore *frames, const QHash<uint32_t, QVector<uint32_t>> *idRows);
+
+    //Every point of sig on bus (-1 for any bus) up to the newest frame. The returned series shares its
+    //data with the store so getting it is cheap. Copy what's needed out of it and let it go, holding on
+    //to it makes the next update copy the whole series.
+    SignalSeries series(const DBC_SIGNAL *sig, int bus = -1);
+    //frames were rewritten in place (normalized timestamps), everything has to be decoded again
+    void reset();
+    void setMaxPoints(int maxPoints) { cache.setMaxCost(maxPoints); }
+
+private:
+    typedef QPair<const DBC_SIGNAL *, int> SeriesKey;
+
+    void catchUp(SignalSeries &series, const DBC_SIGNAL *sig, int bus);
+    static void dropFirst(SignalSeries &series, int num);
+
+    const CANFrameStore *frames;
+    const QHash<uint32_t, QVector<uint32_t>> *idRows;
+    QCache<SeriesKey, SignalSeries> cache; //cost is the number of points
+    int dbcRevision;
+};
+
+#endif // SIGNALSTORE_H
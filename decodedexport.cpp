@@ -0,0 +1,566 @@
+#include "decodedexport.h"
+
+#include <QApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QMutex>
+#include <QProgressDialog>
+#include <QSaveFile>
+#include <QSet>
+#include <QThread>
+#include <QWaitCondition>
+#include <cmath>
+#include <limits>
+#include "utility.h"
+
+static const int FRAMES_PER_CHUNK = 20000;
+
+//rounds towards negative infinity, timestamps can be negative after normalizing
+static int64_t floorDiv(int64_t value, int64_t divisor)
+{
+    int64_t result = value / divisor;
+    if ((value % divisor) != 0 && (value < 0)) result--;
+    return result;
+}
+
+//findMessage takes a lock every call, each chunk keeps its own answers instead
+static DBC_MESSAGE *lookupMessage(DBCHandler *dbcHandler, QHash<quint64, DBC_MESSAGE *> &lookup, const CANFrameView &view)
+{
+    //error frames all have ID 0, the frame type keeps them apart from real ID 0 frames
+    quint64 key = (static_cast<quint64>(view.frameType()) << 40) | (static_cast<quint64>(static_cast<uint32_t>(view.bus())) << 32) | view.frameId();
+    QHash<quint64, DBC_MESSAGE *>::const_iterator it = lookup.constFind(key);
+    if (it != lookup.constEnd()) return it.value();
+    DBC_MESSAGE *msg = dbcHandler->findMessage(view.toCANFrame());
+    lookup.insert(key, msg);
+    return msg;
+}
+
+DecodedExport::DecodedExport(const CANFrameStore *frames, DBCHandler *dbcHandler)
+{
+    this->frames = frames;
+    this->dbcHandler = dbcHandler;
+    progress = nullptr;
+    absTime = false;
+    interval = 10000;
+    numChunks = 0;
+    format = TEXT;
+    firstTick = 0;
+}
+
+bool DecodedExport::exportFile(const QString &filename, Format format)
+{
+    this->format = format;
+    numChunks = (frames->count() + FRAMES_PER_CHUNK - 1) / FRAMES_PER_CHUNK;
+
+    QSaveFile outFile(filename);
+    QIODevice::OpenMode mode = QIODevice::WriteOnly;
+    if (format != RESAMPLED_COLUMNS) mode |= QIODevice::Text;
+    if (!outFile.open(mode)) return false;
+
+    QProgressDialog progressDialog(qApp->activeWindow());
+    progressDialog.setWindowModality(Qt::ApplicationModal);
+    progressDialog.setLabelText(tr("Exporting decoded frames..."));
+    progressDialog.setMinimumDuration(0);
+    progressDialog.setRange(0, qMax(1, numChunks * ((format == TEXT) ? 1 : 2)));
+    progressDialog.setValue(0);
+    progress = &progressDialog;
+
+    auto writeOut = [&outFile](const QByteArray &data) { return outFile.write(data) == data.size(); };
+    bool ok;
+
+    if (format == TEXT)
+    {
+        ok = runChunks([this](int chunk) { return textChunk(chunk); }, writeOut);
+    }
+    else
+    {
+        //first pass finds every message and, for resampling, the time range and the last values in each chunk
+        QVector<ChunkSummary> summaries(numChunks);
+        ChunkSummary *summaryOut = summaries.data();
+        ok = runChunks([this, summaryOut](int chunk) { summaryOut[chunk] = scanChunk(chunk); return QByteArray(); },
+                       [](const QByteArray &) { return true; });
+
+        QVector<QPair<DBC_MESSAGE *, int>> messages;
+        QSet<DBC_MESSAGE *> seen;
+        for (int c = 0; c < summaries.count(); c++)
+        {
+            for (int m = 0; m < summaries[c].firstRows.count(); m++)
+            {
+                if (seen.contains(summaries[c].firstRows[m].first)) continue;
+                seen.insert(summaries[c].firstRows[m].first);
+                messages.append(summaries[c].firstRows[m]);
+            }
+        }
+
+        if (ok && format == CSV)
+        {
+            QHash<uint32_t, int> startColumns;
+            ok = writeOut(csvHeader(messages, startColumns));
+            ok = ok && runChunks([this, &startColumns](int chunk) { return csvChunk(chunk, startColumns); }, writeOut);
+        }
+        else if (ok)
+        {
+            //a column for every numeric signal of every message that turned up, in the order they did
+            columns.clear();
+            messageColumns.clear();
+            for (int m = 0; m < messages.count(); m++)
+            {
+                DBC_MESSAGE *msg = messages[m].first;
+                for (int j = 0; j < msg->sigHandler->getCount(); j++)
+                {
+                    DBC_SIGNAL *sig = msg->sigHandler->findSignalByIdx(j);
+                    if (sig->valType == STRING) continue;
+                    messageColumns[msg].append(qMakePair(static_cast<const DBC_SIGNAL *>(sig), columns.count()));
+                    columns.append(sig);
+                }
+            }
+            QHash<const DBC_SIGNAL *, int> columnOf;
+            for (int c = 0; c < columns.count(); c++) columnOf.insert(columns[c], c);
+
+            int64_t minTime = 0;
+            bool anyFrames = false;
+            for (int c = 0; c < summaries.count(); c++)
+            {
+                if (!summaries[c].hasFrames) continue;
+                if (!anyFrames || summaries[c].minTime < minTime) minTime = summaries[c].minTime;
+                anyFrames = true;
+            }
+            firstTick = floorDiv(minTime, interval) * interval;
+
+            //every chunk starts from the values and the latest time the chunks before it left behind
+            QVector<QVector<double>> startValues(numChunks);
+            QVector<int64_t> startTimes(numChunks);
+            QVector<double> values(columns.count(), std::numeric_limits<double>::quiet_NaN());
+            int64_t latest = firstTick;
+            for (int c = 0; c < numChunks; c++)
+            {
+                startValues[c] = values;
+                startTimes[c] = latest;
+                QHash<const DBC_SIGNAL *, double>::const_iterator it;
+                for (it = summaries[c].lastValues.constBegin(); it != summaries[c].lastValues.constEnd(); ++it)
+                {
+                    values[columnOf.value(it.key())] = it.value();
+                }
+                if (summaries[c].hasFrames) latest = qMax(latest, summaries[c].maxTime);
+            }
+            summaries.clear();
+
+            ok = writeOut(resampledHeader());
+            ok = ok && runChunks([this, &startValues, &startTimes](int chunk)
+                                 { return resampledChunk(chunk, startValues.at(chunk), startTimes.at(chunk), chunk == numChunks - 1); },
+                                 writeOut);
+            if (ok && format == RESAMPLED_COLUMNS)
+            {
+                QByteArray end;
+                QDataStream stream(&end, QIODevice::WriteOnly);
+                stream.setByteOrder(QDataStream::LittleEndian);
+                stream << static_cast<quint32>(0);
+                ok = writeOut(end);
+            }
+        }
+    }
+
+    progress = nullptr;
+    if (!ok)
+    {
+        outFile.cancelWriting();
+        return false;
+    }
+    return outFile.commit();
+}
+
+/*
+ * Runs encode for every chunk on worker threads and hands the results to write on this thread in chunk
+ * order. Workers never get more than maxAhead chunks ahead of the writer so finished output can't pile up.
+ * false if a write failed or the user cancelled, the workers stop at the next chunk either way.
+ */
+bool DecodedExport::runChunks(const std::function<QByteArray(int)> &encode, const std::function<bool(const QByteArray &)> &write)
+{
+    if (numChunks == 0) return true;
+
+    int numThreads = qBound(1, QThread::idealThreadCount(), numChunks);
+    const int maxAhead = numThreads * 2 + 2;
+
+    QMutex lock;
+    QWaitCondition roomForMore, chunkDone;
+    QVector<QByteArray> results(numChunks);
+    QVector<bool> finished(numChunks, false);
+    int nextChunk = 0;
+    int written = 0;
+    bool stop = false;
+
+    auto worker = [&]()
+    {
+        QMutexLocker locker(&lock);
+        while (true)
+        {
+            while (!stop && nextChunk < numChunks && nextChunk >= written + maxAhead) roomForMore.wait(&lock);
+            if (stop || nextChunk >= numChunks) return;
+            int chunk = nextChunk++;
+            locker.unlock();
+            QByteArray out = encode(chunk);
+            locker.relock();
+            results[chunk] = out;
+            finished[chunk] = true;
+            chunkDone.wakeAll();
+        }
+    };
+
+    QList<QThread *> threads;
+    for (int t = 0; t < numThreads; t++)
+    {
+        QThread *thread = QThread::create(worker);
+        threads.append(thread);
+        thread->start();
+    }
+
+    bool ok = true;
+    lock.lock();
+    while (written < numChunks)
+    {
+        if (!finished[written])
+        {
+            chunkDone.wait(&lock, 50);
+            lock.unlock();
+            qApp->processEvents();
+            lock.lock();
+            if (progress && progress->wasCanceled())
+            {
+                ok = false;
+                break;
+            }
+            continue;
+        }
+        QByteArray out;
+        out.swap(results[written]);
+        written++;
+        roomForMore.wakeAll();
+        lock.unlock();
+        ok = write(out);
+        if (progress) progress->setValue(progress->value() + 1);
+        lock.lock();
+        if (!ok || (progress && progress->wasCanceled()))
+        {
+            ok = false;
+            break;
+        }
+    }
+    stop = true;
+    roomForMore.wakeAll();
+    lock.unlock();
+
+    for (QThread *thread : threads)
+    {
+        thread->wait();
+        delete thread;
+    }
+    return ok;
+}
+
+DecodedExport::ChunkSummary DecodedExport::scanChunk(int chunk) const
+{
+    ChunkSummary summary;
+    summary.hasFrames = false;
+    summary.minTime = 0;
+    summary.maxTime = 0;
+
+    QHash<quint64, DBC_MESSAGE *> lookup;
+    QSet<DBC_MESSAGE *> seen;
+    bool resampling = (format != CSV);
+    int first = chunk * FRAMES_PER_CHUNK;
+    int end = qMin(first + FRAMES_PER_CHUNK, frames->count());
+    for (CANFrameScanner scan(*frames, first, end - 1); scan.next();)
+    {
+        int row = scan.row();
+        CANFrameView view = scan.frame();
+        int64_t stamp = view.timestamp();
+        if (!summary.hasFrames || stamp < summary.minTime) summary.minTime = stamp;
+        if (!summary.hasFrames || stamp > summary.maxTime) summary.maxTime = stamp;
+        summary.hasFrames = true;
+
+        DBC_MESSAGE *msg = lookupMessage(dbcHandler, lookup, view);
+        if (!msg) continue;
+        if (!seen.contains(msg))
+        {
+            seen.insert(msg);
+            summary.firstRows.append(qMakePair(msg, row));
+        }
+
+        if (!resampling || view.frameType() != QCanBusFrame::DataFrame) continue;
+        const CANFrame frame = view.toCANFrame();
+        for (int j = 0; j < msg->sigHandler->getCount(); j++)
+        {
+            const DBC_SIGNAL *sig = msg->sigHandler->findSignalByIdx(j);
+            DBC_SIGNAL_VALUE val;
+            if (sig->valType == STRING || (sig->isMultiplexed && !sig->isSignalInMessage(frame))) continue;
+            if (sig->decode(frame, val)) summary.lastValues.insert(sig, val.value);
+        }
+    }
+    return summary;
+}
+
+/*
+Time: 205.173000   ID: 0x20E Std Bus: 0 Len: 8
+Data Bytes: 88 10 00 13 BB 00 06 00
+    SignalName	Value
+*/
+QByteArray DecodedExport::textChunk(int chunk) const
+{
+    QString chunkText;
+    QHash<quint64, DBC_MESSAGE *> lookup;
+    int first = chunk * FRAMES_PER_CHUNK;
+    int end = qMin(first + FRAMES_PER_CHUNK, frames->count());
+    for (CANFrameScanner scan(*frames, first, end - 1); scan.next();)
+    {
+        CANFrameView view = scan.frame();
+        const CANFrame frame = view.toCANFrame();
+        const unsigned char *data = reinterpret_cast<const unsigned char *>(frame.payload().constData());
+        int dataLen = frame.payload().count();
+
+        QString builderString;
+        builderString += tr("Time: ") + QString::number((frame.timeStamp().microSeconds() / 1000000.0), 'f', 6);
+        builderString += tr("    ID: ") + Utility::formatCANID(frame.frameId(), frame.hasExtendedFrameFormat());
+        if (frame.hasExtendedFrameFormat()) builderString += tr(" Ext ");
+        else builderString += tr(" Std ");
+        builderString += tr("Bus: ") + QString::number(frame.bus);
+        builderString += " Len: " + QString::number(dataLen) + "\n";
+
+        builderString += tr("Data Bytes: ");
+        for (int temp = 0; temp < dataLen; temp++)
+        {
+            builderString += Utility::formatNumber(data[temp]) + " ";
+        }
+        builderString += "\n";
+
+        DBC_MESSAGE *msg = lookupMessage(dbcHandler, lookup, view);
+        if (msg != nullptr)
+        {
+            for (int j = 0; j < msg->sigHandler->getCount(); j++)
+            {
+                QString temp;
+                if (msg->sigHandler->findSignalByIdx(j)->processAsText(frame, temp))
+                {
+                    builderString.append("\t" + temp);
+                    builderString.append("\n");
+                }
+            }
+        }
+        builderString.append("\n");
+        chunkText += builderString;
+    }
+    return chunkText.toUtf8();
+}
+
+//The fixed columns and then the signals of every message (by ID) in the order they first turned up.
+//A message only gets the signals that could be decoded out of the first frame it was found in.
+QByteArray DecodedExport::csvHeader(const QVector<QPair<DBC_MESSAGE *, int>> &messages, QHash<uint32_t, int> &startColumns) const
+{
+    QString builderString;
+    int columnsAdded = 0;
+    if (absTime)
+    {
+        builderString += tr("Year") + "," + tr("Month") + "," + tr("Day") + "," + tr("Hour") + "," + tr("Minute") + "," + tr("Second") + "," + tr("Ms") + ",";
+        columnsAdded += 7;
+    }
+    else
+    {
+        builderString += tr("Time") + ",";
+        columnsAdded++;
+    }
+    builderString += tr("ID") + ",";
+    builderString += tr("Bus") + ",";
+    builderString += tr("DataLen") + ",";
+    columnsAdded += 3;
+
+    for (int m = 0; m < messages.count(); m++)
+    {
+        DBC_MESSAGE *msg = messages[m].first;
+        if (startColumns.contains(msg->ID)) continue;
+        startColumns.insert(msg->ID, columnsAdded);
+
+        const CANFrame frame = frames->at(messages[m].second);
+        for (int j = 0; j < msg->sigHandler->getCount(); j++)
+        {
+            QString temp;
+            if (msg->sigHandler->findSignalByIdx(j)->processAsText(frame, temp))
+            {
+                builderString.append(msg->sigHandler->findSignalByIdx(j)->name);
+                builderString.append(",");
+                columnsAdded++;
+            }
+        }
+    }
+    builderString += "\n";
+    return builderString.toUtf8();
+}
+
+QByteArray DecodedExport::csvChunk(int chunk, const QHash<uint32_t, int> &startColumns) const
+{
+    QString chunkText;
+    QHash<quint64, DBC_MESSAGE *> lookup;
+    int first = chunk * FRAMES_PER_CHUNK;
+    int end = qMin(first + FRAMES_PER_CHUNK, frames->count());
+    for (CANFrameScanner scan(*frames, first, end - 1); scan.next();)
+    {
+        CANFrameView view = scan.frame();
+        const CANFrame frame = view.toCANFrame();
+        int dataColumnsAdded = 0;
+
+        QString builderString;
+        if (absTime)
+        {
+            QDateTime dt = QDateTime::fromMSecsSinceEpoch(frame.timeStamp().microSeconds() / 1000);
+            builderString += QString::number(dt.date().year()) + "," + QString::number(dt.date().month()) + ",";
+            builderString += QString::number(dt.date().day()) + "," + QString::number(dt.time().hour()) + ",";
+            builderString += QString::number(dt.time().minute()) + "," + QString::number(dt.time().second()) + ",";
+            builderString += QString::number(dt.time().msec()) + ",";
+            dataColumnsAdded += 7;
+        }
+        else
+        {
+            builderString += QString::number((frame.timeStamp().microSeconds() / 1000000.0), 'f', 6) + ",";
+            dataColumnsAdded++;
+        }
+        builderString += Utility::formatCANID(frame.frameId(), frame.hasExtendedFrameFormat()) + ",";
+        builderString += QString::number(frame.bus) + ",";
+        builderString += QString::number(frame.payload().count()) + ",";
+        dataColumnsAdded += 3;
+
+        DBC_MESSAGE *msg = lookupMessage(dbcHandler, lookup, view);
+        if (msg != nullptr)
+        {
+            int startCol = startColumns.value(msg->ID, dataColumnsAdded);
+            while (dataColumnsAdded < startCol)
+            {
+                builderString += ",";
+                dataColumnsAdded++;
+            }
+
+            for (int j = 0; j < msg->sigHandler->getCount(); j++)
+            {
+                QString temp;
+                if (msg->sigHandler->findSignalByIdx(j)->processAsText(frame, temp, false, false))
+                {
+                    builderString.append(temp);
+                    builderString.append(",");
+                    dataColumnsAdded++;
+                }
+            }
+        }
+        builderString.append("\n");
+        chunkText += builderString;
+    }
+    return chunkText.toUtf8();
+}
+
+QByteArray DecodedExport::resampledHeader() const
+{
+    if (format == RESAMPLED_CSV)
+    {
+        QString header = tr("Time");
+        foreach (const DBC_SIGNAL *sig, columns) header += "," + sig->parentMessage->name + "." + sig->name;
+        header += "\n";
+        return header.toUtf8();
+    }
+
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("SCCOLS\0\0", 8);
+    stream << static_cast<quint32>(1) << static_cast<quint32>(columns.count() + 1);
+
+    QByteArray name = tr("Time").toUtf8();
+    stream << static_cast<quint8>(0) << static_cast<quint32>(name.size());
+    stream.writeRawData(name.constData(), name.size());
+    foreach (const DBC_SIGNAL *sig, columns)
+    {
+        name = (sig->parentMessage->name + "." + sig->name).toUtf8();
+        stream << static_cast<quint8>(1) << static_cast<quint32>(name.size());
+        stream.writeRawData(name.constData(), name.size());
+    }
+    return header;
+}
+
+/*
+ * Last value hold. The row for tick time T holds every signal as of the last frame at or before T. A
+ * tick is written just before the first frame that is later than it, and the final chunk writes the
+ * ticks up to the last frame. Timestamps that go backwards still update the values but never bring
+ * back ticks that were already written.
+ */
+QByteArray DecodedExport::resampledChunk(int chunk, const QVector<double> &startValues, int64_t startTime, bool lastChunk) const
+{
+    QVector<double> values = startValues;
+    QHash<quint64, DBC_MESSAGE *> lookup;
+    int64_t latest = startTime;
+    int64_t tick = firstTick + ((startTime - firstTick + interval - 1) / interval) * interval;
+    bool csv = (format == RESAMPLED_CSV);
+
+    QString chunkText;
+    QVector<qint64> tickTimes;
+    QVector<QVector<double>> columnData(csv ? 0 : values.count());
+    auto emitTick = [&]()
+    {
+        if (csv)
+        {
+            chunkText += QString::number(tick / 1000000.0, 'f', 6);
+            for (int c = 0; c < values.count(); c++)
+            {
+                chunkText += ",";
+                if (!std::isnan(values[c])) chunkText += QString::number(values[c], 'g', 12);
+            }
+            chunkText += "\n";
+        }
+        else
+        {
+            tickTimes.append(tick);
+            for (int c = 0; c < values.count(); c++) columnData[c].append(values[c]);
+        }
+        tick += interval;
+    };
+
+    int first = chunk * FRAMES_PER_CHUNK;
+    int end = qMin(first + FRAMES_PER_CHUNK, frames->count());
+    for (CANFrameScanner scan(*frames, first, end - 1); scan.next();)
+    {
+        CANFrameView view = scan.frame();
+        int64_t stamp = view.timestamp();
+        if (stamp > latest)
+        {
+            while (tick < stamp) emitTick();
+            latest = stamp;
+        }
+
+        if (view.frameType() != QCanBusFrame::DataFrame) continue;
+        DBC_MESSAGE *msg = lookupMessage(dbcHandler, lookup, view);
+        if (!msg) continue;
+        const QVector<QPair<const DBC_SIGNAL *, int>> sigColumns = messageColumns.value(msg);
+        if (sigColumns.isEmpty()) continue;
+        const CANFrame frame = view.toCANFrame();
+        for (int s = 0; s < sigColumns.count(); s++)
+        {
+            const DBC_SIGNAL *sig = sigColumns[s].first;
+            DBC_SIGNAL_VALUE val;
+            if (sig->isMultiplexed && !sig->isSignalInMessage(frame)) continue;
+            if (sig->decode(frame, val)) values[sigColumns[s].second] = val.value;
+        }
+    }
+    if (lastChunk)
+    {
+        while (tick <= latest) emitTick();
+    }
+
+    if (csv) return chunkText.toUtf8();
+    if (tickTimes.isEmpty()) return QByteArray();
+
+    QByteArray out;
+    QDataStream stream(&out, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    stream << static_cast<quint32>(tickTimes.count());
+    foreach (qint64 t, tickTimes) stream << t;
+    for (int c = 0; c < columnData.count(); c++)
+    {
+        foreach (double v, columnData[c]) stream << v;
+    }
+    return out;
+}
@@ -0,0 +1,93 @@
+#ifndef DECODEDEXPORT_H
+#define DECODEDEXPORT_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <functional>
+#include "canframestore.h"
+#include "dbc/dbchandler.h"
+
+class QProgressDialog;
+
+/*
+ * Save Decoded. Writes the DBC decoded contents of a frame list in one of these forms:
+ *
+ * TEXT              frame header and data bytes followed by a line per signal
+ * CSV               one row per frame, every message gets its own run of signal columns
+ * RESAMPLED_CSV     one row per fixed interval holding the last value every signal had at that time
+ * RESAMPLED_COLUMNS the resampled table as typed binary columns, see below
+ *
+ * The frames are split into chunks that worker threads (one per core) decode and format while this
+ * thread writes the finished chunks out in order, so memory use stays at a few chunks no matter how
+ * long the capture is. A progress dialog with a cancel button runs the whole time. The output goes
+ * through QSaveFile so a cancelled or failed export leaves whatever file was there before alone.
+ * The frame list and the DBC definitions must not change while this runs, MainWindow holds the
+ * model's ingest for the duration.
+ *
+ * Columnar files are little endian throughout:
+ *   char[8]  "SCCOLS\0\0"
+ *   uint32   version (1)
+ *   uint32   number of columns
+ *   per column: uint8 type (0 = int64, 1 = float64), uint32 name length, UTF-8 name
+ *   batches: uint32 row count followed by each column's values for those rows, one column after the
+ *            other. A row count of 0 ends the file.
+ * The first column is Time, int64 microseconds. Every signal is a float64 column named
+ * Message.Signal and is NaN until the signal first shows up. A batch can be read straight into
+ * an array (numpy.frombuffer and the like) without any parsing.
+ */
+class DecodedExport : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format
+    {
+        TEXT,
+        CSV,
+        RESAMPLED_CSV,
+        RESAMPLED_COLUMNS
+    };
+
+    DecodedExport(const CANFrameStore *frames, DBCHandler *dbcHandler);
+    void setAbsoluteTime(bool absTime) { this->absTime = absTime; } //CSV: calendar time columns instead of seconds
+    void setResampleInterval(int64_t micros) { interval = qMax<int64_t>(1, micros); }
+    //false if the file couldn't be written or the user cancelled
+    bool exportFile(const QString &filename, Format format);
+
+private:
+    //what the first pass found out about one chunk
+    struct ChunkSummary
+    {
+        QVector<QPair<DBC_MESSAGE *, int>> firstRows; //every message in the chunk with the first row it was in
+        QHash<const DBC_SIGNAL *, double> lastValues; //resampling only
+        int64_t minTime;
+        int64_t maxTime;
+        bool hasFrames;
+    };
+
+    bool runChunks(const std::function<QByteArray(int)> &encode, const std::function<bool(const QByteArray &)> &write);
+    ChunkSummary scanChunk(int chunk) const;
+    QByteArray textChunk(int chunk) const;
+    QByteArray csvHeader(const QVector<QPair<DBC_MESSAGE *, int>> &messages, QHash<uint32_t, int> &startColumns) const;
+    QByteArray csvChunk(int chunk, const QHash<uint32_t, int> &startColumns) const;
+    QByteArray resampledChunk(int chunk, const QVector<double> &startValues, int64_t startTime, bool lastChunk) const;
+    QByteArray resampledHeader() const;
+
+    const CANFrameStore *frames;
+    DBCHandler *dbcHandler;
+    QProgressDialog *progress;
+    bool absTime;
+    int64_t interval;
+    int numChunks;
+    Format format;
+
+    //resampled formats, filled in after the first pass
+    QVector<const DBC_SIGNAL *> columns;
+    QHash<DBC_MESSAGE *, QVector<QPair<const DBC_SIGNAL *, int>>> messageColumns;
+    int64_t firstTick;
+};
+
+#endif // DECODEDEXPORT_H
@@ -0,0 +1,1096 @@
+#include "filesniffer.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTextStream>
+#include <QtEndian>
+#include <algorithm>
+#include <string.h>
+
+#include "utility.h"
+#include "blfhandler.h"
+#include "capturefile.h"
+
+namespace
+{
+struct FormatEntry
+{
+    FileSniffer::Format format;
+    FileSniffer::Confidence (*sniffer)(QIODevice *);
+    bool text; //sniffer reads lines, gets QIODevice::Text and never sees a partial last line
+    const char *extensions; //space separated, lower case
+};
+}
+
+QVector<FileSniffer::Match> FileSniffer::sniff(const QString &filename)
+{
+    QFile inFile(filename);
+    if (!inFile.open(QIODevice::ReadOnly)) return QVector<Match>();
+    QByteArray head = inFile.read(HEAD_BYTES);
+    return sniff(head, inFile.atEnd(), QFileInfo(filename).suffix());
+}
+
+QVector<FileSniffer::Match> FileSniffer::sniff(const QByteArray &head, bool wholeFile, const QString &suffix)
+{
+    static const FormatEntry formats[NUM_FORMATS] =
+    {
+        {CAPTURE, &FileSniffer::isCaptureFile, false, "sccap"},
+        {BLF, &FileSniffer::isCanalyzerBLF, false, "blf"},
+        {NATIVE_CSV, &FileSniffer::isNativeCSVFile, true, "csv"},
+        {TESLA_AP, &FileSniffer::isTeslaAPFile, false, "can"},
+        {CANSERVER, &FileSniffer::isCANServerFile, false, "log"},
+        {WIRESHARK, &FileSniffer::isWiresharkFile, false, "pcap pcapng"},
+        {CANALYZER_ASC, &FileSniffer::isCanalyzerASC, true, "asc"},
+        {CRTD, &FileSniffer::isCRTDFile, true, "crt crtd txt"},
+        {TRACE, &FileSniffer::isTraceFile, true, "trace"},
+        {VEHICLE_SPY, &FileSniffer::isVehicleSpyFile, true, "csv"},
+        {CANDUMP, &FileSniffer::isCanDumpFile, true, "log"},
+        {CARBUS, &FileSniffer::isCARBUSAnalyzerFile, false, "trc"},
+        {CANHACKER, &FileSniffer::isCANHackerFile, true, "trc"},
+        {CABANA, &FileSniffer::isCabanaFile, true, "csv"},
+        {CANOPEN, &FileSniffer::isCANOpenFile, true, "csv"},
+        {BUSMASTER, &FileSniffer::isLogFile, true, "log"},
+        {PCAN, &FileSniffer::isPCANFile, true, "trc"},
+        {IXXAT, &FileSniffer::isIXXATFile, true, "csv"},
+        {MICROCHIP, &FileSniffer::isMicrochipFile, true, "can log"},
+        {CANDO, &FileSniffer::isCANDOFile, false, "avc can evc qcc"},
+        {KVASER, &FileSniffer::isKvaserFile, true, "txt"},
+        {CLX000, &FileSniffer::isCLX000File, true, "txt"},
+        {LAWICEL, &FileSniffer::isLawicelFile, true, "txt log"},
+        {GENERIC_CSV, &FileSniffer::isGenericCSVFile, true, "csv"}
+    };
+
+    QVector<Match> matches;
+    if (head.isEmpty()) return matches;
+
+    //the line based sniffers read until the buffer runs out, they must not trip over half a line
+    QByteArray textHead = head;
+    if (!wholeFile)
+    {
+        int lastLine = textHead.lastIndexOf('\n');
+        if (lastLine >= 0) textHead.truncate(lastLine + 1);
+    }
+
+    QString ext = suffix.toLower();
+    QVector<int> scores;
+    for (const FormatEntry &entry : formats)
+    {
+        QBuffer buffer;
+        buffer.setData(entry.text ? textHead : head);
+        buffer.open(entry.text ? (QIODevice::ReadOnly | QIODevice::Text) : QIODevice::ReadOnly);
+        Confidence confidence = entry.sniffer(&buffer);
+        if (confidence == None) continue;
+
+        int score = confidence * 2;
+        if (!ext.isEmpty() && QString(entry.extensions).split(' ').contains(ext)) score++;
+        matches.append({entry.format, confidence});
+        scores.append(score);
+    }
+
+    //stable so equal scores stay in registry order
+    QVector<int> order(matches.count());
+    for (int i = 0; i < order.count(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&scores](int a, int b) { return scores[a] > scores[b]; });
+    QVector<Match> sorted;
+    for (int i : order) sorted.append(matches[i]);
+    return sorted;
+}
+
+QString FileSniffer::formatName(Format format)
+{
+    switch (format)
+    {
+    case CAPTURE: return "SavvyCAN Capture";
+    case BLF: return "Canalyzer BLF";
+    case NATIVE_CSV: return "GVRET CSV";
+    case TESLA_AP: return "Tesla AP Snapshot";
+    case CANSERVER: return "CANServer Binary Log";
+    case WIRESHARK: return "Wireshark";
+    case CANALYZER_ASC: return "Canalyzer ASC";
+    case CRTD: return "CRTD";
+    case TRACE: return "Vector Trace";
+    case VEHICLE_SPY: return "Vehicle Spy";
+    case CANDUMP: return "candump";
+    case CARBUS: return "CARBUS Analyzer";
+    case CANHACKER: return "CANHacker";
+    case CABANA: return "Cabana";
+    case CANOPEN: return "CANOpen Magic";
+    case BUSMASTER: return "BusMaster Log";
+    case PCAN: return "PCAN Viewer";
+    case IXXAT: return "IXXAT MiniLog";
+    case MICROCHIP: return "Microchip Log";
+    case CANDO: return "CAN-DO Log";
+    case KVASER: return "Kvaser Log";
+    case CLX000: return "CLX000";
+    case LAWICEL: return "CANDump Lawicel";
+    case GENERIC_CSV: return "Generic ID/Data CSV";
+    case NUM_FORMATS: break;
+    }
+    return "Unknown";
+}
+
+QString FileSniffer::confidenceName(Confidence confidence)
+{
+    switch (confidence)
+    {
+    case High: return "high";
+    case Medium: return "medium";
+    case Low: return "low";
+    case None: break;
+    }
+    return "no";
+}
+
+FileSniffer::Confidence FileSniffer::isCaptureFile(QIODevice *inFile)
+{
+    return CaptureFileReader::isCaptureHeader(inFile->read(16)) ? High : None;
+}
+
+//pcap (only the byte order pcaplite reads) or pcapng section header block
+FileSniffer::Confidence FileSniffer::isWiresharkFile(QIODevice *inFile)
+{
+    QByteArray magicBytes = inFile->read(4);
+    if (magicBytes.size() != 4) return None;
+    uint32_t magic;
+    memcpy(&magic, magicBytes.constData(), sizeof(magic));
+    return (magic == 0xA1B2C3D4 || magic == 0x0A0D0D0A) ? High : None;
+}
+
+FileSniffer::Confidence FileSniffer::isVehicleSpyFile(QIODevice *inFile)
+{
+    QByteArray line;
+    bool foundProbableHeader = false;
+    bool isMatch = false;
+    try {
+        for (int i = 0; i < 10; i++)
+        {
+            if (!inFile->atEnd())
+            {
+                line = inFile->readLine().simplified().toUpper();
+                if (line.startsWith("LINE") && line.contains("TIME") && line.contains("B1"))
+                {
+                    foundProbableHeader = true;
+                }
+            }
+        }
+        if (foundProbableHeader)
+        {
+            if (!inFile->atEnd())
+            {
+                line = inFile->readLine().simplified().toUpper();
+                QList<QByteArray> tokens = line.split(',');
+                if (tokens.length() > 20)
+                {
+                    if (tokens[9].toInt(nullptr, 16) > 0) isMatch = true;
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? Medium : None;
+}
+
+FileSniffer::Confidence FileSniffer::isCRTDFile(QIODevice *inFile)
+{
+    QByteArray line;
+    int lineCounter = 0;
+    bool isMatch = false;
+
+    try
+    {
+        line = inFile->readLine().toUpper(); //read out the header first and discard it.
+
+        while (!inFile->atEnd() && lineCounter < 100) {
+            lineCounter++;
+            line = inFile->readLine().simplified();
+            if (line.length() > 2)
+            {
+                QList<QByteArray> tokens = line.split(' ');
+                if (tokens.length() > 2)
+                {
+                    char firstChar = tokens[1].left(1)[0];
+                    if (firstChar >= '1' && firstChar <= '9')
+                    {
+                        tokens[1].remove(0,1); // Remove leading digit (bus number)
+                        firstChar = tokens[1].left(1)[0];
+                    }
+                    if (firstChar == 'R' || firstChar == 'T')
+                    {
+                        if (tokens[1] == "R29" || tokens[1] == "T29") isMatch = true;
+                        if (tokens[1] == "R11" || tokens[1] == "T11") isMatch = true;
+                    }
+                }
+                else isMatch = false;
+            }
+            if (lineCounter > 10) break;
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? Medium : None;
+}
+
+FileSniffer::Confidence FileSniffer::isCARBUSAnalyzerFile(QIODevice *inFile)
+{
+    QByteArray line;
+
+    bool isMatch = false;
+
+    // not Text mode because file contains `\r` new lines
+    try
+    {
+        //read header
+        line = inFile->readLine().toUpper();
+        if (line.startsWith("@ TEXT @")) return High;
+    } catch (...)
+    {
+        isMatch = false;
+    }
+
+    return isMatch ? High : None;
+}
+
+FileSniffer::Confidence FileSniffer::isCANHackerFile(QIODevice *inFile)
+{
+    QByteArray line;
+    int lineCounter = 0;
+    bool isMatch = false;
+
+    try
+    {
+        line = inFile->readLine().toUpper(); //read out the header first and discard it.
+        if (line.contains("CANHACKER")) return High;
+
+        while (!inFile->atEnd()) {
+            lineCounter++;
+            line = inFile->readLine().simplified();
+            if (line.length() > 2)
+            {
+                QList<QByteArray> tokens = line.split(' ');
+                if (tokens.length() > 3)
+                {
+                    if (tokens[1].toInt(nullptr, 16) > 0)
+                    {
+                        int len = tokens[2].toInt();
+                        if (len > -1 && len < 9)
+                        {
+                            isMatch = true;
+                        }
+                    }
+                }
+                else isMatch = false;
+            }
+            if (lineCounter > 10) break;
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? Low : None;
+}
+
+FileSniffer::Confidence FileSniffer::isCANOpenFile(QIODevice *inFile)
+{
+    QByteArray line;
+    int lineCounter = 0;
+    bool isMatch = false;
+
+    try
+    {
+        line = inFile->readLine().toUpper();
+        if (!line.contains("CANOPEN MAGIC")) return None;
+        line = inFile->readLine();
+        line = inFile->readLine();
+        line = inFile->readLine();
+        line = inFile->readLine();
+
+        while (!inFile->atEnd()) {
+            lineCounter++;
+            if (lineCounter > 10)
+            {
+                break;
+            }
+
+            line = inFile->readLine().replace('\"', ' ').simplified();
+            if (line.length() > 2)
+            {
+                QList<QByteArray> tokens = line.split(',');
+                if (tokens.length() > 11)
+                {
+                    if (Utility::ParseStringToNum(tokens[5].simplified()) > 0)
+                    {
+                        QList<QByteArray> dataTok = tokens[11].simplified().split(' ');
+                        if ( dataTok.length() > -1 && dataTok.length() < 9) isMatch = true;
+                    }
+                }
+                else isMatch = false;
+            }
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? High : None;
+}
+
+FileSniffer::Confidence FileSniffer::isPCANFile(QIODevice *inFile)
+{
+    QByteArray line;
+    int lineCounter = 0;
+    bool hasFileVer = false;
+    bool isMatch = false;
+
+    try
+    {
+        while (!inFile->atEnd()) {
+            lineCounter++;
+            if (lineCounter > 25)
+            {
+                break;
+            }
+            line = inFile->readLine();
+            if (line.startsWith(";$FILEVERSION=")) hasFileVer = true;
+            if (line.toUpper().contains("PCAN") && hasFileVer) isMatch = true;
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? High : None;
+}
+
+FileSniffer::Confidence FileSniffer::isCanalyzerASC(QIODevice *inFile)
+{
+    QByteArray line;
+    //int lineCounter = 0;
+    //bool inHeader = true;
+    bool isMatch = true;
+    QList<QByteArray> tokens;
+
+    try
+    {
+        if (!inFile->atEnd())
+        {
+            line = inFile->readLine();
+            if (!line.startsWith("date")) isMatch = false;
+        }
+        if (!inFile->atEnd() && isMatch)
+        {
+            line = inFile->readLine();
+            if (!line.startsWith("base")) isMatch = false;
+        }
+        if (!inFile->atEnd() && isMatch)
+        {
+            line = inFile->readLine();
+            if (!line.contains("logged")) isMatch = false;
+        }
+        if (!inFile->atEnd() && isMatch)
+        {
+            line = inFile->readLine();
+            if (!line.contains("version")) isMatch = false;
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? Medium : None;
+}
+
+FileSniffer::Confidence FileSniffer::isCanalyzerBLF(QIODevice *inFile)
+{
+    BLF_FILE_HEADER header;
+
+    bool isMatch = false;
+
+    if (inFile->read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header)) return None;
+    if (qFromLittleEndian(header.sig) == 0x47474F4C)
+    {
+        isMatch = true;
+    }
+    else isMatch = false;
+
+    return isMatch ? High : None;
+}
+
+FileSniffer::Confidence FileSniffer::isNativeCSVFile(QIODevice *inFile)
+{
+    QByteArray line;
+    int fileVersion = 1;
+    bool isMatch = true;
+
+    try
+    {
+        line = inFile->readLine().toUpper(); //read out the header first and discard it.
+        if (line.length() < 24) isMatch = false;
+        else if (line.at(23) == 'D') fileVersion = 2; //Dir is found starting at position 23 if this is a V2 file
+
+        if (!line.contains("TIME STAMP")) isMatch = false;
+        if (!line.contains("EXTENDED")) isMatch = false;
+        if (!line.contains("D1")) isMatch = false;
+
+        if (!inFile->atEnd()) {
+            line = inFile->readLine().simplified();
+            if (line.length() > 2)
+            {
+                QList<QByteArray> tokens = line.split(',');
+                if (tokens.length() >= 5)
+                {
+                    if (fileVersion == 1)
+                    {
+                        if (tokens[4].toUInt() > 8) isMatch = false;
+                    }
+                    else if (fileVersion == 2)
+                    {
+                        if ( tokens[5].toUInt() > 8) isMatch = false;
+                    }
+                }
+                else isMatch = false;
+            }
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+
+    return isMatch ? Medium : None;
+}
+
+FileSniffer::Confidence FileSniffer::isGenericCSVFile(QIODevice *inFile)
+{
+    QByteArray line;
+    bool isMatch = true;
+
+    try
+    {
+        line = inFile->readLine(); //read out the header first and discard it.
+
+        if (!inFile->atEnd()) {
+            line = inFile->readLine();
+            if (line.length() > 2)
+            {
+                QList<QByteArray> tokens = line.split(',');
+
+                int ID = tokens[0].toInt(nullptr, 16);
+                if (ID < 1 || ID > 0x1FFFFFFF) isMatch = false;
+
+                if (tokens.count() < 2)
+                {
+                    isMatch = false;
+                }
+
+                if (isMatch)
+                {
+                    QList<QByteArray> dataTok = tokens[1].simplified().split(' ');
+                    int len = dataTok.length();
+                    if (len > 8) isMatch = false;
+                    if (len < 2) isMatch = false;
+                }
+            }
+            else isMatch = false;
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? Low : None;
+}
+
+FileSniffer::Confidence FileSniffer::isLogFile(QIODevice *inFile)
+{
+    QByteArray line;
+    bool isMatch = true;
+
+    try
+    {
+        line = inFile->readLine().toUpper();
+        if (!line.contains("BUSMASTER")) isMatch = false;
+
+        while (!inFile->atEnd() && line.startsWith("***")) {
+            line = inFile->readLine().toUpper();
+        }
+
+        if (!inFile->atEnd())
+        {
+            line = inFile->readLine().toUpper();
+            if (line.length() > 1)
+            {
+                QList<QByteArray> tokens = line.split(' ');
+                if (tokens.length() >= 6)
+                {
+                    QList<QByteArray> timeToks = tokens[0].split(':');
+                    if (timeToks.count() != 4) isMatch = false;
+
+                    int ID = tokens[3].right(tokens[3].length() - 2).toInt(nullptr, 16);
+                    if (ID < 1 || ID > 0x1FFFFFFF) isMatch = false;
+                    if (tokens[4] != "S" && tokens[4] != "X" && tokens[4] != "SR" && tokens[4] != "XR") isMatch = false;
+                    int len = tokens[5].toInt();
+                    if (len > 8) isMatch = false;
+                }
+                else isMatch = false;
+            }
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+
+    return isMatch ? High : None;
+}
+
+FileSniffer::Confidence FileSniffer::isIXXATFile(QIODevice *inFile)
+{
+    QByteArray line;
+    bool isMatch = true;
+
+    try
+    {
+        line = inFile->readLine().toUpper();
+        if (!line.contains("IXXAT")) isMatch = false;
+
+        for (int i = 0; i < 6; i++)
+        {
+            if (!inFile->atEnd()) line = inFile->readLine().toUpper();
+            else isMatch = false;
+        }
+
+        if (!line.contains("FORMAT")) isMatch = false;
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+
+    return isMatch ? High : None;
+}
+
+FileSniffer::Confidence FileSniffer::isCANDOFile(QIODevice *inFile)
+{
+    int lineCounter = 0;
+    QByteArray data;
+    bool isMatch = true;
+
+    //this file format is in static 12 byte blocks.
+    //Bytes 0 - 1 are a time stamp
+    //Bytes 2 - 3 are the data length (top 4 bits) then ID (bottom 11 bits)
+    //Bytes 4 - 11 are the data bytes (padded with FF for bytes not used)
+    try
+    {
+        while (!inFile->atEnd() && lineCounter < 200)
+        {
+            lineCounter++;
+
+            data = inFile->read(12);
+
+            int ID = ((data[3] & 0x0F) * 256 + data[2]);
+            int len = data[3] >> 4;
+
+            if (len <= 8 && ID <= 0x7FF)
+            {
+                if (len < 8)
+                {
+                    if (data[4 + len] != static_cast<char>(0xFF)) isMatch = false;
+                }
+            }
+            else isMatch = false;
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+
+    return isMatch ? Low : None;
+}
+
+FileSniffer::Confidence FileSniffer::isMicrochipFile(QIODevice *inFile)
+{
+    QByteArray line;
+    bool inComment = false;
+    int lineCounter = 0;
+    bool isMatch = true;
+
+    try
+    {
+        while (!inFile->atEnd() && lineCounter < 100) {
+            lineCounter++;
+
+            line = inFile->readLine();
+            if (line.length() > 2)
+            {
+                if (line.startsWith("//"))
+                {
+                    inComment = !inComment;
+                }
+                else
+                {
+                    if (!inComment)
+                    {
+                        QList<QByteArray> tokens = line.trimmed().split(';');
+                        if (tokens.last().isEmpty()) tokens.removeLast(); //lines can end in a ;
+                        if (tokens.length() >= 4)
+                        {
+                            int ID = Utility::ParseStringToNum(tokens[2]);
+                            if (ID < 1 || ID > 0x1FFFFFFF) isMatch = false;
+                            int len = tokens[3].toInt();
+                            if ( len > 8 || len < 0 ) isMatch = false;
+                            if ( (len + 4)  < tokens.length() ) isMatch = false;
+                        }
+                        else isMatch = false;
+                    }
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? Low : None;
+}
+
+FileSniffer::Confidence FileSniffer::isTraceFile(QIODevice *inFile)
+{
+    QByteArray line;
+    int lineCounter = 0;
+    bool isMatch = true;
+
+    try
+    {
+        while (!inFile->atEnd() && lineCounter < 100) {
+            lineCounter++;
+
+            line = inFile->readLine();
+            line = line.trimmed();
+            if (line.length() > 2)
+            {
+                if (line.startsWith(";"))
+                {
+                    // a comment. Ignore it.
+                }
+                else
+                {
+                    QList<QByteArray> tokens = line.split('\t');
+                    if (tokens.length() > 3)
+                    {
+                        QList<QByteArray> timestampToks = tokens[1].split(':');
+                        if (timestampToks.count() != 4) isMatch = false;
+
+                        long ID = tokens[2].toLong(nullptr, 16);
+                        if (ID < 1 || ID > 0x1FFFFFFF) isMatch = false;
+                        int len = tokens[3].toInt();
+                        if (len > 8 || len < 0) isMatch = false;
+                        QList<QByteArray> dataToks = tokens[4].split(' ');
+                        if (len > dataToks.length()) isMatch = false;
+                    }
+                    else isMatch = false;
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+
+    return isMatch ? Low : None;
+}
+
+FileSniffer::Confidence FileSniffer::isCanDumpFile(QIODevice *inFile)
+{
+    QByteArray line;
+    QList<QByteArray> tokens;
+    QRegularExpression timeExp(QRegularExpression::anchoredPattern("^\\((\\S+)\\)$")); //anchored pattern causes exact match
+    QRegularExpression IdValExp(QRegularExpression::anchoredPattern("^(\\S+)#(\\S+)$"));
+    QRegularExpression valExp("(\\S{2})");
+    int lineCounter = 0;
+    int pos = 0;
+    bool isMatch = true;
+    bool ret;
+
+    try
+    {
+        while (!inFile->atEnd() && lineCounter < 100) {
+            lineCounter++;
+
+            line = inFile->readLine().toUpper();
+            if (line.length() > 1)
+            {
+                /* tokenize */
+                tokens.clear();
+                tokens = line.simplified().split(' ');
+                if(tokens.count() < 3) isMatch = false;
+
+                /* timestamp */                
+                QRegularExpressionMatch timeExpMatched = timeExp.match(tokens[0]);
+                if(!timeExpMatched.hasMatch()) {
+                    isMatch = false;
+                }
+
+                /*uint64_t timestamp = (uint64_t)*/(timeExpMatched.captured(1).toDouble(&ret) /** (double)1000000.0*/);
+                if(!ret) isMatch = false;
+
+                if (line.contains('[')) //the expanded format
+                {
+                    //(1551774790.942758) can1 7A8 [8] F4 DC D1 83 0E 02 00 00
+                    //     0               1     2   3  4 5  6  7  8  9  10 11
+                    if (tokens.count() < 4)
+                    {
+                        isMatch = false;
+                        continue;
+                    }
+                    int ID = tokens[2].toULong(nullptr, 16);
+                    if (ID > 0x1FFFFFFF || ID == 0) isMatch = false;
+                    if (tokens[3].size() < 2) {
+                        isMatch = false;
+                        continue;
+                    }
+                    int len = tokens[3].at(1) - '0';
+                    if (len < 0 || len > 8) isMatch = false;
+                }
+                else  //the more concise format
+                {
+                    /* ID & value */
+                    //qDebug() << tokens[2];
+                    if (tokens.count() < 3)
+                    {
+                        isMatch = false;
+                        continue;
+                    }
+
+                    QRegularExpressionMatch IdValExpMatched = IdValExp.match(tokens[2]);
+                    if(!IdValExpMatched.hasMatch())
+                    {
+                        isMatch = false;
+                        continue;
+                    }
+
+                    /* ID */
+                    /*int ID = */IdValExpMatched.captured(1).toInt(&ret, 16);
+
+                    QString val= IdValExpMatched.captured(2);
+
+                    pos = 0;
+                    int len = 0;
+                    if (val.startsWith("R") && val.at(1).isDigit()) {
+                        len = val.at(1).toLatin1() - '0';
+                        if (len < 0 || len > 8)
+                        {
+                            isMatch = false;
+                            continue;
+                        }
+                    } else {
+                        /* val byte per byte */
+                        int lng = 0;
+                        QRegularExpressionMatch valExpMatch;
+                        QRegularExpressionMatchIterator i = valExp.globalMatch(val);
+                        while (i.hasNext()) {
+                            valExpMatch = i.next();
+                            lng++;
+                            if (lng > 8)
+                            {
+                                isMatch = false;
+                                break;
+                            }
+                            /*int data = */valExpMatch.captured(1).toInt(&ret, 16);
+                            if(!ret)
+                            {
+                                isMatch = false;
+                                break;
+                            }
+
+                        }
+                    }
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? Medium : None;
+}
+
+FileSniffer::Confidence FileSniffer::isLawicelFile(QIODevice *inFile)
+{
+    QByteArray line;
+    int lineCounter = 0;
+    bool isMatch = false;
+
+    try
+    {
+        while (!inFile->atEnd() && lineCounter < 100) {
+            lineCounter++;
+
+            line = inFile->readLine().toUpper();
+            if (line.length() > 4 && !line.startsWith("S"))
+            {
+                int ID = line.mid(0, 3).toInt(nullptr, 16);
+                if (ID > 0 && ID < 0x800)
+                {
+                    line.remove(0, 3);
+                    int len = line.length() / 2;
+                    if (len > -1 && len < 9) isMatch = true;
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? Low : None;
+}
+
+FileSniffer::Confidence FileSniffer::isKvaserFile(QIODevice *inFile)
+{
+    QByteArray line;
+    int lineCounter = 0;
+    bool isMatch = true;
+
+    try
+    {
+        line = inFile->readLine().simplified().toUpper();
+        if (!line.contains("CHN")) isMatch = false;
+        if (!line.contains("FLG")) isMatch = false;
+        if (!line.contains("D0")) isMatch = false;
+
+        if (inFile->atEnd()) isMatch = false;
+
+        while (!inFile->atEnd() && lineCounter < 10) {
+            lineCounter++;
+
+            line = inFile->readLine().toUpper();
+
+            if (line.length() > 70) {
+                //Chn Identifier Flg   DLC  D0...1...2...3...4...5...6..D7       Time     Dir
+                // 0    000000AD         8  FF  FF  00  00  00  00  00  00     154.266550 R
+                int len = line.mid(21, 3).simplified().toInt();
+                if (len > 8 || len < 0) isMatch = false;
+            }
+            else isMatch = false;
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+    return isMatch ? Medium : None;
+}
+
+FileSniffer::Confidence FileSniffer::isCabanaFile(QIODevice *inFile)
+{
+    QByteArray line;
+    int lineCounter = 0;
+    bool isMatch = true;
+
+    try
+    {
+        line = inFile->readLine().toUpper(); //read out the header first and discard it.
+        if (!line.contains("TIME")) isMatch = false;
+        if (!line.contains("ADDR")) isMatch = false;
+
+        while (!inFile->atEnd() || lineCounter < 100) {
+            lineCounter++;
+
+            line = inFile->readLine().simplified();
+            if (line.length() > 2)
+            {
+                QList<QByteArray> tokens = line.split(',');
+                if (tokens.length() >= 3 && tokens.length() < 5)
+                {
+                    int ID = tokens[1].toInt();
+                    if (ID < 1 || ID > 0x1FFFFFFF) isMatch = false;
+                }
+                else isMatch = false;
+            }
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+
+    return isMatch ? Medium : None;
+}
+
+FileSniffer::Confidence FileSniffer::isTeslaAPFile(QIODevice *inFile)
+{
+    bool isValidFile = true;
+    int records = 0;
+    TeslaAPCANRecord record;
+
+    //only whole records, the buffer may end part way into one
+    while (inFile->read((char *)&record, sizeof(TeslaAPCANRecord)) == sizeof(TeslaAPCANRecord))
+    {
+        records++;
+        if (record.id > 0x7FF) isValidFile = false;
+        if ((record.ctr >> 4) > 8) isValidFile = false;
+        if ((record.ctr & 0xF) > 6) isValidFile = false;
+    }
+
+    return (isValidFile && records > 0) ? Low : None;
+}
+
+FileSniffer::Confidence FileSniffer::isCLX000File(QIODevice *inFile) {
+    QTextStream fileStream(inFile);
+    //bool foundErrors = false;
+
+    // Contains 16 lines of header prior to (potential) data.
+    QString headerLine;
+    headerLine = fileStream.readLine();
+    if(!headerLine.startsWith("# Logger type: ")) {
+        return None;
+    }
+
+    // Skip to next usable field.
+    fileStream.readLine();
+    fileStream.readLine();
+    fileStream.readLine();
+    fileStream.readLine();
+    fileStream.readLine();
+
+    // Extract base time.
+    headerLine = fileStream.readLine();
+    if(!headerLine.startsWith("# Time: ")) {
+        qDebug() << "Not the correct start time:" << headerLine;
+        return None;
+    }
+    headerLine = headerLine.right(15);
+
+    QDateTime startDate = QDateTime::fromString(headerLine, "yyyyMMddThhmmss");
+    if(!startDate.isValid()) {
+        qDebug() << "Could not parse " << headerLine << "using \"yyyyMMddThhmmss\" as format string";
+        return None;
+    }
+
+    QString const validSeparators(" -~");
+
+    // Decode separators and format for later decoding.
+    headerLine = fileStream.readLine();
+    QString const valueSeparatorPattern = "# Value separator: \"(?<valueSeparator>[" + validSeparators + "])\"";
+    QRegularExpression valueSeparatorRegEx(valueSeparatorPattern);
+    auto matchValueSeparator = valueSeparatorRegEx.match(headerLine);
+    if(!matchValueSeparator.hasMatch()) {
+        qDebug() << "Could not decode value separator" << headerLine << "using pattern" << valueSeparatorPattern;
+        return None;
+    }
+    QChar valueSeparator = matchValueSeparator.captured("valueSeparator").front();
+
+    headerLine = fileStream.readLine();
+    QString const timeFormatPattern = "# Time format: (?<timeFormat>\\d)";
+    QRegularExpression timeFormatRegEx(timeFormatPattern);
+    auto matchTimeFormat = timeFormatRegEx.match(headerLine);
+    if(!matchTimeFormat.hasMatch()) {
+        qDebug() << "Could not decode time format" << headerLine << "using pattern" << timeFormatPattern;
+        return None;
+    }
+    //auto timeFormat = matchTimeFormat.captured("timeFormat").front().digitValue();
+
+    headerLine = fileStream.readLine();
+    QString const timeSeparatorPattern = "# Time separator: \"(?<timeSeparator>[" + validSeparators + "]?)\"";
+    QRegularExpression timeSeparatorRegEx(timeSeparatorPattern);
+    auto matchTimeSeparator = timeSeparatorRegEx.match(headerLine);
+    if( !matchTimeSeparator.hasMatch()) {
+        qDebug() << "Could not decode time format" << headerLine << "using pattern" << timeSeparatorPattern;
+        return None;
+    }
+    //QChar timeSeparator = matchTimeSeparator.captured("timeSeparator").front();
+
+    headerLine = fileStream.readLine();
+    QString const timeSeparatorMsPattern = "# Time separator ms: \"(?<timeSeparatorMs>[" + validSeparators + "]?)\"";
+    QRegularExpression timeSeparatorMsRegEx(timeSeparatorMsPattern);
+    auto matchTimeSeparatorMs = timeSeparatorMsRegEx.match(headerLine);
+    if( !matchTimeSeparatorMs.hasMatch()) {
+        qDebug() << "Could not decode time format ms" << headerLine << "using pattern" << timeSeparatorMsPattern;
+        return None;
+    }
+    //QChar timeSeparatorMs = matchTimeSeparatorMs.captured("timeSeparatorMs").front();
+
+    headerLine = fileStream.readLine();
+    QString const dateSeparatorPattern = "# Date separator: \"(?<dateSeparator>[" + validSeparators + "]?)\"";
+    QRegularExpression dateSeparatorRegEx(dateSeparatorPattern);
+    auto matchDateSeparator = dateSeparatorRegEx.match(headerLine);
+    if( !matchDateSeparator.hasMatch()) {
+        qDebug() << "Could not decode time format ms" << headerLine << "using pattern" << dateSeparatorPattern;
+        return None;
+    }
+    //QChar dateSeparator = matchDateSeparator.captured("dateSeparator").front();
+
+    headerLine = fileStream.readLine();
+    QString const timeDateSeparatorPattern = "# Time and date separator: \"(?<timeDateSeparator>[" + validSeparators + "]?)\"";
+    QRegularExpression timeDateSeparatorRegEx(timeDateSeparatorPattern);
+    auto matchTimeDateSeparator = timeDateSeparatorRegEx.match(headerLine);
+    if( !matchTimeDateSeparator.hasMatch()) {
+        qDebug() << "Could not decode time format ms" << headerLine << "using pattern" << timeDateSeparatorPattern;
+        return None;
+    }
+    //QChar timeDateSeparator = matchTimeDateSeparator.captured("timeDateSeparator").front();
+
+    // Skip remaining header lines.
+    fileStream.readLine();
+    fileStream.readLine();
+    fileStream.readLine();
+
+    // Decode which fields are present.
+    headerLine = fileStream.readLine();
+    auto const presentFields = headerLine.split(valueSeparator);
+    QStringList const validStrings = {"Timestamp", "Type", "ID", "Length", "Data"};
+
+    if(!std::all_of(
+        presentFields.cbegin(),
+        presentFields.cend(),
+        [&validStrings](QString const& entry){return validStrings.contains(entry);})
+        ) {
+        return None;
+    }
+
+    return High;
+}
+
+FileSniffer::Confidence FileSniffer::isCANServerFile(QIODevice *inFile)
+{
+    QByteArray headerData;
+    bool isMatch = false;
+
+    try
+    {
+        //Read the first 20 bytes from the file to check for the matching signature
+        headerData = inFile->read(22);
+
+        //qDebug() << "header.length: " << headerData.length();
+
+        if (headerData.length() == 22)
+        {
+            //qDebug() << "header: " << headerData;
+            //We have enough bytes to make up our header.  Lets check if it matches
+            if (headerData == "CANSERVER_v2_CANSERVER" || headerData == "CANSERVER_v3_CANSERVER")
+            {
+                isMatch = true;
+            }
+        }
+    }
+    catch (...)
+    {
+        isMatch = false;
+    }
+
+    return isMatch ? High : None;
+}
@@ -0,0 +1,114 @@
+#ifndef FILESNIFFER_H
+#define FILESNIFFER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include <stdint.h>
+
+struct TeslaAPCANRecord
+{
+    #pragma pack(push, 1)
+    int64_t sec;
+    int32_t nano;
+    int32_t padding1;
+    uint16_t id;
+    uint8_t ctr;
+    uint8_t data[8];
+    uint8_t padding2;
+    #pragma pack(pop)
+};
+
+/*
+ * Figures out which log format a file is in for FrameFileIO::autoDetectLoadFile. The start of the file
+ * (HEAD_BYTES) is read once and every known format looks at that same buffer, so detection costs one
+ * small read no matter how many formats there are or where the file lives. Each format answers with how
+ * sure it is. A binary signature is a high confidence match, a recognisable header line medium and
+ * "the lines look about right" low. A matching file extension breaks ties between equally sure formats.
+ */
+class FileSniffer
+{
+public:
+    //in the order autodetect used to try them, which is also the tie breaker
+    enum Format
+    {
+        CAPTURE,
+        BLF,
+        NATIVE_CSV,
+        TESLA_AP,
+        CANSERVER,
+        WIRESHARK,
+        CANALYZER_ASC,
+        CRTD,
+        TRACE,
+        VEHICLE_SPY,
+        CANDUMP,
+        CARBUS,
+        CANHACKER,
+        CABANA,
+        CANOPEN,
+        BUSMASTER,
+        PCAN,
+        IXXAT,
+        MICROCHIP,
+        CANDO,
+        KVASER,
+        CLX000,
+        LAWICEL,
+        GENERIC_CSV,
+        NUM_FORMATS
+    };
+
+    enum Confidence
+    {
+        None,
+        Low,
+        Medium,
+        High
+    };
+
+    struct Match
+    {
+        Format format;
+        Confidence confidence;
+    };
+
+    static const int HEAD_BYTES = 64 * 1024;
+
+    //every format that could be it, best guess first. Empty if the file can't be read or nothing matched.
+    static QVector<Match> sniff(const QString &filename);
+    //same on a buffer already in memory. wholeFile says whether head is all of the file or just its start.
+    static QVector<Match> sniff(const QByteArray &head, bool wholeFile, const QString &suffix = QString());
+
+    static QString formatName(Format format);
+    static QString confidenceName(Confidence confidence);
+
+private:
+    static Confidence isCaptureFile(QIODevice *inFile);
+    static Confidence isCanalyzerBLF(QIODevice *inFile);
+    static Confidence isNativeCSVFile(QIODevice *inFile);
+    static Confidence isTeslaAPFile(QIODevice *inFile);
+    static Confidence isCANServerFile(QIODevice *inFile);
+    static Confidence isWiresharkFile(QIODevice *inFile);
+    static Confidence isCanalyzerASC(QIODevice *inFile);
+    static Confidence isCRTDFile(QIODevice *inFile);
+    static Confidence isTraceFile(QIODevice *inFile);
+    static Confidence isVehicleSpyFile(QIODevice *inFile);
+    static Confidence isCanDumpFile(QIODevice *inFile);
+    static Confidence isCARBUSAnalyzerFile(QIODevice *inFile);
+    static Confidence isCANHackerFile(QIODevice *inFile);
+    static Confidence isCabanaFile(QIODevice *inFile);
+    static Confidence isCANOpenFile(QIODevice *inFile);
+    static Confidence isLogFile(QIODevice *inFile);
+    static Confidence isPCANFile(QIODevice *inFile);
+    static Confidence isIXXATFile(QIODevice *inFile);
+    static Confidence isMicrochipFile(QIODevice *inFile);
+    static Confidence isCANDOFile(QIODevice *inFile);
+    static Confidence isKvaserFile(QIODevice *inFile);
+    static Confidence isCLX000File(QIODevice *inFile);
+    static Confidence isLawicelFile(QIODevice *inFile);
+    static Confidence isGenericCSVFile(QIODevice *inFile);
+};
+
+#endif // FILESNIFFER_H
@@ -0,0 +1,38 @@
+#include "framebatch.h"
+
+QAtomicInt FrameBatch::numInFlight;
+
+//FD payloads in a batch are rare and few, no need for the big blocks the store uses
+FrameBatch::FrameBatch(CANConnection *conn, int busBase) : arena(4096)
+{
+    this->conn = conn;
+    base = busBase;
+    firstSeq = 0;
+    numInFlight.fetchAndAddOrdered(1);
+}
+
+FrameBatch::~FrameBatch()
+{
+    numInFlight.fetchAndAddOrdered(-1);
+}
+
+void FrameBatch::append(const CANFrame &frame)
+{
+    records.emplace_back();
+    CANFrameStore::pack(records.back(), arena, frame);
+}
+
+CANFrameView FrameBatch::view(int idx) const
+{
+    const PackedCANFrame &rec = records[idx];
+    if (rec.length <= 8) return CANFrameView(&rec, rec.payload.inlineData);
+    return CANFrameView(&rec, rec.payload.arenaData);
+}
+
+QVector<CANFrame> FrameBatch::toVector() const
+{
+    QVector<CANFrame> out;
+    out.reserve(count());
+    for (int i = 0; i < count(); i++) out.append(at(i));
+    return out;
+}
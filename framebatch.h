@@ -0,0 +1,64 @@
+#ifndef FRAMEBATCH_H
+#define FRAMEBATCH_H
+
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QMetaType>
+#include <vector>
+#include "canframestore.h"
+
+class CANConnection;
+
+/*
+ * The frames from one drain of a connection queue, packed the same way CANFrameStore packs them. The
+ * ingest thread fills a batch in and then hands it to everyone connected to
+ * CANConManager::framesReceived as a FrameBatchPtr. From that point on it is read only so every
+ * consumer, whatever thread it lives in, shares the one copy of the frames.
+ */
+class FrameBatch
+{
+public:
+    FrameBatch(CANConnection *conn, int busBase);
+    ~FrameBatch();
+
+    void append(const CANFrame &frame);
+    void reserve(int num) { records.reserve(num); }
+    void setFirstSequence(uint64_t seq) { firstSeq = seq; }
+
+    int count() const { return static_cast<int>(records.size()); }
+    bool isEmpty() const { return records.empty(); }
+    CANFrameView view(int idx) const;
+    CANFrame at(int idx) const { return view(idx).toCANFrame(); }
+    QVector<CANFrame> toVector() const;
+    const PackedCANFrame &record(int idx) const { return records[idx]; }
+
+    //the connection the frames came from (nullptr for frames sent while nothing was connected) and the
+    //global number of its first bus. Bus numbers in the frames are already global.
+    CANConnection *connection() const { return conn; }
+    int busBase() const { return base; }
+
+    //Sequence numbers the frames got in the capture store, firstSequence() up to but not including
+    //endSequence(). Meaningless if there was no capture store to put them in.
+    uint64_t firstSequence() const { return firstSeq; }
+    uint64_t endSequence() const { return firstSeq + static_cast<uint64_t>(count()); }
+
+    //Number of batches that still exist because some consumer hasn't let go of them yet. If this keeps
+    //climbing a slot connected to framesReceived can't keep up.
+    static int inFlight() { return numInFlight.loadAcquire(); }
+
+private:
+    std::vector<PackedCANFrame> records;
+    PayloadArena arena;
+    CANConnection *conn;
+    int base;
+    uint64_t firstSeq;
+
+    static QAtomicInt numInFlight;
+
+    Q_DISABLE_COPY(FrameBatch)
+};
+
+typedef QSharedPointer<const FrameBatch> FrameBatchPtr;
+Q_DECLARE_METATYPE(FrameBatchPtr)
+
+#endif // FRAMEBATCH_H
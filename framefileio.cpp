@@ -3,30 +3,27 @@
 #include <QMessageBox>
 #include <QProgressDialog>
 #include <QDateTime>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
 #include <QRegularExpression>
 #include <QtEndian>
 #include <QSettings>
+#include <QThread>
+#include <QAtomicInt>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include "pcaplite.h"
 
 #include "utility.h"
 #include "blfhandler.h"
+#include "capturefile.h"
+#include "textlogloader.h"
+#include "filesniffer.h"
 
-QFile FrameFileIO::continuousFile;
-
-struct TeslaAPCANRecord
-{
-    #pragma pack(push, 1)
-    int64_t sec;
-    int32_t nano;
-    int32_t padding1;
-    uint16_t id;
-    uint8_t ctr;
-    uint8_t data[8];
-    uint8_t padding2;
-    #pragma pack(pop)
-};
+QString FrameFileIO::detectReport;
 
 FrameFileIO::FrameFileIO()
 {
@@ -53,6 +50,7 @@ bool FrameFileIO::saveFrameFile(QString &fileName, const QVector<CANFrame>* fram
     filters.append(QString(tr("Cabana Log (*.csv *.CSV)")));
     filters.append(QString(tr("CANalyzer Ascii Log (*.asc *.ASC)")));
     filters.append(QString(tr("CARBUS Analyzer (*.trc *.TRC)")));
+    filters.append(QString(tr("SavvyCAN Capture (*.sccap *.SCCAP)")));
 
     dialog.setDirectory(settings.value("FileIO/LoadSaveDirectory", dialog.directory().path()).toString());
     dialog.setFileMode(QFileDialog::AnyFile);
@@ -143,6 +141,11 @@ bool FrameFileIO::saveFrameFile(QString &fileName, const QVector<CANFrame>* fram
             if (!filename.contains('.')) filename += ".trc";
             result = saveCARBUSAnalzyer(filename, frameCache);
         }
+        if (dialog.selectedNameFilter() == filters[13])
+        {
+            if (!filename.contains('.')) filename += ".sccap";
+            result = saveCaptureFile(filename, frameCache);
+        }
 
         progress.cancel();
 
@@ -165,6 +168,7 @@ bool FrameFileIO::loadFrameFile(QString &fileName, QVector<CANFrame>* frameCache
     QSettings settings;
     bool result = false;
 
+    detectReport.clear();
     QStringList filters;
     filters.append(QString(tr("Autodetect File Type (*.*)")));
     filters.append(QString(tr("GVRET Logs (*.csv *.CSV)")));
@@ -191,6 +195,7 @@ bool FrameFileIO::loadFrameFile(QString &fileName, QVector<CANFrame>* frameCache
     filters.append(QString(tr("CLX000 (*.txt *.TXT)")));
     filters.append(QString(tr("CANServer Binary Log (*.log *.LOG)")));
     filters.append(QString(tr("Wireshark (*.pcap *.PCAP *.pcapng *.PCAPNG)")));
+    filters.append(QString(tr("SavvyCAN Capture (*.sccap *.SCCAP)")));
 
     dialog.setDirectory(settings.value("FileIO/LoadSaveDirectory", dialog.directory().path()).toString());
     dialog.setFileMode(QFileDialog::ExistingFile);
@@ -237,6 +242,7 @@ bool FrameFileIO::loadFrameFile(QString &fileName, QVector<CANFrame>* frameCache
         if (selectedNameFilter == filters[22]) result = loadCLX000File(filename, frameCache);
         if (selectedNameFilter == filters[23]) result = loadCANServerFile(filename, frameCache);
         if (selectedNameFilter == filters[24]) result = loadWiresharkFile(filename, frameCache);
+        if (selectedNameFilter == filters[25]) result = loadCaptureFile(filename, frameCache);
 
 
         progress.cancel();
@@ -263,301 +269,208 @@ bool FrameFileIO::loadFrameFile(QString &fileName, QVector<CANFrame>* frameCache
 }
 
 
-//Try every format by first using the "is" functions which try to detect whether a given file is a good match to that
-//file format or not. Those functions are much less tolerant than the load functions and so should help to discriminate
-//whether a file could be loaded or not by a given loader. The loader return is still used in case the guess was wrong.
+//One sniff of the start of the file ranks the formats that could be it, then the loaders are tried best
+//guess first. The sniffers are much less tolerant than the load functions so they mostly rule formats out,
+//the loader return is still used in case the guess was wrong. A loader that fails has its frames taken
+//back out so the next one starts clean, the best guess's partial frames are kept for salvaging.
 bool FrameFileIO::autoDetectLoadFile(QString filename, QVector<CANFrame>* frames)
 {
-    qDebug() << "Attempting Canalyzer BLF";
-    if (isCanalyzerBLF(filename))
-    {
-        if (loadCanalyzerBLF(filename, frames))
-        {
-            qDebug() << "Loaded as Canalyzer BLF successfully!";
-            return true;
-        }
-    }
-
-    qDebug() << "Attempting native CSV";
-    if (isNativeCSVFile(filename))
-    {
-        if (loadNativeCSVFile(filename, frames))
-        {
-            qDebug() << "Loaded as native CSV successfully!";
-            return true;
-        }
-    }
-
-    qDebug() << "Attempting Tesla AP Snapshot";
-    if (isTeslaAPFile(filename))
-    {
-        if (loadTeslaAPFile(filename, frames))
-        {
-            qDebug() << "Loaded as Tesla AP Snapshot successfully!";
-            return true;
-        }
-    }
-
-    qDebug() << "Attempting CANServer Binary Log";
-    if (isCANServerFile(filename))
-    {
-        if (loadCANServerFile(filename, frames))
-        {
-            qDebug() << "Loaded as CANServer Binary Log successfully!";
-            return true;
-        }
-    }
-
-    qDebug() << "Attempting Wireshark Log";
-    if (isWiresharkFile(filename))
-    {
-        if (loadWiresharkFile(filename, frames))
-        {
-            qDebug() << "Loaded as Wireshark Log successfully!";
-            return true;
-        }
-    }
-
-    qDebug() << "Attempting canalyzer ASC";
-    if (isCanalyzerASC(filename))
-    {
-        if (loadCanalyzerASC(filename, frames))
-        {
-            qDebug() << "Loaded as Canalyzer ASC successfully!";
-            return true;
-        }
-    }
+    QVector<FileSniffer::Match> matches = FileSniffer::sniff(filename);
+    int startCount = frames->count();
+    QVector<CANFrame> salvage;
+    QStringList tried;
 
-    qDebug() << "Attempting CRTD";
-    if (isCRTDFile(filename))
+    detectReport.clear();
+    for (int i = 0; i < matches.count(); i++)
     {
-        if (loadCRTDFile(filename, frames))
-        {
-            qDebug() << "Loaded as CRTD successfully!";
-            return true;
-        }
-    }
-
+        const FileSniffer::Match &match = matches[i];
+        QString name = FileSniffer::formatName(match.format);
+        qDebug() << "Attempting" << name << "with" << FileSniffer::confidenceName(match.confidence) << "confidence";
+        tried.append(name);
 
-    qDebug() << "Attempting trace file";
-    if (isTraceFile(filename))
-    {
-        if (loadTraceFile(filename, frames))
+        if (loadDetectedFile(match.format, filename, frames))
         {
-            qDebug() << "Loaded as trace successfully!";
+            qDebug() << "Loaded as" << name << "successfully!";
+            detectReport = QString("Loaded as %1 (%2 confidence).").arg(name, FileSniffer::confidenceName(match.confidence));
+            QStringList others;
+            for (int j = 0; j < matches.count(); j++)
+            {
+                if (j == i) continue;
+                others.append(QString("%1 (%2)").arg(FileSniffer::formatName(matches[j].format),
+                                                     FileSniffer::confidenceName(matches[j].confidence)));
+            }
+            if (!others.isEmpty()) detectReport += " Other possible formats: " + others.join(", ");
             return true;
         }
-    }
 
-    qDebug() << "Attempting vehicle spy";
-    if (isVehicleSpyFile(filename))
-    {
-        if (loadVehicleSpyFile(filename, frames))
-        {
-            qDebug() << "Loaded as vehicle spy successfully!";
-            return true;
-        }
+        if (salvage.isEmpty() && frames->count() > startCount) salvage = frames->mid(startCount);
+        frames->resize(startCount);
     }
 
-    qDebug() << "Attempting candump";
-    if (isCanDumpFile(filename))
+    if (!salvage.isEmpty())
     {
-        if (loadCanDumpFile(filename, frames))
-        {
-            qDebug() << "Loaded as candump successfully!";
-            return true;
-        }
+        frames->append(salvage);
+        detectReport = QString("Partially loaded as %1.").arg(tried.first());
+        return false;
     }
 
-    qDebug() << "Attempting 'CARBUS Analyzer'";
-    if (isCARBUSAnalyzerFile(filename))
-    {
-        if (loadCARBUSAnalyzerFile(filename, frames))
-        {
-            qDebug() << "Loaded as 'CARBUS Analyzer' successfully!";
-            return true;
-        }
-    }
+    QMessageBox msgBox;
+    if (tried.isEmpty()) msgBox.setText("Could not autodetect the file type.\rPlease try to manually select the file format.");
+    else msgBox.setText("Could not autodetect the file type. Tried: " + tried.join(", ") +
+                        "\rPlease try to manually select the file format.");
+    msgBox.exec();
+    qDebug() << "Nothing worked... sorry...";
+    return false;
+}
 
-    qDebug() << "Attempting canhacker";
-    if (isCANHackerFile(filename))
-    {
-        if (loadCANHackerFile(filename, frames))
-        {
-            qDebug() << "Loaded as CANHacker successfully!";
-            return true;
-        }
-    }
+/*
+ * For captures too big to load. A SavvyCAN capture is paged in from where it is. The text formats parsed by
+ * TextLogLoader get converted into a capture in the cache directory the first time, opening the same
+ * unchanged log again reuses that. Anything else has to be loaded normally and saved as a capture first.
+ */
+bool FrameFileIO::openStreamingFile(QString &fileName, QString &captureFile)
+{
+    QFileDialog dialog;
+    QSettings settings;
 
-    qDebug() << "Attempting cabana";
-    if (isCabanaFile(filename))
-    {
-        if (loadCabanaFile(filename, frames))
-        {
-            qDebug() << "Loaded as Cabana successfully!";
-            return true;
-        }
-    }
+    QStringList filters;
+    filters.append(QString(tr("Streamable Logs (*.sccap *.csv *.log *.asc *.SCCAP *.CSV *.LOG *.ASC)")));
+    filters.append(QString(tr("All Files (*.*)")));
 
-    qDebug() << "Attempting canopen";
-    if (isCANOpenFile(filename))
-    {
-        if (loadCANOpenFile(filename, frames))
-        {
-            qDebug() << "Loaded as CANOpen Magic successfully!";
-            return true;
-        }
-    }
+    dialog.setDirectory(settings.value("FileIO/LoadSaveDirectory", dialog.directory().path()).toString());
+    dialog.setFileMode(QFileDialog::ExistingFile);
+    dialog.setNameFilters(filters);
+    dialog.setViewMode(QFileDialog::Detail);
+    if (dialog.exec() != QDialog::Accepted) return false;
 
-    qDebug() << "Attempting busmaster log";
-    if (isLogFile(filename))
-    {
-        if (loadLogFile(filename, frames))
-        {
-            qDebug() << "Loaded as Busmaster Log successfully!";
-            return true;
-        }
-    }
+    QString filename = dialog.selectedFiles()[0];
+    settings.setValue("FileIO/LoadSaveDirectory", dialog.directory().path());
+    QFileInfo info(filename);
 
-    qDebug() << "Attempting pcan";
-    if (isPCANFile(filename))
+    TextLogFormat format;
+    bool canConvert = false;
+    foreach (const FileSniffer::Match &match, FileSniffer::sniff(filename))
     {
-        if (loadPCANFile(filename, frames))
+        if (match.format == FileSniffer::CAPTURE)
         {
-            qDebug() << "Loaded as PCAN successfully!";
+            captureFile = filename;
+            fileName = info.fileName();
             return true;
         }
-    }
-
-    qDebug() << "Attempting ixxat";
-    if (isIXXATFile(filename))
-    {
-        if (loadIXXATFile(filename, frames))
+        if (streamableFormat(match.format, format))
         {
-            qDebug() << "Loaded as IXXAT successfully!";
-            return true;
+            canConvert = true;
+            break;
         }
     }
-
-    qDebug() << "Attempting microchip";
-    if (isMicrochipFile(filename))
+    if (!canConvert)
     {
-        if (loadMicrochipFile(filename, frames))
-        {
-            qDebug() << "Loaded as microchip successfully!";
-            return true;
-        }
+        QMessageBox msgBox;
+        msgBox.setText("This file can't be streamed.\r\nSavvyCAN captures, GVRET CSV, candump and CANalyzer ASC logs can. "
+                       "Other formats can be loaded normally and saved as a SavvyCAN capture.");
+        msgBox.exec();
+        return false;
     }
 
-    qDebug() << "Attempting CANDo";
-    if (isCANDOFile(filename))
-    {
-        if (loadCANDOFile(filename, frames))
-        {
-            qDebug() << "Loaded as CANDO successfully!";
-            return true;
-        }
-    }
+    //keyed on where the log is, its size and when it was changed so an edited log gets converted again
+    QString key = info.absoluteFilePath() + "|" + QString::number(info.size()) + "|"
+            + QString::number(info.lastModified().toMSecsSinceEpoch());
+    QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/streams");
+    if (!cacheDir.mkpath(".")) return false;
+    QString cached = cacheDir.filePath(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex() + ".sccap");
 
-    qDebug() << "Attempting kvaser";
-    if (isKvaserFile(filename))
+    if (!QFile::exists(cached))
     {
-        if (loadKvaserFile(filename, frames,true))
-        {
-            qDebug() << "Loaded as Kvaser HEX successfully!";
-            return true;
-        }
-        if (loadKvaserFile(filename, frames,false))
+        //written under another name first so a cancelled or failed conversion never gets reused
+        QString partial = cached + ".part";
+        CaptureFileWriter writer;
+        int badLines = 0;
+        bool truncated = false;
+        bool ok = writer.open(partial) && TextLogLoader::convert(filename, format, writer, &badLines, &truncated);
+        ok = writer.close() && ok;
+        if (!ok || !QFile::rename(partial, cached))
         {
-            qDebug() << "Loaded as KVaser Decimal successfully!";
-            return true;
+            QFile::remove(partial);
+            if (truncated)
+            {
+                QMessageBox msgBox;
+                msgBox.setText(info.fileName() + " can't be streamed, reading it stopped at a line that doesn't belong in the log. "
+                               "Loading it normally shows the frames before that line.");
+                msgBox.exec();
+            }
+            return false;
         }
-    }
-
-    qDebug() << "Attempting CLX000";
-    if (isCLX000File(filename))
-    {
-        if (loadCLX000File(filename, frames))
+        if (badLines)
         {
-            qDebug() << "Loaded as CLX000 successfully!";
-            return true;
+            QMessageBox msgBox;
+            msgBox.setText(QString::number(badLines) + " lines of " + info.fileName() + " could not be read and were skipped.");
+            msgBox.exec();
         }
     }
 
-    qDebug() << "Attempting lawicel";
-    if (isLawicelFile(filename))
-    {
-        if (loadLawicelFile(filename, frames))
-        {
-            qDebug() << "Loaded as lawicel successfully!";
-            return true;
-        }
-    }
+    captureFile = cached;
+    fileName = info.fileName();
+    return true;
+}
 
-    qDebug() << "Attempting generic CSV";
-    if (isGenericCSVFile(filename))
-    {
-        if (loadGenericCSVFile(filename, frames))
-        {
-            qDebug() << "Loaded as generic CSV successfully!";
-            return true;
-        }
+bool FrameFileIO::streamableFormat(FileSniffer::Format format, TextLogFormat &out)
+{
+    switch (format)
+    {
+    case FileSniffer::NATIVE_CSV: out = nativeCSVFormat(); return true;
+    case FileSniffer::CANDUMP: out = canDumpFormat(); return true;
+    case FileSniffer::CANALYZER_ASC: out = canalyzerASCFormat(); return true;
+    default: return false;
+    }
+}
+
+bool FrameFileIO::loadDetectedFile(FileSniffer::Format format, QString filename, QVector<CANFrame>* frames)
+{
+    int startCount = frames->count();
+
+    switch (format)
+    {
+    case FileSniffer::CAPTURE: return loadCaptureFile(filename, frames);
+    case FileSniffer::BLF: return loadCanalyzerBLF(filename, frames);
+    case FileSniffer::NATIVE_CSV: return loadNativeCSVFile(filename, frames);
+    case FileSniffer::TESLA_AP: return loadTeslaAPFile(filename, frames);
+    case FileSniffer::CANSERVER: return loadCANServerFile(filename, frames);
+    case FileSniffer::WIRESHARK: return loadWiresharkFile(filename, frames);
+    case FileSniffer::CANALYZER_ASC: return loadCanalyzerASC(filename, frames);
+    case FileSniffer::CRTD: return loadCRTDFile(filename, frames);
+    case FileSniffer::TRACE: return loadTraceFile(filename, frames);
+    case FileSniffer::VEHICLE_SPY: return loadVehicleSpyFile(filename, frames);
+    case FileSniffer::CANDUMP: return loadCanDumpFile(filename, frames);
+    case FileSniffer::CARBUS: return loadCARBUSAnalyzerFile(filename, frames);
+    case FileSniffer::CANHACKER: return loadCANHackerFile(filename, frames);
+    case FileSniffer::CABANA: return loadCabanaFile(filename, frames);
+    case FileSniffer::CANOPEN: return loadCANOpenFile(filename, frames);
+    case FileSniffer::BUSMASTER: return loadLogFile(filename, frames);
+    case FileSniffer::PCAN: return loadPCANFile(filename, frames);
+    case FileSniffer::IXXAT: return loadIXXATFile(filename, frames);
+    case FileSniffer::MICROCHIP: return loadMicrochipFile(filename, frames);
+    case FileSniffer::CANDO: return loadCANDOFile(filename, frames);
+    case FileSniffer::KVASER:
+        //the sniffer can't tell the two apart, hex first as before
+        if (loadKvaserFile(filename, frames, true)) return true;
+        frames->resize(startCount);
+        return loadKvaserFile(filename, frames, false);
+    case FileSniffer::CLX000: return loadCLX000File(filename, frames);
+    case FileSniffer::LAWICEL: return loadLawicelFile(filename, frames);
+    case FileSniffer::GENERIC_CSV: return loadGenericCSVFile(filename, frames);
+    case FileSniffer::NUM_FORMATS: break;
     }
-
-    QMessageBox msgBox;
-    msgBox.setText("Could not autodetect the file type.\rPlease try to manually select the file format.");
-    msgBox.exec();
-    qDebug() << "Nothing worked... sorry...";
     return false;
 }
 
-
-bool FrameFileIO::isVehicleSpyFile(QString filename)
+QString FrameFileIO::autoDetectReport()
 {
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    bool foundProbableHeader = false;
-    bool isMatch = false;
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-    try {
-        for (int i = 0; i < 10; i++)
-        {
-            if (!inFile->atEnd())
-            {
-                line = inFile->readLine().simplified().toUpper();
-                if (line.startsWith("LINE") && line.contains("TIME") && line.contains("B1"))
-                {
-                    foundProbableHeader = true;
-                }
-            }
-        }
-        if (foundProbableHeader)
-        {
-            if (!inFile->atEnd())
-            {
-                line = inFile->readLine().simplified().toUpper();
-                inFile->close();
-                QList<QByteArray> tokens = line.split(',');
-                if (tokens.length() > 20)
-                {
-                    if (tokens[9].toInt(nullptr, 16) > 0) isMatch = true;
-                }
-            }
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    return isMatch;
+    return detectReport;
 }
 
 
+
+
 //2,2550.368293675,0.003818174999651092,67371008,F,F,HS CAN $119,HS CAN,,119,F,F,00,00,00,00,00,00,0D,8B,,,
 //Line,Abs Time(Sec),Rel Time (Sec),Status,Er,Tx,Description,Network,Node,Arb ID,Remote,Xtd,B1,B2,B3,B4,B5,B6,B7,B8,Value,Trigger,Signals
 // 0       1             2             3   4  5   6             7     8     9     10     11 12 13 14 15 16 17 18 19  20     21      22
@@ -636,56 +549,6 @@ bool FrameFileIO::saveVehicleSpyFile(QString filename, const QVector<CANFrame> *
     return true;
 }
 
-bool FrameFileIO::isCRTDFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    int lineCounter = 0;
-    bool isMatch = false;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-
-    try
-    {
-        line = inFile->readLine().toUpper(); //read out the header first and discard it.
-
-        while (!inFile->atEnd() && lineCounter < 100) {
-            lineCounter++;
-            line = inFile->readLine().simplified();
-            if (line.length() > 2)
-            {
-                QList<QByteArray> tokens = line.split(' ');
-                if (tokens.length() > 2)
-                {
-                    char firstChar = tokens[1].left(1)[0];
-                    if (firstChar >= '1' && firstChar <= '9')
-                    {
-                        tokens[1].remove(0,1); // Remove leading digit (bus number)
-                        firstChar = tokens[1].left(1)[0];
-                    }
-                    if (firstChar == 'R' || firstChar == 'T')
-                    {
-                        if (tokens[1] == "R29" || tokens[1] == "T29") isMatch = true;
-                        if (tokens[1] == "R11" || tokens[1] == "T11") isMatch = true;
-                    }
-                }
-                else isMatch = false;
-            }
-            if (lineCounter > 10) break;
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 //CRTD format from Mark Webb-Johnson / OVMS project
 // Specification at: https://docs.openvehicles.com/en/latest/crtd/
@@ -794,33 +657,6 @@ bool FrameFileIO::loadCRTDFile(QString filename, QVector<CANFrame>* frames)
     return !foundErrors;
 }
 
-bool FrameFileIO::isCARBUSAnalyzerFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-
-    bool isMatch = false;
-
-    // not Text mode because file contains `\r` new lines
-    if (!inFile->open(QIODevice::ReadOnly))
-    {
-        delete inFile;
-        return false;
-    }
-    try
-    {
-        //read header
-        line = inFile->readLine().toUpper();
-        if (line.startsWith("@ TEXT @")) return true;
-    } catch (...)
-    {
-        isMatch = false;
-    }
-
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 // CARBUS Analayzer trace format https://canhacker.ru/can-trace-format/ :
 // header
@@ -1004,53 +840,6 @@ bool FrameFileIO::saveCARBUSAnalzyer(QString filename, const QVector<CANFrame>*
     return true;
 }
 
-bool FrameFileIO::isCANHackerFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    int lineCounter = 0;
-    bool isMatch = false;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-    try
-    {
-        line = inFile->readLine().toUpper(); //read out the header first and discard it.
-        if (line.contains("CANHACKER")) return true;
-
-        while (!inFile->atEnd()) {
-            lineCounter++;
-            line = inFile->readLine().simplified();
-            if (line.length() > 2)
-            {
-                QList<QByteArray> tokens = line.split(' ');
-                if (tokens.length() > 3)
-                {
-                    if (tokens[1].toInt(nullptr, 16) > 0)
-                    {
-                        int len = tokens[2].toInt();
-                        if (len > -1 && len < 9)
-                        {
-                            isMatch = true;
-                        }
-                    }
-                }
-                else isMatch = false;
-            }
-            if (lineCounter > 10) break;
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 // CANHacker trace format
 // Time   ID     DLC Data                    Comment
@@ -1136,82 +925,29 @@ bool FrameFileIO::loadCANHackerFile(QString filename, QVector<CANFrame>* frames)
     return !foundErrors;
 }
 
-bool FrameFileIO::isCANOpenFile(QString filename)
+
+//"Message Number","Time (ms)","Time","Excel Time","Count","ID","Flags","Message Type","Node","Details","Process Data","Data (Hex)","Data (Text)","Data (Decimal)","Length","Raw Message"
+//"0","0.000","8:09:42:48.7953090'",43447.7100146116,"","0x2E1","","Default: PDO","","Default: TPDO 2 of Node 0x61 (97)","","10 21 04 00 00 00 00 00 ",". ! . . . . . . ","U:0 S:0","8","10 21 04 00 00 00 00 00"
+bool FrameFileIO::loadCANOpenFile(QString filename, QVector<CANFrame>* frames)
 {
     QFile *inFile = new QFile(filename);
+    CANFrame thisFrame;
     QByteArray line;
     int lineCounter = 0;
-    bool isMatch = false;
+    bool foundErrors = false;
 
     if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
     {
         delete inFile;
+        qDebug() << "Could not open the file!";
         return false;
     }
 
-    try
-    {
-        line = inFile->readLine().toUpper();
-        if (!line.contains("CANOPEN MAGIC")) return false;
-        line = inFile->readLine();
-        line = inFile->readLine();
-        line = inFile->readLine();
-        line = inFile->readLine();
-
-        while (!inFile->atEnd()) {
-            lineCounter++;
-            if (lineCounter > 10)
-            {
-                break;
-            }
-
-            line = inFile->readLine().replace('\"', ' ').simplified();
-            if (line.length() > 2)
-            {
-                QList<QByteArray> tokens = line.split(',');
-                if (tokens.length() > 11)
-                {
-                    if (Utility::ParseStringToNum(tokens[5].simplified()) > 0)
-                    {
-                        QList<QByteArray> dataTok = tokens[11].simplified().split(' ');
-                        if ( dataTok.length() > -1 && dataTok.length() < 9) isMatch = true;
-                    }
-                }
-                else isMatch = false;
-            }
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
-
-//"Message Number","Time (ms)","Time","Excel Time","Count","ID","Flags","Message Type","Node","Details","Process Data","Data (Hex)","Data (Text)","Data (Decimal)","Length","Raw Message"
-//"0","0.000","8:09:42:48.7953090'",43447.7100146116,"","0x2E1","","Default: PDO","","Default: TPDO 2 of Node 0x61 (97)","","10 21 04 00 00 00 00 00 ",". ! . . . . . . ","U:0 S:0","8","10 21 04 00 00 00 00 00"
-bool FrameFileIO::loadCANOpenFile(QString filename, QVector<CANFrame>* frames)
-{
-    QFile *inFile = new QFile(filename);
-    CANFrame thisFrame;
-    QByteArray line;
-    int lineCounter = 0;
-    bool foundErrors = false;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        qDebug() << "Could not open the file!";
-        return false;
-    }
-
-    line = inFile->readLine(); //read out the header first and discard it.
-    line = inFile->readLine();
-    line = inFile->readLine();
-    line = inFile->readLine();
-    line = inFile->readLine();
+    line = inFile->readLine(); //read out the header first and discard it.
+    line = inFile->readLine();
+    line = inFile->readLine();
+    line = inFile->readLine();
+    line = inFile->readLine();
 
     while (!inFile->atEnd()) {
         lineCounter++;
@@ -1316,41 +1052,6 @@ bool FrameFileIO::saveCRTDFile(QString filename, const QVector<CANFrame>* frames
 }
 
 
-bool FrameFileIO::isPCANFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    int lineCounter = 0;
-    bool hasFileVer = false;
-    bool isMatch = false;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-
-    try
-    {
-        while (!inFile->atEnd()) {
-            lineCounter++;
-            if (lineCounter > 25)
-            {
-                break;
-            }
-            line = inFile->readLine();
-            if (line.startsWith(";$FILEVERSION=")) hasFileVer = true;
-            if (line.toUpper().contains("PCAN") && hasFileVer) isMatch = true;
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 /*Fixed length lines
     Version 1.1
@@ -1624,51 +1325,6 @@ bool FrameFileIO::loadPCANFile(QString filename, QVector<CANFrame>* frames)
 }
 
 //supporting two styles now and they have very different line layouts. Just checking for the header for now. That should still match only ASC files.
-bool FrameFileIO::isCanalyzerASC(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    //int lineCounter = 0;
-    //bool inHeader = true;
-    bool isMatch = true;
-    QList<QByteArray> tokens;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-    try
-    {
-        if (!inFile->atEnd())
-        {
-            line = inFile->readLine();
-            if (!line.startsWith("date")) isMatch = false;
-        }
-        if (!inFile->atEnd() && isMatch)
-        {
-            line = inFile->readLine();
-            if (!line.startsWith("base")) isMatch = false;
-        }
-        if (!inFile->atEnd() && isMatch)
-        {
-            line = inFile->readLine();
-            if (!line.contains("logged")) isMatch = false;
-        }
-        if (!inFile->atEnd() && isMatch)
-        {
-            line = inFile->readLine();
-            if (!line.contains("version")) isMatch = false;
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 //There tends to be four lines of header first. The last of which starts with // so first burn off lines
 //until a line starting with // is seen, then the rest are formatted like this:
@@ -1690,192 +1346,109 @@ bool FrameFileIO::isCanalyzerASC(QString filename)
 //Time Type Bus Dir ID ?          ?         (length)    (Real Length) (bytes) (many values of unknown type)           (Ver 17.3)
 //0    1    2   3   4  5          6         7           8             9       10
 //This seems like a rather eclectic mix. It's almost arbitrary!
-bool FrameFileIO::loadCanalyzerASC(QString filename, QVector<CANFrame>* frames)
+TextLogFormat FrameFileIO::canalyzerASCFormat()
 {
-    QFile *inFile = new QFile(filename);
-    CANFrame thisFrame;
-    QByteArray line;
-    int lineCounter = 0;
-    bool foundErrors = false;
-    bool inHeader = true;
-    int verMajor;
-    int verMinor;
-    int verRevision;
-
-    thisFrame.setFrameType(QCanBusFrame::DataFrame);
-    QList<QByteArray> tokens;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
+    TextLogFormat format;
+    format.findBody = [](const char *data, qint64 size) -> qint64
     {
-        delete inFile;
-        return false;
-    }
-
-    while (!inFile->atEnd()) {
-        lineCounter++;
-        if (lineCounter > 100)
+        const char *p = data;
+        const char *end = data + size;
+        for (int lineCounter = 1; p < end; lineCounter++)
         {
-            qApp->processEvents();
-            lineCounter = 0;
-        }
-        line = inFile->readLine();
-        if (inHeader)
-        {
-            if (line.startsWith("//"))
+            const char *nl = static_cast<const char *>(memchr(p, '\n', static_cast<size_t>(end - p)));
+            const char *next = nl ? nl + 1 : end;
+            if (TextLog::startsWith(p, next, "//"))
             {
-                line = line.right(line.length() - 11);
-                QList<QByteArray> versionTokens = line.split('.');
+                QList<QByteArray> versionTokens = QByteArray(p, static_cast<int>(next - p)).mid(11).split('.');
                 if (versionTokens.length() > 2)
                 {
-                    verMajor = versionTokens[0].toInt();
-                    verMinor = versionTokens[1].toInt();
-                    verRevision = versionTokens[2].toInt();
-                    qDebug() << "Major: " << verMajor << " Minor:" << verMinor << " Rev:" << verRevision;
+                    qDebug() << "Major: " << versionTokens[0].toInt() << " Minor:" << versionTokens[1].toInt() << " Rev:" << versionTokens[2].toInt();
                 }
+                return next - data;
             }
-            if (line.startsWith("//") ||  lineCounter > 4)
-            {
-                inHeader = false;
-                continue;
-            }
+            if (lineCounter > 4) return next - data;
+            p = next;
         }
-        if (inHeader) continue;
-        if (line.length() > 2 && !line.startsWith("//"))
-        {            
-            tokens = line.simplified().split(' ');
+        return size;
+    };
 
-            if (tokens[0].contains("Begin")) continue; //probably begin triggerblock but we're ignoring that.
+    format.parseLine = [](const char *begin, const char *end, CANFrameData &frame)
+    {
+        if (end - begin < 2 || TextLog::startsWith(begin, end, "//")) return TextLogFormat::Skip;
 
-            //try to do some investigating to see if this line is a CAN frame or not. The file format has many other potential line types it seems...
-            if (tokens.length() > 5)
-            {
-                if (tokens[3].toUpper().startsWith("RX") || tokens[3].toUpper().startsWith("TX"))
-                {
-                    thisFrame.setTimeStamp(QCanBusFrame::TimeStamp(0, static_cast<uint64_t>(tokens[0].toDouble() * 1000000.0)));
-                    if (tokens[1].contains("CAN")) //the different format I haven't seen a whole lot of, seems to support CANFD in this format
-                    {
-                        if (tokens[4].endsWith('x'))
-                        {
-                            QByteArray copied_id = tokens[4];
-                            copied_id.chop(1);
-                            thisFrame.setFrameId(copied_id.toUInt(nullptr, 16));
-                            thisFrame.setExtendedFrameFormat(true);
-                        }
-                        else
-                        {
-                            thisFrame.setFrameId(tokens[4].toUInt(nullptr, 16));
-                            thisFrame.setExtendedFrameFormat(thisFrame.frameId() > 0x7FF);  //some .asc files have extended IDs without 'x'
-                        }
+        TextLog::Tokens tokens;
+        TextLog::split(begin, end, ' ', tokens);
+        if (tokens.count == 0 || tokens.startsWith(0, "Begin")) return TextLogFormat::Skip; //probably begin triggerblock but we're ignoring that.
 
-                        int payloadLen = tokens[8].toInt();
-                        qDebug() << "PayloadLen: " << payloadLen << " Tokens: " << tokens;
-                        QByteArray bytes(payloadLen, 0);
-                        if (payloadLen > 64)
-                        {
-                            qDebug() << "Payload length too long. Original line: " << line;
-                            return false;
-                        }
-                        if (payloadLen < 0)
-                        {
-                            qDebug() << "Payload length negative! Original line: " << line;
-                            return false;
-                        }
-                        thisFrame.isReceived = tokens[3].toUpper().contains("RX");
-                        thisFrame.bus = tokens[2].toInt();
+        //try to do some investigating to see if this line is a CAN frame or not. The file format has many other potential line types it seems...
+        if (tokens.count <= 5 || !(tokens.startsWith(3, "RX") || tokens.startsWith(3, "TX"))) return TextLogFormat::Skip;
 
-                        if (tokens[5].at(0) >= '0' && tokens[5].at(0) <= '9')
-                        {
-                            for (int d = 9; d < (9 + payloadLen); d++)
-                            {
-                                if (tokens.count() > d)
-                                {
-                                    bytes[d - 9] = static_cast<char>(tokens[d].toInt(nullptr, 16));
-                                }
-                                else //expected byte wasn't there to read. Set it zero and set error flag
-                                {
-                                    bytes[d - 9] = 0;
-                                    foundErrors = true;
-                                    qDebug() << "D:" << d << " Count:" << tokens.count();
-                                    qDebug() << "Expected byte missing! Original line: " << line;
-                                }
-                            }
-                            thisFrame.setPayload(bytes);
-                        }
-                        else
-                        {
-                            for (int d = 10; d < (10 + payloadLen); d++)
-                            {
-                                if (tokens.count() > d)
-                                {
-                                    bytes[d - 10] = static_cast<char>(tokens[d].toInt(nullptr, 16));
-                                }
-                                else //expected byte wasn't there to read. Set it zero and set error flag
-                                {
-                                    bytes[d - 10] = 0;
-                                    foundErrors = true;
-                                    qDebug() << "D:" << d << " Count:" << tokens.count();
-                                    qDebug() << "Expected byte missing! Original line: " << line;
-                                }
-                            }
-                            thisFrame.setPayload(bytes);
-                        }
-                    }
-                    else
-                    {
-                        int payloadLen = tokens[5].toInt();
-                        thisFrame.setTimeStamp(QCanBusFrame::TimeStamp(0, static_cast<uint64_t>(tokens[0].toDouble() * 1000000.0)));
-                        if (tokens[2].endsWith('x'))
-                        {
-                            QByteArray copied_id = tokens[2];
-                            copied_id.chop(1);
-                            thisFrame.setFrameId(copied_id.toUInt(nullptr, 16));
-                            thisFrame.setExtendedFrameFormat(true);
-                        }
-                        else
-                        {
-                            thisFrame.setFrameId(tokens[2].toUInt(nullptr, 16));
-                            thisFrame.setExtendedFrameFormat(thisFrame.frameId() > 0x7FF);  //some .asc files have extended IDs without 'x'
-                        }
-                        QByteArray bytes(payloadLen, 0);
+        int64_t micros, value;
+        if (!TextLog::parseSeconds(tokens.begin[0], tokens.length[0], micros)) micros = 0;
+        frame.timestamp = micros;
+        if (tokens.startsWith(3, "RX")) frame.flags |= CANFrameData::Received;
+        frame.frameType = QCanBusFrame::DataFrame;
 
-                        if (payloadLen > 8)
-                        {
-                            qDebug() << "Payload length too long. Original line: " << line;
-                            return false;
-                        }
-                        if (payloadLen < 0)
-                        {
-                            qDebug() << "Payload length negative! Original line: " << line;
-                            return false;
-                        }
-                        thisFrame.isReceived = tokens[3].toUpper().contains("RX");
-                        thisFrame.bus = tokens[1].toInt();
-                        if (tokens[4] == "r") thisFrame.setFrameType(QCanBusFrame::RemoteRequestFrame);
-                        for (int d = 6; d < (6 + payloadLen); d++)
-                        {
-                            if (tokens.count() > d)
-                            {
-                                bytes[d - 6] = static_cast<char>(tokens[d].toInt(nullptr, 16));
-                            }
-                            else //expected byte wasn't there to read. Set it zero and set error flag
-                            {
-                                bytes[d - 6] = 0;
-                                foundErrors = true;
-                                qDebug() << "D:" << d << " Count:" << tokens.count();
-                                qDebug() << "Expected byte missing! Original line: " << line;
-                            }
-                        }
-                        thisFrame.setPayload(bytes);
-                    }
-                    frames->append(thisFrame);
-                }
+        bool isFD = tokens.startsWith(1, "CAN"); //the different format I haven't seen a whole lot of, seems to support CANFD in this format
+        int idIdx = isFD ? 4 : 2;
+        int busIdx = isFD ? 2 : 1;
+        const char *id = tokens.begin[idIdx];
+        int idLen = tokens.length[idIdx];
+        if (idLen > 0 && id[idLen - 1] == 'x')
+        {
+            if (!TextLog::parseHex(id, idLen - 1, frame.frameId)) frame.frameId = 0;
+            frame.flags |= CANFrameData::Extended;
+        }
+        else
+        {
+            if (!TextLog::parseHex(id, idLen, frame.frameId)) frame.frameId = 0;
+            if (frame.frameId > 0x7FF) frame.flags |= CANFrameData::Extended; //some .asc files have extended IDs without 'x'
+        }
+        if (!TextLog::parseInt(tokens.begin[busIdx], tokens.length[busIdx], value)) value = 0;
+        frame.bus = static_cast<uint8_t>(value);
+
+        int dataIdx, maxLen;
+        if (isFD)
+        {
+            //the symbol name column is optional, the data length comes right before the data either way
+            dataIdx = (tokens.length[5] > 0 && tokens.begin[5][0] >= '0' && tokens.begin[5][0] <= '9') ? 9 : 10;
+            if (tokens.equals(1, "CANFD"))
+            {
+                frame.flags |= CANFrameData::FlexibleData;
+                if (tokens.equals(dataIdx - 4, "1")) frame.flags |= CANFrameData::BitrateSwitch;
+                if (tokens.equals(dataIdx - 3, "1")) frame.flags |= CANFrameData::ErrorState;
             }
+            maxLen = 64;
         }
-        //else foundErrors = true;
-    }
-    inFile->close();
-    delete inFile;
-    return !foundErrors;
+        else
+        {
+            dataIdx = 6;
+            maxLen = 8;
+            if (tokens.equals(4, "r")) frame.frameType = QCanBusFrame::RemoteRequestFrame;
+        }
+
+        if (dataIdx - 1 >= tokens.count || !TextLog::parseInt(tokens.begin[dataIdx - 1], tokens.length[dataIdx - 1], value)) value = 0;
+        if (value > maxLen || value < 0) return TextLogFormat::Fatal; //payload length out of range, the rest of the file can't be trusted
+        frame.length = static_cast<uint8_t>(value);
+
+        //expected bytes that aren't there are left zero and fail the load
+        TextLogFormat::LineResult result = TextLogFormat::Frame;
+        for (int d = 0; d < frame.length; d++)
+        {
+            uint32_t byte = 0;
+            if (dataIdx + d < tokens.count) TextLog::parseHex(tokens.begin[dataIdx + d], tokens.length[dataIdx + d], byte);
+            else result = TextLogFormat::FrameWithError;
+            frame.data[d] = static_cast<uint8_t>(byte);
+        }
+        return result;
+    };
+
+    return format;
+}
+
+bool FrameFileIO::loadCanalyzerASC(QString filename, QVector<CANFrame>* frames)
+{
+    return TextLogLoader::load(filename, canalyzerASCFormat(), frames);
 }
 
 bool FrameFileIO::saveCanalyzerASC(QString filename, const QVector<CANFrame>* frames)
@@ -1969,31 +1542,6 @@ bool FrameFileIO::saveCanalyzerASC(QString filename, const QVector<CANFrame>* fr
     return true;
 }
 
-bool FrameFileIO::isCanalyzerBLF(QString filename)
-{
-    BLF_FILE_HEADER header;
-
-    QFile *inFile = new QFile(filename);
-    bool isMatch = false;
-
-    if (!inFile->open(QIODevice::ReadOnly))
-    {
-        delete inFile;
-        return false;
-    }
-    inFile->read(reinterpret_cast<char *>(&header), sizeof(header));
-    if (qFromLittleEndian(header.sig) == 0x47474F4C)
-    {
-        qDebug() << "Proper BLF file header token";
-        isMatch = true;
-    }
-    else isMatch = false;
-
-    inFile->close();
-    delete inFile;
-
-    return isMatch;
-}
 
 //this one is pretty complicated and handled by it's own class
 bool FrameFileIO::loadCanalyzerBLF(QString filename, QVector<CANFrame> *frames)
@@ -2002,152 +1550,83 @@ bool FrameFileIO::loadCanalyzerBLF(QString filename, QVector<CANFrame> *frames)
     return blf.loadBLF(filename, frames);
 }
 
-bool FrameFileIO::isNativeCSVFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    int fileVersion = 1;
-    bool isMatch = true;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-    try
-    {
-        line = inFile->readLine().toUpper(); //read out the header first and discard it.
-        if (line.length() < 23) isMatch = false;
-        else if (line.at(23) == 'D') fileVersion = 2; //Dir is found starting at position 23 if this is a V2 file
-
-        if (!line.contains("TIME STAMP")) isMatch = false;
-        if (!line.contains("EXTENDED")) isMatch = false;
-        if (!line.contains("D1")) isMatch = false;
-
-        if (!inFile->atEnd()) {
-            line = inFile->readLine().simplified();
-            if (line.length() > 2)
-            {
-                QList<QByteArray> tokens = line.split(',');
-                if (tokens.length() >= 5)
-                {
-                    if (fileVersion == 1)
-                    {
-                        if (tokens[4].toUInt() > 8) isMatch = false;
-                    }
-                    else if (fileVersion == 2)
-                    {
-                        if ( tokens[5].toUInt() > 8) isMatch = false;
-                    }
-                }
-                else isMatch = false;
-            }
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-
-    return isMatch;
-}
 
 //The "native" file format for this program
 //Time Stamp,ID,Extended,Dir,Bus,LEN,D1,D2,D3,D4,D5,D6,D7,D8
 //39747828,000005EB,false,Rx,0,8,E8,45,85,4B,4A,28,36,69,
-bool FrameFileIO::loadNativeCSVFile(QString filename, QVector<CANFrame>* frames)
+TextLogFormat FrameFileIO::nativeCSVFormat()
 {
-    QFile *inFile = new QFile(filename);
-    CANFrame thisFrame;
-    QByteArray line;
-    int fileVersion = 1;
-    uint64_t timeStamp = Utility::GetTimeMS();
-    int lineCounter = 0;
-    bool foundErrors = false;
-    thisFrame.setFrameType(QCanBusFrame::DataFrame);
+    //set by findBody and read by parseLine, shared so the format can outlive this function
+    std::shared_ptr<int> fileVersion(new int(1));
+    TextLogFormat format;
 
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
+    format.findBody = [fileVersion](const char *data, qint64 size) -> qint64
     {
-        delete inFile;
-        return false;
-    }
+        //the header tells which version this is and is thrown away
+        const char *nl = static_cast<const char *>(memchr(data, '\n', static_cast<size_t>(size)));
+        qint64 headerLen = nl ? (nl - data) + 1 : size;
+        if (headerLen > 23 && (data[23] == 'D' || data[23] == 'd')) *fileVersion = 2; //Dir is found starting at position 23 if this is a V2 file
+        return headerLen;
+    };
 
-    line = inFile->readLine().toUpper(); //read out the header first and discard it.
-    if (line.at(23) == 'D') fileVersion = 2; //Dir is found starting at position 23 if this is a V2 file
+    format.parseLine = [fileVersion](const char *begin, const char *end, CANFrameData &frame)
+    {
+        TextLog::Tokens tokens;
+        while (begin < end && static_cast<unsigned char>(*begin) <= ' ') begin++;
+        if (end - begin <= 2) return TextLogFormat::Skip;
+        TextLog::split(begin, end, ',', tokens);
+        if (tokens.count < 5) return TextLogFormat::Error;
 
-    while (!inFile->atEnd()) {
-        lineCounter++;
-        if (lineCounter > 100)
+        TextLogFormat::LineResult result = TextLogFormat::Frame;
+        int64_t value = 0;
+        if (tokens.length[0] > 3)
         {
-            qApp->processEvents();
-            lineCounter = 0;
+            if (!TextLog::parseInt(tokens.begin[0], tokens.length[0], value)) value = 0;
+            frame.timestamp = value;
         }
+        else result = TextLogFormat::FrameUntimed;
 
-        line = inFile->readLine().simplified();
-        if (line.length() > 2)
+        if (!TextLog::parseHex(tokens.begin[1], tokens.length[1], frame.frameId)) frame.frameId = 0;
+        if (tokens.startsWith(2, "TRUE")) frame.flags |= CANFrameData::Extended;
+        //fix for faulty files that fail to set the extended flag when they should
+        if (frame.frameId > 0x7FF) frame.flags |= CANFrameData::Extended;
+        frame.frameType = QCanBusFrame::DataFrame;
+
+        //version 1 has no direction column, everything in it was received
+        int col = 3;
+        if (*fileVersion == 2)
         {
-            QList<QByteArray> tokens = line.split(',');
-            if (tokens.length() >= 5)
-            {
-                if (tokens[0].length() > 3)
-                {
-                    thisFrame.setTimeStamp(QCanBusFrame::TimeStamp(0, tokens[0].toULongLong()));
-                }
-                else
-                {
-                    timeStamp += 5;
-                    thisFrame.setTimeStamp(QCanBusFrame::TimeStamp(0, timeStamp));
-                }
+            if (tokens.length[3] > 0 && tokens.begin[3][0] == 'R') frame.flags |= CANFrameData::Received;
+            col = 4;
+        }
+        else frame.flags |= CANFrameData::Received;
 
-                thisFrame.setFrameId(tokens[1].toUInt(nullptr, 16));
-                if (tokens[2].toUpper().contains("TRUE")) thisFrame.setExtendedFrameFormat(true);
-                    else thisFrame.setExtendedFrameFormat(false);
+        if (!TextLog::parseInt(tokens.begin[col], tokens.length[col], value)) value = 0;
+        frame.bus = static_cast<uint8_t>(value);
+        if (col + 1 >= tokens.count || !TextLog::parseInt(tokens.begin[col + 1], tokens.length[col + 1], value)) value = 0;
+        int lng = static_cast<int>(qBound<int64_t>(0, value, 8));
+        if (lng + col + 2 > tokens.count) lng = tokens.count - col - 2;
+        if (lng < 0) lng = 0;
+        frame.length = static_cast<uint8_t>(lng);
+        for (int d = 0; d < lng; d++)
+        {
+            uint32_t byte = 0;
+            TextLog::parseHex(tokens.begin[col + 2 + d], tokens.length[col + 2 + d], byte);
+            frame.data[d] = static_cast<uint8_t>(byte);
+        }
+        return result;
+    };
 
-                //fix for faulty files that fail to set the extended flag when they should
-                if (thisFrame.frameId() > 0x7FF) thisFrame.setExtendedFrameFormat(true);
+    //lines without a real timestamp count up from the time of day, 5 apart
+    format.untimedStart = static_cast<int64_t>(Utility::GetTimeMS());
+    format.untimedStep = 5;
 
-                thisFrame.setFrameType(QCanBusFrame::DataFrame);
-
-                if (fileVersion == 1)
-                {
-                    thisFrame.isReceived = true;
-                    thisFrame.bus = tokens[3].toInt();
-                    int lng = tokens[4].toInt();
-                    if (lng > 8) lng = 8;
-                    if (lng < 0) lng = 0;
-                    if (lng + 5 > tokens.length()) lng = tokens.length() - 5;
-                    QByteArray bytes(lng, 0);
-                    for (int c = 0; c < lng; c++) bytes[c] = 0;
-                    for (int d = 0; d < lng; d++)
-                        bytes[d] = static_cast<char>(tokens[5 + d].toInt(nullptr, 16));
-                    thisFrame.setPayload(bytes);
-                }
-                else if (fileVersion == 2)
-                {
-                    if (tokens[3].at(0) == 'R') thisFrame.isReceived = true;
-                    else thisFrame.isReceived = false;
-                    thisFrame.bus = tokens[4].toInt();                    
-                    int lng = tokens[5].toInt();
-                    if (lng > 8) lng = 8;
-                    if (lng < 0) lng = 0;
-                    if (lng + 6 > tokens.length()) lng = tokens.length() - 6;
-                    QByteArray bytes(lng, 0);
-                    for (int c = 0; c < lng; c++) bytes[c] = 0;
-                    for (int d = 0; d < lng; d++)
-                        bytes[d] = static_cast<char>(tokens[6 + d].toInt(nullptr, 16));
-                    thisFrame.setPayload(bytes);
-                }
+    return format;
+}
 
-                frames->append(thisFrame);
-            }
-            else foundErrors = true;
-        }
-    }
-    inFile->close();
-    delete inFile;
-    return !foundErrors;
+bool FrameFileIO::loadNativeCSVFile(QString filename, QVector<CANFrame>* frames)
+{
+    return TextLogLoader::load(filename, nativeCSVFormat(), frames);
 }
 
 bool FrameFileIO::saveNativeCSVFile(QString filename, const QVector<CANFrame>* frames)
@@ -2216,7 +1695,8 @@ bool FrameFileIO::saveNativeCSVFile(QString filename, const QVector<CANFrame>* f
     return true;
 }
 
-bool FrameFileIO::openContinuousNative()
+//Picks the file and format and starts the logger on it, rotation comes from the settings dialog
+bool FrameFileIO::openContinuousLog(ContinuousLogger &logger)
 {
     QString filename;
     QFileDialog dialog(qApp->activeWindow());
@@ -2224,6 +1704,7 @@ bool FrameFileIO::openContinuousNative()
 
     QStringList filters;
     filters.append(QString(tr("GVRET Logs (*.csv *.CSV)")));
+    filters.append(QString(tr("SavvyCAN Capture (*.sccap *.SCCAP)")));
 
     dialog.setDirectory(settings.value("FileIO/LoadSaveDirectory", dialog.directory().path()).toString());
     dialog.setFileMode(QFileDialog::AnyFile);
@@ -2234,135 +1715,24 @@ bool FrameFileIO::openContinuousNative()
     if (dialog.exec() == QDialog::Accepted)
     {
         filename = dialog.selectedFiles()[0];
-        continuousFile.setFileName(filename);
-
-        if (!continuousFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        ContinuousLogger::Format format = ContinuousLogger::NativeCSV;
+        if (dialog.selectedNameFilter() == filters[1])
         {
-            return false;
+            format = ContinuousLogger::Capture;
+            if (!filename.contains('.')) filename += ".sccap";
         }
-        continuousFile.write("Time Stamp,ID,Extended,Dir,Bus,LEN,D1,D2,D3,D4,D5,D6,D7,D8");
-        continuousFile.write("\n");
-        settings.setValue("FileIO/LoadSaveDirectory", dialog.directory().path());
-        return true;
-    }
-    return false;
-}
+        else if (!filename.contains('.')) filename += ".csv";
 
-bool FrameFileIO::closeContinuousNative()
-{
-    if (continuousFile.isOpen())
-    {
-        continuousFile.close();
+        qint64 rotateBytes = settings.value("Main/LogRotateSize", 0).toLongLong() * 1024 * 1024;
+        int rotateSeconds = settings.value("Main/LogRotateMinutes", 0).toInt() * 60;
+        if (!logger.start(filename, format, rotateBytes, rotateSeconds)) return false;
+        settings.setValue("FileIO/LoadSaveDirectory", dialog.directory().path());
         return true;
     }
     return false;
 }
 
-bool FrameFileIO::writeContinuousNative(const QVector<CANFrame>* frames, int beginningFrame)
-{
-
-    const unsigned char *data;
-    int dataLen;
-    const CANFrame *frame;
-
-    if (!continuousFile.isOpen()) return false;
-    qDebug() << "Bgn: " << beginningFrame << "  Count: " << frames->count();
-    for (int c = beginningFrame; c < frames->count(); c++)
-    {
-        frame = &frames->at(c);
-        data = reinterpret_cast<const unsigned char *>(frame->payload().constData());
-        dataLen = frame->payload().count();
-
-        continuousFile.write(QString::number(frame->timeStamp().microSeconds()).toUtf8());
-        continuousFile.putChar(44);
-
-        continuousFile.write(QString::number(frame->frameId(), 16).toUpper().rightJustified(8, '0').toUtf8());
-        continuousFile.putChar(44);
-
-        if (frame->hasExtendedFrameFormat()) continuousFile.write("true,");
-        else continuousFile.write("false,");
-
-        if (frame->isReceived) continuousFile.write("Rx,");
-        else continuousFile.write("Tx,");
-
-        continuousFile.write(QString::number(frame->bus).toUtf8());
-        continuousFile.putChar(44);
-
-        continuousFile.write(QString::number(dataLen).toUtf8());
-        continuousFile.putChar(44);
-
-        for (int temp = 0; temp < 8; temp++)
-        {
-            if (temp < dataLen)
-                continuousFile.write(QString::number(data[temp], 16).toUpper().rightJustified(2, '0').toUtf8());
-            else
-                continuousFile.write("00");
-            continuousFile.putChar(44);
-        }
-
-        continuousFile.write("\n");
-    }
-    return true;
-}
-
-bool FrameFileIO::flushContinuousNative()
-{
-    if (continuousFile.isOpen())
-    {
-        return continuousFile.flush();
-    }
-    return false;
-}
-
-
-bool FrameFileIO::isGenericCSVFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    bool isMatch = true;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-    try
-    {
-        line = inFile->readLine(); //read out the header first and discard it.
-
-        if (!inFile->atEnd()) {
-            line = inFile->readLine();
-            if (line.length() > 2)
-            {
-                QList<QByteArray> tokens = line.split(',');
 
-                int ID = tokens[0].toInt(nullptr, 16);
-                if (ID < 1 || ID > 0x1FFFFFFF) isMatch = false;
-
-                if (tokens.count() < 2)
-                {
-                    isMatch = false;
-                }
-
-                if (isMatch)
-                {
-                    QList<QByteArray> dataTok = tokens[1].split(' ');
-                    int len = dataTok.length();
-                    if (len > 8) isMatch = false;
-                    if (len < 2) isMatch = false;
-                }
-            }
-            else isMatch = false;
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 bool FrameFileIO::loadGenericCSVFile(QString filename, QVector<CANFrame>* frames)
 {
@@ -2466,61 +1836,10 @@ bool FrameFileIO::saveGenericCSVFile(QString filename, const QVector<CANFrame>*
     }
     outFile->close();
     delete outFile;
-    return true;
-}
-
-bool FrameFileIO::isLogFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    bool isMatch = true;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-
-    try
-    {
-        line = inFile->readLine().toUpper();
-        if (!line.contains("BUSMASTER")) isMatch = false;
-
-        while (!inFile->atEnd() && line.startsWith("***")) {
-            line = inFile->readLine().toUpper();
-        }
-
-        if (!inFile->atEnd())
-        {
-            line = inFile->readLine().toUpper();
-            if (line.length() > 1)
-            {
-                QList<QByteArray> tokens = line.split(' ');
-                if (tokens.length() >= 6)
-                {
-                    QList<QByteArray> timeToks = tokens[0].split(':');
-                    if (timeToks.count() != 4) isMatch = false;
-
-                    int ID = tokens[3].right(tokens[3].length() - 2).toInt(nullptr, 16);
-                    if (ID < 1 || ID > 0x1FFFFFFF) isMatch = false;
-                    if (tokens[4] != "S" && tokens[4] != "X" && tokens[4] != "SR" && tokens[4] != "XR") isMatch = false;
-                    int len = tokens[5].toInt();
-                    if (len > 8) isMatch = false;
-                }
-                else isMatch = false;
-            }
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-
-    inFile->close();
-    delete inFile;
-    return isMatch;
+    return true;
 }
 
+
 //busmaster log file
 /*
 tokens:
@@ -2707,40 +2026,6 @@ bool FrameFileIO::saveLogFile(QString filename, const QVector<CANFrame>* frames)
     return true;
 }
 
-bool FrameFileIO::isIXXATFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    bool isMatch = true;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-
-    try
-    {
-        line = inFile->readLine().toUpper();
-        if (!line.contains("IXXAT")) isMatch = false;
-
-        for (int i = 0; i < 6; i++)
-        {
-            if (!inFile->atEnd()) line = inFile->readLine().toUpper();
-            else isMatch = false;
-        }
-
-        if (!line.contains("FORMAT")) isMatch = false;
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 //"00:01:03.03","223","Std","","00 00 00 00 49 00 00 01 "
 bool FrameFileIO::loadIXXATFile(QString filename, QVector<CANFrame>* frames)
@@ -2885,53 +2170,6 @@ bool FrameFileIO::saveIXXATFile(QString filename, const QVector<CANFrame>* frame
     return true;
 }
 
-bool FrameFileIO::isCANDOFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    int lineCounter = 0;
-    QByteArray data;
-    bool isMatch = true;
-
-    if (!inFile->open(QIODevice::ReadOnly))
-    {
-        delete inFile;
-        return false;
-    }
-
-    //this file format is in static 12 byte blocks.
-    //Bytes 0 - 1 are a time stamp
-    //Bytes 2 - 3 are the data length (top 4 bits) then ID (bottom 11 bits)
-    //Bytes 4 - 11 are the data bytes (padded with FF for bytes not used)
-    try
-    {
-        while (!inFile->atEnd() && lineCounter < 200)
-        {
-            lineCounter++;
-
-            data = inFile->read(12);
-
-            int ID = ((data[3] & 0x0F) * 256 + data[2]);
-            int len = data[3] >> 4;
-
-            if (len <= 8 && ID <= 0x7FF)
-            {
-                if (len < 8)
-                {
-                    if (data[4 + len] != static_cast<char>(0xFF)) isMatch = false;
-                }
-            }
-            else isMatch = false;
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 bool FrameFileIO::loadCANDOFile(QString filename, QVector<CANFrame>* frames)
 {
@@ -3062,58 +2300,6 @@ bool FrameFileIO::saveCANDOFile(QString filename, const QVector<CANFrame>* frame
     return true;
 }
 
-bool FrameFileIO::isMicrochipFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    bool inComment = false;
-    int lineCounter = 0;
-    bool isMatch = true;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-    try
-    {
-        while (!inFile->atEnd() && lineCounter < 100) {
-            lineCounter++;
-
-            line = inFile->readLine();
-            if (line.length() > 2)
-            {
-                if (line.startsWith("//"))
-                {
-                    inComment = !inComment;
-                }
-                else
-                {
-                    if (!inComment)
-                    {
-                        QList<QByteArray> tokens = line.split(';');
-                        if (tokens.length() >= 4)
-                        {
-                            int ID = Utility::ParseStringToNum(tokens[2]);
-                            if (ID < 1 || ID > 0x1FFFFFFF) isMatch = false;
-                            int len = tokens[3].toInt();
-                            if ( len > 8 || len < 0 ) isMatch = false;
-                            if ( (len + 4)  < tokens.length() ) isMatch = false;
-                        }
-                        else isMatch = false;
-                    }
-                }
-            }
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 //log file from microchip tool
 /*
@@ -3263,61 +2449,6 @@ bool FrameFileIO::saveMicrochipFile(QString filename, const QVector<CANFrame>* f
     return true;
 }
 
-bool FrameFileIO::isTraceFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    int lineCounter = 0;
-    bool isMatch = true;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-
-    try
-    {
-        while (!inFile->atEnd() && lineCounter < 100) {
-            lineCounter++;
-
-            line = inFile->readLine();
-            line = line.trimmed();
-            if (line.length() > 2)
-            {
-                if (line.startsWith(";"))
-                {
-                    // a comment. Ignore it.
-                }
-                else
-                {
-                    QList<QByteArray> tokens = line.split('\t');
-                    if (tokens.length() > 3)
-                    {
-                        QList<QByteArray> timestampToks = tokens[1].split(':');
-                        if (timestampToks.count() != 4) isMatch = false;
-
-                        long ID = tokens[2].toLong(nullptr, 16);
-                        if (ID < 1 || ID > 0x1FFFFFFF) isMatch = false;
-                        int len = tokens[3].toInt();
-                        if (len > 8 || len < 0) isMatch = false;
-                        QList<QByteArray> dataToks = tokens[4].split(' ');
-                        if (len > dataToks.length()) isMatch = false;
-                    }
-                    else isMatch = false;
-                }
-            }
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 /*
 ;  CAN Logger trace file
@@ -3576,306 +2707,109 @@ bool FrameFileIO::saveCanDumpFile(QString filename, const QVector<CANFrame> * fr
     return true;
 }
 
-bool FrameFileIO::isCanDumpFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    QList<QByteArray> tokens;
-    QRegularExpression timeExp(QRegularExpression::anchoredPattern("^\\((\\S+)\\)$")); //anchored pattern causes exact match
-    QRegularExpression IdValExp(QRegularExpression::anchoredPattern("^(\\S+)#(\\S+)$"));
-    QRegularExpression valExp("(\\S{2})");
-    int lineCounter = 0;
-    int pos = 0;
-    bool isMatch = true;
-    bool ret;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-
-    try
-    {
-        while (!inFile->atEnd() && lineCounter < 100) {
-            lineCounter++;
-
-            line = inFile->readLine().toUpper();
-            if (line.length() > 1)
-            {
-                /* tokenize */
-                tokens.clear();
-                tokens = line.simplified().split(' ');
-                if(tokens.count() < 3) isMatch = false;
-
-                /* timestamp */                
-                QRegularExpressionMatch timeExpMatched = timeExp.match(tokens[0]);
-                if(!timeExpMatched.hasMatch()) {
-                    isMatch = false;
-                }
-
-                /*uint64_t timestamp = (uint64_t)*/(timeExpMatched.captured(1).toDouble(&ret) /** (double)1000000.0*/);
-                if(!ret) isMatch = false;
-
-                if (line.contains('[')) //the expanded format
-                {
-                    //(1551774790.942758) can1 7A8 [8] F4 DC D1 83 0E 02 00 00
-                    //     0               1     2   3  4 5  6  7  8  9  10 11
-                    if (tokens.count() < 4)
-                    {
-                        isMatch = false;
-                        continue;
-                    }
-                    int ID = tokens[2].toULong(nullptr, 16);
-                    if (ID > 0x1FFFFFFF || ID == 0) isMatch = false;
-                    if (tokens[3].size() < 2) {
-                        isMatch = false;
-                        continue;
-                    }
-                    int len = tokens[3].at(1) - '0';
-                    if (len < 0 || len > 8) isMatch = false;
-                }
-                else  //the more concise format
-                {
-                    /* ID & value */
-                    //qDebug() << tokens[2];
-                    if (tokens.count() < 3)
-                    {
-                        isMatch = false;
-                        continue;
-                    }
-
-
-                    QRegularExpressionMatch IdValExpMatched = IdValExp.match(tokens[2]);
-                    if(!IdValExpMatched.hasMatch())
-                    {
-                        isMatch = false;
-                        continue;
-                    }
-
-                    /* ID */
-                    /*int ID = */IdValExpMatched.captured(1).toInt(&ret, 16);
-
-                    QString val= IdValExpMatched.captured(2);
-
-                    pos = 0;
-                    int len = 0;
-                    if (val.startsWith("R") && val.at(1).isDigit()) {
-                        len = val.at(1).toLatin1() - '0';
-                        if (len < 0 || len > 8)
-                        {
-                            isMatch = false;
-                            continue;
-                        }
-                    } else {
-                        /* val byte per byte */
-                        int lng = 0;
-                        QRegularExpressionMatch valExpMatch;
-                        QRegularExpressionMatchIterator i = valExp.globalMatch(val);
-                        while (i.hasNext()) {
-                            valExpMatch = i.next();
-                            lng++;
-                            if (lng > 8)
-                            {
-                                isMatch = false;
-                                break;
-                            }
-                            /*int data = */valExpMatch.captured(1).toInt(&ret, 16);
-                            if(!ret)
-                            {
-                                isMatch = false;
-                                break;
-                            }
-
-                        }
-                    }
-                }
-            }
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 /*
    (0.003800) vcan0 164#0000c01aa8000013
                        or
    (1551774790.942758) can1 7A8 [8] F4 DC D1 83 0E 02 00 00
 */
-bool FrameFileIO::loadCanDumpFile(QString filename, QVector<CANFrame>* frames)
-{
-    QFile *inFile = new QFile(filename);
-    CANFrame thisFrame;
-    QByteArray line;
-    QList<QByteArray> tokens;
-    QRegularExpression timeExp(QRegularExpression::anchoredPattern("^\\((\\S+)\\)$")); //anchored pattern causes exact match
-    QRegularExpression IdValExp(QRegularExpression::anchoredPattern("^(\\S+)#(\\S+)$"));
-    QRegularExpression valExp("(\\S{2})");
-    int lineCounter = 0;
-    bool ret;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-
-    while (!inFile->atEnd()) {
-        lineCounter++;
-        if (lineCounter > 100)
-        {
-            qApp->processEvents();
-            lineCounter = 0;
-        }
-
-        line = inFile->readLine().toUpper();
-        if (line.length() > 1)
-        {
-            /* tokenize */
-            tokens.clear();
-            tokens = line.simplified().split(' ');
-            if(tokens.count()<3) continue;
-
-            /* timestamp */
-            QRegularExpressionMatch timeExpMatched = timeExp.match(tokens[0]);
-            if(!timeExpMatched.hasMatch()) continue;
-            
-            //Sort out the bus
-            std::string busString = tokens[1].toStdString();
-            const char* busStringPtr = busString.c_str();
-            
-            int busNum = 0;
-            
-            //Search for where we have a bus number (skipping the can or vcan text)
-            for (unsigned int i = 0; i < busString.length(); i++)
-            {
-                if (busStringPtr[i] >= '0' && busStringPtr[i] <= '9')
-                {
-                    //Found where the number starts
-                    busNum = atoi(busStringPtr + i);
-                    break;
-                }
-            }
-            
-            thisFrame.bus = busNum;
-            
-            thisFrame.setTimeStamp(QCanBusFrame::TimeStamp(0, (uint64_t)(timeExpMatched.captured(1).toDouble(&ret) * (double)1000000.0)));
-            if(!ret) continue;
-
-            if (line.contains('[')) //the expanded format (second one from the above list)
-            {
-                //(1551774790.942758) can1 7A8 [8] F4 DC D1 83 0E 02 00 00
-                //     0               1     2   3  4 5  6  7  8  9  10 11
-                thisFrame.setFrameId(tokens[2].toLong(nullptr, 16));
-                if (thisFrame.frameId() > 0x7FF) thisFrame.setExtendedFrameFormat(true);
-                else thisFrame.setExtendedFrameFormat(false);
-                thisFrame.setFrameType(QCanBusFrame::DataFrame);
-                int numBytes = tokens[3].at(1) - '0';
-                QByteArray bytes(numBytes, 0);
-                for (int c = 0; c < numBytes; c++)
-                {
-                    if ((4 + c) < tokens.size()) bytes[c] = static_cast<char>(tokens[4 + c].toInt(nullptr, 16));
-                }
-                thisFrame.setPayload(bytes);
-            }
-            else  //the more concise format (first one from list above)
-            {
-                /* ID & value */
-                //qDebug() << tokens[2];
-                QRegularExpressionMatch IdValExpMatched = IdValExp.match(tokens[2]);
-                if(!IdValExpMatched.hasMatch())
-                {
-                    qDebug() << "ID regex didn't match!";
-                    continue;
-                }
-
-                /* ID */
-                thisFrame.setFrameId(static_cast<uint32_t>(IdValExpMatched.captured(1).toInt(&ret, 16)));
-                if (IdValExpMatched.captured(1).length() > 3)
-                {
-                    thisFrame.setExtendedFrameFormat(true);
-                }
-                else
-                {
-                    thisFrame.setExtendedFrameFormat(false);
-                }
-
-                QString val = IdValExpMatched.captured(2);
-
-                QByteArray bytes;
-                if (val.startsWith("R") && val.at(1).isDigit()) {
-                    thisFrame.payload().resize( val.at(1).toLatin1() - '0' );
-                    thisFrame.setFrameType(QCanBusFrame::RemoteRequestFrame);
-                } else {
-                    thisFrame.setFrameType(QCanBusFrame::DataFrame);
-                    /* val byte per byte */
-                    QRegularExpressionMatch valExpMatch;
-                    QRegularExpressionMatchIterator i = valExp.globalMatch(val);
-                    while (i.hasNext())
-                    {
-                        valExpMatch = i.next();
-                        bytes.append((char)valExpMatch.captured(1).toInt(&ret, 16));
-                        if(!ret) continue;
-                    }
-                }
-                thisFrame.setPayload(bytes);
-            }
-
-            /*NB: should we make sure len <= 8? */
-            thisFrame.isReceived = true;
-       }
-       frames->append(thisFrame);
-    }
-    inFile->close();
-    delete inFile;
-    return true;
-}
-
-bool FrameFileIO::isLawicelFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    int lineCounter = 0;
-    bool isMatch = false;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-
-    try
-    {
-        while (!inFile->atEnd() && lineCounter < 100) {
-            lineCounter++;
-
-            line = inFile->readLine().toUpper();
-            if (line.length() > 4 && !line.startsWith("S"))
+TextLogFormat FrameFileIO::canDumpFormat()
+{
+    //lines that can't be read are skipped, a candump log is never rejected outright
+    TextLogFormat format;
+    format.findBody = [](const char *, qint64) -> qint64 { return 0; };
+    format.parseLine = [](const char *begin, const char *end, CANFrameData &frame)
+    {
+        TextLog::Tokens tokens;
+        TextLog::split(begin, end, ' ', tokens);
+        if (tokens.count < 3) return TextLogFormat::Skip;
+
+        /* timestamp */
+        const char *time = tokens.begin[0];
+        int timeLen = tokens.length[0];
+        if (timeLen < 3 || time[0] != '(' || time[timeLen - 1] != ')') return TextLogFormat::Skip;
+        int64_t micros;
+        if (!TextLog::parseSeconds(time + 1, timeLen - 2, micros)) return TextLogFormat::Skip;
+        frame.timestamp = micros;
+
+        //Sort out the bus, skipping the can or vcan text
+        int64_t busNum = 0;
+        for (int i = 0; i < tokens.length[1]; i++)
+        {
+            if (tokens.begin[1][i] >= '0' && tokens.begin[1][i] <= '9')
             {
-                int ID = line.mid(0, 3).toInt(nullptr, 16);
-                if (ID > 0 && ID < 0x800)
-                {
-                    line.remove(0, 3);
-                    int len = line.length() / 2;
-                    if (len > -1 && len < 9) isMatch = true;
-                }
+                int numLen = 0;
+                while (i + numLen < tokens.length[1] && tokens.begin[1][i + numLen] >= '0' && tokens.begin[1][i + numLen] <= '9') numLen++;
+                TextLog::parseInt(tokens.begin[1] + i, numLen, busNum);
+                break;
             }
         }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-    return isMatch;
+        frame.bus = static_cast<uint8_t>(busNum);
+        frame.flags = CANFrameData::Received;
+        frame.frameType = QCanBusFrame::DataFrame;
+
+        if (TextLog::contains(begin, end, '[')) //the expanded format (second one from the above list)
+        {
+            //(1551774790.942758) can1 7A8 [8] F4 DC D1 83 0E 02 00 00
+            //     0               1     2   3  4 5  6  7  8  9  10 11
+            if (!TextLog::parseHex(tokens.begin[2], tokens.length[2], frame.frameId)) frame.frameId = 0;
+            if (frame.frameId > 0x7FF) frame.flags |= CANFrameData::Extended;
+            int numBytes = (tokens.count > 3 && tokens.length[3] > 1) ? tokens.begin[3][1] - '0' : 0;
+            if (numBytes < 0 || numBytes > 8) return TextLogFormat::Skip;
+            frame.length = static_cast<uint8_t>(numBytes);
+            for (int c = 0; c < numBytes && 4 + c < tokens.count; c++)
+            {
+                uint32_t byte = 0;
+                TextLog::parseHex(tokens.begin[4 + c], tokens.length[4 + c], byte);
+                frame.data[c] = static_cast<uint8_t>(byte);
+            }
+            return TextLogFormat::Frame;
+        }
+
+        //the more concise format (first one from list above). ID#data, ID#R for remote frames and
+        //ID##<flags>data for CAN-FD where flags is one hex digit, 1 = bitrate switch, 2 = error state
+        const char *tok = tokens.begin[2];
+        const char *tokEnd = tok + tokens.length[2];
+        const char *hash = static_cast<const char *>(memchr(tok, '#', tokens.length[2]));
+        if (!hash || hash == tok || hash + 1 == tokEnd) return TextLogFormat::Skip;
+        int idLen = static_cast<int>(hash - tok);
+        if (!TextLog::parseHex(tok, idLen, frame.frameId)) return TextLogFormat::Skip;
+        if (idLen > 3) frame.flags |= CANFrameData::Extended;
+
+        const char *val = hash + 1;
+        int maxBytes = 8;
+        if (*val == '#')
+        {
+            if (tokEnd - val < 2) return TextLogFormat::Skip;
+            int fdFlags = TextLog::hexDigit(val[1]);
+            if (fdFlags < 0) return TextLogFormat::Skip;
+            frame.flags |= CANFrameData::FlexibleData;
+            if (fdFlags & 1) frame.flags |= CANFrameData::BitrateSwitch;
+            if (fdFlags & 2) frame.flags |= CANFrameData::ErrorState;
+            val += 2;
+            maxBytes = 64;
+        }
+        else if ((*val == 'R' || *val == 'r') && (tokEnd - val == 1 || (val[1] >= '0' && val[1] <= '9')))
+        {
+            frame.frameType = QCanBusFrame::RemoteRequestFrame;
+            return TextLogFormat::Frame;
+        }
+
+        int numBytes = TextLog::parseHexBytes(val, static_cast<int>(tokEnd - val), frame.data, maxBytes);
+        if (numBytes < 0) return TextLogFormat::Skip;
+        frame.length = static_cast<uint8_t>(numBytes);
+        return TextLogFormat::Frame;
+    };
+
+    return format;
+}
+
+bool FrameFileIO::loadCanDumpFile(QString filename, QVector<CANFrame>* frames)
+{
+    return TextLogLoader::load(filename, canDumpFormat(), frames);
 }
 
+
 /*Example line:
 1D5210000000000E0D7
 The first three digits are the ID, all bytes are then two hex digits after that. So, the length is determined by line length
@@ -3928,49 +2862,6 @@ bool FrameFileIO::loadLawicelFile(QString filename, QVector<CANFrame>* frames)
     return !foundErrors;
 }
 
-bool FrameFileIO::isKvaserFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    int lineCounter = 0;
-    bool isMatch = true;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-    try
-    {
-        line = inFile->readLine().simplified().toUpper();
-        if (!line.contains("CHN")) isMatch = false;
-        if (!line.contains("FLG")) isMatch = false;
-        if (!line.contains("D0")) isMatch = false;
-
-        if (inFile->atEnd()) isMatch = false;
-
-        while (!inFile->atEnd() && lineCounter < 10) {
-            lineCounter++;
-
-            line = inFile->readLine().toUpper();
-
-            if (line.length() > 70) {
-                //Chn Identifier Flg   DLC  D0...1...2...3...4...5...6..D7       Time     Dir
-                // 0    000000AD         8  FF  FF  00  00  00  00  00  00     154.266550 R
-                int len = line.mid(21, 3).simplified().toInt();
-                if (len > 8 || len < 0) isMatch = false;
-            }
-            else isMatch = false;
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 //Chn Identifier Flg   DLC  D0...1...2...3...4...5...6..D7       Time     Dir
 // 0    000000AD         8  FF  FF  00  00  00  00  00  00     154.266550 R
@@ -4034,49 +2925,6 @@ bool FrameFileIO::loadKvaserFile(QString filename, QVector<CANFrame> *frames, bo
     return !foundErrors;
 }
 
-bool FrameFileIO::isCabanaFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray line;
-    int lineCounter = 0;
-    bool isMatch = true;
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        delete inFile;
-        return false;
-    }
-    try
-    {
-        line = inFile->readLine().toUpper(); //read out the header first and discard it.
-        if (!line.contains("TIME")) isMatch = false;
-        if (!line.contains("ADDR")) isMatch = false;
-
-        while (!inFile->atEnd() || lineCounter < 100) {
-            lineCounter++;
-
-            line = inFile->readLine().simplified();
-            if (line.length() > 2)
-            {
-                QList<QByteArray> tokens = line.split(',');
-                if (tokens.length() >= 3 && tokens.length() < 5)
-                {
-                    int ID = tokens[1].toInt();
-                    if (ID < 1 || ID > 0x1FFFFFFF) isMatch = false;
-                }
-                else isMatch = false;
-            }
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 //Cabana uses a CSV file with four columns
 //time,addr,bus,data
@@ -4246,32 +3094,6 @@ bool FrameFileIO::saveCabanaFile(QString filename, const QVector<CANFrame>* fram
     return true;
 }
 
-bool FrameFileIO::isTeslaAPFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    CANFrame thisFrame;
-    QByteArray data;
-    bool isValidFile = true;
-    TeslaAPCANRecord record;
-
-    if (!inFile->open(QIODevice::ReadOnly))
-    {
-        delete inFile;
-        return false;
-    }
-
-    while (!inFile->atEnd())
-    {
-        inFile->read((char *)&record, sizeof(TeslaAPCANRecord));
-        if (record.id > 0x7FF) isValidFile = false;
-        if ((record.ctr >> 4) > 8) isValidFile = false;
-        if ((record.ctr & 0xF) > 6) isValidFile = false;
-    }
-
-    inFile->close();
-    delete inFile;
-    return isValidFile;
-}
 
 bool FrameFileIO::loadTeslaAPFile(QString filename, QVector<CANFrame>* frames)
 {
@@ -4327,130 +3149,6 @@ bool FrameFileIO::loadTeslaAPFile(QString filename, QVector<CANFrame>* frames)
     return !foundErrors;
 }
 
-bool FrameFileIO::isCLX000File(QString filename) {
-    std::unique_ptr<QFile> inFile = std::unique_ptr<QFile>(new QFile(filename));
-
-    if (!inFile->open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        qDebug() << "Could not open the file!";
-        return false;
-    }
-
-    QTextStream fileStream(inFile.get());
-    //bool foundErrors = false;
-
-    // Contains 16 lines of header prior to (potential) data.
-    QString headerLine;
-    headerLine = fileStream.readLine();
-    if(!headerLine.startsWith("# Logger type: ")) {
-        qDebug() << "Not the correct first header line:" << headerLine;
-        return false;
-    }
-
-    // Skip to next usable field.
-    fileStream.readLine();
-    fileStream.readLine();
-    fileStream.readLine();
-    fileStream.readLine();
-    fileStream.readLine();
-
-    // Extract base time.
-    headerLine = fileStream.readLine();
-    if(!headerLine.startsWith("# Time: ")) {
-        qDebug() << "Not the correct start time:" << headerLine;
-        return false;
-    }
-    headerLine = headerLine.right(15);
-
-    QDateTime startDate = QDateTime::fromString(headerLine, "yyyyMMddThhmmss");
-    if(!startDate.isValid()) {
-        qDebug() << "Could not parse " << headerLine << "using \"yyyyMMddThhmmss\" as format string";
-        return false;
-    }
-
-    QString const validSeparators(" -~");
-
-    // Decode separators and format for later decoding.
-    headerLine = fileStream.readLine();
-    QString const valueSeparatorPattern = "# Value separator: \"(?<valueSeparator>[" + validSeparators + "])\"";
-    QRegularExpression valueSeparatorRegEx(valueSeparatorPattern);
-    auto matchValueSeparator = valueSeparatorRegEx.match(headerLine);
-    if(!matchValueSeparator.hasMatch()) {
-        qDebug() << "Could not decode value separator" << headerLine << "using pattern" << valueSeparatorPattern;
-        return false;
-    }
-    QChar valueSeparator = matchValueSeparator.captured("valueSeparator").front();
-
-    headerLine = fileStream.readLine();
-    QString const timeFormatPattern = "# Time format: (?<timeFormat>\\d)";
-    QRegularExpression timeFormatRegEx(timeFormatPattern);
-    auto matchTimeFormat = timeFormatRegEx.match(headerLine);
-    if(!matchTimeFormat.hasMatch()) {
-        qDebug() << "Could not decode time format" << headerLine << "using pattern" << timeFormatPattern;
-        return false;
-    }
-    //auto timeFormat = matchTimeFormat.captured("timeFormat").front().digitValue();
-
-    headerLine = fileStream.readLine();
-    QString const timeSeparatorPattern = "# Time separator: \"(?<timeSeparator>[" + validSeparators + "]?)\"";
-    QRegularExpression timeSeparatorRegEx(timeSeparatorPattern);
-    auto matchTimeSeparator = timeSeparatorRegEx.match(headerLine);
-    if( !matchTimeSeparator.hasMatch()) {
-        qDebug() << "Could not decode time format" << headerLine << "using pattern" << timeSeparatorPattern;
-        return false;
-    }
-    //QChar timeSeparator = matchTimeSeparator.captured("timeSeparator").front();
-
-    headerLine = fileStream.readLine();
-    QString const timeSeparatorMsPattern = "# Time separator ms: \"(?<timeSeparatorMs>[" + validSeparators + "]?)\"";
-    QRegularExpression timeSeparatorMsRegEx(timeSeparatorMsPattern);
-    auto matchTimeSeparatorMs = timeSeparatorMsRegEx.match(headerLine);
-    if( !matchTimeSeparatorMs.hasMatch()) {
-        qDebug() << "Could not decode time format ms" << headerLine << "using pattern" << timeSeparatorMsPattern;
-        return false;
-    }
-    //QChar timeSeparatorMs = matchTimeSeparatorMs.captured("timeSeparatorMs").front();
-
-    headerLine = fileStream.readLine();
-    QString const dateSeparatorPattern = "# Date separator: \"(?<dateSeparator>[" + validSeparators + "]?)\"";
-    QRegularExpression dateSeparatorRegEx(dateSeparatorPattern);
-    auto matchDateSeparator = dateSeparatorRegEx.match(headerLine);
-    if( !matchDateSeparator.hasMatch()) {
-        qDebug() << "Could not decode time format ms" << headerLine << "using pattern" << dateSeparatorPattern;
-        return false;
-    }
-    //QChar dateSeparator = matchDateSeparator.captured("dateSeparator").front();
-
-    headerLine = fileStream.readLine();
-    QString const timeDateSeparatorPattern = "# Time and date separator: \"(?<timeDateSeparator>[" + validSeparators + "]?)\"";
-    QRegularExpression timeDateSeparatorRegEx(timeDateSeparatorPattern);
-    auto matchTimeDateSeparator = timeDateSeparatorRegEx.match(headerLine);
-    if( !matchTimeDateSeparator.hasMatch()) {
-        qDebug() << "Could not decode time format ms" << headerLine << "using pattern" << timeDateSeparatorPattern;
-        return false;
-    }
-    //QChar timeDateSeparator = matchTimeDateSeparator.captured("timeDateSeparator").front();
-
-    // Skip remaining header lines.
-    fileStream.readLine();
-    fileStream.readLine();
-    fileStream.readLine();
-
-    // Decode which fields are present.
-    headerLine = fileStream.readLine();
-    auto const presentFields = headerLine.split(valueSeparator);
-    QStringList const validStrings = {"Timestamp", "Type", "ID", "Length", "Data"};
-
-    if(!std::all_of(
-        presentFields.cbegin(),
-        presentFields.cend(),
-        [&validStrings](QString const& entry){return validStrings.contains(entry);})
-        ) {
-        return false;
-    }
-
-    return true;
-}
 
 bool FrameFileIO::loadCLX000File(QString filename, QVector<CANFrame>* frames) {
     std::unique_ptr<QFile> inFile = std::unique_ptr<QFile>(new QFile(filename));
@@ -4773,43 +3471,6 @@ bool FrameFileIO::loadCLX000File(QString filename, QVector<CANFrame>* frames) {
     return !foundErrors;
 }
 
-bool FrameFileIO::isCANServerFile(QString filename)
-{
-    QFile *inFile = new QFile(filename);
-    QByteArray headerData;
-    bool isMatch = false;
-
-    if (!inFile->open(QIODevice::ReadOnly))
-    {
-        delete inFile;
-        return false;
-    }
-    try
-    {
-        //Read the first 20 bytes from the file to check for the matching signature
-        headerData = inFile->read(22);
-
-        //qDebug() << "header.length: " << headerData.length();
-
-        if (headerData.length() == 22)
-        {
-            //qDebug() << "header: " << headerData;
-            //We have enough bytes to make up our header.  Lets check if it matches
-            if (headerData == "CANSERVER_v2_CANSERVER" || headerData == "CANSERVER_v3_CANSERVER")
-            {
-                isMatch = true;
-            }
-        }
-    }
-    catch (...)
-    {
-        isMatch = false;
-    }
-
-    inFile->close();
-    delete inFile;
-    return isMatch;
-}
 
 bool FrameFileIO::loadCANServerFile(QString filename, QVector<CANFrame>* frames)
 {
@@ -5073,19 +3734,73 @@ bool FrameFileIO::loadWiresharkFile(QString filename, QVector<CANFrame>* frames)
     return !foundErrors;
 }
 
-bool FrameFileIO::isWiresharkFile(QString filename)
+
+
+//Blocks are independent so every core decompresses its own share of them straight into the right spot
+//of the frame list. Files that weren't closed properly still load, minus a torn last block.
+bool FrameFileIO::loadCaptureFile(QString filename, QVector<CANFrame>* frames)
 {
-    pcap_t *pcap_data_file;
-    char errbuf[PCAP_ERRBUF_SIZE];
-    QByteArray ba = filename.toLocal8Bit();
+    CaptureFileReader reader;
+    if (!reader.open(filename)) return false;
+    if (reader.frameCount() > std::numeric_limits<int>::max() - frames->count()) return false;
 
-    pcap_data_file = pcap_open_offline(ba.data(), errbuf);
-	if (!pcap_data_file) {
-		return false;
-	}
+    int base = frames->count();
+    frames->resize(base + static_cast<int>(reader.frameCount()));
+    CANFrame *out = frames->data() + base;
 
-    pcap_close(pcap_data_file);
-	pcap_data_file = NULL;
+    QAtomicInt nextBlock(0);
+    QAtomicInt failed(0);
+    auto worker = [&reader, &nextBlock, &failed, out]()
+    {
+        QVector<CANFrameData> blockFrames;
+        int idx;
+        while (!failed.loadAcquire() && (idx = nextBlock.fetchAndAddRelaxed(1)) < reader.blockCount())
+        {
+            if (!reader.readBlock(idx, blockFrames))
+            {
+                failed.storeRelease(1);
+                return;
+            }
+            CANFrame *dest = out + reader.block(idx).firstFrame;
+            for (int i = 0; i < blockFrames.count(); i++) dest[i] = blockFrames[i].toCANFrame();
+        }
+    };
+
+    int numThreads = qBound(1, QThread::idealThreadCount(), qMax(1, reader.blockCount()));
+    QList<QThread *> threads;
+    for (int i = 0; i < numThreads; i++)
+    {
+        QThread *thread = QThread::create(worker);
+        threads.append(thread);
+        thread->start();
+    }
+    for (QThread *thread : threads)
+    {
+        while (!thread->wait(50)) qApp->processEvents();
+        delete thread;
+    }
 
+    if (failed.loadAcquire())
+    {
+        frames->resize(base);
+        return false;
+    }
     return true;
 }
+
+bool FrameFileIO::saveCaptureFile(QString filename, const QVector<CANFrame>* frames)
+{
+    CaptureFileWriter writer;
+    if (!writer.open(filename)) return false;
+
+    for (int c = 0; c < frames->count(); c++)
+    {
+        if (!writer.append(frames->at(c)))
+        {
+            writer.close();
+            return false;
+        }
+        if ((c & 0xFFFF) == 0xFFFF) qApp->processEvents();
+    }
+    return writer.close();
+}
@@ -14,6 +14,10 @@
 #include <QFileDialog>
 #include "can_structs.h"
 #include "utility.h"
+#include "filesniffer.h"
+#include "continuouslogger.h"
+
+struct TextLogFormat;
 
 class FrameFileIO: public QObject
 {
@@ -31,6 +35,12 @@ public:
 
     //These do the actual loading and saving and can be used directly if you'd prefer
     static bool autoDetectLoadFile(QString, QVector<CANFrame>*);
+    //what the last autodetect load went with and what else the file looked like, empty if the last load
+    //wasn't autodetected
+    static QString autoDetectReport();
+    //Picks a log to stream instead of load. captureFile is the SavvyCAN capture to page it in from,
+    //either the file itself or a converted copy of it in the cache directory.
+    static bool openStreamingFile(QString &fileName, QString &captureFile);
     static bool loadCRTDFile(QString, QVector<CANFrame>*);
     static bool loadNativeCSVFile(QString, QVector<CANFrame>*);
     static bool loadGenericCSVFile(QString, QVector<CANFrame>*);
@@ -54,32 +64,7 @@ public:
     static bool loadCLX000File(QString filename, QVector<CANFrame>* frames);
     static bool loadCANServerFile(QString filename, QVector<CANFrame>* frames);
     static bool loadWiresharkFile(QString filename, QVector<CANFrame>* frames);
-
-    //functions that pre-scan a file to try to figure out if they could read it. Used to automatically determine
-    //file type and load it.
-    static bool isCRTDFile(QString);
-    static bool isNativeCSVFile(QString);
-    static bool isGenericCSVFile(QString);
-    static bool isLogFile(QString);
-    static bool isMicrochipFile(QString);
-    static bool isTraceFile(QString);
-    static bool isIXXATFile(QString);
-    static bool isCANDOFile(QString);
-    static bool isVehicleSpyFile(QString);
-    static bool isCanDumpFile(QString);
-    static bool isLawicelFile(QString);
-    static bool isPCANFile(QString);
-    static bool isKvaserFile(QString);
-    static bool isCanalyzerASC(QString);
-    static bool isCanalyzerBLF(QString);
-    static bool isCARBUSAnalyzerFile(QString filename);
-    static bool isCANHackerFile(QString filename);
-    static bool isCabanaFile(QString filename);
-    static bool isCANOpenFile(QString filename);
-    static bool isTeslaAPFile(QString filename);
-    static bool isCLX000File(QString filename);
-    static bool isCANServerFile(QString filename);
-    static bool isWiresharkFile(QString filename);
+    static bool loadCaptureFile(QString filename, QVector<CANFrame>* frames);
 
     static bool saveCRTDFile(QString, const QVector<CANFrame>*);
     static bool saveNativeCSVFile(QString, const QVector<CANFrame>*);
@@ -94,14 +79,18 @@ public:
     static bool saveCabanaFile(QString filename, const QVector<CANFrame>* frames);
     static bool saveCanalyzerASC(QString filename, const QVector<CANFrame>* frames);
     static bool saveCARBUSAnalzyer(QString filename, const QVector<CANFrame>* frames);
+    static bool saveCaptureFile(QString filename, const QVector<CANFrame>* frames);
 
-    static bool openContinuousNative();
-    static bool closeContinuousNative();
-    static bool writeContinuousNative(const QVector<CANFrame>*, int);
-    static bool flushContinuousNative();
+    static bool openContinuousLog(ContinuousLogger &logger);
 
 private:
-    static QFile continuousFile;
+    static bool loadDetectedFile(FileSniffer::Format, QString, QVector<CANFrame>*);
+    static bool streamableFormat(FileSniffer::Format, TextLogFormat &);
+    static TextLogFormat nativeCSVFormat();
+    static TextLogFormat canDumpFormat();
+    static TextLogFormat canalyzerASCFormat();
+
+    static QString detectReport;
 };
 
 #endif // FRAMEFILEIO_H
@@ -1,7 +1,7 @@
 #include "framesenderobject.h"
 #include "mainwindow.h"
 
-FrameSenderObject::FrameSenderObject(const QVector<CANFrame> *frames)
+FrameSenderObject::FrameSenderObject(const CANFrameStore *frames)
 {
     mThread_p = new QThread();
 
@@ -49,6 +49,8 @@ void FrameSenderObject::initialize()
     //mStarted = true;
 
     connect(MainWindow::getReference(), SIGNAL(framesUpdated(int)), this, SLOT(updatedFrames(int)));
+    //live frames come straight from the ingest thread so triggers don't wait for the next GUI refresh
+    connect(CANConManager::getInstance(), &CANConManager::framesReceived, this, &FrameSenderObject::framesReceived);
 
     /* in multithread case, this will be called before entering thread event loop */
     return piStart();
@@ -238,7 +240,6 @@ void FrameSenderObject::buildFrameCache()
 //remember, negative numbers are special -1 = all frames deleted, -2 = totally new set of frames.
 void FrameSenderObject::updatedFrames(int numFrames)
 {
-    CANFrame thisFrame;
     if (numFrames == -1) //all frames deleted.
     {
     }
@@ -246,24 +247,18 @@ void FrameSenderObject::updatedFrames(int numFrames)
     {
         buildFrameCache();
     }
-    else //just got some new frames. See if they are relevant.
+    //new frames are handled as they arrive by framesReceived
+}
+
+void FrameSenderObject::framesReceived(const FrameBatchPtr &pBatch)
+{
+    CANFrame thisFrame;
+    //run through the new frames in order
+    for (int i = 0; i < pBatch->count(); i++)
     {
-        if (numFrames > modelFrames->count()) return;
-        qDebug() << "New frames in sender window";
-        //run through the supposedly new frames in order
-        for (int i = modelFrames->count() - numFrames; i < modelFrames->count(); i++)
-        {
-            thisFrame = modelFrames->at(i);
-            if (!frameCache.contains(thisFrame.frameId()))
-            {
-                frameCache.insert(thisFrame.frameId(), thisFrame);
-            }
-            else
-            {
-                frameCache[thisFrame.frameId()] = thisFrame;
-            }
-            processIncomingFrame(&thisFrame);
-        }
+        thisFrame = pBatch->at(i);
+        frameCache[thisFrame.frameId()] = thisFrame;
+        processIncomingFrame(&thisFrame);
     }
 }
 
@@ -8,6 +8,7 @@
 #include <QDebug>
 #include <QMutex>
 #include "can_structs.h"
+#include "canframestore.h"
 #include "connections/canconmanager.h"
 #include "can_trigger_structs.h"
 #include "dbc/dbchandler.h"
@@ -17,7 +18,7 @@ class FrameSenderObject : public QObject
     Q_OBJECT
 
 public:
-    FrameSenderObject(const QVector<CANFrame> *frames);
+    FrameSenderObject(const CANFrameStore *frames);
     ~FrameSenderObject();
 
 public slots:
@@ -45,6 +46,7 @@ signals:
 private slots:
     void timerTriggered();
     void updatedFrames(int);
+    void framesReceived(const FrameBatchPtr &pBatch);
 
 private:
     QList<CANFrame> sendingList;
@@ -56,7 +58,7 @@ private:
     QList<FrameSendData> sendingData;
     QThread*            mThread_p;    
     QHash<int, CANFrame> frameCache; //hash with frame ID as the key and the most recent frame as the value
-    const QVector<CANFrame> *modelFrames;
+    const CANFrameStore *modelFrames;
     bool inhibitChanged = false;
     QMutex mutex;
     DBCHandler *dbcHandler;
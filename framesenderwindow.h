@@ -7,6 +7,7 @@
 #include <QTime>
 #include <QMutex>
 #include "can_structs.h"
+#include "canframestore.h"
 #include "can_trigger_structs.h"
 #include "dbc/dbchandler.h"
 #include "triggerdialog.h"
@@ -35,7 +36,7 @@ class FrameSenderWindow : public QDialog
     Q_OBJECT
 
 public:
-    explicit FrameSenderWindow(const QVector<CANFrame> *frames, QWidget *parent = 0);
+    explicit FrameSenderWindow(const CANFrameStore *frames, QWidget *parent = 0);
     ~FrameSenderWindow();
 
 private slots:
@@ -53,7 +54,7 @@ private:
     Ui::FrameSenderWindow *ui;
     QList<FrameSendData> sendingData;
     QHash<int, CANFrame> frameCache; //hash with frame ID as the key and the most recent frame as the value
-    const QVector<CANFrame> *modelFrames;
+    const CANFrameStore *modelFrames;
     QTimer *intervalTimer;
     QElapsedTimer elapsedTimer;
     bool inhibitChanged = false;
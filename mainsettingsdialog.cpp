@@ -89,6 +89,7 @@ MainSettingsDialog::MainSettingsDialog(QWidget *parent) :
     ui->comboSendingBus->setCurrentIndex(settings.value("Playback/SendingBus", 4).toInt());
     ui->cbUseFiltered->setChecked(settings.value("Main/UseFiltered", false).toBool());
     ui->cbUseOpenGL->setChecked(settings.value("Main/UseOpenGL", false).toBool());
+    ui->cbLowLatency->setChecked(settings.value("Main/LowLatencyCapture", false).toBool());
     ui->cbFilterLabeling->setChecked(settings.value("Main/FilterLabeling", true).toBool());
     ui->cbIgnoreDBCColors->setChecked(settings.value("Main/IgnoreDBCColors", false).toBool());
 
@@ -106,6 +107,11 @@ MainSettingsDialog::MainSettingsDialog(QWidget *parent) :
 
     ui->spinMaximumFrames->setValue(settings.value("Main/MaximumFrames", maxFramesDefault).toInt());
     ui->spinBytesPerLine->setValue(settings.value("Main/BytesPerLine", 8).toInt());
+    ui->comboRetention->setCurrentIndex(settings.value("Main/RetentionMode", 0).toInt());
+    ui->spinRetentionMemory->setValue(settings.value("Main/RetentionMemory", 1024).toInt());
+    ui->spinRetentionTime->setValue(settings.value("Main/RetentionTime", 600).toInt());
+    ui->spinLogRotateSize->setValue(settings.value("Main/LogRotateSize", 0).toInt());
+    ui->spinLogRotateMinutes->setValue(settings.value("Main/LogRotateMinutes", 0).toInt());
 
     //just for simplicity they all call the same function and that function updates all settings at once
     connect(ui->cbDisplayHex, SIGNAL(toggled(bool)), this, SLOT(updateSettings()));
@@ -126,6 +132,7 @@ MainSettingsDialog::MainSettingsDialog(QWidget *parent) :
     connect(ui->cbUseFiltered, SIGNAL(toggled(bool)), this, SLOT(updateSettings()));
     connect(ui->lineClockFormat, SIGNAL(editingFinished()), this, SLOT(updateSettings()));
     connect(ui->cbUseOpenGL, SIGNAL(toggled(bool)), this, SLOT(updateSettings()));
+    connect(ui->cbLowLatency, SIGNAL(toggled(bool)), this, SLOT(updateSettings()));
     connect(ui->lineRemoteHost, SIGNAL(editingFinished()), this, SLOT(updateSettings()));
     connect(ui->lineRemotePort, SIGNAL(editingFinished()), this, SLOT(updateSettings()));
     connect(ui->lineRemoteUser, SIGNAL(editingFinished()), this, SLOT(updateSettings()));
@@ -138,6 +145,11 @@ MainSettingsDialog::MainSettingsDialog(QWidget *parent) :
     connect(ui->spinMaximumFrames, SIGNAL(valueChanged(int)), this, SLOT(updateSettings()));
     connect(ui->cbFontFixedWidth, SIGNAL(toggled(bool)), this, SLOT(updateSettings()));
     connect(ui->spinBytesPerLine, SIGNAL(valueChanged(int)), this, SLOT(updateSettings()));
+    connect(ui->comboRetention, SIGNAL(currentIndexChanged(int)), this, SLOT(updateSettings()));
+    connect(ui->spinRetentionMemory, SIGNAL(valueChanged(int)), this, SLOT(updateSettings()));
+    connect(ui->spinRetentionTime, SIGNAL(valueChanged(int)), this, SLOT(updateSettings()));
+    connect(ui->spinLogRotateSize, SIGNAL(valueChanged(int)), this, SLOT(updateSettings()));
+    connect(ui->spinLogRotateMinutes, SIGNAL(valueChanged(int)), this, SLOT(updateSettings()));
 
     installEventFilter(this);
 }
@@ -196,6 +208,7 @@ void MainSettingsDialog::updateSettings()
     settings.setValue("Playback/SendingBus", ui->comboSendingBus->currentIndex());
     settings.setValue("Main/UseFiltered", ui->cbUseFiltered->isChecked());
     settings.setValue("Main/UseOpenGL", ui->cbUseOpenGL->isChecked());
+    settings.setValue("Main/LowLatencyCapture", ui->cbLowLatency->isChecked());
     settings.setValue("Main/TimeFormat", ui->lineClockFormat->text());
     settings.setValue("Main/FontSize", ui->spinFontSize->value());
     settings.setValue("Remote/Host", ui->lineRemoteHost->text());
@@ -207,6 +220,11 @@ void MainSettingsDialog::updateSettings()
     settings.setValue("Main/IgnoreDBCColors", ui->cbIgnoreDBCColors->isChecked());
     settings.setValue("Main/MaximumFrames", ui->spinMaximumFrames->value());
     settings.setValue("Main/BytesPerLine", ui->spinBytesPerLine->value());
+    settings.setValue("Main/RetentionMode", ui->comboRetention->currentIndex());
+    settings.setValue("Main/RetentionMemory", ui->spinRetentionMemory->value());
+    settings.setValue("Main/RetentionTime", ui->spinRetentionTime->value());
+    settings.setValue("Main/LogRotateSize", ui->spinLogRotateSize->value());
+    settings.setValue("Main/LogRotateMinutes", ui->spinLogRotateMinutes->value());
     settings.setValue("Main/FontFixedWidth", ui->cbFontFixedWidth->isChecked());
 
     settings.sync();
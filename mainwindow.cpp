@@ -9,6 +9,8 @@
 #include "helpwindow.h"
 #include "utility.h"
 #include "filterutility.h"
+#include "decodedexport.h"
+#include <QInputDialog>
 
 /*
 Some notes on things I'd like to put into the program but haven't put on github (yet)
@@ -101,12 +103,13 @@ MainWindow::MainWindow(QWidget *parent) :
     inhibitFilterUpdate = false;
     rxFrames = 0;
     framesPerSec = 0;
-    continuousLogging = false;
-    continuousLogFlushCounter = 0;
+    continuousLogStatusCounter = 0;
+    continuousLogLastBytes = 0;
 
     //handlers for all menu entries
     connect(ui->actionSetup, SIGNAL(triggered(bool)), SLOT(showConnectionSettingsWindow()));
     connect(ui->actionOpen_Log_File, &QAction::triggered, this, &MainWindow::handleLoadFile);
+    connect(ui->actionStream_Log_File, &QAction::triggered, this, &MainWindow::handleStreamFile);
     connect(ui->actionGraph_Dta, &QAction::triggered, this, &MainWindow::showGraphingWindow);
     connect(ui->actionFrame_Data_Analysis, &QAction::triggered, this, &MainWindow::showFrameDataAnalysis);
     connect(ui->actionSave_Log_File, &QAction::triggered, this, &MainWindow::handleSaveFile);
@@ -146,9 +149,9 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->canFramesView, &QAbstractItemView::customContextMenuRequested, this, &MainWindow::gridContextMenuRequest);
 
     connect(model, &CANFrameModel::updatedFiltersList, this, &MainWindow::updateFilterList);
-    connect(CANConManager::getInstance(), &CANConManager::framesReceived, model, &CANFrameModel::addFrames);
-    //new implementation for continuous logging
-    connect(CANConManager::getInstance(), &CANConManager::framesReceived, this, &MainWindow::logReceivedFrame);
+    connect(model, &CANFrameModel::framesEvicted, this, &MainWindow::framesEvicted);
+    //runs on the ingest thread, the logger only queues the batch there and writes it on its own thread
+    connect(CANConManager::getInstance(), &CANConManager::framesReceived, this, &MainWindow::logReceivedFrame, Qt::DirectConnection);
 
     connect(ui->cbInterpret, &QAbstractButton::toggled, this, &MainWindow::interpretToggled);
     connect(ui->cbOverwrite, &QAbstractButton::toggled, this, &MainWindow::overwriteToggled);
@@ -256,6 +259,8 @@ MainWindow::MainWindow(QWidget *parent) :
 MainWindow::~MainWindow()
 {
     updateTimer.stop();
+    disconnect(CANConManager::getInstance(), &CANConManager::framesReceived, this, &MainWindow::logReceivedFrame);
+    continuousLogger.stop();
     frameSender->stopSending();
     killEmAll(); //Ride the lightning
     delete ui;
@@ -431,6 +436,8 @@ void MainWindow::readUpdateableSettings()
     model->setIgnoreDBCColors(ignoreDBCColors);
     int bpl = settings.value("Main/BytesPerLine", 8).toInt();
     model->setBytesPerLine(bpl);
+    model->loadRetentionSettings();
+    CANConManager::getInstance()->setLowLatency(settings.value("Main/LowLatencyCapture", false).toBool());
 
     CSVAbsTime = settings.value("Main/CSVAbsTime", false).toBool();
 
@@ -955,13 +962,9 @@ void MainWindow::filterClearAll()
     model->setAllFilters(false);
 }
 
-void MainWindow::logReceivedFrame(CANConnection* conn, QVector<CANFrame> frames)
+void MainWindow::logReceivedFrame(const FrameBatchPtr &batch)
 {
-    Q_UNUSED(conn);
-    if (continuousLogging)
-    {
-        FrameFileIO::writeContinuousNative(&frames, 0);
-    }
+    continuousLogger.enqueue(batch); //does nothing unless logging
 }
 
 void MainWindow::tickGUIUpdate()
@@ -990,27 +993,14 @@ void MainWindow::tickGUIUpdate()
 
         if (model->needsFilterRefresh()) updateFilterList();
 
-        if (continuousLogging)
+        if (continuousLogger.isRunning())
         {
-//            const QVector<CANFrame> *modelFrames = model->getListReference();
-//            FrameFileIO::writeContinuousNative(modelFrames, modelFrames->count() - rxFrames);
-
-            continuousLogFlushCounter++;
-            if ((continuousLogFlushCounter % 3) == 0)
-            {
-                if (ui->lblContMsg->text().length() > 2)
-                {
-                    ui->lblContMsg->setText("");
-                }
-                else
-                {
-                    ui->lblContMsg->setText("LOGGING");
-                }
-            }
-            if (continuousLogFlushCounter > 8)
+            //the logger thread writes and flushes on its own, this only shows how it's keeping up
+            continuousLogStatusCounter++;
+            if (continuousLogStatusCounter >= 4)
             {
-                continuousLogFlushCounter = 0;
-                FrameFileIO::flushContinuousNative();
+                continuousLogStatusCounter = 0;
+                updateContinuousLogStatus();
             }
         }
 
@@ -1108,10 +1098,35 @@ void MainWindow::handleLoadFile()
         if (ui->cbAutoScroll->isChecked()) ui->canFramesView->scrollToBottom();
 
         updateFileStatus();
+        //what autodetect decided shows for a moment and stays on the file name's tooltip
+        lbStatusFilename.setToolTip(FrameFileIO::autoDetectReport());
+        if (!FrameFileIO::autoDetectReport().isEmpty()) ui->statusBar->showMessage(FrameFileIO::autoDetectReport(), 8000);
         emit framesUpdated(-1);
     }
 }
 
+//The file stays on disk and is paged in as the grid and the other windows need it
+void MainWindow::handleStreamFile()
+{
+    QString filename, captureFile;
+    if (!FrameFileIO::openStreamingFile(filename, captureFile)) return;
+
+    disableAutoRowExpansion();
+    ui->canFramesView->scrollToTop();
+    model->clearFrames();
+    if (!model->openStream(captureFile))
+    {
+        QMessageBox::warning(this, "Error Loading", "Could not open " + filename + " for streaming.");
+        return;
+    }
+    loadedFileName = filename;
+    ui->lbNumFrames->setText(QString::number(model->rowCount()));
+
+    updateFileStatus();
+    lbStatusFilename.setToolTip(tr("Streamed from %1").arg(captureFile));
+    emit framesUpdated(-1);
+}
+
 void MainWindow::handleDroppedFile(const QString &filename)
 {
     QProgressDialog progress(qApp->activeWindow());
@@ -1152,16 +1167,30 @@ void MainWindow::handleDroppedFile(const QString &filename)
         if (ui->cbAutoScroll->isChecked()) ui->canFramesView->scrollToBottom();
 
         updateFileStatus();
+        //what autodetect decided shows for a moment and stays on the file name's tooltip
+        lbStatusFilename.setToolTip(FrameFileIO::autoDetectReport());
+        if (!FrameFileIO::autoDetectReport().isEmpty()) ui->statusBar->showMessage(FrameFileIO::autoDetectReport(), 8000);
         emit framesUpdated(-1);
     }
 }
 
 
+//a streamed file would have to be loaded in full to be saved, and it is already on disk
+bool MainWindow::refuseWhileStreaming()
+{
+    if (!model->isStreaming()) return false;
+    QMessageBox::information(this, "Streaming", "The frames shown are streamed from a file on disk and can't be saved from here.\r\n"
+                                                "Load the file normally to save it in another format.");
+    return true;
+}
+
 void MainWindow::handleSaveFile()
 {
     QString filename;
+    if (refuseWhileStreaming()) return;
 
-    if (FrameFileIO::saveFrameFile(filename, model->getListReference()))
+    QVector<CANFrame> saveFrames = model->getListReference()->toVector();
+    if (FrameFileIO::saveFrameFile(filename, &saveFrames))
     {
         loadedFileName = filename;
         updateFileStatus();
@@ -1170,26 +1199,48 @@ void MainWindow::handleSaveFile()
 
 void MainWindow::handleContinousLogging()
 {
-    continuousLogging = !continuousLogging;
-
-    if (continuousLogging)
+    if (!continuousLogger.isRunning())
     {
+        if (!FrameFileIO::openContinuousLog(continuousLogger)) return;
         ui->actionSave_Continuous_Logfile->setText(tr("Cease Continuous Logging"));
-        FrameFileIO::openContinuousNative();
+        ui->lblContMsg->setText(tr("LOGGING"));
+        continuousLogStatusCounter = 0;
+        continuousLogLastBytes = 0;
+        continuousLogTimer.start();
     }
     else
     {
+        continuousLogger.stop();
         ui->actionSave_Continuous_Logfile->setText(tr("Start Continuous Logging"));
         ui->lblContMsg->setText("");
-        FrameFileIO::closeContinuousNative();
+        ui->lblContMsg->setToolTip("");
     }
 }
 
+void MainWindow::updateContinuousLogStatus()
+{
+    qint64 bytes = continuousLogger.bytesWritten();
+    qint64 elapsed = qMax<qint64>(1, continuousLogTimer.restart());
+    double rate = (bytes - continuousLogLastBytes) * 1000.0 / elapsed;
+    continuousLogLastBytes = bytes;
+
+    QString text;
+    if (continuousLogger.hasFailed()) text = tr("LOG WRITE FAILED");
+    else text = tr("LOGGING %1 KB/s").arg(rate / 1024.0, 0, 'f', 1);
+    if (continuousLogger.backlog() > 0) text += tr(", %1 queued").arg(continuousLogger.backlog());
+    if (continuousLogger.framesDropped() > 0) text += tr(", %1 dropped").arg(continuousLogger.framesDropped());
+    ui->lblContMsg->setText(text);
+    ui->lblContMsg->setToolTip(tr("%1 frames, %2 MB in %3 file(s)").arg(continuousLogger.framesWritten())
+                               .arg(bytes / (1024.0 * 1024.0), 0, 'f', 1).arg(continuousLogger.filesStarted()));
+}
+
 void MainWindow::handleSaveFilteredFile()
 {
     QString filename;
+    if (refuseWhileStreaming()) return;
 
-    if (FrameFileIO::saveFrameFile(filename, model->getFilteredListReference()))
+    QVector<CANFrame> saveFrames = model->getFilteredListReference()->toVector();
+    if (FrameFileIO::saveFrameFile(filename, &saveFrames))
     {
         loadedFileName = filename;
         updateFileStatus();
@@ -1261,7 +1312,12 @@ void MainWindow::handleSaveDecodedMethod(bool csv)
 
     QStringList filters;
     if (!csv) filters.append(QString(tr("Text File (*.txt *.TXT)")));
-    else filters.append(QString(tr("CSV File (*.csv *.CSV)")));
+    else
+    {
+        filters.append(QString(tr("CSV File (*.csv *.CSV)")));
+        filters.append(QString(tr("CSV File, resampled (*.csv *.CSV)")));
+        filters.append(QString(tr("Columnar binary, resampled (*.sccols)")));
+    }
 
     dialog.setDirectory(settings.value("FileIO/LoadSaveDirectory", dialog.directory().path()).toString());
     dialog.setFileMode(QFileDialog::AnyFile);
@@ -1272,257 +1328,41 @@ void MainWindow::handleSaveDecodedMethod(bool csv)
     if (dialog.exec() == QDialog::Accepted)
     {
         filename = dialog.selectedFiles()[0];
-        if (!filename.contains('.'))
-        {
-            if (!csv) filename += ".txt";
-            else filename += ".csv";
-        }
-
-        if(csv)
-            saveDecodedTextFileAsColumns(filename);
-        else
-            saveDecodedTextFile(filename);
-
-        settings.setValue("FileIO/LoadSaveDirectory", dialog.directory().path());
-    }
-}
 
-void MainWindow::saveDecodedTextFileAsColumns(QString filename)
-{
-    QFile *outFile = new QFile(filename);
-    const QVector<CANFrame> *frames = model->getFilteredListReference();
-
-    //const unsigned char *data;
-    int dataLen;
-    const CANFrame *frame;
-
-    if (!outFile->open(QIODevice::WriteOnly | QIODevice::Text))
-        return;
-/*
-Time: 205.173000   ID: 0x20E Std Bus: 0 Len: 8
-Data Bytes: 88 10 00 13 BB 00 06 00
-    SignalName	Value
-*/
-    QList<QPair<uint32_t, int>> msgsAndColumns;
-    int columnsAdded = 0;
-    int dataStartCol = 0;
-
-    QString builderString;
-    if (CSVAbsTime)
-    {
-        builderString += tr("Year") + "," + tr("Month") + "," + tr("Day") + "," + tr("Hour") + "," + tr("Minute") + "," + tr("Second") + "," + tr("Ms") + ",";
-        dataStartCol += 7;
-    }
-    else
-    {
-        //time
-        builderString += tr("Time") + ",";
-        dataStartCol++;
-    }
-    //id
-    builderString += tr("ID") + ",";
-    dataStartCol++;
-    //if (frame->hasExtendedFrameFormat()) builderString += tr(" Ext ");
-    //else builderString += tr(" Std ");
-    //bus
-    builderString += tr("Bus") + ",";
-    dataStartCol++;
-    //len
-    builderString += tr("DataLen") + ",";
-    dataStartCol++;
-
-    columnsAdded = dataStartCol;
-
-    //loop through all the frames and the message data therein
-    for (int c = 0; c < frames->count(); c++)
-    {
-        frame = &frames->at(c);
-        //data = reinterpret_cast<const unsigned char *>(frame->payload().constData());
-        dataLen = frame->payload().count();
-
-        //add all column names
-        if (dbcHandler != nullptr)
+        DecodedExport::Format format = DecodedExport::TEXT;
+        if (csv)
         {
-            DBC_MESSAGE *msg = dbcHandler->findMessage(*frame);
-            if (msg != nullptr)
-            {
-                bool found = false;
-                for (int j = 0; j < msg->sigHandler->getCount(); j++)
-                {
-                    if(j==0)
-                    {
-                        for(int m=0; m<msgsAndColumns.count(); m++)
-                        {
-                            if(msgsAndColumns[m].first == msg->ID)
-                                found = true;
-                        }
-                        if(found == false)
-                            msgsAndColumns.append(QPair<uint32_t,int>(msg->ID, columnsAdded));
-                    }
-
-                    if(found == false)
-                    {
-                        QString temp;
-                        if (msg->sigHandler->findSignalByIdx(j)->processAsText(*frame, temp))
-                        {
-                            builderString.append(msg->sigHandler->findSignalByIdx(j)->name);
-                            builderString.append(",");
-                            columnsAdded++;
-                        }
-                    }
-                }
-            }
+            format = DecodedExport::CSV;
+            if (dialog.selectedNameFilter() == filters[1]) format = DecodedExport::RESAMPLED_CSV;
+            if (dialog.selectedNameFilter() == filters[2]) format = DecodedExport::RESAMPLED_COLUMNS;
         }
-    }
-
-    //add EOL
-    builderString += "\n";
-    //write out the header row
-    outFile->write(builderString.toUtf8());
 
-        //builderString = tr("Data Bytes: ");
-        //for (int temp = 0; temp < dataLen; temp++)
-        //{
-        //    builderString += Utility::formatNumber(data[temp]) + " ";
-        //}
-        //builderString += "\n";
-        //outFile->write(builderString.toUtf8());
-
-    int dataColumnsAdded = 0;
-    builderString = "";
-    for (int c = 0; c < frames->count(); c++)
-    {
-        dataColumnsAdded = 0;
-        frame = &frames->at(c);
-        //data = reinterpret_cast<const unsigned char *>(frame->payload().constData());
-        dataLen = frame->payload().count();
-
-        QString builderString;
-        if (CSVAbsTime)
-        {
-            QDateTime dt = QDateTime::fromMSecsSinceEpoch(frame->timeStamp().microSeconds() / 1000);
-            builderString += QString::number(dt.date().year()) + "," + QString::number(dt.date().month()) + ",";
-            builderString += QString::number(dt.date().day()) + "," + QString::number(dt.time().hour()) + ",";
-            builderString += QString::number(dt.time().minute()) + "," + QString::number(dt.time().second()) + ",";
-            builderString += QString::number(dt.time().msec()) + ",";
-            dataColumnsAdded += 7;
-        }
-        else {
-            builderString += QString::number((frame->timeStamp().microSeconds() / 1000000.0), 'f', 6) + ",";
-            dataColumnsAdded++;
-        }
-        //id
-        builderString += Utility::formatCANID(frame->frameId(), frame->hasExtendedFrameFormat()) + ",";
-        dataColumnsAdded++;
-        //if (frame->hasExtendedFrameFormat()) builderString += tr(" Ext ");
-        //else builderString += tr(" Std ");
-        //bus
-        builderString += QString::number(frame->bus) + ",";
-        dataColumnsAdded++;
-        //len
-        builderString += QString::number(dataLen) + ",";
-        dataColumnsAdded++;
-
-        if (dbcHandler != nullptr)
+        if (!filename.contains('.'))
         {
-            DBC_MESSAGE *msg = dbcHandler->findMessage(*frame);
-            if (msg != nullptr)
-            {
-                for (int j = 0; j < msg->sigHandler->getCount(); j++)
-                {
-                    if(j==0)
-                    {
-                        for(int i = 0; i<msgsAndColumns.count(); i++)
-                        {
-                            if(msgsAndColumns[i].first == msg->ID)
-                            {
-                                int startCol = msgsAndColumns[i].second;
-                                while(dataColumnsAdded < startCol)
-                                {
-                                    builderString += ",";
-                                    dataColumnsAdded++;
-                                }
-                            }
-                        }
-                    }
-
-                    QString temp;
-                    if (msg->sigHandler->findSignalByIdx(j)->processAsText(*frame, temp, false, false))
-                    {
-                        builderString.append(temp);
-                        builderString.append(",");
-                        dataColumnsAdded++;
-                    }
-                }
-            }
-            builderString.append("\n");
-            outFile->write(builderString.toUtf8());
+            if (format == DecodedExport::TEXT) filename += ".txt";
+            else if (format == DecodedExport::RESAMPLED_COLUMNS) filename += ".sccols";
+            else filename += ".csv";
         }
-    }
-    outFile->close();
-}
-
-void MainWindow::saveDecodedTextFile(QString filename)
-{
-    QFile *outFile = new QFile(filename);
-    const QVector<CANFrame> *frames = model->getFilteredListReference();
-
-    const unsigned char *data;
-    int dataLen;
-    const CANFrame *frame;
 
-    if (!outFile->open(QIODevice::WriteOnly | QIODevice::Text))
-        return;
-/*
-Time: 205.173000   ID: 0x20E Std Bus: 0 Len: 8
-Data Bytes: 88 10 00 13 BB 00 06 00
-    SignalName	Value
-*/
-    for (int c = 0; c < frames->count(); c++)
-    {
-        frame = &frames->at(c);
-        data = reinterpret_cast<const unsigned char *>(frame->payload().constData());
-        dataLen = frame->payload().count();
-
-        QString builderString;
-        builderString += tr("Time: ") + QString::number((frame->timeStamp().microSeconds() / 1000000.0), 'f', 6);
-        builderString += tr("    ID: ") + Utility::formatCANID(frame->frameId(), frame->hasExtendedFrameFormat());
-        if (frame->hasExtendedFrameFormat()) builderString += tr(" Ext ");
-        else builderString += tr(" Std ");
-        builderString += tr("Bus: ") + QString::number(frame->bus);
-        builderString += " Len: " + QString::number(dataLen) + "\n";
-        outFile->write(builderString.toUtf8());
-
-        builderString = tr("Data Bytes: ");
-        for (int temp = 0; temp < dataLen; temp++)
+        DecodedExport exporter(model->getFilteredListReference(), dbcHandler);
+        exporter.setAbsoluteTime(CSVAbsTime);
+        if (format == DecodedExport::RESAMPLED_CSV || format == DecodedExport::RESAMPLED_COLUMNS)
         {
-            builderString += Utility::formatNumber(data[temp]) + " ";
+            bool ok;
+            int intervalMs = QInputDialog::getInt(this, tr("Save Decoded"), tr("Resample interval (ms):"),
+                                                  settings.value("FileIO/DecodedResampleMs", 10).toInt(), 1, 3600000, 1, &ok);
+            if (!ok) return;
+            settings.setValue("FileIO/DecodedResampleMs", intervalMs);
+            exporter.setResampleInterval(static_cast<int64_t>(intervalMs) * 1000);
         }
-        builderString += "\n";
-        outFile->write(builderString.toUtf8());
 
-        builderString = "";
-        if (dbcHandler != nullptr)
-        {
-            DBC_MESSAGE *msg = dbcHandler->findMessage(*frame);
-            if (msg != nullptr)
-            {
-                for (int j = 0; j < msg->sigHandler->getCount(); j++)
-                {
-
-                    QString temp;
-                    if (msg->sigHandler->findSignalByIdx(j)->processAsText(*frame, temp))
-                    {
-                        builderString.append("\t" + temp);
-                        builderString.append("\n");
-                    }
-                }
-            }
-            builderString.append("\n");
-            outFile->write(builderString.toUtf8());
-        }
+        //the export reads the frame list from worker threads, nothing may be added or evicted meanwhile
+        model->setIngestHold(true);
+        exporter.exportFile(filename, format);
+        model->setIngestHold(false);
+
+        settings.setValue("FileIO/LoadSaveDirectory", dialog.directory().path());
     }
-    outFile->close();
 }
 
 void MainWindow::toggleCapture()
@@ -1547,6 +1387,7 @@ void MainWindow::updateFileStatus()
     if (model->rowCount() == 0)
     {
         output = tr("No packets loaded");
+        lbStatusFilename.setToolTip(QString());
     }
     else
     {
@@ -1623,7 +1464,7 @@ void MainWindow::showTemporalGraphWindow()
     //only create an instance of the object if we dont have one. Otherwise just display the existing one.
     if (!temporalGraphWindow)
     {
-        const QVector<CANFrame> *frames;
+        const CANFrameStore *frames;
         if (!useFiltered)
             frames = model->getListReference();
         else
@@ -8,6 +8,7 @@
 #include "canframemodel.h"
 #include "can_structs.h"
 #include "framefileio.h"
+#include "framebatch.h"
 #include "dbc/dbchandler.h"
 #include "bus_protocols/isotp_handler.h"
 #include "framesenderobject.h"
@@ -71,6 +72,7 @@ public:
 
 private slots:
     void handleLoadFile();
+    void handleStreamFile();
     void handleSaveFile();
     void handleSaveFilteredFile();
     void handleSaveFilters();
@@ -115,7 +117,7 @@ private slots:
     void interpretToggled(bool);
     void overwriteToggled(bool);
     void presistentFiltersToggled(bool state);
-    void logReceivedFrame(CANConnection*, QVector<CANFrame>);
+    void logReceivedFrame(const FrameBatchPtr &batch);
     void tickGUIUpdate();
     void toggleCapture();
     void normalizeTiming();
@@ -142,6 +144,7 @@ signals:
     //-1 = frames cleared, -2 = a new file has been loaded (so all frames are different), otherwise # of new frames
     void framesUpdated(int numFrames); //something has updated the frame list (send at gui update frequency)
     void frameUpdateRapid(int numFrames);
+    void framesEvicted(int numFrames); //the oldest numFrames frames were dropped to stay within the capture retention limit
     void settingsUpdated();
     void sendCenterTimeID(uint32_t ID, double timestamp);
 
@@ -167,8 +170,10 @@ private:
     bool useFiltered; //should sub-windows use the unfiltered or filtered frames list?
     bool inhibitSenderChanged;
 
-    bool continuousLogging;
-    int continuousLogFlushCounter;
+    ContinuousLogger continuousLogger;
+    int continuousLogStatusCounter;
+    qint64 continuousLogLastBytes;
+    QElapsedTimer continuousLogTimer;
 
     //References to other windows we can display
 
@@ -214,8 +219,6 @@ private:
     QString getSignalNameFromPosition(QPoint pos);
     uint32_t getMessageIDFromPosition(QPoint pos);
     void handleSaveDecodedMethod(bool csv);
-    void saveDecodedTextFile(QString);
-    void saveDecodedTextFileAsColumns(QString);
     void addFrameToDisplay(CANFrame &, bool);
     void updateFileStatus();
     void closeEvent(QCloseEvent *event);
@@ -226,6 +229,8 @@ private:
     bool eventFilter(QObject *obj, QEvent *event);
     void manageRowExpansion();
     void disableAutoRowExpansion();
+    bool refuseWhileStreaming();
+    void updateContinuousLogStatus();
     void createSenderRow();
     void processSenderCellChange(int line, int col);
 };
@@ -9,7 +9,7 @@ const QColor FlowViewWindow::graphColors[8] = {Qt::blue, Qt::green, Qt::black, Q
                                                Qt::gray, Qt::darkYellow, Qt::cyan, Qt::darkMagenta}; //4 5 6 7
 
 
-FlowViewWindow::FlowViewWindow(const QVector<CANFrame> *frames, QWidget *parent) :
+FlowViewWindow::FlowViewWindow(const CANFrameStore *frames, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::FlowViewWindow)
 {
@@ -296,7 +296,7 @@ void FlowViewWindow::plottableDoubleClick(QCPAbstractPlottable* plottable, QMous
     int id = 0;
     //apply transforms to get the X axis value where we double clicked
     double coord = plottable->keyAxis()->pixelToCoord(event->localPos().x());
-    if (frameCache.count() > 0) id = frameCache[0].frameId();
+    if (frameCache.count() > 0) id = frameCache[0].frameId;
     if (secondsMode) emit sendCenterTimeID(id, coord);
     else emit sendCenterTimeID(id, coord / 1000000.0);
 }
@@ -324,7 +324,7 @@ void FlowViewWindow::gotCenterTimeID(uint32_t ID, double timestamp)
     int bestIdx = -1;
     for (int i = 0; i < frameCache.count(); i++)
     {
-        if (frameCache[i].timeStamp().microSeconds() > t_stamp)
+        if (frameCache[i].timestamp > t_stamp)
         {
             bestIdx = i - 1;
             break;
@@ -341,7 +341,7 @@ void FlowViewWindow::gotCenterTimeID(uint32_t ID, double timestamp)
 
         memset(currBytes, 0, 8); //first zero out all 8 bytes
 
-        memcpy(currBytes, frameCache.at(currentPosition).payload().data(), frameCache.at(currentPosition).payload().length());
+        memcpy(currBytes, frameCache.at(currentPosition).data, frameCache.at(currentPosition).length);
 
         updateDataView();
     }
@@ -448,7 +448,7 @@ void FlowViewWindow::updatedFrames(int numFrames)
     const unsigned char *data;
     int dataLen = 0;
 
-    const CANFrame *thisFrame;
+    CANFrame thisFrame;
     if (numFrames == -1) //all frames deleted. Kill the display
     {
         ui->listFrameID->clear();
@@ -478,35 +478,35 @@ void FlowViewWindow::updatedFrames(int numFrames)
     {
         if (numFrames > modelFrames->count()) return;
         unsigned int refID;
-        if (frameCache.count() > 0) refID = frameCache[0].frameId();
+        if (frameCache.count() > 0) refID = frameCache[0].frameId;
             else refID = 0;
         bool needRefresh = false;
         for (int i = modelFrames->count() - numFrames; i < modelFrames->count(); i++)
         {
-            thisFrame = &modelFrames->at(i);
-            data = reinterpret_cast<const unsigned char *>(thisFrame->payload().constData());
-            dataLen = thisFrame->payload().length();
+            thisFrame = modelFrames->at(i);
+            data = reinterpret_cast<const unsigned char *>(thisFrame.payload().constData());
+            dataLen = thisFrame.payload().length();
 
-            if (!foundID.contains(thisFrame->frameId()))
+            if (!foundID.contains(thisFrame.frameId()))
             {
-                foundID.append(thisFrame->frameId());
-                FilterUtility::createFilterItem(thisFrame->frameId(), ui->listFrameID);
+                foundID.append(thisFrame.frameId());
+                FilterUtility::createFilterItem(thisFrame.frameId(), ui->listFrameID);
             }
 
-            if (thisFrame->frameId() == refID)
+            if (thisFrame.frameId() == refID)
             {
-                frameCache.append(*thisFrame);
+                frameCache.append(CANFrameData::fromCANFrame(thisFrame));
 
                 for (int k = 0; k < dataLen; k++)
                 {
                     if (ui->cbTimeGraph->isChecked())
                     {
                         if (secondsMode){
-                            newX[k].append((double)(thisFrame->timeStamp().microSeconds()) / 1000000.0);
+                            newX[k].append((double)(thisFrame.timeStamp().microSeconds()) / 1000000.0);
                         }
                         else
                         {
-                            newX[k].append(thisFrame->timeStamp().microSeconds());
+                            newX[k].append(thisFrame.timeStamp().microSeconds());
                         }
                     }
                     else
@@ -522,7 +522,7 @@ void FlowViewWindow::updatedFrames(int numFrames)
         {
             currentPosition = frameCache.count() - 1;
             memset(currBytes, 0, 64);
-            memcpy(currBytes, frameCache.at(currentPosition).payload().data(), frameCache.at(currentPosition).payload().length());
+            memcpy(currBytes, frameCache.at(currentPosition).data, frameCache.at(currentPosition).length);
             memcpy(refBytes, currBytes, 64);
 
         }
@@ -535,7 +535,7 @@ void FlowViewWindow::updatedFrames(int numFrames)
             }
             ui->graphView->replot();
             updateDataView();
-            if (ui->cbSync->checkState() == Qt::Checked) emit sendCenterTimeID(frameCache[currentPosition].frameId(), frameCache[currentPosition].timeStamp().microSeconds() / 1000000.0);
+            if (ui->cbSync->checkState() == Qt::Checked) emit sendCenterTimeID(frameCache[currentPosition].frameId, frameCache[currentPosition].timestamp / 1000000.0);
         }
     }
     updateFrameLabel();
@@ -552,7 +552,7 @@ void FlowViewWindow::createGraph(int byteNum)
     int tempVal;
     double minval = 1000000.0, maxval = -100000.0;
     const unsigned char *data;
-    const CANFrame *frame;
+    const CANFrameData *frame;
 
     qDebug() << "Create Graph " << byteNum;
 
@@ -568,8 +568,8 @@ void FlowViewWindow::createGraph(int byteNum)
     for (int j = 0; j < numEntries; j++)
     {
         frame = &frameCache[j];
-        data = reinterpret_cast<const unsigned char *>(frame->payload().constData());
-        if (byteNum < frameCache[j].payload().length())
+        data = frame->data;
+        if (byteNum < frame->length)
             tempVal = data[byteNum];
         else
             tempVal = 0;
@@ -577,11 +577,11 @@ void FlowViewWindow::createGraph(int byteNum)
         if (graphByTime)
         {
             if (secondsMode){
-                x[byteNum][j] = frame->timeStamp().microSeconds() / 1000000.0;
+                x[byteNum][j] = frame->timestamp / 1000000.0;
             }
             else
             {
-                x[byteNum][j] = frame->timeStamp().microSeconds();
+                x[byteNum][j] = frame->timestamp;
             }
         }
         else
@@ -608,10 +608,9 @@ void FlowViewWindow::createGraph(int byteNum)
 void FlowViewWindow::refreshIDList()
 {
     int id;
-    for (int i = 0; i < modelFrames->count(); i++)
+    for (CANFrameScanner scan(*modelFrames); scan.next();)
     {
-        CANFrame thisFrame = modelFrames->at(i);
-        id = thisFrame.frameId();
+        id = scan.frame().frameId();
         if (!foundID.contains(id))
         {
             foundID.append(id);
@@ -639,15 +638,13 @@ void FlowViewWindow::changeID(QString newID)
     playbackTimer->stop();
     playbackActive = false;
     int maxBytes = 0;
-    for (int x = 0; x < modelFrames->count(); x++)
+    CANFrameScanner scan(*modelFrames);
+    scan.setIdFilter(id);
+    while (scan.next())
     {
-        CANFrame thisFrame = modelFrames->at(x);
-        if (thisFrame.frameId() == id)
-        {
-            thisFrame.payload().clear();
-            frameCache.append(thisFrame);
-            if (thisFrame.payload().length() > maxBytes) maxBytes = thisFrame.payload().length();
-        }
+        CANFrameData thisFrame = scan.frame().toFrameData();
+        frameCache.append(thisFrame);
+        if (thisFrame.length > maxBytes) maxBytes = thisFrame.length;
     }
     ui->flowView->setBytesToDraw(maxBytes);
     currentPosition = 0;
@@ -664,7 +661,7 @@ void FlowViewWindow::changeID(QString newID)
     updateGraphLocation();
 
     memset(currBytes, 0, 64);
-    memcpy(currBytes, frameCache.at(currentPosition).payload().constData(), frameCache.at(currentPosition).payload().length());
+    memcpy(currBytes, frameCache.at(currentPosition).data, frameCache.at(currentPosition).length);
     memcpy(refBytes, currBytes, 64);
 
     updateDataView();
@@ -712,7 +709,7 @@ void FlowViewWindow::btnStopClick()
     currentPosition = 0;
 
     memset(currBytes, 0, 64);
-    memcpy(currBytes, frameCache.at(currentPosition).payload().constData(), frameCache.at(currentPosition).payload().length());
+    memcpy(currBytes, frameCache.at(currentPosition).data, frameCache.at(currentPosition).length);
     memcpy(refBytes, currBytes, 64);
 
     updateFrameLabel();
@@ -818,7 +815,7 @@ void FlowViewWindow::gotoFrame(int frame) {
     if (frameCache.count() >= frame) currentPosition = frame;
     else currentPosition = 0;
 
-    if (ui->cbSync->checkState() == Qt::Checked) emit sendCenterTimeID(frameCache[currentPosition].frameId(), frameCache[currentPosition].timeStamp().microSeconds() / 1000000.0);
+    if (ui->cbSync->checkState() == Qt::Checked) emit sendCenterTimeID(frameCache[currentPosition].frameId, frameCache[currentPosition].timestamp / 1000000.0);
 }
 
 void FlowViewWindow::updatePosition(bool forward)
@@ -844,14 +841,14 @@ void FlowViewWindow::updatePosition(bool forward)
     //get through that then they're changed and a trigger so we stop playback at this frame.
     //This is complicated by the fact that CAN-FD frames might have far more than 64 bits. It is necessary
     //to thus process them 64 bits at a time and just move chunk to chunk until done.
-    for (int chunk = 0; chunk < frameCache.at(currentPosition).payload().length(); chunk += 8)
+    for (int chunk = 0; chunk < frameCache.at(currentPosition).length; chunk += 8)
     {
         uint64_t changedBits = 0;
         uint8_t cngByte;
-        int maxVal = qMin(chunk * 8 + 8, frameCache.at(currentPosition).payload().length());
+        int maxVal = qMin(chunk * 8 + 8, static_cast<int>(frameCache.at(currentPosition).length));
         for (int i = chunk * 8; i < maxVal; i++)
         {
-            unsigned char thisByte = static_cast<unsigned char>(frameCache.at(currentPosition).payload()[i]);
+            unsigned char thisByte = frameCache.at(currentPosition).data[i];
             cngByte = currBytes[i] ^ thisByte;
             changedBits |= (uint64_t)cngByte << (8ull * (i & 7));
         }
@@ -867,9 +864,9 @@ void FlowViewWindow::updatePosition(bool forward)
         }
     }
     memset(currBytes, 0, 64);
-    memcpy(currBytes, frameCache.at(currentPosition).payload().constData(), frameCache.at(currentPosition).payload().length());
+    memcpy(currBytes, frameCache.at(currentPosition).data, frameCache.at(currentPosition).length);
 
-    if (ui->cbSync->checkState() == Qt::Checked) emit sendCenterTimeID(frameCache[currentPosition].frameId(), frameCache[currentPosition].timeStamp().microSeconds() / 1000000.0);
+    if (ui->cbSync->checkState() == Qt::Checked) emit sendCenterTimeID(frameCache[currentPosition].frameId, frameCache[currentPosition].timestamp / 1000000.0);
     ui->timelineSlider->setValue(currentPosition);
 }
 
@@ -884,9 +881,9 @@ void FlowViewWindow::updateGraphLocation()
     {
         if (secondsMode)
         {
-            ui->graphView->xAxis->setRange(frameCache[start].timeStamp().microSeconds() / 1000000.0, frameCache[end].timeStamp().microSeconds() / 1000000.0);
+            ui->graphView->xAxis->setRange(frameCache[start].timestamp / 1000000.0, frameCache[end].timestamp / 1000000.0);
             /*
-            ui->graphView->xAxis->setTickStep((frameCache[end].timeStamp().microSeconds() - frameCache[start].timeStamp().microSeconds())/ 3000000.0);
+            ui->graphView->xAxis->setTickStep((frameCache[end].timestamp - frameCache[start].timestamp)/ 3000000.0);
             ui->graphView->xAxis->setSubTickCount(0);
             ui->graphView->xAxis->setNumberFormat("f");
             ui->graphView->xAxis->setNumberPrecision(6);
@@ -894,9 +891,9 @@ void FlowViewWindow::updateGraphLocation()
         }
         else
         {
-            ui->graphView->xAxis->setRange(frameCache[start].timeStamp().microSeconds(), frameCache[end].timeStamp().microSeconds());
+            ui->graphView->xAxis->setRange(frameCache[start].timestamp, frameCache[end].timestamp);
             /*
-            ui->graphView->xAxis->setTickStep((frameCache[end].timeStamp().microSeconds() - frameCache[start].timeStamp().microSeconds())/ 3.0);
+            ui->graphView->xAxis->setTickStep((frameCache[end].timestamp - frameCache[start].timestamp)/ 3.0);
             ui->graphView->xAxis->setSubTickCount(0);
             ui->graphView->xAxis->setNumberFormat("f");
             ui->graphView->xAxis->setNumberPrecision(0); */
@@ -4,6 +4,7 @@
 #include "helpwindow.h"
 #include <QtDebug>
 #include <vector>
+#include <algorithm>
 #include "filterutility.h"
 #include "qcpaxistickerhex.h"
 
@@ -13,7 +14,7 @@ QPen FrameInfoWindow::bytePens[8];
 
 const int numIntervalHistBars = 20;
 
-FrameInfoWindow::FrameInfoWindow(const QVector<CANFrame> *frames, QWidget *parent) :
+FrameInfoWindow::FrameInfoWindow(const CANFrameStore *frames, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::FrameInfoWindow)
 {
@@ -338,15 +339,14 @@ void FrameInfoWindow::updatedFrames(int numFrames)
         bool thisID = false;
         for (int x = modelFrames->count() - numFrames; x < modelFrames->count(); x++)
         {
-            CANFrame thisFrame = modelFrames->at(x);
-            int32_t id = static_cast<int32_t>(thisFrame.frameId());
+            int32_t id = static_cast<int32_t>(modelFrames->view(x).frameId());
             if (!foundID.contains(id))
             {
                 foundID.append(id);
                 FilterUtility::createFilterItem(id, ui->listFrameID);
             }
 
-            if (currID == modelFrames->at(x).frameId())
+            if (currID == static_cast<uint32_t>(id))
             {
                 thisID = true;
                 break;
@@ -407,16 +407,16 @@ void FrameInfoWindow::updateDetailsWindow(QString newID)
     {
 
         frameCache.clear();
-        for (int i = 0; i < modelFrames->count(); i++)
-        {
-            CANFrame thisFrame = modelFrames->at(i);
-            if (thisFrame.frameId() == static_cast<uint32_t>(targettedID)) frameCache.append(thisFrame);
-        }
+        CANFrameScanner scan(*modelFrames);
+        scan.setIdFilter(static_cast<uint32_t>(targettedID));
+        while (scan.next()) frameCache.append(scan.frame().toFrameData());
+        //plain structs so this is cheap, and it makes every interval below come out non-negative
+        std::stable_sort(frameCache.begin(), frameCache.end());
 
         if (frameCache.count() == 0) return; //nothing to do if there are no frames!
 
-        const unsigned char *data = reinterpret_cast<const unsigned char *>(frameCache.at(0).payload().constData());
-        int dataLen = frameCache.at(0).payload().length();
+        const unsigned char *data = frameCache.at(0).data;
+        int dataLen = frameCache.at(0).length;
 
         ui->treeDetails->clear();
 
@@ -425,7 +425,7 @@ void FrameInfoWindow::updateDetailsWindow(QString newID)
         baseNode = new QTreeWidgetItem();
         baseNode->setText(0, QString("ID: ") + newID );
 
-        if (frameCache[0].hasExtendedFrameFormat()) //if these frames seem to be extended then try for J1939 decoding
+        if (frameCache[0].isExtended()) //if these frames seem to be extended then try for J1939 decoding
         {
             // ------- J1939 decoding ----------
             J1939ID jid;
@@ -509,8 +509,8 @@ void FrameInfoWindow::updateDetailsWindow(QString newID)
         }
         signalInstances.clear();
 
-        data = reinterpret_cast<const unsigned char *>(frameCache.at(0).payload().constData());
-        dataLen = frameCache.at(0).payload().length();
+        data = frameCache.at(0).data;
+        dataLen = frameCache.at(0).length;
 
         for (int c = 0; c < dataLen; c++)
         {
@@ -525,11 +525,29 @@ void FrameInfoWindow::updateDetailsWindow(QString newID)
 
         DBC_MESSAGE *msg = dbcHandler->findMessageForFilter(targettedID, nullptr);
 
+        //When the message has exactly this ID its numeric signals come out of the shared signal store,
+        //counting each distinct value and formatting it once. Only what's left is decoded frame by frame.
+        //The store covers every captured frame so it's no use when this window works on the filtered list,
+        //the counts have to come from the same frames as everything else shown here.
+        CANFrameModel *model = MainWindow::getReference()->getCANFrameModel();
+        QVector<DBC_SIGNAL *> perFrameSignals, storedSignals;
+        if (msg)
+        {
+            bool useStore = (msg->ID == static_cast<uint32_t>(targettedID)) && (modelFrames == model->getListReference());
+            for (int i = 0; i < msg->sigHandler->getCount(); i++)
+            {
+                DBC_SIGNAL *sig = msg->sigHandler->findSignalByIdx(i);
+                if (!sig) continue;
+                if (useStore && sig->valType != STRING) storedSignals.append(sig);
+                else perFrameSignals.append(sig);
+            }
+        }
+
         //then find all data points
         for (int j = 0; j < frameCache.count(); j++)
         {
-            data = reinterpret_cast<const unsigned char *>(frameCache.at(j).payload().constData());
-            dataLen = frameCache.at(j).payload().length();
+            data = frameCache.at(j).data;
+            dataLen = frameCache.at(j).length;
 
             byteGraphX.append(j);
             for (int bytcnt = 0; bytcnt < dataLen; bytcnt++)
@@ -539,12 +557,7 @@ void FrameInfoWindow::updateDetailsWindow(QString newID)
 
             if (j != 0)
             {
-                //TODO - we try the interval whichever way doesn't go negative. But, we should probably sort the frame list before
-                //starting so that the intervals are all correct.
-                if (frameCache[j].timeStamp().microSeconds() > frameCache[j-1].timeStamp().microSeconds())
-                    thisInterval = (frameCache[j].timeStamp().microSeconds() - frameCache[j-1].timeStamp().microSeconds());
-                else
-                    thisInterval = (frameCache[j-1].timeStamp().microSeconds() - frameCache[j].timeStamp().microSeconds());
+                thisInterval = frameCache[j].timestamp - frameCache[j-1].timestamp;
 
                 sortedIntervals.push_back(thisInterval);
                 intervalSum += thisInterval;
@@ -584,27 +597,35 @@ void FrameInfoWindow::updateDetailsWindow(QString newID)
 
             //Search every signal in the selected message and give output of the range the signal took and
             //how many messages contained each discrete value.
-            if (msg)
+            if (!perFrameSignals.isEmpty())
             {
-                int numSignals = msg->sigHandler->getCount();
-                for (int i = 0; i < numSignals; i++)
+                const CANFrame frame = frameCache.at(j).toCANFrame();
+                foreach (DBC_SIGNAL *sig, perFrameSignals)
                 {
-                    DBC_SIGNAL *sig = msg->sigHandler->findSignalByIdx(i);
-                    if (sig)
+                    if (sig->isSignalInMessage(frame))
                     {
-                        if (sig->isSignalInMessage(frameCache.at(j)))
+                        QString sigVal;
+                        if (sig->processAsText(frame, sigVal, false))
                         {
-                            QString sigVal;
-                            if (sig->processAsText(frameCache.at(j), sigVal, false))
-                            {
-                                signalInstances[sig->name][sigVal] = signalInstances[sig->name][sigVal] + 1;
-                            }
+                            signalInstances[sig->name][sigVal] = signalInstances[sig->name][sigVal] + 1;
                         }
                     }
                 }
             }
         }
 
+        SignalStore *signalStore = model->getSignalStore();
+        foreach (DBC_SIGNAL *sig, storedSignals)
+        {
+            SignalSeries series = signalStore->series(sig);
+            QHash<double, int> valueCounts;
+            for (int i = 0; i < series.count(); i++) valueCounts[series.values[i]]++;
+            for (QHash<double, int>::const_iterator it = valueCounts.constBegin(); it != valueCounts.constEnd(); ++it)
+            {
+                signalInstances[sig->name][sig->formatValue(SignalSeries::signalValue(sig, it.key()), false)] += it.value();
+            }
+        }
+
         //Divide all the bit flip heat values by the number of frames to get a ratio
         for (int j = 0; j < 64; j++) bitFlipHeat[j] /= (double)frameCache.count();
 
@@ -823,10 +844,9 @@ void FrameInfoWindow::updateDetailsWindow(QString newID)
 void FrameInfoWindow::refreshIDList()
 {
     int id;
-    for (int i = 0; i < modelFrames->count(); i++)
+    for (CANFrameScanner scan(*modelFrames); scan.next();)
     {
-        CANFrame thisFrame = modelFrames->at(i);
-        id = (int)thisFrame.frameId();
+        id = (int)scan.frame().frameId();
         if (!foundID.contains(id))
         {
             foundID.append(id);
@@ -8,7 +8,7 @@
 #include "connections/canconmanager.h"
 #include "filterutility.h"
 
-FuzzingWindow::FuzzingWindow(const QVector<CANFrame> *frames, QWidget *parent) :
+FuzzingWindow::FuzzingWindow(const CANFrameStore *frames, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::FuzzingWindow)
 {
@@ -104,7 +104,7 @@ void FuzzingWindow::updatedFrames(int numFrames)
         if (numFrames > modelFrames->count()) return;
         for (int i = modelFrames->count() - numFrames; i < modelFrames->count(); i++)
         {
-            id = modelFrames->at(i).frameId();
+            id = modelFrames->view(i).frameId();
             if (!foundIDs.contains(id))
             {
                 foundIDs.append(id);
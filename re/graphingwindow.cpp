@@ -4,12 +4,13 @@
 #include "mainwindow.h"
 #include "helpwindow.h"
 #include "utility.h"
+#include "dbc/signalbulkdecoder.h"
 #include <QDebug>
 
 #include <algorithm>
 #include <limits>
 
-GraphingWindow::GraphingWindow(const QVector<CANFrame> *frames, QWidget *parent) :
+GraphingWindow::GraphingWindow(const CANFrameStore *frames, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::GraphingWindow)
 {
@@ -84,6 +85,7 @@ GraphingWindow::GraphingWindow(const QVector<CANFrame> *frames, QWidget *parent)
     connect(ui->graphingView, SIGNAL(legendClick(QCPLegend*,QCPAbstractLegendItem*,QMouseEvent*)), this, SLOT(legendSingleClick(QCPLegend*,QCPAbstractLegendItem*)));
 
     connect(MainWindow::getReference(), SIGNAL(framesUpdated(int)), this, SLOT(updatedFrames(int)));
+    connect(MainWindow::getReference(), SIGNAL(framesEvicted(int)), this, SLOT(framesEvicted(int)));
 
     // setup policy and connect slot for context menu popup:
     ui->graphingView->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -220,9 +222,10 @@ void GraphingWindow::updatedFrames(int numFrames)
             y.clear();
             for (int i = modelFrames->count() - numFrames; i < modelFrames->count(); i++)
             {
-                thisFrame = modelFrames->at(i);
-                if ( graphParams[j].ID == thisFrame.frameId() && ( (graphParams[j].bus == -1) || (graphParams[j].bus == thisFrame.bus) ) )
+                CANFrameView view = modelFrames->view(i);
+                if ( graphParams[j].ID == view.frameId() && ( (graphParams[j].bus == -1) || (graphParams[j].bus == view.bus()) ) )
                 {
+                    thisFrame = view.toCANFrame();
                     appendToGraph(graphParams[j], thisFrame, x, y);
                     appendedToGraph = true;
                 }
@@ -1235,6 +1238,45 @@ void GraphingWindow::addNewGraph()
     showParamsDialog(-1);
 }
 
+double GraphingWindow::timestampToX(const GraphParams &params, int64_t micros)
+{
+    if (Utility::timeStyle == TS_SECONDS)
+    {
+        return ((double)(micros) / 1000000.0 - params.xbias);
+    }
+    else if (Utility::timeStyle == TS_CLOCK)
+    {
+        QDateTime dt = QDateTime::fromMSecsSinceEpoch((micros / 1000) - params.xbias);
+        return (dt.time().second() + dt.time().minute() * 60 + dt.time().hour() * 3600);
+    }
+    return (micros - params.xbias);
+}
+
+//The main window dropped its oldest frames to stay inside the capture retention limit. Drop the points
+//that came from them too instead of regenerating every graph.
+void GraphingWindow::framesEvicted(int numFrames)
+{
+    Q_UNUSED(numFrames);
+    if (modelFrames->count() == 0) return;
+    int64_t oldest = modelFrames->view(0).timestamp();
+    bool needReplot = false;
+
+    for (int j = 0; j < graphParams.count(); j++)
+    {
+        GraphParams &params = graphParams[j];
+        double cutoff = timestampToX(params, oldest);
+        int drop = 0;
+        while (drop < params.x.count() && params.x[drop] < cutoff) drop++;
+        if (drop == 0) continue;
+        params.x.remove(0, drop);
+        params.y.remove(0, drop);
+        if (params.ref) params.ref->data()->removeBefore(cutoff);
+        needReplot = true;
+    }
+
+    if (needReplot) ui->graphingView->replot();
+}
+
 void GraphingWindow::appendToGraph(GraphParams &params, CANFrame &frame, QVector<double> &x, QVector<double> &y)
 {
     params.strideSoFar++;
@@ -1242,21 +1284,11 @@ void GraphingWindow::appendToGraph(GraphParams &params, CANFrame &frame, QVector
     {
         params.strideSoFar = 0;
         int64_t tempVal; //64 bit temp value.
-        tempVal = Utility::processIntegerSignal(frame.payload(), params.startBit, params.numBits, params.intelFormat, params.isSigned); //& params.mask;
+        if (!params.extractor.matches(params.startBit, params.numBits, params.intelFormat, params.isSigned))
+            params.extractor.compile(params.startBit, params.numBits, params.intelFormat, params.isSigned);
+        tempVal = params.extractor.extract(frame.payload()); //& params.mask;
         double xVal, yVal;
-        if (Utility::timeStyle == TS_SECONDS)
-        {
-            xVal = ((double)(frame.timeStamp().microSeconds()) / 1000000.0 - params.xbias);
-        }
-        else if (Utility::timeStyle == TS_CLOCK)
-        {
-            QDateTime dt = QDateTime::fromMSecsSinceEpoch((frame.timeStamp().microSeconds() / 1000) - params.xbias);
-            xVal = (dt.time().second() + dt.time().minute() * 60 + dt.time().hour() * 3600);
-        }
-        else
-        {
-            xVal = (frame.timeStamp().microSeconds() - params.xbias);
-        }
+        xVal = timestampToX(params, frame.timeStamp().microSeconds());
         yVal = (tempVal * params.scale) + params.bias;
         params.x.append(xVal);
         params.y.append(yVal);
@@ -1313,9 +1345,19 @@ void GraphingWindow::appendToGraph(GraphParams &params, CANFrame &frame, QVector
     }
 }
 
+//true when the graph is its associated signal unchanged, the user can edit the bits and scaling after picking one
+static bool graphsDBCSignal(const GraphParams &params)
+{
+    const DBC_SIGNAL *sig = params.associatedSignal;
+    if (!sig || !sig->parentMessage || params.ID != sig->parentMessage->ID) return false;
+    if (sig->valType != SIGNED_INT && sig->valType != UNSIGNED_INT) return false;
+    return params.startBit == sig->startBit && params.numBits == sig->signalSize && params.intelFormat == sig->intelByteOrder
+            && params.isSigned == (sig->valType == SIGNED_INT) && params.scale == sig->factor && params.bias == sig->bias;
+}
+
 void GraphingWindow::createGraph(GraphParams &params, bool createGraphParam)
 {
-    int64_t tempVal; //64 bit temp value.
+    int64_t tempVal = 0; //64 bit temp value.
     double yminval=10000000.0, ymaxval = -1000000.0;
     double xminval=10000000000.0, xmaxval = -10000000000.0;
     GraphParams *refParam = &params;
@@ -1329,75 +1371,90 @@ void GraphingWindow::createGraph(GraphParams &params, bool createGraphParam)
     qDebug() << "Signed: " << params.isSigned;
     qDebug() << "Mask: " << params.mask;
 
-    frameCache.clear();
-    for (int i = 0; i < modelFrames->count(); i++)
+    bool wantRaw = params.associatedSignal && !params.associatedSignal->valList.isEmpty();
+    QVector<double> times;
+    QVector<int64_t> rawVals;
+    int numEntries;
+    bool noFrames;
+
+    if (graphsDBCSignal(params))
+    {
+        //graphed exactly as the DBC defines it so the decode is shared with every other window showing it
+        SignalSeries series = MainWindow::getReference()->getCANFrameModel()->getSignalStore()->series(params.associatedSignal, params.bus);
+        if (wantRaw)
+        {
+            rawVals.reserve(series.count());
+            foreach (const SignalStateRun &run, series.runs) rawVals.insert(rawVals.end(), run.numPoints, run.rawValue);
+        }
+        if (params.stride > 1)
+        {
+            params.y.clear();
+            for (int i = 0; i < series.count(); i += params.stride)
+            {
+                times.append(series.times[i]);
+                params.y.append(series.values[i]);
+                if (wantRaw) rawVals[times.count() - 1] = rawVals[i];
+            }
+            if (wantRaw) rawVals.resize(times.count());
+        }
+        else
+        {
+            //copied, still sharing the store's vectors would make its next catch up copy the whole series
+            params.y.clear();
+            times.reserve(series.count());
+            params.y.reserve(series.count());
+            for (int i = 0; i < series.count(); i++)
+            {
+                times.append(series.times[i]);
+                params.y.append(series.values[i]);
+            }
+        }
+        numEntries = times.count();
+        noFrames = (numEntries == 0);
+    }
+    else
     {
-        CANFrame thisFrame = modelFrames->at(i);
-        if ( (thisFrame.frameId() == params.ID) && (thisFrame.frameType() == QCanBusFrame::DataFrame)
-       &&  ( ( params.bus == -1) ||  (params.bus == thisFrame.bus) ) ) frameCache.append(thisFrame);
+        //decode the whole graph in one go straight from the capture store
+        SignalBulkDecoder decoder(params.startBit, params.numBits, params.intelFormat, params.isSigned, params.scale, params.bias);
+        decoder.setMultiplexFilter(params.associatedSignal);
+        QVector<uint32_t> rows = SignalBulkDecoder::collectRows(*modelFrames, params.ID, params.bus, params.stride);
+        numEntries = decoder.decode(*modelFrames, rows, times, params.y, wantRaw ? &rawVals : nullptr);
+        noFrames = rows.isEmpty();
     }
 
     //to fix weirdness where a graph that has no data won't be able to be edited, selected, or deleted properly
-    //we'll check for the condition that there is nothing to graph and add a single dummy frame to the cache
-    //that has all data bytes = 0. This allows the graph to be edited and deleted. No idea why you can't otherwise.
-    if (frameCache.count() == 0)
+    //we'll check for the condition that there is nothing to graph and add a single dummy point as if there
+    //was a frame with all data bytes = 0. This allows the graph to be edited and deleted. No idea why you can't otherwise.
+    if (noFrames)
     {
-        CANFrame dummy;
-        dummy.setFrameId(params.ID);
-        dummy.bus = 0;
-        dummy.setPayload(QByteArray(8, 0));
-        dummy.setFrameType(QCanBusFrame::DataFrame);
-        frameCache.append(dummy);
+        times.append(0);
+        params.y.append(params.bias);
+        if (wantRaw) rawVals.append(0);
+        numEntries = 1;
     }
 
-    int numEntries = frameCache.count() / params.stride;
-    if (numEntries < 1) numEntries = 1; //could happen if stride is larger than frame count
-
-    params.x.clear();
-    params.y.clear();
-    params.x.reserve(numEntries);
-    params.y.reserve(numEntries);
-    //params.x.fill(0, numEntries);
-    //params.y.fill(0, numEntries);
-
-    int sBit = params.startBit;
-    int bits = params.numBits;
-    bool intelFormat = params.intelFormat;
-    bool isSigned = params.isSigned;
+    params.x.resize(numEntries);
 
     for (int j = 0; j < numEntries; j++)
     {
-        int k = j * params.stride;
-        if (params.associatedSignal)
-        {
-            //skip all the rest of the stuff in this loop and don't add this to the graph if this signal isn't in this frame
-            if (!params.associatedSignal->isSignalInMessage(frameCache[k]))
-            {
-                qDebug() << "Signal was not in this frame";
-                continue;
-            }
-            else qDebug() << "Signal in the frame!";
-        }
-        tempVal = Utility::processIntegerSignal(frameCache[k].payload(), sBit, bits, intelFormat, isSigned); //& params.mask;
-        //qDebug() << tempVal;
-        y = (tempVal * params.scale) + params.bias;
-        params.y.append( y );
+        tempVal = wantRaw ? rawVals[j] : 0;
+        y = params.y[j];
 
         if (Utility::timeStyle == TS_SECONDS)
         {
-            x = (frameCache[k].timeStamp().microSeconds()) / 1000000.0;
+            x = times[j] / 1000000.0;
         }
         else if (Utility::timeStyle == TS_CLOCK)
         {
-            QDateTime dt = QDateTime::fromMSecsSinceEpoch((frameCache[k].timeStamp().microSeconds() / 1000) - params.xbias);
+            QDateTime dt = QDateTime::fromMSecsSinceEpoch((static_cast<int64_t>(times[j]) / 1000) - params.xbias);
             x = (dt.time().msecsSinceStartOfDay() / 1000.0);
         }
         else
         {
-            x = frameCache[k].timeStamp().microSeconds();
+            x = times[j];
         }
 
-        params.x.append( x );
+        params.x[j] = x;
 
         if (params.associatedSignal && numEntries > 1)
         {
@@ -3,6 +3,7 @@
 
 #include "qcustomplot.h"
 #include "can_structs.h"
+#include "canframestore.h"
 #include "dbc/dbchandler.h"
 
 #include <QDialog>
@@ -44,6 +45,7 @@ public:
     QCPItemBracket *lastBracket;
     QList<QCPItemBracket *> brackets;
     QList<QCPItemText *> bracketTexts;
+    SignalExtractor extractor; //recompiled whenever it no longer matches the fields above
 };
 
 class GraphingWindow : public QDialog
@@ -51,7 +53,7 @@ class GraphingWindow : public QDialog
     Q_OBJECT
 
 public:
-    explicit GraphingWindow(const QVector<CANFrame> *, QWidget *parent = 0);
+    explicit GraphingWindow(const CANFrameStore *, QWidget *parent = 0);
     ~GraphingWindow();
     void showEvent(QShowEvent*);
 
@@ -83,6 +85,7 @@ private slots:
     void appendToGraph(GraphParams &params, CANFrame &frame, QVector<double> &x, QVector<double> &y);
     void editSelectedGraph();
     void updatedFrames(int);
+    void framesEvicted(int numFrames);
     void gotCenterTimeID(uint32_t ID, double timestamp);
     void resetView();
     void zoomIn();
@@ -92,10 +95,11 @@ signals:
     void sendCenterTimeID(uint32_t ID, double timestamp);
 
 private:
+    double timestampToX(const GraphParams &params, int64_t micros);
+
     Ui::GraphingWindow *ui;
     DBCHandler *dbcHandler;
-    QList<CANFrame> frameCache;
-    const QVector<CANFrame> *modelFrames;
+    const CANFrameStore *modelFrames;
     QList<GraphParams> graphParams;
     QPen selectedPen;
     QCPSelectionDecorator *selDecorator;
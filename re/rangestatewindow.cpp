@@ -2,10 +2,11 @@
 #include "ui_rangestatewindow.h"
 #include "mainwindow.h"
 #include "utility.h"
+#include "utils/signalextractor.h"
 #include "helpwindow.h"
 #include "filterutility.h"
 
-RangeStateWindow::RangeStateWindow(const QVector<CANFrame> *frames, QWidget *parent) :
+RangeStateWindow::RangeStateWindow(const CANFrameStore *frames, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::RangeStateWindow)
 {
@@ -177,7 +178,7 @@ void RangeStateWindow::refreshFilterList()
 
     for (int i = 0; i < modelFrames->length(); i++)
     {
-        id = modelFrames->at(i).frameId();
+        id = modelFrames->view(i).frameId();
         if (!idFilters.contains(id))
         {
             idFilters.insert(id, true);
@@ -218,7 +219,7 @@ void RangeStateWindow::recalcButton()
             id = iter.key();
             for (int j = 0; j < modelFrames->count(); j++)
             {
-                if (modelFrames->at(j).frameId() == id) frameCache.append(modelFrames->at(j));
+                if (modelFrames->view(j).frameId() == id) frameCache.append(modelFrames->at(j));
             }
             //now we've got a list with all the same ID. Time to send it off for processing
             signalsFactory();
@@ -289,10 +290,11 @@ bool RangeStateWindow::processSignal(int startBit, int bitLength, int sensitivit
     diff2.reserve(frameCache.count() - 2);
 
     int i;
+    SignalExtractor extractor(startBit, bitLength, !bigEndian, isSigned);
 
     for (i = 0; i < numFrames; i++)
     {
-        valu = Utility::processIntegerSignal(frameCache.at(i).payload(), startBit, bitLength, !bigEndian, isSigned);
+        valu = extractor.extract(frameCache.at(i).payload());
         if (valu < lowestValue) lowestValue = valu;
         if (valu > highestValue) highestValue = valu;
     }
@@ -311,7 +313,7 @@ bool RangeStateWindow::processSignal(int startBit, int bitLength, int sensitivit
         return false; //doesn't range enough.
 
     for (i = 0; i < numFrames; i++)
-        scaledVals.append((int)((Utility::processIntegerSignal(frameCache.at(i).payload(), startBit, bitLength, !bigEndian, isSigned) - lowestValue)));
+        scaledVals.append((int)((extractor.extract(frameCache.at(i).payload()) - lowestValue)));
 
     for (i = 1; i < numFrames; i++)
     {
@@ -469,12 +471,13 @@ void RangeStateWindow::clickedSignalList(int idx)
 
     for (int j = 0; j < modelFrames->count(); j++)
     {
-        if (modelFrames->at(j).frameId() == id) frameCache.append(modelFrames->at(j));
+        if (modelFrames->view(j).frameId() == id) frameCache.append(modelFrames->at(j));
     }
 
     int numFrames = frameCache.count();
     QVector<int> values;
     values.reserve(numFrames);
-    for (int i = 0; i < numFrames; i++) values.append((int)((Utility::processIntegerSignal(frameCache.at(i).payload(), startBit, bitLength, !isBigEndian, isSigned))));
+    SignalExtractor extractor(startBit, bitLength, !isBigEndian, isSigned);
+    for (int i = 0; i < numFrames; i++) values.append((int)((extractor.extract(frameCache.at(i).payload()))));
     createGraph(values);
 }
@@ -314,10 +314,11 @@ void SnifferModel::filter(fltType pType, int pId)
 /**********         slots       ****************/
 /***********************************************/
 
-void SnifferModel::update(CANConnection*, QVector<CANFrame>& pFrames)
+void SnifferModel::update(const FrameBatchPtr &pBatch)
 {
-    foreach(const CANFrame& frame, pFrames)
+    for (int i = 0; i < pBatch->count(); i++)
     {
+        const CANFrame frame = pBatch->at(i);
         if(!mMap.contains(frame.frameId()))
         {
             int index = std::distance(mMap.begin(), mMap.lowerBound(frame.frameId()));
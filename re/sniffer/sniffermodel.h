@@ -9,6 +9,7 @@
 #include "can_structs.h"
 #include "connections/canconnection.h"
 #include "snifferitem.h"
+#include "framebatch.h"
 
 
 enum fltType
@@ -51,7 +52,7 @@ public:
 
 
 public slots:
-    void update(CANConnection*, QVector<CANFrame>&);
+    void update(const FrameBatchPtr &pBatch);
     void notch();
     void unNotch();
 
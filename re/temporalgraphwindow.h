@@ -4,6 +4,7 @@
 #include <QDialog>
 #include "qcustomplot.h"
 #include "can_structs.h"
+#include "canframestore.h"
 
 namespace Ui {
 class TemporalGraphWindow;
@@ -19,7 +20,7 @@ class TemporalGraphWindow : public QDialog
     Q_OBJECT
 
 public:
-    explicit TemporalGraphWindow(const QVector<CANFrame> *, QWidget *parent = nullptr);
+    explicit TemporalGraphWindow(const CANFrameStore *, QWidget *parent = nullptr);
     ~TemporalGraphWindow();
     void showEvent(QShowEvent*);
 
@@ -34,7 +35,7 @@ private slots:
 
 private:
     Ui::TemporalGraphWindow *ui;    
-    const QVector<CANFrame> *modelFrames;
+    const CANFrameStore *modelFrames;
     bool useOpenGL;
     bool followGraphEnd;
     QCPGraph *graph;
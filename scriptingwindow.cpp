@@ -11,7 +11,7 @@
 #include "connections/canconmanager.h"
 #include "helpwindow.h"
 
-ScriptingWindow::ScriptingWindow(const QVector<CANFrame> *frames, QWidget *parent) :
+ScriptingWindow::ScriptingWindow(const CANFrameStore *frames, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::ScriptingWindow)
 {
@@ -69,17 +69,16 @@ ScriptingWindow::~ScriptingWindow()
 }
 
 
-void ScriptingWindow::newFrames(const CANConnection* pConn, const QVector<CANFrame>& pFrames)
+void ScriptingWindow::newFrames(const FrameBatchPtr &pBatch)
 {
     /*FIXME: name of the probe and bus should be checked */
-    Q_UNUSED(pConn);
-    Q_UNUSED(pFrames);
+    Q_UNUSED(pBatch);
 
     /*for (int j = 0; j < scripts.length(); j++)
     {
-        foreach(const CANFrame& frame, pFrames)
+        for (int i = 0; i < pBatch->count(); i++)
         {
-            //scripts[j]->gotFrame(frame);
+            //scripts[j]->gotFrame(pBatch->at(i));
         }
     }*/
 }
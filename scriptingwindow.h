@@ -3,6 +3,8 @@
 
 #include "scriptcontainer.h"
 #include "can_structs.h"
+#include "canframestore.h"
+#include "framebatch.h"
 #include "connections/canconnection.h"
 #include "jsedit.h"
 
@@ -20,7 +22,7 @@ class ScriptingWindow : public QDialog
     Q_OBJECT
 
 public:
-    explicit ScriptingWindow(const QVector<CANFrame> *frames, QWidget *parent = 0);
+    explicit ScriptingWindow(const CANFrameStore *frames, QWidget *parent = 0);
     void showEvent(QShowEvent*);
     ~ScriptingWindow();
 
@@ -42,7 +44,7 @@ private slots:
     void reloadScript();
     void recompileScript();
     void changeCurrentScript();
-    void newFrames(const CANConnection*, const QVector<CANFrame>&);
+    void newFrames(const FrameBatchPtr &pBatch);
     void clickedLogClear();
     void valuesTimerElapsed();
     void updatedValue(int row, int col);
@@ -58,7 +60,7 @@ private:
     JSEdit *editor;
     QList<ScriptContainer *> scripts;
     ScriptContainer *currentScript;
-    const QVector<CANFrame> *modelFrames;
+    const CANFrameStore *modelFrames;
     QElapsedTimer elapsedTime;
     QTimer valuesTimer;
 };
@@ -8,7 +8,7 @@
 #define MSG_COL     1
 #define VALUE_COL   2
 
-SignalViewerWindow::SignalViewerWindow(const QVector<CANFrame> *frames, QWidget *parent) :
+SignalViewerWindow::SignalViewerWindow(const CANFrameStore *frames, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::SignalViewerWindow)
 {
@@ -70,10 +70,23 @@ void SignalViewerWindow::updatedFrames(int numFrames)
     }
     else if (numFrames == -2) //all new set of frames. Reset
     {
-        for (int i = 0; i < modelFrames->count(); i++)
+        //only the newest value of each signal is shown so walk backward from the end and stop as soon as
+        //every signal has been found instead of decoding the whole capture
+        QVector<bool> found(signalList.count(), false);
+        int remaining = signalList.count();
+        for (int i = modelFrames->count() - 1; i >= 0 && remaining > 0; i--)
         {
-            thisFrame = modelFrames->at(i);
-            processFrame(thisFrame);
+            CANFrameView view = modelFrames->view(i);
+            for (int s = 0; s < signalList.count(); s++)
+            {
+                DBC_SIGNAL *sig = signalList.at(s);
+                if (found[s] || !sig || sig->parentMessage->ID != view.frameId()) continue;
+                if (!sig->isSignalInPayload(view.data(), view.length())) continue;
+                found[s] = true;
+                remaining--;
+                thisFrame = view.toCANFrame();
+                showSignalValue(s, thisFrame);
+            }
         }
     }
     else //just got some new frames. See if they are relevant.
@@ -90,7 +103,6 @@ void SignalViewerWindow::updatedFrames(int numFrames)
 
 void SignalViewerWindow::processFrame(CANFrame &frame)
 {
-    QString sigString;
     DBC_SIGNAL *sig;
     for (int i = 0; i < signalList.count(); i++)
     {
@@ -100,21 +112,27 @@ void SignalViewerWindow::processFrame(CANFrame &frame)
         {
             if (sig->isSignalInMessage(frame)) //filter out multiplexed signals that aren't in this message.
             {
-                if (sig->processAsText(frame, sigString, false)) //if true we could interpret the signal so update it in the list
-                {
-                    QTableWidgetItem *item = ui->tableViewer->item(i, VALUE_COL);
-                    if (!item)
-                    {
-                        item = new QTableWidgetItem(sigString);
-                        ui->tableViewer->setItem(i, VALUE_COL, item);
-                    }
-                    else item->setText(sigString);
-                }
+                showSignalValue(i, frame);
             }
         }
     }
 }
 
+void SignalViewerWindow::showSignalValue(int row, const CANFrame &frame)
+{
+    QString sigString;
+    if (signalList.at(row)->processAsText(frame, sigString, false)) //if true we could interpret the signal so update it in the list
+    {
+        QTableWidgetItem *item = ui->tableViewer->item(row, VALUE_COL);
+        if (!item)
+        {
+            item = new QTableWidgetItem(sigString);
+            ui->tableViewer->setItem(row, VALUE_COL, item);
+        }
+        else item->setText(sigString);
+    }
+}
+
 void SignalViewerWindow::removeSelectedSignal()
 {
     int selRow = ui->tableViewer->currentRow();
@@ -3,6 +3,7 @@
 
 #include <QDialog>
 #include "dbc/dbchandler.h"
+#include "canframestore.h"
 
 namespace Ui {
 class SignalViewerWindow;
@@ -13,7 +14,7 @@ class SignalViewerWindow : public QDialog
     Q_OBJECT
 
 public:
-    explicit SignalViewerWindow(const QVector<CANFrame> *frames, QWidget *parent = 0);
+    explicit SignalViewerWindow(const CANFrameStore *frames, QWidget *parent = 0);
     ~SignalViewerWindow();
 
 private slots:
@@ -39,9 +40,10 @@ private:
     DBC_MESSAGE *currentlySelectedMsg;
 
     QList<DBC_SIGNAL *> signalList;
-    const QVector<CANFrame> *modelFrames;
+    const CANFrameStore *modelFrames;
 
     void processFrame(CANFrame &frame);
+    void showSignalValue(int row, const CANFrame &frame);
 };
 
 #endif // SIGNALVIEWERWINDOW_H
@@ -2,6 +2,11 @@
 
 #include "tst_lfqueue.h"
 #include "tst_cancon.h"
+#include "tst_signalextractor.h"
+#include "tst_dbcparser.h"
+#include "tst_capturefile.h"
+#include "tst_filesniffer.h"
+#include "tst_continuouslogger.h"
 
 
 int main(int argc, char** argv)
@@ -15,6 +20,11 @@ int main(int argc, char** argv)
    };
 
    ASSERT_TEST(new TestLFQueue());
+   ASSERT_TEST(new TestSignalExtractor());
+   ASSERT_TEST(new TestDBCParser());
+   ASSERT_TEST(new TestCaptureFile());
+   ASSERT_TEST(new TestFileSniffer());
+   ASSERT_TEST(new TestContinuousLogger());
    ASSERT_TEST(new TestCanCon(CANCon::SOCKETCAN, "vcan0", 1));
 
    return status;
@@ -1,19 +1,33 @@
 QT += core gui serialbus widgets testlib serialbus
 
 
-CONFIG += c++11
+CONFIG += c++17
 
 INCLUDEPATH += ../ ../connections
 
+DEFINES += SAVVYCAN_EXAMPLES=\\\"$$PWD/../examples\\\"
+
 SOURCES += \
     tst_lfqueue.cpp \
+    tst_signalextractor.cpp \
+    tst_dbcparser.cpp \
+    tst_capturefile.cpp \
+    tst_filesniffer.cpp \
+    tst_continuouslogger.cpp \
     main.cpp \
     tst_cancon.cpp \
     ../connections/canconfactory.cpp \
     ../connections/canconnection.cpp \
     ../connections/gvretserial.cpp \
     ../connections/socketcan.cpp \
-    ../canbus.cpp
+    ../canbus.cpp \
+    ../dbc/dbclineparser.cpp \
+    ../capturefile.cpp \
+    ../filesniffer.cpp \
+    ../continuouslogger.cpp \
+    ../framebatch.cpp \
+    ../canframestore.cpp \
+    ../utility.cpp
 
 
 #HEADERS += \
@@ -24,10 +38,22 @@ INSTALLS += target
 
 HEADERS += \
     tst_lfqueue.h \
+    tst_signalextractor.h \
+    tst_dbcparser.h \
+    tst_capturefile.h \
+    tst_filesniffer.h \
+    tst_continuouslogger.h \
     tst_cancon.h \
     ../connections/canconconst.h \
     ../connections/canconfactory.h \
     ../connections/canconnection.h \
     ../connections/gvretserial.h \
     ../connections/socketcan.h \
-    ../canbus.h
+    ../canbus.h \
+    ../dbc/dbclineparser.h \
+    ../capturefile.h \
+    ../filesniffer.h \
+    ../continuouslogger.h \
+    ../framebatch.h \
+    ../canframestore.h \
+    ../utility.h
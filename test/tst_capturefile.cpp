@@ -0,0 +1,150 @@
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "capturefile.h"
+#include "tst_capturefile.h"
+
+
+//every kind of frame the format has to keep apart, cycled through so the frames span several blocks
+static CANFrameData makeFrame(int i)
+{
+    CANFrameData frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.timestamp = 1000000000LL + i * 250LL;
+    frame.frameId = static_cast<uint32_t>(0x100 + (i % 37));
+    frame.bus = static_cast<uint8_t>(i % 3);
+    frame.frameType = QCanBusFrame::DataFrame;
+    frame.flags = (i % 2) ? CANFrameData::Received : 0;
+    frame.length = static_cast<uint8_t>(i % 9);
+
+    switch (i % 5)
+    {
+    case 1:
+        frame.flags |= CANFrameData::Extended | CANFrameData::FlexibleData | CANFrameData::BitrateSwitch;
+        frame.frameId |= 0x18000000;
+        frame.length = 64;
+        break;
+    case 2:
+        frame.flags |= CANFrameData::FlexibleData | CANFrameData::ErrorState;
+        frame.length = 12;
+        break;
+    case 3:
+        frame.frameType = QCanBusFrame::RemoteRequestFrame;
+        frame.length = 0;
+        break;
+    case 4:
+        frame.frameType = QCanBusFrame::ErrorFrame;
+        frame.frameId = QCanBusFrame::BusOffError;
+        frame.length = 8;
+        break;
+    }
+    for (int b = 0; b < frame.length; b++) frame.data[b] = static_cast<uint8_t>(i * 7 + b);
+    return frame;
+}
+
+static bool sameFrame(const CANFrameData &a, const CANFrameData &b)
+{
+    return a.timestamp == b.timestamp && a.frameId == b.frameId && a.bus == b.bus && a.length == b.length
+        && a.flags == b.flags && a.frameType == b.frameType && !memcmp(a.data, b.data, a.length);
+}
+
+static const int NUM_FRAMES = CaptureFileWriter::FRAMES_PER_BLOCK * 2 + 1234;
+
+void TestCaptureFile::roundTrip()
+{
+    QTemporaryDir dir;
+    QString path = dir.filePath("roundtrip.sccap");
+
+    CaptureFileWriter writer;
+    QVERIFY(writer.open(path));
+    for (int i = 0; i < NUM_FRAMES; i++) QVERIFY(writer.append(makeFrame(i)));
+    QVERIFY(writer.close());
+
+    CaptureFileReader reader;
+    QVERIFY(reader.open(path));
+    QCOMPARE(reader.frameCount(), static_cast<qint64>(NUM_FRAMES));
+
+    int i = 0;
+    QVector<CANFrameData> frames;
+    for (int b = 0; b < reader.blockCount(); b++)
+    {
+        QVERIFY(reader.readBlock(b, frames));
+        foreach (const CANFrameData &frame, frames)
+        {
+            if (!sameFrame(frame, makeFrame(i))) QFAIL(qPrintable(QString("frame %1 differs").arg(i)));
+            i++;
+        }
+    }
+    QCOMPARE(i, NUM_FRAMES);
+
+    //the trip through CANFrame has to keep the same fields
+    CANFrameData fd = makeFrame(1);
+    QVERIFY(sameFrame(CANFrameData::fromCANFrame(fd.toCANFrame()), fd));
+    CANFrameData err = makeFrame(4);
+    QVERIFY(sameFrame(CANFrameData::fromCANFrame(err.toCANFrame()), err));
+}
+
+void TestCaptureFile::blockIndex()
+{
+    QTemporaryDir dir;
+    QString path = dir.filePath("index.sccap");
+
+    CaptureFileWriter writer;
+    QVERIFY(writer.open(path));
+    for (int i = 0; i < NUM_FRAMES; i++) writer.append(makeFrame(i));
+    QVERIFY(writer.close());
+
+    CaptureFileReader reader;
+    QVERIFY(reader.open(path));
+    QCOMPARE(reader.blockCount(), 3);
+    for (int b = 0; b < reader.blockCount(); b++)
+    {
+        const CaptureBlockInfo &info = reader.block(b);
+        int first = b * CaptureFileWriter::FRAMES_PER_BLOCK;
+        QCOMPARE(info.firstFrame, static_cast<qint64>(first));
+        QCOMPARE(info.firstTimestamp, makeFrame(first).timestamp);
+        QCOMPARE(info.lastTimestamp, makeFrame(first + static_cast<int>(info.frameCount) - 1).timestamp);
+        QVERIFY(info.mayContain(0x100));
+        QVERIFY(info.mayContain(0x100 + 36));
+    }
+    QCOMPARE(reader.block(2).frameCount, 1234u);
+}
+
+void TestCaptureFile::unclosedFile()
+{
+    QTemporaryDir dir;
+    QString path = dir.filePath("live.sccap");
+    QString copyPath = dir.filePath("crashed.sccap");
+
+    //a copy taken while the writer is still open looks like a file left behind by a crash
+    CaptureFileWriter writer;
+    QVERIFY(writer.open(path));
+    for (int i = 0; i < 5000; i++) writer.append(makeFrame(i));
+    QVERIFY(writer.flush());
+    for (int i = 5000; i < 6000; i++) writer.append(makeFrame(i));
+    QVERIFY(writer.flush());
+    QVERIFY(QFile::copy(path, copyPath));
+    writer.close();
+
+    //and a torn write on top of that
+    QFile torn(copyPath);
+    QVERIFY(torn.open(QIODevice::Append));
+    torn.write(QByteArray("\x40\x00\x00\x00\x10\x00\x00\x00garbage", 15));
+    torn.close();
+
+    CaptureFileReader reader;
+    QVERIFY(reader.open(copyPath));
+    QCOMPARE(reader.blockCount(), 2);
+    QCOMPARE(reader.frameCount(), 6000LL);
+    QVector<CANFrameData> frames;
+    QVERIFY(reader.readBlock(1, frames));
+    QVERIFY(sameFrame(frames.last(), makeFrame(5999)));
+}
+
+void TestCaptureFile::notACapture()
+{
+    QString csv = QString(SAVVYCAN_EXAMPLES) + "/../README.md";
+    QVERIFY(!CaptureFileReader::isCaptureFile(csv));
+    CaptureFileReader reader;
+    QVERIFY(!reader.open(csv));
+}
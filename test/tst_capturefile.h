@@ -0,0 +1,18 @@
+#ifndef TST_CAPTUREFILE_H
+#define TST_CAPTUREFILE_H
+
+#include <QObject>
+
+class TestCaptureFile: public QObject
+{
+    Q_OBJECT
+private:
+
+private slots:
+    void roundTrip();
+    void blockIndex();
+    void unclosedFile();
+    void notACapture();
+};
+
+#endif // TST_CAPTUREFILE_H
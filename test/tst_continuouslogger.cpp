@@ -0,0 +1,146 @@
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "continuouslogger.h"
+#include "tst_continuouslogger.h"
+
+
+static CANFrame makeFrame(int i)
+{
+    CANFrame frame;
+    frame.setFrameType(QCanBusFrame::DataFrame);
+    frame.setFrameId(static_cast<uint32_t>((i % 3 == 0) ? 0x18DAF100 + i % 16 : 0x100 + i % 37));
+    frame.setExtendedFrameFormat(i % 3 == 0);
+    QByteArray payload;
+    int len = (i % 7 == 6) ? 12 : i % 9; //some FD frames, only their first 8 bytes go in the log
+    for (int b = 0; b < len; b++) payload.append(static_cast<char>(i * 13 + b));
+    frame.setPayload(payload);
+    if (len > 8) frame.setFlexibleDataRateFormat(true);
+    frame.setTimeStamp(QCanBusFrame::TimeStamp(0, 1000000LL * (i % 5) + i * 321));
+    frame.bus = i % 4;
+    frame.isReceived = (i % 2) == 0;
+    return frame;
+}
+
+static FrameBatchPtr makeBatch(int first, int count)
+{
+    FrameBatch *batch = new FrameBatch(nullptr, 0);
+    for (int i = first; i < first + count; i++) batch->append(makeFrame(i));
+    return FrameBatchPtr(batch);
+}
+
+//how the GUI thread writer used to put a line together, the logger has to match it byte for byte
+static QByteArray oldNativeLine(const CANFrame &frame)
+{
+    QByteArray line;
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(frame.payload().constData());
+    int dataLen = frame.payload().count();
+    line += QString::number(frame.timeStamp().microSeconds()).toUtf8() + ",";
+    line += QString::number(frame.frameId(), 16).toUpper().rightJustified(8, '0').toUtf8() + ",";
+    line += frame.hasExtendedFrameFormat() ? "true," : "false,";
+    line += frame.isReceived ? "Rx," : "Tx,";
+    line += QString::number(frame.bus).toUtf8() + ",";
+    line += QString::number(dataLen).toUtf8() + ",";
+    for (int temp = 0; temp < 8; temp++)
+    {
+        if (temp < dataLen) line += QString::number(data[temp], 16).toUpper().rightJustified(2, '0').toUtf8();
+        else line += "00";
+        line += ",";
+    }
+    line += "\n";
+    return line;
+}
+
+void TestContinuousLogger::nativeLine()
+{
+    FrameBatchPtr batch = makeBatch(0, 200);
+    char buffer[ContinuousLogger::MAX_LINE_BYTES];
+    for (int i = 0; i < batch->count(); i++)
+    {
+        int len = ContinuousLogger::formatNative(batch->view(i), buffer);
+        QVERIFY(len <= ContinuousLogger::MAX_LINE_BYTES);
+        QCOMPARE(QByteArray(buffer, len), oldNativeLine(makeFrame(i)));
+    }
+}
+
+void TestContinuousLogger::csvLog()
+{
+    QTemporaryDir dir;
+    QString path = dir.filePath("continuous.csv");
+
+    ContinuousLogger logger;
+    QVERIFY(logger.start(path, ContinuousLogger::NativeCSV));
+    QVERIFY(logger.isRunning());
+    for (int b = 0; b < 10; b++) logger.enqueue(makeBatch(b * 100, 100));
+    logger.stop();
+    QVERIFY(!logger.isRunning());
+    QVERIFY(!logger.hasFailed());
+    QCOMPARE(logger.framesWritten(), 1000LL);
+    QCOMPARE(logger.framesDropped(), 0LL);
+    QCOMPARE(logger.backlog(), 0);
+
+    QByteArray expected("Time Stamp,ID,Extended,Dir,Bus,LEN,D1,D2,D3,D4,D5,D6,D7,D8\n");
+    for (int i = 0; i < 1000; i++) expected += oldNativeLine(makeFrame(i));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    QCOMPARE(file.readAll(), expected);
+
+    //batches that come in after stopping are ignored
+    logger.enqueue(makeBatch(0, 10));
+    QCOMPARE(logger.backlog(), 0);
+}
+
+void TestContinuousLogger::rotateBySize()
+{
+    QTemporaryDir dir;
+    QString path = dir.filePath("rotated.csv");
+
+    ContinuousLogger logger;
+    QVERIFY(logger.start(path, ContinuousLogger::NativeCSV, 4096));
+    for (int b = 0; b < 20; b++) logger.enqueue(makeBatch(b * 50, 50));
+    logger.stop();
+    QVERIFY(logger.filesStarted() > 1);
+    QCOMPARE(ContinuousLogger::rotatedName(path, 0), path);
+    QCOMPARE(ContinuousLogger::rotatedName(path, 2), dir.filePath("rotated_002.csv"));
+
+    //every file starts with the header and together they have every frame exactly once, in order
+    QByteArray all;
+    for (int n = 0; n < logger.filesStarted(); n++)
+    {
+        QFile file(ContinuousLogger::rotatedName(path, n));
+        QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+        QByteArray contents = file.readAll();
+        QVERIFY(contents.startsWith("Time Stamp,ID"));
+        all += contents.mid(contents.indexOf('\n') + 1);
+    }
+    QByteArray expected;
+    for (int i = 0; i < 1000; i++) expected += oldNativeLine(makeFrame(i));
+    QCOMPARE(all, expected);
+}
+
+void TestContinuousLogger::captureLog()
+{
+    QTemporaryDir dir;
+    QString path = dir.filePath("continuous.sccap");
+
+    ContinuousLogger logger;
+    QVERIFY(logger.start(path, ContinuousLogger::Capture));
+    for (int b = 0; b < 10; b++) logger.enqueue(makeBatch(b * 100, 100));
+    logger.stop();
+    QVERIFY(!logger.hasFailed());
+    QCOMPARE(logger.bytesWritten(), QFileInfo(path).size());
+
+    CaptureFileReader reader;
+    QVERIFY(reader.open(path));
+    QCOMPARE(reader.frameCount(), 1000LL);
+    QVector<CANFrameData> frames;
+    QVERIFY(reader.readBlock(0, frames));
+    for (int i = 0; i < frames.count(); i++)
+    {
+        CANFrame frame = makeFrame(i);
+        QCOMPARE(frames[i].frameId, frame.frameId());
+        QCOMPARE(frames[i].timestamp, static_cast<int64_t>(frame.timeStamp().microSeconds()));
+        QCOMPARE(static_cast<int>(frames[i].length), frame.payload().count());
+        QVERIFY(!memcmp(frames[i].data, frame.payload().constData(), frames[i].length));
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef TST_CONTINUOUSLOGGER_H
+#define TST_CONTINUOUSLOGGER_H
+
+#include <QObject>
+
+class TestContinuousLogger: public QObject
+{
+    Q_OBJECT
+private:
+
+private slots:
+    void nativeLine();
+    void csvLog();
+    void rotateBySize();
+    void captureLog();
+};
+
+#endif // TST_CONTINUOUSLOGGER_H
@@ -0,0 +1,271 @@
+#include <QtTest>
+#include <QRegularExpression>
+
+#include "dbc/dbclineparser.h"
+#include "tst_dbcparser.h"
+
+
+//the expressions DBCFile used before DBCLineParser, tried in the same order it tried them
+static bool regexParseSignal(const QString &line, DBCSignalLine &out)
+{
+    static const QString tail = " *: *(\\d+)\\|(\\d+)@(\\d+)([\\+|\\-]) \\(([0-9.+\\-eE]+),([0-9.+\\-eE]+)\\) \\[([0-9.+\\-eE]+)\\|([0-9.+\\-eE]+)\\] \\\"(.*)\\\" (.*)";
+    static const QRegularExpression multiplexor("^SG\\_ *([-\\w]+) +M" + tail);
+    static const QRegularExpression multiplexed("^SG\\_ *([-\\w]+) +m(\\d+)" + tail);
+    static const QRegularExpression extended("^SG\\_ *([-\\w]+) +m(\\d+)M" + tail);
+    static const QRegularExpression plain("^SG\\_ *([-\\w]+)" + tail);
+
+    int offset = 1;
+    out.isMultiplexor = false;
+    out.isMultiplexed = false;
+    out.multiplexValue = 0;
+    QRegularExpressionMatch match = multiplexor.match(line);
+    if (match.hasMatch())
+    {
+        out.isMultiplexor = true;
+        offset = 0;
+    }
+    else if ((match = multiplexed.match(line)).hasMatch()) out.isMultiplexed = true;
+    else if ((match = extended.match(line)).hasMatch())
+    {
+        out.isMultiplexed = true;
+        out.isMultiplexor = true;
+    }
+    else
+    {
+        match = plain.match(line);
+        offset = 0;
+    }
+    if (!match.hasMatch()) return false;
+
+    if (offset) out.multiplexValue = match.captured(2).toInt();
+    out.name = match.captured(1);
+    out.startBit = match.captured(2 + offset).toInt();
+    out.signalSize = match.captured(3 + offset).toInt();
+    out.valueType = match.captured(4 + offset).toInt();
+    out.isSigned = (match.captured(5 + offset) != "+");
+    out.factor = match.captured(6 + offset).toDouble();
+    out.bias = match.captured(7 + offset).toDouble();
+    out.min = match.captured(8 + offset).toDouble();
+    out.max = match.captured(9 + offset).toDouble();
+    out.unitName = match.captured(10 + offset);
+    out.receivers = match.captured(11 + offset);
+    return true;
+}
+
+static bool regexParseMessage(const QString &line, DBCMessageLine &out)
+{
+    static const QRegularExpression regex("^BO\\_ (\\w+) ([-\\w]+) *: (\\w+) ([-\\w]+)");
+    QRegularExpressionMatch match = regex.match(line);
+    if (!match.hasMatch()) return false;
+    out.rawID = match.captured(1).toULong();
+    out.name = match.captured(2);
+    out.len = match.captured(3).toUInt();
+    out.sender = match.captured(4);
+    return true;
+}
+
+static bool sameSignal(const DBCSignalLine &a, const DBCSignalLine &b)
+{
+    return a.name == b.name && a.isMultiplexor == b.isMultiplexor && a.isMultiplexed == b.isMultiplexed
+        && a.multiplexValue == b.multiplexValue && a.startBit == b.startBit && a.signalSize == b.signalSize
+        && a.valueType == b.valueType && a.isSigned == b.isSigned && a.factor == b.factor && a.bias == b.bias
+        && a.min == b.min && a.max == b.max && a.unitName == b.unitName && a.receivers == b.receivers;
+}
+
+//every line of a file the way DBCFile::loadFile sees them
+static QStringList readLines(const QString &fileName)
+{
+    QStringList lines;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return lines;
+    while (!file.atEnd()) lines.append(QString(file.readLine()).simplified());
+    return lines;
+}
+
+//same layout DBCFile::saveFile writes a signal in
+static QString formatSignal(const DBCSignalLine &sig)
+{
+    QString line = "SG_ " + sig.name;
+    if (sig.isMultiplexed) line += " m" + QString::number(sig.multiplexValue);
+    if (sig.isMultiplexor)
+    {
+        if (!sig.isMultiplexed) line += " ";
+        line += "M";
+    }
+    line += " : " + QString::number(sig.startBit) + "|" + QString::number(sig.signalSize) + "@";
+    line += QString::number(sig.valueType) + (sig.isSigned ? "-" : "+");
+    line += " (" + QString::number(sig.factor, 'g', 17) + "," + QString::number(sig.bias, 'g', 17) + ")";
+    line += " [" + QString::number(sig.min, 'g', 17) + "|" + QString::number(sig.max, 'g', 17) + "]";
+    line += " \"" + sig.unitName + "\" " + sig.receivers;
+    return line;
+}
+
+
+void TestDBCParser::examples_data()
+{
+    QTest::addColumn<QString>("fileName");
+
+    QDir dir(SAVVYCAN_EXAMPLES);
+    foreach (QString name, dir.entryList(QStringList("*.dbc"), QDir::Files))
+    {
+        QTest::newRow(qPrintable(name)) << dir.filePath(name);
+    }
+}
+
+
+/* every BO_ and SG_ line in the example files has to come out exactly as the old expressions had it */
+void TestDBCParser::examples()
+{
+    QFETCH(QString, fileName);
+
+    int numSignals = 0;
+    foreach (QString line, readLines(fileName))
+    {
+        if (line.startsWith("SG_ "))
+        {
+            DBCSignalLine expected, actual;
+            bool expectedOk = regexParseSignal(line, expected);
+            QCOMPARE(DBCLineParser::parseSignal(line, actual), expectedOk);
+            if (expectedOk)
+            {
+                QVERIFY2(sameSignal(actual, expected), qPrintable(line));
+                numSignals++;
+            }
+        }
+        else if (line.startsWith("BO_ "))
+        {
+            DBCMessageLine expected, actual;
+            bool expectedOk = regexParseMessage(line, expected);
+            QCOMPARE(DBCLineParser::parseMessage(line, actual), expectedOk);
+            if (expectedOk)
+            {
+                QCOMPARE(actual.rawID, expected.rawID);
+                QCOMPARE(actual.name, expected.name);
+                QCOMPARE(actual.len, expected.len);
+                QCOMPARE(actual.sender, expected.sender);
+            }
+        }
+    }
+    QVERIFY(numSignals > 0);
+}
+
+
+void TestDBCParser::edgeCases_data()
+{
+    QTest::addColumn<QString>("line");
+
+    QTest::newRow("plain")            << "SG_ Speed : 0|16@1+ (0.01,0) [0|655.35] \"km/h\" Vector__XXX";
+    QTest::newRow("no space colon")   << "SG_ Speed: 0|16@1+ (0.01,0) [0|655.35] \"km/h\" Vector__XXX";
+    QTest::newRow("multiplexor")      << "SG_ Mode M : 0|8@1+ (1,0) [0|255] \"\" ECU";
+    QTest::newRow("multiplexed")      << "SG_ Temp m3 : 8|8@0- (0.5,-40) [-40|87.5] \"degC\" ECU,BMS";
+    QTest::newRow("extended")         << "SG_ Sub m12M : 8|4@1+ (1,0) [0|15] \"\" ECU";
+    QTest::newRow("named M")          << "SG_ M : 0|8@1+ (1,0) [0|255] \"\" ECU";
+    QTest::newRow("name ends in M")   << "SG_ ModeM : 0|8@1+ (1,0) [0|255] \"\" ECU";
+    QTest::newRow("space before M")   << "SG_ Sub m1 M : 8|4@1+ (1,0) [0|15] \"\" ECU";
+    QTest::newRow("m without value")  << "SG_ Sub m : 8|4@1+ (1,0) [0|15] \"\" ECU";
+    QTest::newRow("pipe sign")        << "SG_ Odd : 8|4@1| (1,0) [0|15] \"\" ECU";
+    QTest::newRow("float exponent")   << "SG_ F : 0|32@1- (1E-3,+2.5e2) [-1e9|1e9] \"\" ECU";
+    QTest::newRow("quote in unit")    << "SG_ Q : 0|8@1+ (1,0) [0|1] \"a\" b\" ECU";
+    QTest::newRow("no receiver")      << "SG_ R : 0|8@1+ (1,0) [0|1] \"\" ";
+    QTest::newRow("unit not closed")  << "SG_ R : 0|8@1+ (1,0) [0|1] \"abc";
+    QTest::newRow("no space at @")    << "SG_ R : 0|8@1+(1,0) [0|1] \"\" ECU";
+    QTest::newRow("unicode name")     << QString::fromUtf8("SG_ Drehzahl_\xc3\xbc : 0|8@1+ (1,0) [0|1] \"\" ECU");
+    QTest::newRow("message")          << "BO_ 2566844926 Status_Frame: 8 BMS";
+    QTest::newRow("message spaced")   << "BO_ 100 Status : 8 BMS";
+    QTest::newRow("message hex id")   << "BO_ 0x100 Status: 8 BMS";
+    QTest::newRow("message no node")  << "BO_ 100 Status: 8";
+}
+
+
+void TestDBCParser::edgeCases()
+{
+    QFETCH(QString, line);
+
+    DBCSignalLine expected, actual;
+    bool expectedOk = regexParseSignal(line, expected);
+    QCOMPARE(DBCLineParser::parseSignal(line, actual), expectedOk);
+    if (expectedOk) QVERIFY(sameSignal(actual, expected));
+
+    DBCMessageLine expectedMsg, actualMsg;
+    expectedOk = regexParseMessage(line, expectedMsg);
+    QCOMPARE(DBCLineParser::parseMessage(line, actualMsg), expectedOk);
+    if (expectedOk)
+    {
+        QCOMPARE(actualMsg.rawID, expectedMsg.rawID);
+        QCOMPARE(actualMsg.name, expectedMsg.name);
+        QCOMPARE(actualMsg.len, expectedMsg.len);
+        QCOMPARE(actualMsg.sender, expectedMsg.sender);
+    }
+}
+
+
+/* signals written back out the way saveFile does it have to parse to the same thing again */
+void TestDBCParser::roundTrip()
+{
+    QDir dir(SAVVYCAN_EXAMPLES);
+    int numSignals = 0;
+    foreach (QString name, dir.entryList(QStringList("*.dbc"), QDir::Files))
+    {
+        foreach (QString line, readLines(dir.filePath(name)))
+        {
+            DBCSignalLine first, second;
+            if (!line.startsWith("SG_ ") || !DBCLineParser::parseSignal(line, first)) continue;
+            QString written = formatSignal(first);
+            QVERIFY2(DBCLineParser::parseSignal(written, second), qPrintable(written));
+            QVERIFY2(sameSignal(first, second), qPrintable(written));
+            numSignals++;
+        }
+    }
+    QVERIFY(numSignals > 0);
+}
+
+
+void TestDBCParser::parseSpeed_data()
+{
+    QTest::addColumn<bool>("scanner");
+
+    QTest::newRow("QRegularExpression per line") << false;
+    QTest::newRow("DBCLineParser")              << true;
+}
+
+
+/* the signal lines of the biggest example. The regex side compiles its expressions for every line like
+ * the loader used to */
+void TestDBCParser::parseSpeed()
+{
+    QFETCH(bool, scanner);
+
+    QStringList lines;
+    foreach (QString line, readLines(QDir(SAVVYCAN_EXAMPLES).filePath("ThinkCity.dbc")))
+    {
+        if (line.startsWith("SG_ ")) lines.append(line);
+    }
+    QVERIFY(!lines.isEmpty());
+
+    const QString tail = " *: *(\\d+)\\|(\\d+)@(\\d+)([\\+|\\-]) \\(([0-9.+\\-eE]+),([0-9.+\\-eE]+)\\) \\[([0-9.+\\-eE]+)\\|([0-9.+\\-eE]+)\\] \\\"(.*)\\\" (.*)";
+    int parsed = 0;
+    QBENCHMARK {
+        parsed = 0;
+        foreach (const QString &line, lines)
+        {
+            if (scanner)
+            {
+                DBCSignalLine sig;
+                if (DBCLineParser::parseSignal(line, sig)) parsed++;
+            }
+            else
+            {
+                QRegularExpression regex;
+                regex.setPattern("^SG\\_ *([-\\w]+) +M" + tail);
+                if (regex.match(line).hasMatch()) { parsed++; continue; }
+                regex.setPattern("^SG\\_ *([-\\w]+) +m(\\d+)" + tail);
+                if (regex.match(line).hasMatch()) { parsed++; continue; }
+                regex.setPattern("^SG\\_ *([-\\w]+) +m(\\d+)M" + tail);
+                if (regex.match(line).hasMatch()) { parsed++; continue; }
+                regex.setPattern("^SG\\_ *([-\\w]+)" + tail);
+                if (regex.match(line).hasMatch()) parsed++;
+            }
+        }
+    }
+    QCOMPARE(parsed, lines.count());
+}
@@ -0,0 +1,21 @@
+#ifndef TST_DBCPARSER_H
+#define TST_DBCPARSER_H
+
+#include <QObject>
+
+class TestDBCParser: public QObject
+{
+    Q_OBJECT
+private:
+
+private slots:
+    void examples_data();
+    void examples();
+    void edgeCases_data();
+    void edgeCases();
+    void roundTrip();
+    void parseSpeed_data();
+    void parseSpeed();
+};
+
+#endif // TST_DBCPARSER_H
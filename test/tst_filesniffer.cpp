@@ -0,0 +1,111 @@
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include "filesniffer.h"
+#include "tst_filesniffer.h"
+
+Q_DECLARE_METATYPE(FileSniffer::Format)
+
+static QByteArray readAll(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+    return file.readAll();
+}
+
+static QString describe(const QVector<FileSniffer::Match> &matches)
+{
+    QStringList names;
+    foreach (const FileSniffer::Match &match, matches)
+    {
+        names.append(FileSniffer::formatName(match.format) + "/" + FileSniffer::confidenceName(match.confidence));
+    }
+    return names.join(", ");
+}
+
+
+void TestFileSniffer::examples_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<FileSniffer::Format>("format");
+
+    QDir dir(SAVVYCAN_EXAMPLES);
+    QTest::newRow("BusMaster") << dir.filePath("BusMasterLog.log") << FileSniffer::BUSMASTER;
+    QTest::newRow("CRTD") << dir.filePath("CRTD_Log.txt") << FileSniffer::CRTD;
+    QTest::newRow("CARBUS") << dir.filePath("CarBusAnalyzer.trc") << FileSniffer::CARBUS;
+    QTest::newRow("GVRET") << dir.filePath("GVRET_Log.csv") << FileSniffer::NATIVE_CSV;
+    QTest::newRow("generic CSV") << dir.filePath("GenericID_Log.csv") << FileSniffer::GENERIC_CSV;
+    QTest::newRow("Microchip") << dir.filePath("MicrochipLog.log") << FileSniffer::MICROCHIP;
+    QTest::newRow("candump") << dir.filePath("candump.log") << FileSniffer::CANDUMP;
+}
+
+/* the best guess for every example log is its own format, from the file and from a buffer alike */
+void TestFileSniffer::examples()
+{
+    QFETCH(QString, fileName);
+    QFETCH(FileSniffer::Format, format);
+
+    QVector<FileSniffer::Match> matches = FileSniffer::sniff(fileName);
+    QVERIFY2(!matches.isEmpty(), qPrintable(fileName));
+    QVERIFY2(matches.first().format == format, qPrintable(describe(matches)));
+
+    QByteArray contents = readAll(fileName);
+    QVector<FileSniffer::Match> fromBuffer = FileSniffer::sniff(contents.left(FileSniffer::HEAD_BYTES),
+                                                                contents.size() <= FileSniffer::HEAD_BYTES,
+                                                                QFileInfo(fileName).suffix());
+    QCOMPARE(describe(fromBuffer), describe(matches));
+}
+
+void TestFileSniffer::notLogs_data()
+{
+    QTest::addColumn<QString>("fileName");
+
+    QDir dir(SAVVYCAN_EXAMPLES);
+    foreach (QString name, dir.entryList(QStringList() << "*.dbc" << "*.js", QDir::Files))
+    {
+        QTest::newRow(qPrintable(name)) << dir.filePath(name);
+    }
+}
+
+/* DBC files and scripts sit next to the logs, nothing should be sure they're a log */
+void TestFileSniffer::notLogs()
+{
+    QFETCH(QString, fileName);
+
+    foreach (const FileSniffer::Match &match, FileSniffer::sniff(fileName))
+    {
+        QVERIFY2(match.confidence == FileSniffer::Low, qPrintable(describe(FileSniffer::sniff(fileName))));
+    }
+}
+
+void TestFileSniffer::binarySignatures()
+{
+    QByteArray capture("SCCAPT\0\0\1\0\0\0\0\0\0\0", 16);
+    QCOMPARE(FileSniffer::sniff(capture, true).first().format, FileSniffer::CAPTURE);
+    QCOMPARE(FileSniffer::sniff(capture, true).first().confidence, FileSniffer::High);
+
+    QByteArray pcap(24, '\0');
+    uint32_t magic = 0xA1B2C3D4;
+    memcpy(pcap.data(), &magic, sizeof(magic));
+    QCOMPARE(FileSniffer::sniff(pcap, true).first().format, FileSniffer::WIRESHARK);
+
+    QByteArray canServer("CANSERVER_v2_CANSERVER");
+    QCOMPARE(FileSniffer::sniff(canServer, true).first().format, FileSniffer::CANSERVER);
+
+    QVERIFY(FileSniffer::sniff(QByteArray(), true).isEmpty());
+}
+
+/* only the start of a big file is looked at, a line cut off at the end of it mustn't spoil the guess */
+void TestFileSniffer::partialHead()
+{
+    QByteArray contents = readAll(QDir(SAVVYCAN_EXAMPLES).filePath("candump.log"));
+    QVERIFY(contents.size() > 100);
+    QByteArray head = contents.left(contents.indexOf('\n', 50) + 10);
+
+    QVector<FileSniffer::Match> matches = FileSniffer::sniff(head, false, "log");
+    QVERIFY(!matches.isEmpty());
+    QCOMPARE(matches.first().format, FileSniffer::CANDUMP);
+}
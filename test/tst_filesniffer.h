@@ -0,0 +1,20 @@
+#ifndef TST_FILESNIFFER_H
+#define TST_FILESNIFFER_H
+
+#include <QObject>
+
+class TestFileSniffer: public QObject
+{
+    Q_OBJECT
+private:
+
+private slots:
+    void examples_data();
+    void examples();
+    void notLogs_data();
+    void notLogs();
+    void binarySignatures();
+    void partialHead();
+};
+
+#endif // TST_FILESNIFFER_H
@@ -83,3 +83,176 @@ void TestLFQueue::exchange()
 
     thread.waitForFinished();
 }
+
+
+void TestLFQueue::count()
+{
+    LFQueue<int> queue;
+    QCOMPARE(queue.setSize(3), true);
+    QCOMPARE(queue.capacity(), 4);
+    QCOMPARE(queue.count(), 0);
+
+    for(int i=0; i<4 ; i++) {
+        QVERIFY(queue.get());
+        queue.queue();
+        QCOMPARE(queue.count(), i+1);
+    }
+    QVERIFY(!queue.get());
+
+    /* wrap around */
+    queue.dequeue();
+    queue.dequeue();
+    QVERIFY(queue.get());
+    queue.queue();
+    QCOMPARE(queue.count(), 3);
+}
+
+
+void TestLFQueue::bulk()
+{
+    LFQueue<int> queue;
+    QCOMPARE(queue.setSize(8), true);
+
+    /* runs stop at the end of the buffer */
+    int num = 6;
+    int* val_p = queue.reserve(num);
+    QVERIFY(val_p);
+    QCOMPARE(num, 6);
+    for(int i=0; i<num ; i++)
+        val_p[i] = i;
+    queue.commit(num);
+
+    num = 4;
+    val_p = queue.peekBulk(num);
+    QVERIFY(val_p);
+    QCOMPARE(num, 4);
+    QCOMPARE(val_p[3], 3);
+    queue.release(num);
+
+    num = 100;
+    val_p = queue.reserve(num);
+    QCOMPARE(num, 2);
+    val_p[0] = 6;
+    val_p[1] = 7;
+    queue.commit(num);
+
+    num = 100;
+    val_p = queue.reserve(num);
+    QCOMPARE(num, 4);
+    for(int i=0; i<num ; i++)
+        val_p[i] = 8 + i;
+    queue.commit(num);
+
+    num = 100;
+    QVERIFY(!queue.reserve(num));
+    QCOMPARE(num, 0);
+
+    /* read back everything across the wrap */
+    int expected = 4;
+    while((val_p = queue.peekBulk(num = 100))) {
+        for(int i=0; i<num ; i++)
+            QCOMPARE(val_p[i], expected++);
+        queue.release(num);
+    }
+    QCOMPARE(expected, 12);
+    QCOMPARE(queue.count(), 0);
+}
+
+
+static void bulkReaderThread(LFQueue<quint32>* pQueue_p, quint32 pCount, bool* pOk_p)
+{
+    quint32 expected = 0;
+    int num;
+    *pOk_p = true;
+
+    while(expected < pCount) {
+        num = 1 << 20;
+        quint32* val_p = pQueue_p->peekBulk(num);
+        if(!val_p) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        for(int i=0; i<num ; i++) {
+            if(val_p[i] != expected++)
+                *pOk_p = false;
+        }
+        pQueue_p->release(num);
+    }
+}
+
+
+static void bulkWriter(LFQueue<quint32>& pQueue, quint32 pCount, int pRun)
+{
+    quint32 next = 0;
+    int num;
+
+    while(next < pCount) {
+        num = pRun;
+        quint32* val_p = pQueue.reserve(num);
+        if(!val_p) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        int filled = 0;
+        while(filled < num && next < pCount)
+            val_p[filled++] = next++;
+        pQueue.commit(filled);
+    }
+}
+
+
+void TestLFQueue::stress_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("run");
+
+    QTest::newRow("small queue, single")    << 16      << 1;
+    QTest::newRow("gvret size, runs")       << 4000    << 200;
+    QTest::newRow("big queue, big runs")    << 65536   << 4096;
+}
+
+
+void TestLFQueue::stress()
+{
+    QFETCH(int, size);
+    QFETCH(int, run);
+    const quint32 count = 4000000;
+
+    LFQueue<quint32> queue;
+    QCOMPARE(queue.setSize(size), true);
+
+    bool ok = false;
+    QFuture<void> thread = QtConcurrent::run(bulkReaderThread, &queue, count, &ok);
+    bulkWriter(queue, count, run);
+    thread.waitForFinished();
+
+    QVERIFY(ok);
+    QCOMPARE(queue.count(), 0);
+}
+
+
+void TestLFQueue::throughput_data()
+{
+    QTest::addColumn<int>("run");
+
+    QTest::newRow("get/queue")  << 1;
+    QTest::newRow("runs of 200") << 200;
+}
+
+
+void TestLFQueue::throughput()
+{
+    QFETCH(int, run);
+    const quint32 count = 1000000;
+
+    LFQueue<quint32> queue;
+    QCOMPARE(queue.setSize(4096), true);
+
+    QBENCHMARK {
+        bool ok = false;
+        QFuture<void> thread = QtConcurrent::run(bulkReaderThread, &queue, count, &ok);
+        bulkWriter(queue, count, run);
+        thread.waitForFinished();
+        QVERIFY(ok);
+    }
+}
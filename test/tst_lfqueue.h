@@ -13,6 +13,12 @@ private slots:
     void setSize();
     void exchange_data();
     void exchange();
+    void count();
+    void bulk();
+    void stress_data();
+    void stress();
+    void throughput_data();
+    void throughput();
 };
 
 #endif // TST_LFQUEUE_H
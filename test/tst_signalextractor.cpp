@@ -0,0 +1,111 @@
+#include <QtTest>
+
+#include "utility.h"
+#include "utils/signalextractor.h"
+#include "tst_signalextractor.h"
+
+
+static QByteArray makePayload(int len, bool allOnes, unsigned int seed)
+{
+    QByteArray data(len, 0);
+    for (int i = 0; i < len; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[i] = allOnes ? char(0xFF) : char(seed >> 16);
+    }
+    return data;
+}
+
+
+void TestSignalExtractor::golden_data()
+{
+    QTest::addColumn<int>("length");
+    QTest::addColumn<bool>("allOnes");
+
+    //classic CAN, every CAN-FD size and a couple that don't exist on the bus but can come out of a file
+    const int lengths[] = {0, 1, 3, 7, 8, 9, 12, 16, 20, 24, 32, 48, 63, 64};
+    for (int len : lengths)
+    {
+        QTest::newRow(qPrintable(QString("%1 random").arg(len))) << len << false;
+        QTest::newRow(qPrintable(QString("%1 ones").arg(len))) << len << true;
+    }
+}
+
+
+/* every start bit, size and byte order against processIntegerSignal. Start bits run a little past
+ * the end of a 64 byte frame to cover signals that only partly fit */
+void TestSignalExtractor::golden()
+{
+    QFETCH(int, length);
+    QFETCH(bool, allOnes);
+
+    QByteArray data = makePayload(length, allOnes, length + 1);
+
+    for (int startBit = 0; startBit < 520; startBit++)
+    {
+        for (int sigSize = 1; sigSize <= 64; sigSize++)
+        {
+            for (int order = 0; order < 2; order++)
+            {
+                for (int sign = 0; sign < 2; sign++)
+                {
+                    if (sign && sigSize == 64) continue; //see signed64
+                    int64_t expected = Utility::processIntegerSignal(data, startBit, sigSize, order, sign);
+                    SignalExtractor extractor(startBit, sigSize, order, sign);
+                    int64_t actual = extractor.extract(data);
+                    if (actual != expected)
+                    {
+                        QFAIL(qPrintable(QString("start %1 size %2 intel %3 signed %4: got %5 expected %6")
+                                         .arg(startBit).arg(sigSize).arg(order).arg(sign).arg(actual).arg(expected)));
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/* processIntegerSignal can't sign extend a full 64 bit signal so it's checked against the raw bits */
+void TestSignalExtractor::signed64()
+{
+    QByteArray data = makePayload(16, false, 7);
+    data[0] = char(0x80);
+    data[15] = char(0x80);
+
+    for (int startBit = 0; startBit < 64; startBit++)
+    {
+        SignalExtractor intel(startBit, 64, true, true);
+        QCOMPARE(intel.extract(data), Utility::processIntegerSignal(data, startBit, 64, true, false));
+        SignalExtractor motorola(startBit, 64, false, true);
+        QCOMPARE(motorola.extract(data), Utility::processIntegerSignal(data, startBit, 64, false, false));
+    }
+}
+
+
+void TestSignalExtractor::throughput_data()
+{
+    QTest::addColumn<bool>("compiled");
+
+    QTest::newRow("processIntegerSignal") << false;
+    QTest::newRow("SignalExtractor")      << true;
+}
+
+
+void TestSignalExtractor::throughput()
+{
+    QFETCH(bool, compiled);
+
+    QVector<QByteArray> frames;
+    for (int i = 0; i < 10000; i++) frames.append(makePayload(8, false, i));
+    SignalExtractor extractor(12, 20, false, true);
+    int64_t sum = 0;
+
+    QBENCHMARK {
+        for (const QByteArray &frame : frames)
+        {
+            if (compiled) sum += extractor.extract(frame);
+            else sum += Utility::processIntegerSignal(frame, 12, 20, false, true);
+        }
+    }
+    QVERIFY(sum != 1); //keep the loop from being optimized away
+}
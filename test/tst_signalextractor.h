@@ -0,0 +1,19 @@
+#ifndef TST_SIGNALEXTRACTOR_H
+#define TST_SIGNALEXTRACTOR_H
+
+#include <QObject>
+
+class TestSignalExtractor: public QObject
+{
+    Q_OBJECT
+private:
+
+private slots:
+    void golden_data();
+    void golden();
+    void signed64();
+    void throughput_data();
+    void throughput();
+};
+
+#endif // TST_SIGNALEXTRACTOR_H
@@ -0,0 +1,482 @@
+#include "textlogloader.h"
+#include "capturefile.h"
+
+#include <QApplication>
+#include <QAtomicInt>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QProgressDialog>
+#include <QThread>
+#include <charconv>
+#include <limits>
+#include <string.h>
+
+static const qint64 MIN_CHUNK_BYTES = 1024 * 1024;
+static const int CANCEL_CHECK_LINES = 4096;
+static const int PROGRESS_STEPS = 1000;
+static const int CONVERT_WINDOW = 2; //chunks per thread parsed before they are written out
+
+namespace TextLog
+{
+
+bool Tokens::equals(int idx, const char *str) const
+{
+    int len = static_cast<int>(strlen(str));
+    return idx < count && length[idx] == len && !memcmp(begin[idx], str, len);
+}
+
+bool Tokens::startsWith(int idx, const char *str) const
+{
+    if (idx >= count) return false;
+    int len = static_cast<int>(strlen(str));
+    if (length[idx] < len) return false;
+    for (int i = 0; i < len; i++)
+    {
+        char a = begin[idx][i], b = str[i];
+        if (a >= 'a' && a <= 'z') a -= 'a' - 'A';
+        if (b >= 'a' && b <= 'z') b -= 'a' - 'A';
+        if (a != b) return false;
+    }
+    return true;
+}
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+void split(const char *begin, const char *end, char sep, Tokens &out)
+{
+    out.count = 0;
+    const char *p = begin;
+    if (sep == ' ')
+    {
+        while (p < end && out.count < MAX_TOKENS)
+        {
+            while (p < end && isSpace(*p)) p++;
+            if (p == end) break;
+            const char *tokStart = p;
+            while (p < end && !isSpace(*p)) p++;
+            out.begin[out.count] = tokStart;
+            out.length[out.count] = static_cast<int>(p - tokStart);
+            out.count++;
+        }
+        return;
+    }
+
+    while (p <= end && out.count < MAX_TOKENS)
+    {
+        const char *tokEnd = static_cast<const char *>(memchr(p, sep, end - p));
+        if (!tokEnd) tokEnd = end;
+        const char *a = p, *b = tokEnd;
+        while (a < b && isSpace(*a)) a++;
+        while (b > a && isSpace(b[-1])) b--;
+        out.begin[out.count] = a;
+        out.length[out.count] = static_cast<int>(b - a);
+        out.count++;
+        p = tokEnd + 1;
+    }
+}
+
+bool parseHex(const char *str, int len, uint32_t &out)
+{
+    if (len <= 0 || len > 8) return false;
+    uint32_t val = 0;
+    for (int i = 0; i < len; i++)
+    {
+        int digit = hexDigit(str[i]);
+        if (digit < 0) return false;
+        val = (val << 4) | static_cast<uint32_t>(digit);
+    }
+    out = val;
+    return true;
+}
+
+bool parseInt(const char *str, int len, int64_t &out)
+{
+    if (len > 0 && str[0] == '+')
+    {
+        str++;
+        len--;
+    }
+    std::from_chars_result res = std::from_chars(str, str + len, out);
+    return len > 0 && res.ec == std::errc() && res.ptr == str + len;
+}
+
+bool parseSeconds(const char *str, int len, int64_t &micros)
+{
+    const char *end = str + len;
+    const char *dot = static_cast<const char *>(memchr(str, '.', len));
+    int64_t secs = 0;
+    if (!parseInt(str, static_cast<int>((dot ? dot : end) - str), secs) || secs < 0) return false;
+
+    int64_t frac = 0;
+    int digits = 0;
+    if (dot)
+    {
+        for (const char *p = dot + 1; p < end; p++)
+        {
+            if (*p < '0' || *p > '9') return false;
+            if (digits < 6)
+            {
+                frac = frac * 10 + (*p - '0');
+                digits++;
+            }
+        }
+    }
+    for (; digits < 6; digits++) frac *= 10;
+    micros = secs * 1000000 + frac;
+    return true;
+}
+
+int parseHexBytes(const char *str, int len, uint8_t *out, int max)
+{
+    if (len & 1 || len / 2 > max) return -1;
+    for (int i = 0; i < len; i += 2)
+    {
+        int hi = hexDigit(str[i]), lo = hexDigit(str[i + 1]);
+        if (hi < 0 || lo < 0) return -1;
+        out[i / 2] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return len / 2;
+}
+
+bool startsWith(const char *begin, const char *end, const char *str)
+{
+    size_t len = strlen(str);
+    return static_cast<size_t>(end - begin) >= len && !memcmp(begin, str, len);
+}
+
+bool contains(const char *begin, const char *end, char c)
+{
+    return memchr(begin, c, end - begin) != nullptr;
+}
+
+}
+
+namespace
+{
+template <class T>
+struct LoadChunk
+{
+    qint64 begin;
+    qint64 end;
+    QVector<T> frames;
+    QVector<int> untimed; //indexes into frames
+    int errors = 0;
+    bool fatal = false;
+};
+
+inline void storeFrame(QVector<CANFrame> &out, const CANFrameData &frame) { out.append(frame.toCANFrame()); }
+inline void storeFrame(QVector<CANFrameData> &out, const CANFrameData &frame) { out.append(frame); }
+}
+
+//Starts numThreads copies of worker and keeps the GUI alive until they're all done. poll runs on this
+//thread every so often while waiting.
+static void runWorkers(int numThreads, const std::function<void()> &worker, const std::function<void()> &poll)
+{
+    QList<QThread *> threads;
+    for (int t = 0; t < numThreads; t++)
+    {
+        QThread *thread = QThread::create(worker);
+        threads.append(thread);
+        thread->start();
+    }
+    for (QThread *thread : threads)
+    {
+        while (!thread->wait(50))
+        {
+            if (poll) poll();
+            qApp->processEvents();
+        }
+        delete thread;
+    }
+}
+
+//Maps the whole file, or reads it into contents where it can't be mapped (32 bit builds)
+static const char *mapFile(QFile &inFile, QByteArray &contents)
+{
+    qint64 size = inFile.size();
+    const char *data = reinterpret_cast<const char *>(inFile.map(0, size));
+    if (!data)
+    {
+        if (size > std::numeric_limits<int>::max() - 1) return nullptr;
+        contents = inFile.readAll();
+        data = contents.constData();
+    }
+    return data;
+}
+
+//Offsets the chunks start at from bodyStart on, each cut just past a line ending, with size as the last entry
+static QVector<qint64> splitLines(const char *data, qint64 bodyStart, qint64 size, qint64 chunkBytes)
+{
+    QVector<qint64> cuts;
+    qint64 pos = bodyStart;
+    while (pos < size)
+    {
+        cuts.append(pos);
+        qint64 cut = qMin(size, pos + chunkBytes);
+        if (cut < size)
+        {
+            const char *nl = static_cast<const char *>(memchr(data + cut, '\n', size - cut));
+            cut = nl ? (nl - data) + 1 : size;
+        }
+        pos = cut;
+    }
+    cuts.append(size);
+    return cuts;
+}
+
+//Runs every line of one chunk through the format. False if it gave up because of cancelled.
+template <class T>
+static bool parseChunk(const TextLogFormat &format, const char *data, LoadChunk<T> &chunk, const QAtomicInt &cancelled)
+{
+    CANFrameData frame;
+    const char *p = data + chunk.begin;
+    const char *end = data + chunk.end;
+    int lines = 0;
+    while (p < end && !chunk.fatal)
+    {
+        const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+        const char *lineEnd = nl ? nl : end;
+        const char *next = nl ? nl + 1 : end;
+        if (lineEnd > p && lineEnd[-1] == '\r') lineEnd--;
+
+        memset(&frame, 0, sizeof(frame));
+        switch (format.parseLine(p, lineEnd, frame))
+        {
+        case TextLogFormat::FrameUntimed:
+            chunk.untimed.append(chunk.frames.count());
+            storeFrame(chunk.frames, frame);
+            break;
+        case TextLogFormat::FrameWithError:
+            chunk.errors++;
+            storeFrame(chunk.frames, frame);
+            break;
+        case TextLogFormat::Frame:
+            storeFrame(chunk.frames, frame);
+            break;
+        case TextLogFormat::Error:
+            chunk.errors++;
+            break;
+        case TextLogFormat::Fatal:
+            chunk.fatal = true;
+            break;
+        case TextLogFormat::Skip:
+            break;
+        }
+        p = next;
+        if (++lines == CANCEL_CHECK_LINES)
+        {
+            lines = 0;
+            if (cancelled.loadAcquire()) return false;
+        }
+    }
+    return true;
+}
+
+bool TextLogLoader::load(const QString &filename, const TextLogFormat &format, QVector<CANFrame> *frames)
+{
+    QFile inFile(filename);
+    if (!inFile.open(QIODevice::ReadOnly)) return false;
+    qint64 size = inFile.size();
+    if (size == 0) return false;
+
+    QByteArray contents;
+    const char *data = mapFile(inFile, contents);
+    if (!data) return false;
+
+    qint64 bodyStart = format.findBody(data, size);
+    if (bodyStart < 0 || bodyStart > size) return false;
+
+    int numThreads = qMax(1, QThread::idealThreadCount());
+    qint64 chunkBytes = qMax(MIN_CHUNK_BYTES, (size - bodyStart) / (numThreads * 4) + 1);
+    QVector<qint64> cuts = splitLines(data, bodyStart, size, chunkBytes);
+    QVector<LoadChunk<CANFrame>> chunks(cuts.count() - 1);
+    for (int c = 0; c < chunks.count(); c++)
+    {
+        chunks[c].begin = cuts[c];
+        chunks[c].end = cuts[c + 1];
+    }
+    numThreads = qBound(1, numThreads, qMax(1, chunks.count()));
+
+    QProgressDialog progress(qApp->activeWindow());
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setLabelText(QObject::tr("Loading %1...").arg(QFileInfo(filename).fileName()));
+    progress.setRange(0, PROGRESS_STEPS);
+    progress.setMinimumDuration(500);
+
+    //workers go through the raw pointer, operator[] on a QVector isn't safe to call from several threads
+    LoadChunk<CANFrame> *chunkList = chunks.data();
+    int numChunks = chunks.count();
+    QAtomicInt nextChunk(0);
+    QAtomicInt cancelled(0);
+    QAtomicInteger<qint64> bytesDone(0);
+    auto parser = [&]()
+    {
+        int idx;
+        while (!cancelled.loadAcquire() && (idx = nextChunk.fetchAndAddRelaxed(1)) < numChunks)
+        {
+            LoadChunk<CANFrame> &chunk = chunkList[idx];
+            if (!parseChunk(format, data, chunk, cancelled)) return;
+            bytesDone.fetchAndAddRelaxed(chunk.end - chunk.begin);
+        }
+    };
+
+    //the cancel button belongs to this thread so it's polled here and passed on to the workers
+    runWorkers(numThreads, parser, [&]()
+    {
+        progress.setValue(static_cast<int>(bytesDone.loadAcquire() * PROGRESS_STEPS / qMax<qint64>(1, size - bodyStart)));
+        if (progress.wasCanceled()) cancelled.storeRelease(1);
+    });
+    if (cancelled.loadAcquire())
+    {
+        qDebug() << "Loading" << filename << "cancelled";
+        return false;
+    }
+
+    //everything after a fatal line is thrown away, same as a sequential loader returning right there
+    bool ok = true;
+    int usedChunks = chunks.count();
+    int64_t untimedTime = format.untimedStart;
+    qint64 total = 0;
+    QVector<qint64> firstFrame(chunks.count());
+    for (int c = 0; c < usedChunks; c++)
+    {
+        LoadChunk<CANFrame> &chunk = chunks[c];
+        if (chunk.errors) ok = false;
+        for (int idx : chunk.untimed)
+        {
+            untimedTime += format.untimedStep;
+            chunk.frames[idx].setTimeStamp(QCanBusFrame::TimeStamp(0, untimedTime));
+        }
+        firstFrame[c] = total;
+        total += chunk.frames.count();
+        if (chunk.fatal)
+        {
+            ok = false;
+            usedChunks = c + 1;
+        }
+    }
+    if (total > std::numeric_limits<int>::max() - frames->count()) return false;
+
+    //moving the frames into place is as much work as it sounds with this many of them, so it's split up too
+    int base = frames->count();
+    frames->resize(base + static_cast<int>(total));
+    CANFrame *out = frames->data() + base;
+    QAtomicInt nextMove(0);
+    auto mover = [&]()
+    {
+        int idx;
+        while ((idx = nextMove.fetchAndAddRelaxed(1)) < usedChunks)
+        {
+            QVector<CANFrame> &src = chunkList[idx].frames;
+            CANFrame *dest = out + firstFrame[idx];
+            for (int i = 0; i < src.count(); i++) dest[i] = std::move(src[i]);
+            src = QVector<CANFrame>();
+        }
+    };
+    progress.setCancelButton(nullptr);
+    runWorkers(qBound(1, numThreads, usedChunks), mover, nullptr);
+
+    return ok;
+}
+
+/*
+ * Same parsing as load but the whole file never has to fit in memory. The chunks are parsed a window at
+ * a time, numThreads * CONVERT_WINDOW of them in parallel, and the frames of the window go to the
+ * writer in file order before the next window starts. So memory use stays at a few chunks worth of
+ * frames no matter how big the log is.
+ */
+bool TextLogLoader::convert(const QString &filename, const TextLogFormat &format, CaptureFileWriter &writer, int *badLines,
+                            bool *truncated)
+{
+    if (truncated) *truncated = false;
+    if (badLines) *badLines = 0;
+    QFile inFile(filename);
+    if (!inFile.open(QIODevice::ReadOnly)) return false;
+    qint64 size = inFile.size();
+    if (size == 0) return false;
+
+    QByteArray contents;
+    const char *data = mapFile(inFile, contents);
+    if (!data) return false;
+
+    qint64 bodyStart = format.findBody(data, size);
+    if (bodyStart < 0 || bodyStart > size) return false;
+
+    QVector<qint64> cuts = splitLines(data, bodyStart, size, MIN_CHUNK_BYTES);
+    int numChunks = cuts.count() - 1;
+    int numThreads = qMax(1, QThread::idealThreadCount());
+    int windowSize = numThreads * CONVERT_WINDOW;
+
+    QProgressDialog progress(qApp->activeWindow());
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setLabelText(QObject::tr("Converting %1 for streaming...").arg(QFileInfo(filename).fileName()));
+    progress.setRange(0, PROGRESS_STEPS);
+    progress.setMinimumDuration(500);
+
+    QAtomicInt cancelled(0);
+    QAtomicInteger<qint64> bytesDone(0);
+    int64_t untimedTime = format.untimedStart;
+    auto poll = [&]()
+    {
+        progress.setValue(static_cast<int>(bytesDone.loadAcquire() * PROGRESS_STEPS / qMax<qint64>(1, size - bodyStart)));
+        if (progress.wasCanceled()) cancelled.storeRelease(1);
+    };
+
+    for (int first = 0; first < numChunks; first += windowSize)
+    {
+        QVector<LoadChunk<CANFrameData>> window(qMin(windowSize, numChunks - first));
+        for (int c = 0; c < window.count(); c++)
+        {
+            window[c].begin = cuts[first + c];
+            window[c].end = cuts[first + c + 1];
+        }
+
+        LoadChunk<CANFrameData> *chunkList = window.data();
+        int windowChunks = window.count();
+        QAtomicInt nextChunk(0);
+        auto parser = [&]()
+        {
+            int idx;
+            while (!cancelled.loadAcquire() && (idx = nextChunk.fetchAndAddRelaxed(1)) < windowChunks)
+            {
+                if (!parseChunk(format, data, chunkList[idx], cancelled)) return;
+                bytesDone.fetchAndAddRelaxed(chunkList[idx].end - chunkList[idx].begin);
+            }
+        };
+        runWorkers(qBound(1, numThreads, windowChunks), parser, poll);
+        if (cancelled.loadAcquire())
+        {
+            qDebug() << "Converting" << filename << "cancelled";
+            return false;
+        }
+
+        for (int c = 0; c < windowChunks; c++)
+        {
+            LoadChunk<CANFrameData> &chunk = chunkList[c];
+            if (badLines) *badLines += chunk.errors + (chunk.fatal ? 1 : 0);
+            for (int idx : chunk.untimed)
+            {
+                untimedTime += format.untimedStep;
+                chunk.frames[idx].timestamp = untimedTime;
+            }
+            for (const CANFrameData &frame : chunk.frames)
+            {
+                if (!writer.append(frame)) return false;
+            }
+            chunk.frames = QVector<CANFrameData>();
+            if (chunk.fatal)
+            {
+                if (truncated) *truncated = true;
+                return false;
+            }
+            poll();
+            qApp->processEvents();
+            if (cancelled.loadAcquire()) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef TEXTLOGLOADER_H
+#define TEXTLOGLOADER_H
+
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <stdint.h>
+#include "can_structs.h"
+
+class CaptureFileWriter;
+
+/*
+ * Shared engine for the line based text log formats. The file is mapped, split at line boundaries into
+ * chunks and the chunks are parsed on one thread per core. Each format only supplies a function that
+ * turns one line into a CANFrameData. Those run on the worker threads, so they must not touch anything
+ * shared and shouldn't allocate either (the helpers in TextLog below are there for that).
+ * The frames of every chunk end up in the output in file order exactly as if the file was read line
+ * by line. A progress dialog with a cancel button shows up if loading takes longer than a moment.
+ */
+struct TextLogFormat
+{
+    enum LineResult
+    {
+        Frame,          //frame filled in
+        FrameUntimed,   //frame filled in but the line had no usable time, see untimedStart
+        FrameWithError, //frame filled in as far as the line allowed, loading reports failure at the end
+        Skip,           //not a frame, no harm done
+        Error,          //looked like a frame but couldn't be read. Loading goes on but reports failure
+        Fatal           //loading stops here, the frames before this line are kept
+    };
+
+    //Given the whole file, returns the offset the frame lines start at (past any header) or -1 if the
+    //file can't be loaded. Runs once before any parseLine call so it can set up state parseLine reads.
+    std::function<qint64(const char *data, qint64 size)> findBody;
+    //begin to end is one line without its line ending, frame comes in zeroed
+    std::function<LineResult(const char *begin, const char *end, CANFrameData &frame)> parseLine;
+
+    //Frames without a time of their own get untimedStart + untimedStep, + 2 * untimedStep and so on
+    //in file order. This is what needs the whole file so it's done after the chunks are parsed.
+    int64_t untimedStart = 0;
+    int64_t untimedStep = 1;
+};
+
+class TextLogLoader
+{
+public:
+    //appends the frames to frames. False if the file couldn't be read, had errors or the user cancelled.
+    static bool load(const QString &filename, const TextLogFormat &format, QVector<CANFrame> *frames);
+    //Parses the log straight into a capture file a few chunks at a time, for logs too big to load.
+    //False if the file couldn't be read or written or the user cancelled. Lines that looked like frames
+    //but couldn't be read don't stop it, they're counted in badLines. A line the format can't go on
+    //after does, it's false too with truncated set since the capture only has what came before.
+    static bool convert(const QString &filename, const TextLogFormat &format, CaptureFileWriter &writer,
+                        int *badLines = nullptr, bool *truncated = nullptr);
+};
+
+//Parsing helpers that work straight on the mapped bytes
+namespace TextLog
+{
+    static const int MAX_TOKENS = 96;
+
+    struct Tokens
+    {
+        const char *begin[MAX_TOKENS];
+        int length[MAX_TOKENS];
+        int count;
+
+        bool equals(int idx, const char *str) const;
+        bool startsWith(int idx, const char *str) const; //case insensitive
+    };
+
+    //Splits on sep and trims whitespace around each token. A sep of ' ' splits on runs of whitespace
+    //instead, like QByteArray::simplified().split(' ') did. Tokens past MAX_TOKENS are dropped.
+    void split(const char *begin, const char *end, char sep, Tokens &out);
+
+    inline int hexDigit(char c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+    //all of these return false if there's anything other than the number in the text
+    bool parseHex(const char *str, int len, uint32_t &out);
+    bool parseInt(const char *str, int len, int64_t &out);
+    //seconds with an optional fraction into microseconds, without a round trip through double
+    bool parseSeconds(const char *str, int len, int64_t &micros);
+    //two hex digits per byte, out has room for max bytes. Returns the number of bytes or -1.
+    int parseHexBytes(const char *str, int len, uint8_t *out, int max);
+
+    bool startsWith(const char *begin, const char *end, const char *str);
+    bool contains(const char *begin, const char *end, char c);
+}
+
+#endif // TEXTLOGLOADER_H
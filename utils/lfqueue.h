@@ -5,19 +5,29 @@
 #include <QDebug>
 
 
-/* macros */
-#define IS_EMPTY()  (  mWIdx.loadAcquire()             == mRIdx.loadAcquire() )
-#define IS_FULL()   ( (mWIdx.loadAcquire()+1)%mSize    == mRIdx.loadAcquire() )
-
-
+/* size of a cache line, the two indices live on different ones so writer and reader don't keep stealing
+ * the same line from each other */
+#define LFQUEUE_CACHE_LINE 64
+
+
+/*
+ * Single producer / single consumer ring. The capacity is always a power of two and the indices run
+ * freely (they only get masked when used) so every slot can be filled and no modulo is needed.
+ *
+ * Besides the one at a time get()/queue() and peek()/dequeue() there is a bulk interface. reserve()
+ * hands the producer a run of free slots, commit() publishes however many of them were filled with a
+ * single release store. peekBulk()/release() do the same for the consumer. Runs never wrap around the
+ * end of the buffer so they may be shorter than what is available, just call again.
+ */
 template<class T>
 class LFQueue
 {
 public:
-    LFQueue() : mSize(0), mArray(nullptr){}
+    LFQueue() : mSize(0), mMask(0), mArray(nullptr), mRIdxCache(0), mWIdxCache(0) {}
 
     ~LFQueue() {setSize(0);}
 
+    /* size gets rounded up to the next power of two */
     bool setSize(int size) {
         if(size<0)
             return false;
@@ -26,11 +36,20 @@ public:
             delete[] mArray;
             mArray = nullptr;
         }
+        mSize = 0;
+        mMask = 0;
+        flush();
 
         if(size>0) {
-            mArray = new T[size];
-            if(mArray)
-                mSize = size;
+            unsigned int pow2 = 1;
+            while(pow2 < (unsigned int)size)
+                pow2 <<= 1;
+
+            mArray = new T[pow2];
+            if(mArray) {
+                mSize = pow2;
+                mMask = pow2 - 1;
+            }
             return ( mArray != nullptr );
         }
 
@@ -40,52 +59,121 @@ public:
     void flush() {
         mRIdx.storeRelease(0);
         mWIdx.storeRelease(0);
+        mWIdxCache = 0;
+        mRIdxCache = 0;
     }
 
+    /* producer: single slot */
     T* get() {
-        if(IS_FULL())
-            return nullptr;
-
-        return &(mArray[mWIdx.loadAcquire()]); /* prevent memory reordering (belt and braces) */
+        int num = 1;
+        return reserve(num);
     }
 
 
     void queue() {
+        commit(1);
+    }
+
+
+    /* producer: up to num contiguous free slots, num is set to how many were handed out */
+    T* reserve(int &num) {
+        unsigned int wIdx = mWIdx.loadRelaxed();
+        unsigned int space = mSize - (wIdx - mRIdxCache);
+        if(space < (unsigned int)num || space > mSize) {
+            /* only go for the shared index when the cached one says we're out of room (or is from before a flush) */
+            mRIdxCache = mRIdx.loadAcquire();
+            space = mSize - (wIdx - mRIdxCache);
+        }
+
+        unsigned int toEnd = mSize - (wIdx & mMask);
+        unsigned int avail = qMin(space, toEnd);
+        if(avail == 0) {
+            num = 0;
+            return nullptr;
+        }
+        if((unsigned int)num > avail)
+            num = avail;
+        return &(mArray[wIdx & mMask]);
+    }
+
+
+    void commit(int num) {
+        unsigned int wIdx = mWIdx.loadRelaxed();
         #ifdef QT_DEBUG
-        if(IS_FULL())
+        if((unsigned int)num > mSize - (wIdx - mRIdx.loadAcquire()))
             qCritical() << "BUG: queueing in full queue";
         #endif
 
-        int wIdx = mWIdx.loadAcquire();
-        mWIdx.storeRelease((wIdx+1)%mSize);
+        mWIdx.storeRelease(wIdx + num);
     }
 
 
+    /* consumer: single slot */
     T* peek() {
-        if(IS_EMPTY())
-            return nullptr;
-
-        return &(mArray[mRIdx.loadAcquire()]); /* prevent memory reordering (belt and braces) */
+        int num = 1;
+        return peekBulk(num);
     }
 
 
     void dequeue() {
+        release(1);
+    }
+
+
+    /* consumer: up to num contiguous queued slots, num is set to how many can be read */
+    T* peekBulk(int &num) {
+        unsigned int rIdx = mRIdx.loadRelaxed();
+        unsigned int queued = mWIdxCache - rIdx;
+        if(queued < (unsigned int)num || queued > mSize) {
+            mWIdxCache = mWIdx.loadAcquire();
+            queued = mWIdxCache - rIdx;
+        }
+
+        unsigned int toEnd = mSize - (rIdx & mMask);
+        unsigned int avail = qMin(queued, toEnd);
+        if(avail == 0) {
+            num = 0;
+            return nullptr;
+        }
+        if((unsigned int)num > avail)
+            num = avail;
+        return &(mArray[rIdx & mMask]);
+    }
+
+
+    void release(int num) {
+        unsigned int rIdx = mRIdx.loadRelaxed();
         #ifdef QT_DEBUG
-        if(IS_EMPTY())
+        if((unsigned int)num > mWIdx.loadAcquire() - rIdx)
             qCritical() << "BUG: dequeueing an empty queue";
         #endif
 
-        int rIdx = mRIdx.loadAcquire();
-        mRIdx.storeRelease((rIdx+1)%mSize);
+        mRIdx.storeRelease(rIdx + num);
+    }
+
+
+    /* number of queued elements, only a snapshot if the other side is running */
+    int count() {
+        return (int)(mWIdx.loadAcquire() - mRIdx.loadAcquire());
+    }
+
+
+    int capacity() const {
+        return (int)mSize;
     }
 
 
 private:
-    int mSize;
+    unsigned int mSize;
+    unsigned int mMask;
     T*  mArray;
 
-    QAtomicInt mRIdx;
-    QAtomicInt mWIdx;
+    /* the class is cache line aligned as a whole so nothing else ends up next to mRIdx either */
+    alignas(LFQUEUE_CACHE_LINE) QAtomicInteger<unsigned int> mWIdx;
+    unsigned int mRIdxCache; /* producer's last look at mRIdx */
+
+    alignas(LFQUEUE_CACHE_LINE) QAtomicInteger<unsigned int> mRIdx;
+    unsigned int mWIdxCache; /* consumer's last look at mWIdx */
 };
 
 #endif // LFQUEUE_H
@@ -0,0 +1,139 @@
+#ifndef SIGNALEXTRACTOR_H
+#define SIGNALEXTRACTOR_H
+
+#include <QByteArray>
+#include <QtEndian>
+#include <stdint.h>
+#include <string.h>
+
+
+/*
+ * Precompiled version of Utility::processIntegerSignal. compile() works out once which bytes a signal
+ * lives in and how far to shift them, extract() then does two loads, a byte swap (big endian signals
+ * only), a shift and a mask instead of walking the signal one bit at a time.
+ *
+ * Any signal of up to 64 bits spans at most 9 bytes, so it is read as a 64 bit word plus the byte after
+ * it. Payloads up to 64 bytes (CAN-FD) work the same way. The results, including returning 0 for a
+ * signal that doesn't fit the payload, match processIntegerSignal bit for bit (test/tst_signalextractor).
+ * The one exception is a signed 64 bit signal, which processIntegerSignal can't sign extend properly
+ * and which simply comes back as the two's complement value here.
+ */
+class SignalExtractor
+{
+public:
+    SignalExtractor() : mStartBit(-1), mSigSize(0), mLittleEndian(false), mIsSigned(false),
+        mValid(false), mNeedsPadding(false), mFirstByte(0), mShift(0), mMinLength(0), mMask(0), mSignBit(0) {}
+
+    SignalExtractor(int startBit, int sigSize, bool littleEndian, bool isSigned) : SignalExtractor()
+    {
+        compile(startBit, sigSize, littleEndian, isSigned);
+    }
+
+    void compile(int startBit, int sigSize, bool littleEndian, bool isSigned)
+    {
+        mStartBit = startBit;
+        mSigSize = sigSize;
+        mLittleEndian = littleEndian;
+        mIsSigned = isSigned;
+
+        //nonsense parameters or a signal that starts past the end of the largest frame always give 0
+        mValid = (startBit >= 0) && (startBit < 512) && (sigSize > 0) && (sigSize <= 64);
+        if (!mValid) return;
+
+        mMask = (sigSize == 64) ? ~0ULL : ((1ULL << sigSize) - 1);
+        mSignBit = (isSigned && sigSize < 64) ? (1ULL << (sigSize - 1)) : 0;
+        mFirstByte = startBit / 8;
+
+        //Same bit walk processIntegerSignal does, only once, to find the last byte the signal touches.
+        //Bits from 512 up are never read and count as 0.
+        int lastByte = -1;
+        bool pastEnd = false;
+        int bit = startBit;
+        for (int bitpos = 0; bitpos < sigSize; bitpos++)
+        {
+            if (bit >= 512) pastEnd = true;
+            else if ((bit / 8) > lastByte) lastByte = bit / 8;
+            if (littleEndian) bit++;
+            else if ((bit % 8) == 0) bit += 15;
+            else bit--;
+        }
+        mMinLength = qMax((startBit + sigSize) / 8, lastByte + 1);
+        mNeedsPadding = pastEnd || (mFirstByte + 9 > 64);
+
+        if (littleEndian)
+        {
+            //bits run upward from startBit through the little endian 72 bit window
+            mShift = startBit % 8;
+        }
+        else
+        {
+            //Motorola bits run downward within a byte then on to the top of the next byte. Numbered MSB first
+            //that's just sigSize consecutive bits of a big endian window starting 7 - (startBit % 8) bits in.
+            //mShift is how far to shift the 72 bit window right to bring the last of them down to bit 0
+            mShift = 72 - (7 - (startBit % 8)) - sigSize;
+        }
+    }
+
+    bool matches(int startBit, int sigSize, bool littleEndian, bool isSigned) const
+    {
+        return (mStartBit == startBit) && (mSigSize == sigSize) && (mLittleEndian == littleEndian) && (mIsSigned == isSigned);
+    }
+
+    //shortest payload the signal can be extracted from, anything shorter gives 0
+    int minLength() const { return mValid ? mMinLength : 0; }
+
+    int64_t extract(const uint8_t *data, int len) const
+    {
+        if (!mValid || len < mMinLength) return 0;
+
+        const uint8_t *window = data + mFirstByte;
+        uint8_t padded[80];
+        if (mNeedsPadding || mFirstByte + 9 > len)
+        {
+            //signal sits at the very end of the payload, read it from a zero filled copy instead of past the end
+            int copyLen = qMin(len, 64);
+            memset(padded, 0, sizeof(padded));
+            memcpy(padded, data, copyLen);
+            window = padded + mFirstByte;
+        }
+
+        uint64_t result;
+        if (mLittleEndian)
+        {
+            uint64_t word = qFromLittleEndian<quint64>(window);
+            result = word >> mShift;
+            if (mShift) result |= static_cast<uint64_t>(window[8]) << (64 - mShift);
+        }
+        else
+        {
+            uint64_t word = qFromBigEndian<quint64>(window);
+            if (mShift >= 8) result = word >> (mShift - 8);
+            else result = (word << (8 - mShift)) | (window[8] >> mShift);
+        }
+        result &= mMask;
+
+        if (result & mSignBit) result |= ~mMask;
+        return static_cast<int64_t>(result);
+    }
+
+    int64_t extract(const QByteArray &data) const
+    {
+        return extract(reinterpret_cast<const uint8_t *>(data.constData()), data.size());
+    }
+
+private:
+    int mStartBit;
+    int mSigSize;
+    bool mLittleEndian;
+    bool mIsSigned;
+
+    bool mValid;
+    bool mNeedsPadding;
+    int mFirstByte;
+    int mShift;
+    int mMinLength;
+    uint64_t mMask;
+    uint64_t mSignBit;
+};
+
+#endif // SIGNALEXTRACTOR_H